@@ -0,0 +1,139 @@
+//
+// Replacements of the global operator new and operator delete that count the
+// heap allocations for BenchSuite.h. They live in their own source file, so
+// the benchmarks never see them next to the allocations they count; it's
+// compiled into every benchmark executable that includes BenchSuite.h.
+//
+
+#include "BenchSuite.h"
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    void* allocate(std::size_t size)
+    {
+        ++bench::allocationCount();
+        return std::malloc(size ? size : 1);
+    }
+
+    void* allocateAligned(std::size_t size, std::align_val_t alignment)
+    {
+        ++bench::allocationCount();
+        auto align{ static_cast<std::size_t>(alignment) };
+        // aligned_alloc wants a size multiple of the alignment
+        std::size_t rounded{ (size + align - 1) / align * align };
+        return std::aligned_alloc(align, rounded ? rounded : align);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    if (void* p{ allocate(size) })
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* p{ allocateAligned(size, alignment) })
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, alignment);
+}
+
+// malloc and aligned_alloc memory is released alike, so every form of
+// delete comes down to free
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
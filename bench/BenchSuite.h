@@ -0,0 +1,191 @@
+//
+// Small harness for the benchmarks: timing with an adaptive amount of
+// iterations, heap allocation counting and JSON output.
+// Allocations are counted by the operator new of BenchAllocations.cpp, which
+// must be compiled into every benchmark executable using this header.
+//
+
+#ifndef ELEM_GEOMETRICOS_BENCHSUITE_H
+#define ELEM_GEOMETRICOS_BENCHSUITE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    /*
+     * Amount of calls to any form of operator new since the program started.
+     */
+    inline std::atomic<long>& allocationCount()
+    {
+        static std::atomic<long> count{ 0 };
+        return count;
+    }
+
+    /*
+     * Keeps the compiler from dropping the computation of value.
+     */
+    template <class V>
+    void keep(const V &value)
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    template <class T> const char* typeName();
+    template <> inline const char* typeName<int>() { return "int"; }
+    template <> inline const char* typeName<float>() { return "float"; }
+    template <> inline const char* typeName<double>() { return "double"; }
+
+    struct Result
+    {
+        std::string name;
+        std::string type;
+        long size;
+        long batch;
+        long iterations;
+        double nsPerOp;
+        double itemsPerSecond;
+        double allocationsPerOp;
+    };
+
+    /*
+     * Runs benchmarks and collects their results. Command line options:
+     *   --filter text   only run the benchmarks whose name has text
+     *   --max-size n    skip sizes above n
+     *   --min-time s    time each benchmark for at least s seconds (0.2)
+     *   --json path     write the results to path as JSON
+     */
+    class Suite
+    {
+    private:
+        std::string m_filter;
+        long m_maxSize{ 1000000 };
+        double m_minTime{ 0.2 };
+        std::string m_jsonPath;
+        std::vector<Result> m_results;
+
+    public:
+        Suite(int argc, char** argv)
+        {
+            for(int i{ 1 }; i + 1 < argc; i += 2)
+            {
+                std::string option{ argv[i] };
+                if (option == "--filter")
+                {
+                    m_filter = argv[i + 1];
+                }
+                else if (option == "--max-size")
+                {
+                    m_maxSize = std::atol(argv[i + 1]);
+                }
+                else if (option == "--min-time")
+                {
+                    m_minTime = std::atof(argv[i + 1]);
+                }
+                else if (option == "--json")
+                {
+                    m_jsonPath = argv[i + 1];
+                }
+            }
+            std::printf("%-28s %-7s %9s %7s %14s %14s %10s\n",
+                        "benchmark", "type", "size", "batch", "ns/op", "items/s", "allocs/op");
+        }
+
+        /*
+         * Whether a benchmark with that name and size would run, so its setup
+         * can be skipped otherwise.
+         */
+        bool enabled(const std::string &name, long size) const
+        {
+            return size <= m_maxSize && name.find(m_filter) != std::string::npos;
+        }
+
+        /*
+         * Times op(), which handles batch items, doubling the amount of
+         * calls until they take at least the minimum time.
+         */
+        template <class Op>
+        void run(const std::string &name, const char* type, long size, long batch, Op op)
+        {
+            if (!enabled(name, size))
+            {
+                return;
+            }
+            op();
+            long iterations{ 1 };
+            while (true)
+            {
+                long allocationsBefore{ allocationCount().load() };
+                auto start{ std::chrono::steady_clock::now() };
+                for(long i{}; i < iterations; ++i)
+                {
+                    op();
+                }
+                double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+                long allocations{ allocationCount().load() - allocationsBefore };
+                if (seconds >= m_minTime || iterations >= (1L << 40))
+                {
+                    Result result{ name, type, size, batch, iterations, seconds * 1e9 / iterations,
+                                   static_cast<double>(batch) * iterations / seconds,
+                                   static_cast<double>(allocations) / iterations };
+                    std::printf("%-28s %-7s %9ld %7ld %14.2f %14.4g %10.2f\n", name.c_str(), type, size, batch,
+                                result.nsPerOp, result.itemsPerSecond, result.allocationsPerOp);
+                    m_results.push_back(result);
+                    return;
+                }
+                // aim a bit past the minimum time from this measure
+                double scale{ (seconds > 0) ? 1.4 * m_minTime / seconds : 16.0 };
+                iterations = static_cast<long>(iterations * std::min(16.0, std::max(2.0, scale)));
+            }
+        }
+
+        void writeJson(std::ostream &out) const
+        {
+            out << "{\n  \"benchmarks\": [";
+            for(std::size_t i{}; i < m_results.size(); ++i)
+            {
+                const Result &r{ m_results[i] };
+                out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"type\": \"" << r.type
+                    << "\", \"size\": " << r.size << ", \"batch\": " << r.batch
+                    << ", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.nsPerOp
+                    << ", \"items_per_second\": " << r.itemsPerSecond
+                    << ", \"allocations_per_op\": " << r.allocationsPerOp << "}";
+            }
+            out << "\n  ]\n}\n";
+        }
+
+        /*
+         * Writes the JSON file when asked for. Returns the exit code.
+         */
+        int finish() const
+        {
+            if (m_jsonPath.empty())
+            {
+                return 0;
+            }
+            std::ofstream out{ m_jsonPath };
+            writeJson(out);
+            if (!out)
+            {
+                std::fprintf(stderr, "can't write %s\n", m_jsonPath.c_str());
+                return 1;
+            }
+            std::printf("results written to %s\n", m_jsonPath.c_str());
+            return 0;
+        }
+    };
+}
+
+#endif //ELEM_GEOMETRICOS_BENCHSUITE_H
@@ -0,0 +1,86 @@
+//
+// Construction cost against query speed of PoligonoBandIndex. For each
+// polygon size it prints the time to build the index, the time per query of
+// Poligono::pointInside and of the index, and the amount of queries after
+// which building the index pays off.
+//
+
+#include <elem_geometricos.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace setup
+{
+    /*
+     * Star shaped polygon with a wavy boundary and n vertices.
+     */
+    std::vector<Punto<double>> wavyStar(int n)
+    {
+        std::vector<Punto<double>> vertices;
+        vertices.reserve(static_cast<std::size_t>(n));
+        for(int i{}; i < n; ++i)
+        {
+            double angle{ 2 * M_PI * i / n };
+            double radius{ 1 + 0.3 * std::sin(37 * angle) + 0.05 * std::cos(301 * angle) };
+            vertices.push_back(Punto<double>{ radius * std::cos(angle), radius * std::sin(angle) });
+        }
+        return vertices;
+    }
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    std::mt19937 gen{ 1 };
+    std::uniform_real_distribution<double> coord{ -1.4, 1.4 };
+
+    std::printf("%10s %12s %16s %16s %12s\n",
+                "vertices", "build [ms]", "linear [ns/q]", "index [ns/q]", "break-even");
+    for(int n: { 100, 1000, 10000, 100000, 1000000 })
+    {
+        std::vector<Punto<double>> vertices{ setup::wavyStar(n) };
+        const Poligono<double> star{ vertices.begin(), vertices.end() };
+
+        auto start{ std::chrono::steady_clock::now() };
+        const PoligonoBandIndex<double> index{ star };
+        double buildSeconds{ secondsSince(start) };
+
+        // keep the linear scan to roughly 10^8 edge tests
+        int linearQueries{ std::max(20, 100000000 / n) };
+        int indexQueries{ 1000000 };
+        std::vector<Punto<double>> queries;
+        for(int i{}; i < indexQueries; ++i)
+        {
+            queries.push_back(Punto<double>{ coord(gen), coord(gen) });
+        }
+
+        int insideLinear{ };
+        start = std::chrono::steady_clock::now();
+        for(int i{}; i < linearQueries; ++i)
+        {
+            insideLinear += star.pointInside(queries[i]);
+        }
+        double linearPerQuery{ secondsSince(start) / linearQueries };
+
+        int insideIndex{ };
+        start = std::chrono::steady_clock::now();
+        for(const Punto<double> &q: queries)
+        {
+            insideIndex += index.pointInside(q);
+        }
+        double indexPerQuery{ secondsSince(start) / indexQueries };
+
+        double breakEven{ buildSeconds / (linearPerQuery - indexPerQuery) };
+        // printing the inside counts keeps the queries from being optimized away
+        std::printf("%10d %12.3f %16.1f %16.1f %12.0f   (inside: %d, %d)\n", n, buildSeconds * 1e3,
+                    linearPerQuery * 1e9, indexPerQuery * 1e9, breakEven,
+                    insideIndex, insideLinear);
+    }
+    return 0;
+}
@@ -0,0 +1,325 @@
+//
+// Time per operation, throughput and heap allocations of the basic kernels
+// for int, float and double: Poligono::pointInside over polygon sizes,
+// Poligono::pointsInside over batch sizes, Poligono::doubleSignedArea,
+// PolygonClipper::clipToGrid, rankVertices, VertexRanking::extract,
+// PolygonRTree::locate, Segmento::length, the Punto and Vector operators
+// and the PointBuffer3D kernels.
+// Run it through the bench target to get the results as JSON as well; see
+// BenchSuite.h for the options.
+//
+
+#include <elem_geometricos.h>
+#include "BenchSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace setup
+{
+    const long polygonSizes[]{ 10, 100, 1000, 10000, 100000, 1000000 };
+    const int batchSizes[]{ 16, 1024, 65536 };
+    // vertices of the polygon for the batch benchmarks
+    const int BATCH_POLYGON_SIZE{ 1000 };
+    // squares per side of the partition for the R-tree benchmarks
+    const int RTREE_SIDE{ 256 };
+    // items handled by each call of the element wise benchmarks
+    const int VALUE_BATCH{ 1024 };
+
+    /*
+     * Scale of the coordinates, so int polygons keep their shape while their
+     * areas still fit.
+     */
+    template <class T> double scale() { return 1.0; }
+    template <> double scale<int>() { return 10000.0; }
+
+    template <class T>
+    T coordinate(double value)
+    {
+        return static_cast<T>(std::lround(value * scale<T>()));
+    }
+
+    template <>
+    float coordinate<float>(double value)
+    {
+        return static_cast<float>(value);
+    }
+
+    template <>
+    double coordinate<double>(double value)
+    {
+        return value;
+    }
+
+    /*
+     * Star shaped polygon with a wavy boundary and n vertices.
+     */
+    template <class T>
+    std::vector<Punto<T>> wavyStar(long n)
+    {
+        std::vector<Punto<T>> vertices;
+        vertices.reserve(static_cast<std::size_t>(n));
+        for(long i{}; i < n; ++i)
+        {
+            double angle{ 2 * M_PI * i / n };
+            double radius{ 1 + 0.3 * std::sin(37 * angle) + 0.05 * std::cos(301 * angle) };
+            vertices.push_back(Punto<T>{ coordinate<T>(radius * std::cos(angle)),
+                                         coordinate<T>(radius * std::sin(angle)) });
+        }
+        return vertices;
+    }
+
+    template <class T>
+    std::vector<Punto<T>> randomPoints(int count, double limit, unsigned seed)
+    {
+        std::mt19937 gen{ seed };
+        std::uniform_real_distribution<double> coord{ -limit, limit };
+        std::vector<Punto<T>> points;
+        points.reserve(static_cast<std::size_t>(count));
+        for(int i{}; i < count; ++i)
+        {
+            points.push_back(Punto<T>{ coordinate<T>(coord(gen)), coordinate<T>(coord(gen)) });
+        }
+        return points;
+    }
+}
+
+template <class T>
+void benchPolygons(bench::Suite &suite)
+{
+    const char* type{ bench::typeName<T>() };
+    std::vector<Punto<T>> queries{ setup::randomPoints<T>(setup::VALUE_BATCH, 1.4, 1) };
+    for(long n: setup::polygonSizes)
+    {
+        if (!suite.enabled("pointInside", n) && !suite.enabled("doubleSignedArea", n))
+        {
+            continue;
+        }
+        std::vector<Punto<T>> vertices{ setup::wavyStar<T>(n) };
+        const Poligono<T> star{ vertices.begin(), vertices.end() };
+
+        std::size_t next{ };
+        suite.run("pointInside", type, n, 1, [&]() {
+            bool inside{ star.pointInside(queries[next]) };
+            bench::keep(inside);
+            next = (next + 1) % queries.size();
+        });
+        suite.run("doubleSignedArea", type, n, 1, [&]() {
+            auto area{ star.doubleSignedArea() };
+            bench::keep(area);
+        });
+    }
+
+    std::vector<Punto<T>> vertices{ setup::wavyStar<T>(setup::BATCH_POLYGON_SIZE) };
+    const Poligono<T> star{ vertices.begin(), vertices.end() };
+    for(int batch: setup::batchSizes)
+    {
+        if (!suite.enabled("pointsInside", setup::BATCH_POLYGON_SIZE))
+        {
+            continue;
+        }
+        std::vector<Punto<T>> points{ setup::randomPoints<T>(batch, 1.4, 2) };
+        std::vector<T> xs;
+        std::vector<T> ys;
+        for(const Punto<T> &p: points)
+        {
+            xs.push_back(p.getX());
+            ys.push_back(p.getY());
+        }
+        std::unique_ptr<bool[]> inside{ new bool[static_cast<std::size_t>(batch)] };
+        suite.run("pointsInside", type, setup::BATCH_POLYGON_SIZE, batch, [&]() {
+            star.pointsInside(xs.data(), ys.data(), batch, inside.get());
+            bench::keep(inside[0]);
+        });
+    }
+
+    if (suite.enabled("clipToGrid", setup::BATCH_POLYGON_SIZE))
+    {
+        // 16x16 tiles over the bounding box of the star
+        T tile{ setup::coordinate<T>(2.8 / 16) };
+        const TileGrid<T> grid{ setup::coordinate<T>(-1.4), setup::coordinate<T>(-1.4), tile, tile, 16, 16 };
+        PolygonClipper<T> clipper;
+        PolygonSet<T> pieces;
+        std::vector<int> tiles;
+        suite.run("clipToGrid", type, setup::BATCH_POLYGON_SIZE, 1, [&]() {
+            pieces.clear();
+            tiles.clear();
+            int count{ clipper.clipToGrid(star, grid, pieces, tiles) };
+            bench::keep(count);
+        });
+    }
+
+    if (suite.enabled("rankVertices", setup::BATCH_POLYGON_SIZE) || suite.enabled("extract", setup::BATCH_POLYGON_SIZE))
+    {
+        PolygonSet<T> set;
+        set.push_back(star);
+        suite.run("rankVertices/DouglasPeucker", type, setup::BATCH_POLYGON_SIZE, 1, [&]() {
+            VertexRanking ranking{ rankVertices(set, SimplificationMethod::DOUGLAS_PEUCKER, 1) };
+            bench::keep(ranking);
+        });
+        suite.run("rankVertices/Visvalingam", type, setup::BATCH_POLYGON_SIZE, 1, [&]() {
+            VertexRanking ranking{ rankVertices(set, SimplificationMethod::VISVALINGAM, 1) };
+            bench::keep(ranking);
+        });
+        // a tenth of the vertices kept
+        VertexRanking ranking{ rankVertices(set, SimplificationMethod::VISVALINGAM, 1) };
+        std::vector<double> importance(ranking.getImportance(), ranking.getImportance() + set.getVertexCount());
+        std::nth_element(importance.begin(), importance.begin() + 9 * importance.size() / 10, importance.end());
+        double tolerance{ importance[9 * importance.size() / 10] };
+        PolygonSet<T> simplified;
+        suite.run("VertexRanking::extract", type, setup::BATCH_POLYGON_SIZE, 1, [&]() {
+            simplified.clear();
+            ranking.extract(set, tolerance, simplified);
+            bench::keep(simplified);
+        });
+    }
+
+    if (suite.enabled("PolygonRTree::locate", setup::RTREE_SIDE * setup::RTREE_SIDE))
+    {
+        // a partition of [-1.4, 1.4]^2 in squares
+        PolygonSet<T> squares;
+        double side{ 2.8 / setup::RTREE_SIDE };
+        for(int y{}; y < setup::RTREE_SIDE; ++y)
+        {
+            for(int x{}; x < setup::RTREE_SIDE; ++x)
+            {
+                T x0{ setup::coordinate<T>(-1.4 + x * side) };
+                T y0{ setup::coordinate<T>(-1.4 + y * side) };
+                T x1{ setup::coordinate<T>(-1.4 + (x + 1) * side) };
+                T y1{ setup::coordinate<T>(-1.4 + (y + 1) * side) };
+                squares.push_back(Poligono<T>{ { x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y1 } });
+            }
+        }
+        const PolygonRTree<T> tree{ squares };
+        std::size_t nextQuery{ };
+        suite.run("PolygonRTree::locate", type, setup::RTREE_SIDE * setup::RTREE_SIDE, 1, [&]() {
+            int found{ tree.locate(queries[nextQuery]) };
+            bench::keep(found);
+            nextQuery = (nextQuery + 1) % queries.size();
+        });
+    }
+}
+
+template <class T>
+void benchValues(bench::Suite &suite)
+{
+    const char* type{ bench::typeName<T>() };
+    const int n{ setup::VALUE_BATCH };
+    std::vector<Punto<T>> a{ setup::randomPoints<T>(n, 100, 3) };
+    std::vector<Punto<T>> b{ setup::randomPoints<T>(n, 100, 4) };
+    std::vector<Segmento<T>> segments;
+    std::vector<Vector<T>> u;
+    std::vector<Vector<T>> v;
+    for(int i{}; i < n; ++i)
+    {
+        segments.push_back(Segmento<T>{ a[i], b[i] });
+        u.push_back(Vector<T>{ a[i] });
+        v.push_back(Vector<T>{ b[i] });
+    }
+
+    suite.run("Segmento::length", type, n, n, [&]() {
+        double total{ };
+        for(int i{}; i < n; ++i)
+        {
+            total += segments[i].length();
+        }
+        bench::keep(total);
+    });
+    suite.run("Punto::operator+", type, n, n, [&]() {
+        for(int i{}; i < n; ++i)
+        {
+            Punto<T> sum{ a[i] + b[i] };
+            bench::keep(sum);
+        }
+    });
+    suite.run("Punto::operator-", type, n, n, [&]() {
+        for(int i{}; i < n; ++i)
+        {
+            Punto<T> difference{ a[i] - b[i] };
+            bench::keep(difference);
+        }
+    });
+    suite.run("Punto::operator*", type, n, n, [&]() {
+        for(int i{}; i < n; ++i)
+        {
+            Punto<T> scaled{ a[i] * static_cast<T>(3) };
+            bench::keep(scaled);
+        }
+    });
+    suite.run("Punto::(a-b)*s+c", type, n, n, [&]() {
+        for(int i{}; i < n; ++i)
+        {
+            Punto<T> chained{ (a[i] - b[i])*static_cast<T>(3) + a[i] };
+            bench::keep(chained);
+        }
+    });
+    suite.run("Punto::operator==", type, n, n, [&]() {
+        int equal{ };
+        for(int i{}; i < n; ++i)
+        {
+            equal += (a[i] == b[i]);
+        }
+        bench::keep(equal);
+    });
+    suite.run("Vector::operator+", type, n, n, [&]() {
+        for(int i{}; i < n; ++i)
+        {
+            Vector<T> sum{ u[i] + v[i] };
+            bench::keep(sum);
+        }
+    });
+    suite.run("Vector::operator-", type, n, n, [&]() {
+        for(int i{}; i < n; ++i)
+        {
+            Vector<T> difference{ u[i] - v[i] };
+            bench::keep(difference);
+        }
+    });
+    suite.run("Vector::dotProduct", type, n, n, [&]() {
+        T total{ };
+        for(int i{}; i < n; ++i)
+        {
+            total += dotProduct(u[i], v[i]);
+        }
+        bench::keep(total);
+    });
+    suite.run("Vector::crossProdValue", type, n, n, [&]() {
+        T total{ };
+        for(int i{}; i < n; ++i)
+        {
+            total += crossProdValue(u[i], v[i]);
+        }
+        bench::keep(total);
+    });
+
+    // the 3D points take their Z from the second set
+    PointBuffer3D<T> buffer3D;
+    for(int i{}; i < n; ++i)
+    {
+        buffer3D.push_back(Punto3D<T>{ a[i].getX(), a[i].getY(), b[i].getX() });
+    }
+    std::vector<double> norms(static_cast<std::size_t>(n));
+    std::vector<PlaneSide> sides(static_cast<std::size_t>(n));
+    suite.run("PointBuffer3D::norms", type, n, n, [&]() {
+        buffer3D.norms(norms.data());
+        bench::keep(norms[n - 1]);
+    });
+    suite.run("PointBuffer3D::planeSides", type, n, n, [&]() {
+        buffer3D.planeSides(buffer3D[0], buffer3D[1], buffer3D[2], sides.data());
+        bench::keep(sides[n - 1]);
+    });
+}
+
+int main(int argc, char** argv) {
+    bench::Suite suite{ argc, argv };
+    benchPolygons<int>(suite);
+    benchPolygons<float>(suite);
+    benchPolygons<double>(suite);
+    benchValues<int>(suite);
+    benchValues<float>(suite);
+    benchValues<double>(suite);
+    return suite.finish();
+}
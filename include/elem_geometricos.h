@@ -9,6 +9,24 @@
 #include "../src/Vector.h"
 #include "../src/Poligono.h"
 #include "../src/FloatComparison.h"
+#include "../src/Predicates.h"
 #include "../src/Segmento.h"
+#include "../src/PointBuffer.h"
+#include "../src/PreparedPoligono.h"
+#include "../src/PoligonoBandIndex.h"
+#include "../src/PolygonSet.h"
+#include "../src/PolygonArea.h"
+#include "../src/ConvexHull.h"
+#include "../src/SegmentIntersection.h"
+#include "../src/ConvexPoligono.h"
+#include "../src/Triangulation.h"
+#include "../src/BinaryFormat.h"
+#include "../src/PolygonParser.h"
+#include "../src/Clipping.h"
+#include "../src/Simplification.h"
+#include "../src/PolygonRTree.h"
+#include "../src/BatchQueries.h"
+#include "../src/PointBuffer3D.h"
+#include "../src/PointKdTree.h"
 
 #endif //ELEM_GEOMETRICOS_ELEM_GEOMETRICOS_H
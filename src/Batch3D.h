@@ -0,0 +1,423 @@
+//
+// Batched 3D kernels over coordinates stored as separate X, Y and Z arrays:
+// norms, dot products against one vector and sides of one plane, several
+// points at a time when SSE2 or AVX are available.
+//
+
+#ifndef ELEM_GEOMETRICOS_BATCH3D_H
+#define ELEM_GEOMETRICOS_BATCH3D_H
+
+#include "Punto.h"
+#include "WideArithmetic.h"
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * Side of a plane on which a point lies, see PlaneEquation.
+ */
+enum class PlaneSide : signed char
+{
+    BELOW = -1,
+    ON = 0,
+    ABOVE = 1
+};
+
+/*
+ * Plane a*x + b*y + c*z + d = 0. Integer coefficients are kept in their
+ * OrientationType, where the ones of planeThrough are exact, and so is the
+ * value of the equation at an int32 point.
+ */
+template <class T>
+struct PlaneEquation
+{
+    OrientationType<T> a;
+    OrientationType<T> b;
+    OrientationType<T> c;
+    OrientationType<T> d;
+};
+
+/*
+ * Returns the plane through p, q and r whose normal (a, b, c) is the cross
+ * product (q - p) x (r - p). Points above the plane, where p, q and r are
+ * seen in counter clockwise order, give a positive value, as in orient3d.
+ */
+template <class T>
+PlaneEquation<T> planeThrough(const Punto3D<T> &p, const Punto3D<T> &q, const Punto3D<T> &r)
+{
+    using Difference = WideType<T>;
+    using Coefficient = OrientationType<T>;
+    Difference pqX{ static_cast<Difference>(q.getX()) - p.getX() };
+    Difference pqY{ static_cast<Difference>(q.getY()) - p.getY() };
+    Difference pqZ{ static_cast<Difference>(q.getZ()) - p.getZ() };
+    Difference prX{ static_cast<Difference>(r.getX()) - p.getX() };
+    Difference prY{ static_cast<Difference>(r.getY()) - p.getY() };
+    Difference prZ{ static_cast<Difference>(r.getZ()) - p.getZ() };
+    Coefficient a{ static_cast<Coefficient>(pqY) * prZ - static_cast<Coefficient>(pqZ) * prY };
+    Coefficient b{ static_cast<Coefficient>(pqZ) * prX - static_cast<Coefficient>(pqX) * prZ };
+    Coefficient c{ static_cast<Coefficient>(pqX) * prY - static_cast<Coefficient>(pqY) * prX };
+    Coefficient d{ -(a * p.getX() + b * p.getY() + c * p.getZ()) };
+    return PlaneEquation<T>{ a, b, c, d };
+}
+
+/*
+ * Returns the side of the plane for the value of its equation, which is ON
+ * when it's within tolerance of 0, like lineSide does for lines.
+ */
+template <class V, class T>
+PlaneSide planeSide(V value, T tolerance)
+{
+    if (value > 0 && !(value < tolerance))
+    {
+        return PlaneSide::ABOVE;
+    }
+    if (value < 0 && !(-value < tolerance))
+    {
+        return PlaneSide::BELOW;
+    }
+    return PlaneSide::ON;
+}
+
+/*
+ * Stores in out[i] the euclidean norm of the vector (xs[i], ys[i], zs[i]),
+ * the same value as Vector3D::euclideanNorm. This is the scalar version, used
+ * for any type without a vectorized specialization.
+ */
+template <class T>
+void batchNorm(const T* xs, const T* ys, const T* zs, int count, double* out)
+{
+    using Wide = WideType<T>;
+    using Sum = OrientationType<T>;
+    for(int i{}; i < count; ++i)
+    {
+        Sum squares{ static_cast<Sum>(static_cast<Wide>(xs[i]) * xs[i]) + static_cast<Wide>(ys[i]) * ys[i]
+                     + static_cast<Wide>(zs[i]) * zs[i] };
+        out[i] = std::sqrt(static_cast<double>(squares));
+    }
+}
+
+/*
+ * Stores in out[i] the dot product of (vx, vy, vz) and (xs[i], ys[i], zs[i]),
+ * the same value as dotProduct of both as Vector3D. Scalar version.
+ */
+template <class T>
+void batchDotProduct(T vx, T vy, T vz, const T* xs, const T* ys, const T* zs, int count, OrientationType<T>* out)
+{
+    using Wide = WideType<T>;
+    using Sum = OrientationType<T>;
+    for(int i{}; i < count; ++i)
+    {
+        out[i] = static_cast<Sum>(static_cast<Wide>(vx) * xs[i]) + static_cast<Wide>(vy) * ys[i]
+                 + static_cast<Wide>(vz) * zs[i];
+    }
+}
+
+/*
+ * Stores in out[i] the side of plane on which the point (xs[i], ys[i],
+ * zs[i]) lies, see planeSide. Scalar version.
+ */
+template <class T>
+void batchPlaneSide(const PlaneEquation<T> &plane, T tolerance, const T* xs, const T* ys, const T* zs,
+                    int count, PlaneSide* out)
+{
+    for(int i{}; i < count; ++i)
+    {
+        out[i] = planeSide(plane.a * xs[i] + plane.b * ys[i] + plane.c * zs[i] + plane.d, tolerance);
+    }
+}
+
+#if defined(__AVX__) || defined(__SSE2__)
+
+/*
+ * Writes the sides of lanes points given the bit masks of the lanes above
+ * and below the plane.
+ */
+inline void storePlaneSides(int aboveBits, int belowBits, int lanes, PlaneSide* out)
+{
+    for(int k{}; k < lanes; ++k)
+    {
+        out[k] = static_cast<PlaneSide>(((aboveBits >> k) & 1) - ((belowBits >> k) & 1));
+    }
+}
+
+#endif
+
+#if defined(__AVX__)
+
+template <>
+inline void batchNorm(const double* xs, const double* ys, const double* zs, int count, double* out)
+{
+    int i{};
+    for(; i + 4 <= count; i += 4)
+    {
+        __m256d x{ _mm256_loadu_pd(xs + i) };
+        __m256d y{ _mm256_loadu_pd(ys + i) };
+        __m256d z{ _mm256_loadu_pd(zs + i) };
+        __m256d squares{ _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y)),
+                                       _mm256_mul_pd(z, z)) };
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(squares));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = std::sqrt(xs[i] * xs[i] + ys[i] * ys[i] + zs[i] * zs[i]);
+    }
+}
+
+/*
+ * The sum of squares is taken in float, as Vector3D<float>::euclideanNorm
+ * does, and the square root in double.
+ */
+template <>
+inline void batchNorm(const float* xs, const float* ys, const float* zs, int count, double* out)
+{
+    int i{};
+    for(; i + 8 <= count; i += 8)
+    {
+        __m256 x{ _mm256_loadu_ps(xs + i) };
+        __m256 y{ _mm256_loadu_ps(ys + i) };
+        __m256 z{ _mm256_loadu_ps(zs + i) };
+        __m256 squares{ _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)),
+                                      _mm256_mul_ps(z, z)) };
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(squares))));
+        _mm256_storeu_pd(out + i + 4, _mm256_sqrt_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(squares, 1))));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = std::sqrt(static_cast<double>(xs[i] * xs[i] + ys[i] * ys[i] + zs[i] * zs[i]));
+    }
+}
+
+template <>
+inline void batchDotProduct(double vx, double vy, double vz, const double* xs, const double* ys,
+                            const double* zs, int count, double* out)
+{
+    const __m256d wx{ _mm256_set1_pd(vx) };
+    const __m256d wy{ _mm256_set1_pd(vy) };
+    const __m256d wz{ _mm256_set1_pd(vz) };
+    int i{};
+    for(; i + 4 <= count; i += 4)
+    {
+        __m256d xy{ _mm256_add_pd(_mm256_mul_pd(wx, _mm256_loadu_pd(xs + i)),
+                                  _mm256_mul_pd(wy, _mm256_loadu_pd(ys + i))) };
+        _mm256_storeu_pd(out + i, _mm256_add_pd(xy, _mm256_mul_pd(wz, _mm256_loadu_pd(zs + i))));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = vx * xs[i] + vy * ys[i] + vz * zs[i];
+    }
+}
+
+template <>
+inline void batchDotProduct(float vx, float vy, float vz, const float* xs, const float* ys,
+                            const float* zs, int count, float* out)
+{
+    const __m256 wx{ _mm256_set1_ps(vx) };
+    const __m256 wy{ _mm256_set1_ps(vy) };
+    const __m256 wz{ _mm256_set1_ps(vz) };
+    int i{};
+    for(; i + 8 <= count; i += 8)
+    {
+        __m256 xy{ _mm256_add_ps(_mm256_mul_ps(wx, _mm256_loadu_ps(xs + i)),
+                                 _mm256_mul_ps(wy, _mm256_loadu_ps(ys + i))) };
+        _mm256_storeu_ps(out + i, _mm256_add_ps(xy, _mm256_mul_ps(wz, _mm256_loadu_ps(zs + i))));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = vx * xs[i] + vy * ys[i] + vz * zs[i];
+    }
+}
+
+template <>
+inline void batchPlaneSide(const PlaneEquation<double> &plane, double tolerance, const double* xs,
+                           const double* ys, const double* zs, int count, PlaneSide* out)
+{
+    const __m256d a{ _mm256_set1_pd(plane.a) };
+    const __m256d b{ _mm256_set1_pd(plane.b) };
+    const __m256d c{ _mm256_set1_pd(plane.c) };
+    const __m256d d{ _mm256_set1_pd(plane.d) };
+    const __m256d zero{ _mm256_setzero_pd() };
+    const __m256d tol{ _mm256_set1_pd(tolerance) };
+    const __m256d negTol{ _mm256_set1_pd(-tolerance) };
+    int i{};
+    for(; i + 4 <= count; i += 4)
+    {
+        __m256d xy{ _mm256_add_pd(_mm256_mul_pd(a, _mm256_loadu_pd(xs + i)),
+                                  _mm256_mul_pd(b, _mm256_loadu_pd(ys + i))) };
+        __m256d value{ _mm256_add_pd(_mm256_add_pd(xy, _mm256_mul_pd(c, _mm256_loadu_pd(zs + i))), d) };
+        __m256d above{ _mm256_and_pd(_mm256_cmp_pd(value, zero, _CMP_GT_OQ), _mm256_cmp_pd(value, tol, _CMP_GE_OQ)) };
+        __m256d below{ _mm256_and_pd(_mm256_cmp_pd(value, zero, _CMP_LT_OQ), _mm256_cmp_pd(value, negTol, _CMP_LE_OQ)) };
+        storePlaneSides(_mm256_movemask_pd(above), _mm256_movemask_pd(below), 4, out + i);
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = planeSide(plane.a * xs[i] + plane.b * ys[i] + plane.c * zs[i] + plane.d, tolerance);
+    }
+}
+
+template <>
+inline void batchPlaneSide(const PlaneEquation<float> &plane, float tolerance, const float* xs,
+                           const float* ys, const float* zs, int count, PlaneSide* out)
+{
+    const __m256 a{ _mm256_set1_ps(plane.a) };
+    const __m256 b{ _mm256_set1_ps(plane.b) };
+    const __m256 c{ _mm256_set1_ps(plane.c) };
+    const __m256 d{ _mm256_set1_ps(plane.d) };
+    const __m256 zero{ _mm256_setzero_ps() };
+    const __m256 tol{ _mm256_set1_ps(tolerance) };
+    const __m256 negTol{ _mm256_set1_ps(-tolerance) };
+    int i{};
+    for(; i + 8 <= count; i += 8)
+    {
+        __m256 xy{ _mm256_add_ps(_mm256_mul_ps(a, _mm256_loadu_ps(xs + i)),
+                                 _mm256_mul_ps(b, _mm256_loadu_ps(ys + i))) };
+        __m256 value{ _mm256_add_ps(_mm256_add_ps(xy, _mm256_mul_ps(c, _mm256_loadu_ps(zs + i))), d) };
+        __m256 above{ _mm256_and_ps(_mm256_cmp_ps(value, zero, _CMP_GT_OQ), _mm256_cmp_ps(value, tol, _CMP_GE_OQ)) };
+        __m256 below{ _mm256_and_ps(_mm256_cmp_ps(value, zero, _CMP_LT_OQ), _mm256_cmp_ps(value, negTol, _CMP_LE_OQ)) };
+        storePlaneSides(_mm256_movemask_ps(above), _mm256_movemask_ps(below), 8, out + i);
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = planeSide(plane.a * xs[i] + plane.b * ys[i] + plane.c * zs[i] + plane.d, tolerance);
+    }
+}
+
+#elif defined(__SSE2__)
+
+template <>
+inline void batchNorm(const double* xs, const double* ys, const double* zs, int count, double* out)
+{
+    int i{};
+    for(; i + 2 <= count; i += 2)
+    {
+        __m128d x{ _mm_loadu_pd(xs + i) };
+        __m128d y{ _mm_loadu_pd(ys + i) };
+        __m128d z{ _mm_loadu_pd(zs + i) };
+        __m128d squares{ _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)), _mm_mul_pd(z, z)) };
+        _mm_storeu_pd(out + i, _mm_sqrt_pd(squares));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = std::sqrt(xs[i] * xs[i] + ys[i] * ys[i] + zs[i] * zs[i]);
+    }
+}
+
+/*
+ * The sum of squares is taken in float and the square root in double, see
+ * the AVX version.
+ */
+template <>
+inline void batchNorm(const float* xs, const float* ys, const float* zs, int count, double* out)
+{
+    int i{};
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 x{ _mm_loadu_ps(xs + i) };
+        __m128 y{ _mm_loadu_ps(ys + i) };
+        __m128 z{ _mm_loadu_ps(zs + i) };
+        __m128 squares{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)) };
+        _mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_cvtps_pd(squares)));
+        _mm_storeu_pd(out + i + 2, _mm_sqrt_pd(_mm_cvtps_pd(_mm_movehl_ps(squares, squares))));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = std::sqrt(static_cast<double>(xs[i] * xs[i] + ys[i] * ys[i] + zs[i] * zs[i]));
+    }
+}
+
+template <>
+inline void batchDotProduct(double vx, double vy, double vz, const double* xs, const double* ys,
+                            const double* zs, int count, double* out)
+{
+    const __m128d wx{ _mm_set1_pd(vx) };
+    const __m128d wy{ _mm_set1_pd(vy) };
+    const __m128d wz{ _mm_set1_pd(vz) };
+    int i{};
+    for(; i + 2 <= count; i += 2)
+    {
+        __m128d xy{ _mm_add_pd(_mm_mul_pd(wx, _mm_loadu_pd(xs + i)), _mm_mul_pd(wy, _mm_loadu_pd(ys + i))) };
+        _mm_storeu_pd(out + i, _mm_add_pd(xy, _mm_mul_pd(wz, _mm_loadu_pd(zs + i))));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = vx * xs[i] + vy * ys[i] + vz * zs[i];
+    }
+}
+
+template <>
+inline void batchDotProduct(float vx, float vy, float vz, const float* xs, const float* ys,
+                            const float* zs, int count, float* out)
+{
+    const __m128 wx{ _mm_set1_ps(vx) };
+    const __m128 wy{ _mm_set1_ps(vy) };
+    const __m128 wz{ _mm_set1_ps(vz) };
+    int i{};
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 xy{ _mm_add_ps(_mm_mul_ps(wx, _mm_loadu_ps(xs + i)), _mm_mul_ps(wy, _mm_loadu_ps(ys + i))) };
+        _mm_storeu_ps(out + i, _mm_add_ps(xy, _mm_mul_ps(wz, _mm_loadu_ps(zs + i))));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = vx * xs[i] + vy * ys[i] + vz * zs[i];
+    }
+}
+
+template <>
+inline void batchPlaneSide(const PlaneEquation<double> &plane, double tolerance, const double* xs,
+                           const double* ys, const double* zs, int count, PlaneSide* out)
+{
+    const __m128d a{ _mm_set1_pd(plane.a) };
+    const __m128d b{ _mm_set1_pd(plane.b) };
+    const __m128d c{ _mm_set1_pd(plane.c) };
+    const __m128d d{ _mm_set1_pd(plane.d) };
+    const __m128d zero{ _mm_setzero_pd() };
+    const __m128d tol{ _mm_set1_pd(tolerance) };
+    const __m128d negTol{ _mm_set1_pd(-tolerance) };
+    int i{};
+    for(; i + 2 <= count; i += 2)
+    {
+        __m128d xy{ _mm_add_pd(_mm_mul_pd(a, _mm_loadu_pd(xs + i)), _mm_mul_pd(b, _mm_loadu_pd(ys + i))) };
+        __m128d value{ _mm_add_pd(_mm_add_pd(xy, _mm_mul_pd(c, _mm_loadu_pd(zs + i))), d) };
+        __m128d above{ _mm_and_pd(_mm_cmpgt_pd(value, zero), _mm_cmpge_pd(value, tol)) };
+        __m128d below{ _mm_and_pd(_mm_cmplt_pd(value, zero), _mm_cmple_pd(value, negTol)) };
+        storePlaneSides(_mm_movemask_pd(above), _mm_movemask_pd(below), 2, out + i);
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = planeSide(plane.a * xs[i] + plane.b * ys[i] + plane.c * zs[i] + plane.d, tolerance);
+    }
+}
+
+template <>
+inline void batchPlaneSide(const PlaneEquation<float> &plane, float tolerance, const float* xs,
+                           const float* ys, const float* zs, int count, PlaneSide* out)
+{
+    const __m128 a{ _mm_set1_ps(plane.a) };
+    const __m128 b{ _mm_set1_ps(plane.b) };
+    const __m128 c{ _mm_set1_ps(plane.c) };
+    const __m128 d{ _mm_set1_ps(plane.d) };
+    const __m128 zero{ _mm_setzero_ps() };
+    const __m128 tol{ _mm_set1_ps(tolerance) };
+    const __m128 negTol{ _mm_set1_ps(-tolerance) };
+    int i{};
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 xy{ _mm_add_ps(_mm_mul_ps(a, _mm_loadu_ps(xs + i)), _mm_mul_ps(b, _mm_loadu_ps(ys + i))) };
+        __m128 value{ _mm_add_ps(_mm_add_ps(xy, _mm_mul_ps(c, _mm_loadu_ps(zs + i))), d) };
+        __m128 above{ _mm_and_ps(_mm_cmpgt_ps(value, zero), _mm_cmpge_ps(value, tol)) };
+        __m128 below{ _mm_and_ps(_mm_cmplt_ps(value, zero), _mm_cmple_ps(value, negTol)) };
+        storePlaneSides(_mm_movemask_ps(above), _mm_movemask_ps(below), 4, out + i);
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = planeSide(plane.a * xs[i] + plane.b * ys[i] + plane.c * zs[i] + plane.d, tolerance);
+    }
+}
+
+#endif
+
+#endif //ELEM_GEOMETRICOS_BATCH3D_H
@@ -0,0 +1,377 @@
+//
+// Batched point in polygon kernels. Instead of testing one point against
+// every edge, the polygon edges are walked once per block of points and each
+// edge is tested against the whole block, several points at a time when SSE2
+// or AVX are available.
+//
+
+#ifndef ELEM_GEOMETRICOS_BATCHCONTAINMENT_H
+#define ELEM_GEOMETRICOS_BATCHCONTAINMENT_H
+
+#include "Punto.h"
+#include "WideArithmetic.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * Amount of points tested together against every edge. Coordinates of a block
+ * are copied into local buffers, so it is kept small enough for both buffers
+ * to stay in the L1 cache.
+ */
+const int CONTAINMENT_BLOCK{ 512 };
+
+/*
+ * Edge data shared by all the points of a block. These are the same values
+ * Segmento computes for the edge from start to end: the y coordinates of both
+ * endpoints, diffX, diffY and doubleAreaSegment. Integer edges keep the last
+ * three in their WideType, where they are exact.
+ */
+template <class T>
+struct ContainmentEdge
+{
+    T startY;
+    T endY;
+    WideType<T> diffX;
+    WideType<T> diffY;
+    WideType<T> doubleArea;
+};
+
+/*
+ * Returns whether the edge e, which must straddle the horizontal line through
+ * (x, y), crosses it to the right of the point. Floating point edges compute
+ * the intersection as Poligono::pointInside does. Integer edges take the
+ * exact sign of the line determinant doubleArea + x*diffY - y*diffX instead:
+ * the crossing is to the right when it's positive on an upward edge or
+ * negative on a downward one.
+ */
+template <class T>
+bool crossesToTheRight(const ContainmentEdge<T> &e, T x, T y)
+{
+    if constexpr (std::is_integral<T>::value)
+    {
+        using Determinant = OrientationType<T>;
+        Determinant det{ static_cast<Determinant>(e.doubleArea) + static_cast<Determinant>(x) * e.diffY
+                         - static_cast<Determinant>(y) * e.diffX };
+        return signOf(det) == -signOf(e.diffY);
+    }
+    else
+    {
+        double intersectX{ (y * e.diffX - e.doubleArea)/(static_cast<double>(e.diffY)) };
+        return intersectX - x > 0;
+    }
+}
+
+/*
+ * Flips the parity bit of every point of the block whose horizontal ray
+ * crosses the edge to the right of the point. This is the scalar version,
+ * used for any type without a vectorized specialization. The crossing test
+ * and the intersection are computed exactly as in Poligono::pointInside.
+ */
+template <class T>
+void edgeCrossingBits(const ContainmentEdge<T> &e, const T* xs, const T* ys,
+                      int n, std::uint64_t* parity)
+{
+    for(int j{}; j < n; ++j)
+    {
+        T y{ ys[j] };
+        bool crosses{ (e.startY > y) != (e.endY > y) };
+        if (crosses && crossesToTheRight(e, xs[j], y))
+        {
+            parity[j >> 6] ^= std::uint64_t{ 1 } << (j & 63);
+        }
+    }
+}
+
+#if defined(__AVX__)
+
+/*
+ * Amount of coordinates each vectorized kernel consumes per iteration. Blocks
+ * are padded up to a multiple of it.
+ */
+template <class T> constexpr int containmentLanes() { return 1; }
+template <> constexpr int containmentLanes<double>() { return 4; }
+template <> constexpr int containmentLanes<float>() { return 8; }
+
+/*
+ * AVX version for doubles, four points per iteration.
+ */
+template <>
+inline void edgeCrossingBits(const ContainmentEdge<double> &e, const double* xs,
+                             const double* ys, int n, std::uint64_t* parity)
+{
+    const __m256d startY{ _mm256_set1_pd(e.startY) };
+    const __m256d endY{ _mm256_set1_pd(e.endY) };
+    const __m256d diffX{ _mm256_set1_pd(e.diffX) };
+    const __m256d diffY{ _mm256_set1_pd(e.diffY) };
+    const __m256d area{ _mm256_set1_pd(e.doubleArea) };
+    const __m256d zero{ _mm256_setzero_pd() };
+
+    for(int j{}; j < n; j += 4)
+    {
+        __m256d y{ _mm256_load_pd(ys + j) };
+        __m256d x{ _mm256_load_pd(xs + j) };
+        __m256d crosses{ _mm256_xor_pd(_mm256_cmp_pd(startY, y, _CMP_GT_OQ),
+                                       _mm256_cmp_pd(endY, y, _CMP_GT_OQ)) };
+        __m256d intersectX{ _mm256_div_pd(_mm256_sub_pd(_mm256_mul_pd(y, diffX), area), diffY) };
+        __m256d right{ _mm256_cmp_pd(_mm256_sub_pd(intersectX, x), zero, _CMP_GT_OQ) };
+        auto bits{ static_cast<std::uint64_t>(_mm256_movemask_pd(_mm256_and_pd(crosses, right))) };
+        parity[j >> 6] ^= bits << (j & 63);
+    }
+}
+
+/*
+ * AVX version for floats, eight points per iteration. The numerator of the
+ * intersection is computed in float and the division in double, just like
+ * Segmento<float>::horizontalIntersect does.
+ */
+template <>
+inline void edgeCrossingBits(const ContainmentEdge<float> &e, const float* xs,
+                             const float* ys, int n, std::uint64_t* parity)
+{
+    const __m256 startY{ _mm256_set1_ps(e.startY) };
+    const __m256 endY{ _mm256_set1_ps(e.endY) };
+    const __m256 diffX{ _mm256_set1_ps(e.diffX) };
+    const __m256 area{ _mm256_set1_ps(e.doubleArea) };
+    const __m256d diffY{ _mm256_set1_pd(e.diffY) };
+    const __m256d zero{ _mm256_setzero_pd() };
+
+    for(int j{}; j < n; j += 8)
+    {
+        __m256 y{ _mm256_load_ps(ys + j) };
+        __m256 x{ _mm256_load_ps(xs + j) };
+        __m256 crosses{ _mm256_xor_ps(_mm256_cmp_ps(startY, y, _CMP_GT_OQ),
+                                      _mm256_cmp_ps(endY, y, _CMP_GT_OQ)) };
+        __m256 numerator{ _mm256_sub_ps(_mm256_mul_ps(y, diffX), area) };
+
+        __m256d intersectLow{ _mm256_div_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(numerator)), diffY) };
+        __m256d intersectHigh{ _mm256_div_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(numerator, 1)), diffY) };
+        __m256d xLow{ _mm256_cvtps_pd(_mm256_castps256_ps128(x)) };
+        __m256d xHigh{ _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)) };
+        int right{ _mm256_movemask_pd(_mm256_cmp_pd(_mm256_sub_pd(intersectLow, xLow), zero, _CMP_GT_OQ))
+                   | (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_sub_pd(intersectHigh, xHigh), zero, _CMP_GT_OQ)) << 4) };
+        auto bits{ static_cast<std::uint64_t>(_mm256_movemask_ps(crosses) & right) };
+        parity[j >> 6] ^= bits << (j & 63);
+    }
+}
+
+#elif defined(__SSE2__)
+
+template <class T> constexpr int containmentLanes() { return 1; }
+template <> constexpr int containmentLanes<double>() { return 2; }
+template <> constexpr int containmentLanes<float>() { return 4; }
+
+/*
+ * SSE2 version for doubles, two points per iteration.
+ */
+template <>
+inline void edgeCrossingBits(const ContainmentEdge<double> &e, const double* xs,
+                             const double* ys, int n, std::uint64_t* parity)
+{
+    const __m128d startY{ _mm_set1_pd(e.startY) };
+    const __m128d endY{ _mm_set1_pd(e.endY) };
+    const __m128d diffX{ _mm_set1_pd(e.diffX) };
+    const __m128d diffY{ _mm_set1_pd(e.diffY) };
+    const __m128d area{ _mm_set1_pd(e.doubleArea) };
+    const __m128d zero{ _mm_setzero_pd() };
+
+    for(int j{}; j < n; j += 2)
+    {
+        __m128d y{ _mm_load_pd(ys + j) };
+        __m128d x{ _mm_load_pd(xs + j) };
+        __m128d crosses{ _mm_xor_pd(_mm_cmpgt_pd(startY, y), _mm_cmpgt_pd(endY, y)) };
+        __m128d intersectX{ _mm_div_pd(_mm_sub_pd(_mm_mul_pd(y, diffX), area), diffY) };
+        __m128d right{ _mm_cmpgt_pd(_mm_sub_pd(intersectX, x), zero) };
+        auto bits{ static_cast<std::uint64_t>(_mm_movemask_pd(_mm_and_pd(crosses, right))) };
+        parity[j >> 6] ^= bits << (j & 63);
+    }
+}
+
+/*
+ * SSE2 version for floats, four points per iteration. The numerator is
+ * computed in float and the division in double, see the AVX version.
+ */
+template <>
+inline void edgeCrossingBits(const ContainmentEdge<float> &e, const float* xs,
+                             const float* ys, int n, std::uint64_t* parity)
+{
+    const __m128 startY{ _mm_set1_ps(e.startY) };
+    const __m128 endY{ _mm_set1_ps(e.endY) };
+    const __m128 diffX{ _mm_set1_ps(e.diffX) };
+    const __m128 area{ _mm_set1_ps(e.doubleArea) };
+    const __m128d diffY{ _mm_set1_pd(e.diffY) };
+    const __m128d zero{ _mm_setzero_pd() };
+
+    for(int j{}; j < n; j += 4)
+    {
+        __m128 y{ _mm_load_ps(ys + j) };
+        __m128 x{ _mm_load_ps(xs + j) };
+        __m128 crosses{ _mm_xor_ps(_mm_cmpgt_ps(startY, y), _mm_cmpgt_ps(endY, y)) };
+        __m128 numerator{ _mm_sub_ps(_mm_mul_ps(y, diffX), area) };
+
+        __m128d intersectLow{ _mm_div_pd(_mm_cvtps_pd(numerator), diffY) };
+        __m128d intersectHigh{ _mm_div_pd(_mm_cvtps_pd(_mm_movehl_ps(numerator, numerator)), diffY) };
+        __m128d xLow{ _mm_cvtps_pd(x) };
+        __m128d xHigh{ _mm_cvtps_pd(_mm_movehl_ps(x, x)) };
+        int right{ _mm_movemask_pd(_mm_cmpgt_pd(_mm_sub_pd(intersectLow, xLow), zero))
+                   | (_mm_movemask_pd(_mm_cmpgt_pd(_mm_sub_pd(intersectHigh, xHigh), zero)) << 2) };
+        auto bits{ static_cast<std::uint64_t>(_mm_movemask_ps(crosses) & right) };
+        parity[j >> 6] ^= bits << (j & 63);
+    }
+}
+
+#else
+
+template <class T> constexpr int containmentLanes() { return 1; }
+
+#endif
+
+/*
+ * Returns the data of the edge going from start to end.
+ */
+template <class T>
+ContainmentEdge<T> containmentEdge(const Punto<T> &start, const Punto<T> &end)
+{
+    using Wide = WideType<T>;
+    return ContainmentEdge<T>{ start.getY(), end.getY(),
+                               static_cast<Wide>(static_cast<Wide>(start.getX()) - end.getX()),
+                               static_cast<Wide>(static_cast<Wide>(start.getY()) - end.getY()),
+                               static_cast<Wide>(static_cast<Wide>(start.getX()) * end.getY()
+                                                 - static_cast<Wide>(start.getY()) * end.getX()) };
+}
+
+/*
+ * Returns the data of every edge of the polygon given by its length vertices,
+ * in order and including the closing edge from the last vertex to v0.
+ */
+template <class T>
+std::vector<ContainmentEdge<T>> containmentEdges(const Punto<T>* vertices, int length)
+{
+    std::vector<ContainmentEdge<T>> edges;
+    edges.reserve(static_cast<std::size_t>(length));
+    for(int i{}; i < length; ++i)
+    {
+        edges.push_back(containmentEdge(vertices[i], vertices[(i+1 == length) ? 0 : i+1]));
+    }
+    return edges;
+}
+
+/*
+ * Runs the odd-even test for a block of at most CONTAINMENT_BLOCK points whose
+ * coordinates were already copied to the aligned buffers xs and ys. Both
+ * buffers must have room for n rounded up to a multiple of the lanes of T.
+ * Edges whose y range does not reach any point of the block are skipped.
+ */
+template <class T>
+void pointInsideBlock(const ContainmentEdge<T>* edges, int edgeCount, T* xs, T* ys, int n, bool* inside)
+{
+    const int lanes{ containmentLanes<T>() };
+    int padded{ (n + lanes - 1) / lanes * lanes };
+    // the padding never crosses an edge: NaN compares false against anything
+    for(int j{ n }; j < padded; ++j)
+    {
+        xs[j] = std::numeric_limits<T>::quiet_NaN();
+        ys[j] = std::numeric_limits<T>::quiet_NaN();
+    }
+
+    T minY{ ys[0] };
+    T maxY{ ys[0] };
+    for(int j{ 1 }; j < n; ++j)
+    {
+        minY = std::min(minY, ys[j]);
+        maxY = std::max(maxY, ys[j]);
+    }
+
+    std::uint64_t parity[CONTAINMENT_BLOCK/64]{};
+    for(int i{}; i < edgeCount; ++i)
+    {
+        const ContainmentEdge<T> &e{ edges[i] };
+        // an edge is crossed by the ray at y when min <= y < max
+        if (std::max(e.startY, e.endY) <= minY || std::min(e.startY, e.endY) > maxY)
+        {
+            continue;
+        }
+        edgeCrossingBits(e, xs, ys, padded, parity);
+    }
+
+    for(int j{}; j < n; ++j)
+    {
+        inside[j] = (parity[j >> 6] >> (j & 63)) & 1;
+    }
+}
+
+/*
+ * Checks which of the count points (xs[i], ys[i]) lie inside the polygon whose
+ * edgeCount edges are given, writing the answer for each one in inside[i].
+ * The order of the edges does not matter.
+ */
+template <class T>
+void batchPointInside(const ContainmentEdge<T>* edges, int edgeCount,
+                      const T* xs, const T* ys, int count, bool* inside)
+{
+    alignas(64) T blockX[CONTAINMENT_BLOCK];
+    alignas(64) T blockY[CONTAINMENT_BLOCK];
+
+    for(int first{}; first < count; first += CONTAINMENT_BLOCK)
+    {
+        int n{ std::min(CONTAINMENT_BLOCK, count - first) };
+        std::copy(xs + first, xs + first + n, blockX);
+        std::copy(ys + first, ys + first + n, blockY);
+        pointInsideBlock(edges, edgeCount, blockX, blockY, n, inside + first);
+    }
+}
+
+/*
+ * Same as above, but the points are given as an array of Punto.
+ */
+template <class T>
+void batchPointInside(const ContainmentEdge<T>* edges, int edgeCount,
+                      const Punto<T>* puntos, int count, bool* inside)
+{
+    alignas(64) T blockX[CONTAINMENT_BLOCK];
+    alignas(64) T blockY[CONTAINMENT_BLOCK];
+
+    for(int first{}; first < count; first += CONTAINMENT_BLOCK)
+    {
+        int n{ std::min(CONTAINMENT_BLOCK, count - first) };
+        for(int j{}; j < n; ++j)
+        {
+            blockX[j] = puntos[first + j].getX();
+            blockY[j] = puntos[first + j].getY();
+        }
+        pointInsideBlock(edges, edgeCount, blockX, blockY, n, inside + first);
+    }
+}
+
+/*
+ * Checks which of the count points (xs[i], ys[i]) lie inside the polygon given
+ * by its length vertices, writing the answer for each one in inside[i]. The
+ * result is the same as calling Poligono::pointInside for every point.
+ */
+template <class T>
+void batchPointInside(const Punto<T>* vertices, int length,
+                      const T* xs, const T* ys, int count, bool* inside)
+{
+    std::vector<ContainmentEdge<T>> edges{ containmentEdges(vertices, length) };
+    batchPointInside(edges.data(), length, xs, ys, count, inside);
+}
+
+/*
+ * Same as above, but the points are given as an array of Punto.
+ */
+template <class T>
+void batchPointInside(const Punto<T>* vertices, int length,
+                      const Punto<T>* puntos, int count, bool* inside)
+{
+    std::vector<ContainmentEdge<T>> edges{ containmentEdges(vertices, length) };
+    batchPointInside(edges.data(), length, puntos, count, inside);
+}
+
+#endif //ELEM_GEOMETRICOS_BATCHCONTAINMENT_H
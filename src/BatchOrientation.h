@@ -0,0 +1,300 @@
+//
+// Batched orientation kernels: many points tested against one directed line,
+// several points at a time when SSE2 or AVX are available.
+//
+
+#ifndef ELEM_GEOMETRICOS_BATCHORIENTATION_H
+#define ELEM_GEOMETRICOS_BATCHORIENTATION_H
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * Side of a directed line on which a point lies.
+ */
+enum class LineSide : signed char
+{
+    RIGHT = -1,
+    ON = 0,
+    LEFT = 1
+};
+
+/*
+ * Tolerance of Segmento::isPointInLine: a point is in the line when the
+ * absolute value of its line determinant is below it, or the determinant is
+ * exactly 0. Integer determinants are exact, so they get no tolerance.
+ */
+template <class T>
+struct LineTolerance
+{
+    static constexpr T value{ };
+};
+
+template <>
+struct LineTolerance<double>
+{
+    static constexpr double value{ 1e-10 };
+};
+
+template <>
+struct LineTolerance<float>
+{
+    static constexpr float value{ 1e-7f };
+};
+
+/*
+ * Returns the side of the line for the determinant det, which is ON when det
+ * is within tolerance of 0 as in Segmento::isPointInLine.
+ */
+template <class T>
+LineSide lineSide(T det, T tolerance)
+{
+    if (det > 0 && !(det < tolerance))
+    {
+        return LineSide::LEFT;
+    }
+    if (det < 0 && !(-det < tolerance))
+    {
+        return LineSide::RIGHT;
+    }
+    return LineSide::ON;
+}
+
+/*
+ * Stores in out[i] the line determinant a*xs[i] + b*ys[i] + c of the count
+ * given points. The coefficients of a Segmento are computed once by
+ * Segmento::lineDeterminants. This is the scalar version, used for any type
+ * without a vectorized specialization.
+ */
+template <class T>
+void batchLineDeterminant(T a, T b, T c, const T* xs, const T* ys, int count, T* out)
+{
+    for(int i{}; i < count; ++i)
+    {
+        out[i] = a * xs[i] + b * ys[i] + c;
+    }
+}
+
+/*
+ * Stores in out[i] the side of the line a*x + b*y + c = 0 where the point
+ * (xs[i], ys[i]) lies, see lineSide. Scalar version.
+ */
+template <class T>
+void batchLineSide(T a, T b, T c, T tolerance, const T* xs, const T* ys, int count, LineSide* out)
+{
+    for(int i{}; i < count; ++i)
+    {
+        out[i] = lineSide(a * xs[i] + b * ys[i] + c, tolerance);
+    }
+}
+
+#if defined(__AVX__) || defined(__SSE2__)
+
+/*
+ * Writes the sides of lanes points given the bit masks of the lanes on the
+ * left and on the right.
+ */
+inline void storeLineSides(int leftBits, int rightBits, int lanes, LineSide* out)
+{
+    for(int k{}; k < lanes; ++k)
+    {
+        out[k] = static_cast<LineSide>(((leftBits >> k) & 1) - ((rightBits >> k) & 1));
+    }
+}
+
+#endif
+
+#if defined(__AVX__)
+
+template <>
+inline void batchLineDeterminant(double a, double b, double c, const double* xs, const double* ys,
+                                 int count, double* out)
+{
+    const __m256d va{ _mm256_set1_pd(a) };
+    const __m256d vb{ _mm256_set1_pd(b) };
+    const __m256d vc{ _mm256_set1_pd(c) };
+    int i{};
+    for(; i + 4 <= count; i += 4)
+    {
+        __m256d ax{ _mm256_mul_pd(va, _mm256_loadu_pd(xs + i)) };
+        __m256d by{ _mm256_mul_pd(vb, _mm256_loadu_pd(ys + i)) };
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_add_pd(ax, by), vc));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = a * xs[i] + b * ys[i] + c;
+    }
+}
+
+template <>
+inline void batchLineDeterminant(float a, float b, float c, const float* xs, const float* ys,
+                                 int count, float* out)
+{
+    const __m256 va{ _mm256_set1_ps(a) };
+    const __m256 vb{ _mm256_set1_ps(b) };
+    const __m256 vc{ _mm256_set1_ps(c) };
+    int i{};
+    for(; i + 8 <= count; i += 8)
+    {
+        __m256 ax{ _mm256_mul_ps(va, _mm256_loadu_ps(xs + i)) };
+        __m256 by{ _mm256_mul_ps(vb, _mm256_loadu_ps(ys + i)) };
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_add_ps(ax, by), vc));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = a * xs[i] + b * ys[i] + c;
+    }
+}
+
+template <>
+inline void batchLineSide(double a, double b, double c, double tolerance, const double* xs, const double* ys,
+                          int count, LineSide* out)
+{
+    const __m256d va{ _mm256_set1_pd(a) };
+    const __m256d vb{ _mm256_set1_pd(b) };
+    const __m256d vc{ _mm256_set1_pd(c) };
+    const __m256d zero{ _mm256_setzero_pd() };
+    const __m256d tol{ _mm256_set1_pd(tolerance) };
+    const __m256d negTol{ _mm256_set1_pd(-tolerance) };
+    int i{};
+    for(; i + 4 <= count; i += 4)
+    {
+        __m256d ax{ _mm256_mul_pd(va, _mm256_loadu_pd(xs + i)) };
+        __m256d by{ _mm256_mul_pd(vb, _mm256_loadu_pd(ys + i)) };
+        __m256d det{ _mm256_add_pd(_mm256_add_pd(ax, by), vc) };
+        __m256d left{ _mm256_and_pd(_mm256_cmp_pd(det, zero, _CMP_GT_OQ), _mm256_cmp_pd(det, tol, _CMP_GE_OQ)) };
+        __m256d right{ _mm256_and_pd(_mm256_cmp_pd(det, zero, _CMP_LT_OQ), _mm256_cmp_pd(det, negTol, _CMP_LE_OQ)) };
+        storeLineSides(_mm256_movemask_pd(left), _mm256_movemask_pd(right), 4, out + i);
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = lineSide(a * xs[i] + b * ys[i] + c, tolerance);
+    }
+}
+
+template <>
+inline void batchLineSide(float a, float b, float c, float tolerance, const float* xs, const float* ys,
+                          int count, LineSide* out)
+{
+    const __m256 va{ _mm256_set1_ps(a) };
+    const __m256 vb{ _mm256_set1_ps(b) };
+    const __m256 vc{ _mm256_set1_ps(c) };
+    const __m256 zero{ _mm256_setzero_ps() };
+    const __m256 tol{ _mm256_set1_ps(tolerance) };
+    const __m256 negTol{ _mm256_set1_ps(-tolerance) };
+    int i{};
+    for(; i + 8 <= count; i += 8)
+    {
+        __m256 ax{ _mm256_mul_ps(va, _mm256_loadu_ps(xs + i)) };
+        __m256 by{ _mm256_mul_ps(vb, _mm256_loadu_ps(ys + i)) };
+        __m256 det{ _mm256_add_ps(_mm256_add_ps(ax, by), vc) };
+        __m256 left{ _mm256_and_ps(_mm256_cmp_ps(det, zero, _CMP_GT_OQ), _mm256_cmp_ps(det, tol, _CMP_GE_OQ)) };
+        __m256 right{ _mm256_and_ps(_mm256_cmp_ps(det, zero, _CMP_LT_OQ), _mm256_cmp_ps(det, negTol, _CMP_LE_OQ)) };
+        storeLineSides(_mm256_movemask_ps(left), _mm256_movemask_ps(right), 8, out + i);
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = lineSide(a * xs[i] + b * ys[i] + c, tolerance);
+    }
+}
+
+#elif defined(__SSE2__)
+
+template <>
+inline void batchLineDeterminant(double a, double b, double c, const double* xs, const double* ys,
+                                 int count, double* out)
+{
+    const __m128d va{ _mm_set1_pd(a) };
+    const __m128d vb{ _mm_set1_pd(b) };
+    const __m128d vc{ _mm_set1_pd(c) };
+    int i{};
+    for(; i + 2 <= count; i += 2)
+    {
+        __m128d ax{ _mm_mul_pd(va, _mm_loadu_pd(xs + i)) };
+        __m128d by{ _mm_mul_pd(vb, _mm_loadu_pd(ys + i)) };
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_add_pd(ax, by), vc));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = a * xs[i] + b * ys[i] + c;
+    }
+}
+
+template <>
+inline void batchLineDeterminant(float a, float b, float c, const float* xs, const float* ys,
+                                 int count, float* out)
+{
+    const __m128 va{ _mm_set1_ps(a) };
+    const __m128 vb{ _mm_set1_ps(b) };
+    const __m128 vc{ _mm_set1_ps(c) };
+    int i{};
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 ax{ _mm_mul_ps(va, _mm_loadu_ps(xs + i)) };
+        __m128 by{ _mm_mul_ps(vb, _mm_loadu_ps(ys + i)) };
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_add_ps(ax, by), vc));
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = a * xs[i] + b * ys[i] + c;
+    }
+}
+
+template <>
+inline void batchLineSide(double a, double b, double c, double tolerance, const double* xs, const double* ys,
+                          int count, LineSide* out)
+{
+    const __m128d va{ _mm_set1_pd(a) };
+    const __m128d vb{ _mm_set1_pd(b) };
+    const __m128d vc{ _mm_set1_pd(c) };
+    const __m128d zero{ _mm_setzero_pd() };
+    const __m128d tol{ _mm_set1_pd(tolerance) };
+    const __m128d negTol{ _mm_set1_pd(-tolerance) };
+    int i{};
+    for(; i + 2 <= count; i += 2)
+    {
+        __m128d ax{ _mm_mul_pd(va, _mm_loadu_pd(xs + i)) };
+        __m128d by{ _mm_mul_pd(vb, _mm_loadu_pd(ys + i)) };
+        __m128d det{ _mm_add_pd(_mm_add_pd(ax, by), vc) };
+        __m128d left{ _mm_and_pd(_mm_cmpgt_pd(det, zero), _mm_cmpge_pd(det, tol)) };
+        __m128d right{ _mm_and_pd(_mm_cmplt_pd(det, zero), _mm_cmple_pd(det, negTol)) };
+        storeLineSides(_mm_movemask_pd(left), _mm_movemask_pd(right), 2, out + i);
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = lineSide(a * xs[i] + b * ys[i] + c, tolerance);
+    }
+}
+
+template <>
+inline void batchLineSide(float a, float b, float c, float tolerance, const float* xs, const float* ys,
+                          int count, LineSide* out)
+{
+    const __m128 va{ _mm_set1_ps(a) };
+    const __m128 vb{ _mm_set1_ps(b) };
+    const __m128 vc{ _mm_set1_ps(c) };
+    const __m128 zero{ _mm_setzero_ps() };
+    const __m128 tol{ _mm_set1_ps(tolerance) };
+    const __m128 negTol{ _mm_set1_ps(-tolerance) };
+    int i{};
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 ax{ _mm_mul_ps(va, _mm_loadu_ps(xs + i)) };
+        __m128 by{ _mm_mul_ps(vb, _mm_loadu_ps(ys + i)) };
+        __m128 det{ _mm_add_ps(_mm_add_ps(ax, by), vc) };
+        __m128 left{ _mm_and_ps(_mm_cmpgt_ps(det, zero), _mm_cmpge_ps(det, tol)) };
+        __m128 right{ _mm_and_ps(_mm_cmplt_ps(det, zero), _mm_cmple_ps(det, negTol)) };
+        storeLineSides(_mm_movemask_ps(left), _mm_movemask_ps(right), 4, out + i);
+    }
+    for(; i < count; ++i)
+    {
+        out[i] = lineSide(a * xs[i] + b * ys[i] + c, tolerance);
+    }
+}
+
+#endif
+
+#endif //ELEM_GEOMETRICOS_BATCHORIENTATION_H
@@ -0,0 +1,126 @@
+//
+// Threaded batch queries: the point in polygon and orientation kernels run
+// over chunks of a point batch, or of a polygon set, shared by the threads
+// of the pool in Parallel.h.
+//
+
+#ifndef ELEM_GEOMETRICOS_BATCHQUERIES_H
+#define ELEM_GEOMETRICOS_BATCHQUERIES_H
+
+#include "BatchContainment.h"
+#include "BatchOrientation.h"
+#include "Parallel.h"
+#include "Poligono.h"
+#include "PolygonSet.h"
+#include "Segmento.h"
+#include <algorithm>
+#include <vector>
+
+/*
+ * Edge tests a thread does at least before another one is worth it. The
+ * kernels below do a few nanoseconds of work per edge test, so this is
+ * around a millisecond.
+ */
+const int QUERY_MIN_WORK{ 1 << 18 };
+
+/*
+ * Point in polygon for the count points (xs[i], ys[i]) against pol, writing
+ * the answer for each one in inside[i] as Poligono::pointsInside does. The
+ * points are cut in chunks of whole CONTAINMENT_BLOCK blocks. When threads
+ * is 0 one per hardware thread is used.
+ */
+template <class T>
+void batchPointsInside(const Poligono<T> &pol, const T* xs, const T* ys, int count, bool* inside,
+                       int threads = 0)
+{
+    int length{ pol.getLength() };
+    if (length == 0)
+    {
+        // no edge is crossed, as in Poligono::pointsInside
+        std::fill(inside, inside + count, false);
+        return;
+    }
+    std::vector<ContainmentEdge<T>> edges{ containmentEdges(&pol[0], length) };
+    const ContainmentEdge<T>* first{ edges.data() };
+    int blocks{ (count + CONTAINMENT_BLOCK - 1) / CONTAINMENT_BLOCK };
+    int minBlocks{ std::max(1, QUERY_MIN_WORK / (CONTAINMENT_BLOCK * std::max(1, length))) };
+    parallelFor(blocks, [=](int begin, int end) {
+        int firstPoint{ begin * CONTAINMENT_BLOCK };
+        int lastPoint{ std::min(count, end * CONTAINMENT_BLOCK) };
+        batchPointInside(first, length, xs + firstPoint, ys + firstPoint, lastPoint - firstPoint,
+                         inside + firstPoint);
+    }, threads, minBlocks);
+}
+
+/*
+ * Same as above, but the points are given as an array of Punto.
+ */
+template <class T>
+void batchPointsInside(const Poligono<T> &pol, const Punto<T>* puntos, int count, bool* inside,
+                       int threads = 0)
+{
+    int length{ pol.getLength() };
+    if (length == 0)
+    {
+        // no edge is crossed, as in Poligono::pointsInside
+        std::fill(inside, inside + count, false);
+        return;
+    }
+    std::vector<ContainmentEdge<T>> edges{ containmentEdges(&pol[0], length) };
+    const ContainmentEdge<T>* first{ edges.data() };
+    int blocks{ (count + CONTAINMENT_BLOCK - 1) / CONTAINMENT_BLOCK };
+    int minBlocks{ std::max(1, QUERY_MIN_WORK / (CONTAINMENT_BLOCK * std::max(1, length))) };
+    parallelFor(blocks, [=](int begin, int end) {
+        int firstPoint{ begin * CONTAINMENT_BLOCK };
+        int lastPoint{ std::min(count, end * CONTAINMENT_BLOCK) };
+        batchPointInside(first, length, puntos + firstPoint, lastPoint - firstPoint, inside + firstPoint);
+    }, threads, minBlocks);
+}
+
+/*
+ * Checks whether puntos[i] lies inside polygon i of the set, for every
+ * polygon, writing the answer in inside[i]. The polygons are cut in chunks of
+ * about the same amount of vertices. When threads is 0 one per hardware
+ * thread is used.
+ */
+template <class T>
+void batchPointInPolygon(const PolygonSet<T> &set, const Punto<T>* puntos, bool* inside, int threads = 0)
+{
+    const PolygonSet<T>* polygons{ &set };
+    parallelForBalanced(set.getOffsets(), set.getLength(), [=](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            inside[i] = (*polygons)[i].pointInside(puntos[i]);
+        }
+    }, threads);
+}
+
+/*
+ * Line determinants of the count points (xs[i], ys[i]) against line, as
+ * Segmento::lineDeterminants, on up to threads threads.
+ */
+template <class T>
+void batchLineDeterminants(const Segmento<T> &line, const T* xs, const T* ys, int count,
+                           OrientationType<T>* out, int threads = 0)
+{
+    const Segmento<T>* segment{ &line };
+    parallelFor(count, [=](int begin, int end) {
+        segment->lineDeterminants(xs + begin, ys + begin, end - begin, out + begin);
+    }, threads, QUERY_MIN_WORK);
+}
+
+/*
+ * Sides of line where the count points (xs[i], ys[i]) lie, as
+ * Segmento::classifyPoints, on up to threads threads.
+ */
+template <class T>
+void batchClassifyPoints(const Segmento<T> &line, const T* xs, const T* ys, int count, LineSide* out,
+                         int threads = 0)
+{
+    const Segmento<T>* segment{ &line };
+    parallelFor(count, [=](int begin, int end) {
+        segment->classifyPoints(xs + begin, ys + begin, end - begin, out + begin);
+    }, threads, QUERY_MIN_WORK);
+}
+
+#endif //ELEM_GEOMETRICOS_BATCHQUERIES_H
@@ -0,0 +1,513 @@
+//
+// Binary file format for points, segments and polygon sets, and a reader
+// that maps the file in memory instead of parsing it.
+//
+
+#ifndef ELEM_GEOMETRICOS_BINARYFORMAT_H
+#define ELEM_GEOMETRICOS_BINARYFORMAT_H
+
+#include "Poligono.h"
+#include "PolygonSet.h"
+#include "Segmento.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ELEM_GEOMETRICOS_MMAP 1
+#endif
+
+/*
+ * Layout of a file, every number in little endian:
+ *
+ *   bytes 0-3    magic "EGEO"
+ *   bytes 4-5    format version, BINARY_FORMAT_VERSION
+ *   byte  6      GeometryKind
+ *   byte  7      BinaryScalar code of the coordinates
+ *   bytes 8-15   amount of points, segments or polygons
+ *   bytes 16-23  amount of vertices
+ *   bytes 24-31  position of the first coordinate, a multiple of 8
+ *   byte  32     for polygon sets, the offsets table: amount+1 int32 telling
+ *                where each polygon starts, as in PolygonSet
+ *
+ * followed by the packed coordinates x0 y0 x1 y1 ... Segments store their
+ * start and end one after the other. Since Punto<T> is just its two
+ * coordinates, the mapped file is used as the vertex array as is.
+ */
+const std::uint16_t BINARY_FORMAT_VERSION{ 1 };
+const int BINARY_HEADER_SIZE{ 32 };
+
+enum class GeometryKind : unsigned char
+{
+    POINTS = 1,
+    SEGMENTS = 2,
+    POLYGONS = 3,
+    // a PolygonRTree, see PolygonRTree.h for its layout
+    RTREE = 4
+};
+
+/*
+ * Result of opening a file with MappedGeometry.
+ */
+enum class BinaryStatus
+{
+    OK,
+    CANT_OPEN,
+    TOO_SHORT,
+    BAD_MAGIC,
+    BAD_VERSION,
+    WRONG_SCALAR,
+    BAD_OFFSETS
+};
+
+/*
+ * Code stored in the header for each coordinate type. Types without one
+ * can't be stored.
+ */
+template <class T>
+struct BinaryScalar
+{
+    static constexpr unsigned char code{ 0 };
+};
+
+template <>
+struct BinaryScalar<std::int32_t>
+{
+    static constexpr unsigned char code{ 1 };
+};
+
+template <>
+struct BinaryScalar<float>
+{
+    static constexpr unsigned char code{ 2 };
+};
+
+template <>
+struct BinaryScalar<double>
+{
+    static constexpr unsigned char code{ 3 };
+};
+
+/*
+ * Whether numbers are kept in memory as in the file, so the file can be used
+ * without converting it.
+ */
+constexpr bool hostIsLittleEndian()
+{
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+    return __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__;
+#else
+    return true;
+#endif
+}
+
+/*
+ * Reverses the bytes of each of the count values of size bytes at data when
+ * the host is big endian, turning them from or into little endian.
+ */
+inline void swapToLittleEndian(void* data, std::size_t size, std::size_t count)
+{
+    if (hostIsLittleEndian())
+    {
+        return;
+    }
+    auto bytes{ static_cast<unsigned char*>(data) };
+    for(std::size_t i{}; i < count; ++i)
+    {
+        for(std::size_t k{}; k < size / 2; ++k)
+        {
+            std::swap(bytes[i * size + k], bytes[i * size + size - 1 - k]);
+        }
+    }
+}
+
+/*
+ * Writes count values of type V in little endian.
+ */
+template <class V>
+void writeLittleEndian(std::ostream &out, const V* values, std::size_t count)
+{
+    if (hostIsLittleEndian())
+    {
+        out.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(V)));
+        return;
+    }
+    for(std::size_t i{}; i < count; ++i)
+    {
+        V value{ values[i] };
+        swapToLittleEndian(&value, sizeof(V), 1);
+        out.write(reinterpret_cast<const char*>(&value), sizeof(V));
+    }
+}
+
+/*
+ * Writes the header and, for polygon sets, the offsets table, padded up to
+ * the first coordinate.
+ */
+template <class T>
+void writeBinaryHeader(std::ostream &out, GeometryKind kind, int count, int vertexCount, const int* offsets)
+{
+    static_assert(BinaryScalar<T>::code != 0, "the binary format stores int32, float and double coordinates");
+    std::uint64_t dataOffset{ static_cast<std::uint64_t>(BINARY_HEADER_SIZE) };
+    if (kind == GeometryKind::POLYGONS)
+    {
+        dataOffset += 4 * (static_cast<std::uint64_t>(count) + 1);
+        dataOffset = (dataOffset + 7) / 8 * 8;
+    }
+    out.write("EGEO", 4);
+    writeLittleEndian(out, &BINARY_FORMAT_VERSION, 1);
+    const unsigned char kindAndScalar[2]{ static_cast<unsigned char>(kind), BinaryScalar<T>::code };
+    out.write(reinterpret_cast<const char*>(kindAndScalar), 2);
+    const std::uint64_t sizes[3]{ static_cast<std::uint64_t>(count), static_cast<std::uint64_t>(vertexCount),
+                                  dataOffset };
+    writeLittleEndian(out, sizes, 3);
+    if (kind == GeometryKind::POLYGONS)
+    {
+        std::vector<std::int32_t> table(offsets, offsets + count + 1);
+        writeLittleEndian(out, table.data(), table.size());
+        const char padding[8]{};
+        out.write(padding, static_cast<std::streamsize>(dataOffset - BINARY_HEADER_SIZE - 4 * table.size()));
+    }
+}
+
+/*
+ * Writes the count given points. Returns whether the stream is still good.
+ */
+template <class T>
+bool writePoints(std::ostream &out, const Punto<T>* puntos, int count)
+{
+    static_assert(sizeof(Punto<T>) == 2 * sizeof(T) && std::is_standard_layout<Punto<T>>::value,
+                  "the binary format stores Punto as its two coordinates");
+    writeBinaryHeader<T>(out, GeometryKind::POINTS, count, count, nullptr);
+    writeLittleEndian(out, reinterpret_cast<const T*>(puntos), 2 * static_cast<std::size_t>(count));
+    return out.good();
+}
+
+/*
+ * Writes the count given segments, as their start and end points.
+ */
+template <class T>
+bool writeSegments(std::ostream &out, const Segmento<T>* segmentos, int count)
+{
+    std::vector<Punto<T>> endpoints;
+    endpoints.reserve(2 * static_cast<std::size_t>(count));
+    for(int i{}; i < count; ++i)
+    {
+        endpoints.push_back(segmentos[i].getStart().getEnd());
+        endpoints.push_back(segmentos[i].getEnd().getEnd());
+    }
+    writeBinaryHeader<T>(out, GeometryKind::SEGMENTS, count, 2 * count, nullptr);
+    writeLittleEndian(out, reinterpret_cast<const T*>(endpoints.data()), 2 * endpoints.size());
+    return out.good();
+}
+
+/*
+ * Writes every polygon of the set, with its offsets table.
+ */
+template <class T>
+bool writePolygonSet(std::ostream &out, const PolygonSet<T> &set)
+{
+    static_assert(sizeof(Punto<T>) == 2 * sizeof(T) && std::is_standard_layout<Punto<T>>::value,
+                  "the binary format stores Punto as its two coordinates");
+    writeBinaryHeader<T>(out, GeometryKind::POLYGONS, set.getLength(), set.getVertexCount(), set.getOffsets());
+    writeLittleEndian(out, reinterpret_cast<const T*>(set.getVertices()),
+                      2 * static_cast<std::size_t>(set.getVertexCount()));
+    return out.good();
+}
+
+/*
+ * Bytes of a whole file. Where mmap is available the file is mapped
+ * privately: pages are loaded from the page cache when first touched, and
+ * writing to them never reaches the file. Elsewhere it's read into memory.
+ */
+class MappedFile
+{
+private:
+    char* m_data{};
+    std::size_t m_size{};
+    bool m_mapped{};
+    std::vector<char> m_buffer;
+
+    void release()
+    {
+#if defined(ELEM_GEOMETRICOS_MMAP)
+        if (m_mapped && m_data)
+        {
+            munmap(m_data, m_size);
+        }
+#endif
+        m_data = nullptr;
+        m_size = 0;
+        m_mapped = false;
+        m_buffer.clear();
+    }
+
+public:
+    MappedFile() = default;
+
+    /*
+     * Maps the file at path. On failure the MappedFile is empty and isOpen
+     * returns false.
+     */
+    explicit MappedFile(const std::string &path)
+    {
+#if defined(ELEM_GEOMETRICOS_MMAP)
+        int descriptor{ ::open(path.c_str(), O_RDONLY) };
+        if (descriptor < 0)
+        {
+            return;
+        }
+        struct stat info{};
+        if (fstat(descriptor, &info) == 0 && info.st_size > 0)
+        {
+            void* data{ mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE, descriptor, 0) };
+            if (data != MAP_FAILED)
+            {
+                m_data = static_cast<char*>(data);
+                m_size = static_cast<std::size_t>(info.st_size);
+                m_mapped = true;
+            }
+        }
+        // the mapping stays valid after closing the descriptor
+        ::close(descriptor);
+#else
+        std::ifstream in{ path, std::ios::binary | std::ios::ate };
+        if (in)
+        {
+            m_buffer.resize(static_cast<std::size_t>(in.tellg()));
+            in.seekg(0);
+            if (in.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size())))
+            {
+                m_data = m_buffer.data();
+                m_size = m_buffer.size();
+            }
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+            : m_data{ other.m_data }, m_size{ other.m_size }, m_mapped{ other.m_mapped },
+              m_buffer{ std::move(other.m_buffer) }
+    {
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_mapped = false;
+    }
+
+    MappedFile& operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_mapped = other.m_mapped;
+            m_buffer = std::move(other.m_buffer);
+            other.m_data = nullptr;
+            other.m_size = 0;
+            other.m_mapped = false;
+        }
+        return *this;
+    }
+
+    ~MappedFile() { release(); }
+
+    bool isOpen() const { return m_data != nullptr; }
+    char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+};
+
+/*
+ * Points, segments or polygons stored in a file written by writePoints,
+ * writeSegments or writePolygonSet. Opening it only maps the file and checks
+ * its header and offsets, so it takes about the same time for any file size.
+ * Coordinates are used in place: polygons are handed out as Poligono views
+ * over the mapped vertices. On big endian hosts they are converted into
+ * memory first.
+ * Nothing is thrown on failure: getStatus tells what went wrong, and an
+ * invalid MappedGeometry holds no geometry.
+ */
+template <class T>
+class MappedGeometry
+{
+private:
+    MappedFile m_file;
+    BinaryStatus m_status{ BinaryStatus::CANT_OPEN };
+    GeometryKind m_kind{ GeometryKind::POINTS };
+    int m_length{};
+    int m_vertexCount{};
+    const int* m_offsets{};
+    const Punto<T>* m_vertices{};
+
+    BinaryStatus load();
+
+public:
+    /*
+     * Opens the file at path.
+     */
+    explicit MappedGeometry(const std::string &path);
+
+    BinaryStatus getStatus() const { return m_status; }
+    bool isValid() const { return m_status == BinaryStatus::OK; }
+    GeometryKind getKind() const { return m_kind; }
+
+    /*
+     * Returns the amount of points, segments or polygons in the file.
+     */
+    int getLength() const { return m_length; }
+
+    /*
+     * Returns the amount of vertices, which is twice the amount of segments
+     * for segment files.
+     */
+    int getVertexCount() const { return m_vertexCount; }
+
+    /*
+     * Returns the mapped vertex array.
+     */
+    const Punto<T>* getVertices() const { return m_vertices; }
+
+    /*
+     * Returns the offsets table of a polygon set, with getLength()+1
+     * elements, or nullptr for other kinds.
+     */
+    const int* getOffsets() const { return m_offsets; }
+
+    /*
+     * Returns a read only Poligono view of the polygon at the position index.
+     * Editing it copies its vertices, leaving the mapping untouched.
+     */
+    const Poligono<T> operator[] (int index) const;
+
+    /*
+     * Returns the segment at the position index.
+     */
+    Segmento<T> segment(int index) const;
+};
+
+template<class T>
+MappedGeometry<T>::MappedGeometry(const std::string &path)
+        : m_file{ path }
+{
+    m_status = load();
+    if (m_status != BinaryStatus::OK)
+    {
+        m_length = 0;
+        m_vertexCount = 0;
+        m_offsets = nullptr;
+        m_vertices = nullptr;
+    }
+}
+
+template<class T>
+BinaryStatus MappedGeometry<T>::load() {
+    static_assert(BinaryScalar<T>::code != 0, "the binary format stores int32, float and double coordinates");
+    static_assert(sizeof(Punto<T>) == 2 * sizeof(T) && std::is_standard_layout<Punto<T>>::value,
+                  "the binary format stores Punto as its two coordinates");
+    static_assert(sizeof(int) == 4, "the offsets table is used as the int offsets of PolygonSet");
+    if (!m_file.isOpen())
+    {
+        return BinaryStatus::CANT_OPEN;
+    }
+    char* data{ m_file.data() };
+    std::size_t size{ m_file.size() };
+    if (size < static_cast<std::size_t>(BINARY_HEADER_SIZE))
+    {
+        return BinaryStatus::TOO_SHORT;
+    }
+    if (std::memcmp(data, "EGEO", 4) != 0)
+    {
+        return BinaryStatus::BAD_MAGIC;
+    }
+    std::uint16_t version{};
+    std::memcpy(&version, data + 4, sizeof(version));
+    swapToLittleEndian(&version, sizeof(version), 1);
+    if (version == 0 || version > BINARY_FORMAT_VERSION)
+    {
+        return BinaryStatus::BAD_VERSION;
+    }
+    auto kind{ static_cast<unsigned char>(data[6]) };
+    // RTREE files are opened by PolygonRTree
+    if (kind < 1 || kind > static_cast<unsigned char>(GeometryKind::POLYGONS))
+    {
+        return BinaryStatus::BAD_MAGIC;
+    }
+    m_kind = static_cast<GeometryKind>(kind);
+    if (static_cast<unsigned char>(data[7]) != BinaryScalar<T>::code)
+    {
+        return BinaryStatus::WRONG_SCALAR;
+    }
+    std::uint64_t sizes[3]{};
+    std::memcpy(sizes, data + 8, sizeof(sizes));
+    swapToLittleEndian(sizes, sizeof(std::uint64_t), 3);
+    std::uint64_t count{ sizes[0] };
+    std::uint64_t vertexCount{ sizes[1] };
+    std::uint64_t dataOffset{ sizes[2] };
+    const std::uint64_t maxCount{ 0x7fffffff };
+    if (count >= maxCount || vertexCount >= maxCount || dataOffset % 8 != 0)
+    {
+        return BinaryStatus::BAD_OFFSETS;
+    }
+    std::uint64_t tableEnd{ BINARY_HEADER_SIZE + ((m_kind == GeometryKind::POLYGONS) ? 4 * (count + 1) : 0) };
+    // the offset comes from the file, so it's checked apart before it's used
+    // to bound the vertices
+    if (dataOffset < tableEnd || dataOffset > size || (size - dataOffset) / (2 * sizeof(T)) < vertexCount)
+    {
+        return BinaryStatus::TOO_SHORT;
+    }
+    if ((m_kind == GeometryKind::POINTS && vertexCount != count)
+        || (m_kind == GeometryKind::SEGMENTS && vertexCount != 2 * count))
+    {
+        return BinaryStatus::BAD_OFFSETS;
+    }
+
+    // the mapping is private, so converting in place doesn't touch the file
+    swapToLittleEndian(data + BINARY_HEADER_SIZE, 4, static_cast<std::size_t>(tableEnd - BINARY_HEADER_SIZE) / 4);
+    swapToLittleEndian(data + dataOffset, sizeof(T), 2 * static_cast<std::size_t>(vertexCount));
+
+    m_length = static_cast<int>(count);
+    m_vertexCount = static_cast<int>(vertexCount);
+    m_vertices = reinterpret_cast<const Punto<T>*>(data + dataOffset);
+    if (m_kind == GeometryKind::POLYGONS)
+    {
+        m_offsets = reinterpret_cast<const int*>(data + BINARY_HEADER_SIZE);
+        // views must stay inside the vertex array
+        if (m_offsets[0] != 0 || m_offsets[m_length] != m_vertexCount)
+        {
+            return BinaryStatus::BAD_OFFSETS;
+        }
+        for(int i{}; i < m_length; ++i)
+        {
+            if (m_offsets[i + 1] < m_offsets[i])
+            {
+                return BinaryStatus::BAD_OFFSETS;
+            }
+        }
+    }
+    return BinaryStatus::OK;
+}
+
+template<class T>
+const Poligono<T> MappedGeometry<T>::operator[](int index) const {
+    return Poligono<T>::view(m_vertices + m_offsets[index], m_offsets[index + 1] - m_offsets[index]);
+}
+
+template<class T>
+Segmento<T> MappedGeometry<T>::segment(int index) const {
+    return Segmento<T>{ m_vertices[2 * index], m_vertices[2 * index + 1] };
+}
+
+#endif //ELEM_GEOMETRICOS_BINARYFORMAT_H
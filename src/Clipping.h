@@ -0,0 +1,511 @@
+//
+// Sutherland–Hodgman clipping of polygons against convex windows and grids
+// of rectangular tiles.
+//
+
+#ifndef ELEM_GEOMETRICOS_CLIPPING_H
+#define ELEM_GEOMETRICOS_CLIPPING_H
+
+#include "Poligono.h"
+#include "ConvexPoligono.h"
+#include "PolygonSet.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Grid of columns x rows rectangular tiles of the same size, with the lower
+ * left corner of its first tile at (minX, minY). Tile (column, row) covers
+ * [minX + column*tileWidth, minX + (column+1)*tileWidth] horizontally and
+ * the same for the rows vertically, and its index is row*columns + column.
+ */
+template <class T>
+struct TileGrid
+{
+    T minX;
+    T minY;
+    T tileWidth;
+    T tileHeight;
+    int columns;
+    int rows;
+};
+
+/*
+ * A piece left by batchClipToGrid: the polygon of the input set it was cut
+ * from and the index of its tile.
+ */
+struct ClippedPiece
+{
+    int polygon;
+    int tile;
+};
+
+/*
+ * Clips polygons with the Sutherland–Hodgman algorithm: the polygon is cut
+ * by the line of each side of the window, keeping the part on its inner side
+ * along with the points where the boundary crosses it. Intersections are
+ * computed in double, and integer results are rounded to the nearest
+ * coordinates.
+ * As usual with Sutherland–Hodgman, when a concave polygon leaves the window
+ * several times its pieces come out as a single polygon joined by edges
+ * running along the border of the window.
+ * The buffers are kept between calls, so a PolygonClipper is meant to be
+ * reused for many polygons, one per thread.
+ */
+template <class T>
+class PolygonClipper
+{
+private:
+    /*
+     * Parallel strips between the lines origin + k*size, for k from 0 to
+     * count. Strip k lies between the lines k and k+1, both included.
+     */
+    struct Strips
+    {
+        T origin;
+        T size;
+        int count;
+
+        T line(int k) const { return static_cast<T>(origin + k*size); }
+    };
+
+    /*
+     * Rings left by cutting a polygon in strips: the points of strip
+     * first+j are points[start[j]] to points[start[j+1]-1].
+     */
+    struct StripRings
+    {
+        std::vector<int> emittedStrip;
+        std::vector<Punto<double>> emitted;
+        std::vector<int> start;
+        std::vector<Punto<double>> points;
+        int first{};
+        int count{};
+    };
+
+    std::vector<Punto<double>> m_ring;
+    std::vector<Punto<double>> m_clipped;
+    StripRings m_rows;
+    StripRings m_columns;
+    std::vector<Punto<T>> m_output;
+
+    /*
+     * Cuts the polygon with the length points of ring in the given strips in
+     * a single pass over its edges, horizontal ones when Vertical is false
+     * and vertical ones otherwise. The crossings with the lines of the
+     * strips come from Segmento::horizontalIntersect, swapping the axes for
+     * vertical lines.
+     */
+    template <bool Vertical, class U>
+    static void cutInStrips(const Punto<U>* ring, int length, const Strips &strips, StripRings &out);
+
+    /*
+     * Appends the point p to the strips holding it, given its coordinate
+     * across the strips.
+     */
+    static void emit(const Punto<double> &p, double across, const Strips &strips, StripRings &out);
+
+    /*
+     * Appends the point p, which lies on the line k, to the strips at both
+     * sides of it.
+     */
+    static void emitOnLine(const Punto<double> &p, int k, const Strips &strips, StripRings &out);
+
+    /*
+     * Whether p and q have exactly the same coordinates, with no tolerance.
+     */
+    static bool sameCoordinates(const Punto<T> &p, const Punto<T> &q)
+    {
+        return p.getX() == q.getX() && p.getY() == q.getY();
+    }
+
+    /*
+     * Appends to out the polygon with the length points of ring converted
+     * to T, without repeated consecutive vertices. Returns false and leaves
+     * out as it was when nothing with area is left.
+     */
+    bool emitPolygon(const Punto<double>* ring, int length, PolygonSet<T> &out);
+
+public:
+    PolygonClipper() = default;
+    PolygonClipper(const PolygonClipper&) = delete;
+    PolygonClipper& operator=(const PolygonClipper&) = delete;
+
+    /*
+     * Appends to out the part of subject inside window. Returns whether
+     * anything was left, since otherwise nothing is appended.
+     */
+    bool clip(const Poligono<T> &subject, const ConvexPoligono<T> &window, PolygonSet<T> &out);
+
+    /*
+     * Appends to out the part of subject inside the rectangle from
+     * (minX, minY) to (maxX, maxY). Returns whether anything was left.
+     */
+    bool clipRectangle(const Poligono<T> &subject, T minX, T minY, T maxX, T maxY, PolygonSet<T> &out);
+
+    /*
+     * Appends to out the part of subject inside each tile of the grid, in
+     * order of tile index, and the index of the tile of each of them to
+     * tiles. The polygon is first cut in rows in a single pass over its
+     * edges and then every row in columns the same way, so the cost grows
+     * with the vertices plus the crossings with the lines of the grid
+     * instead of with the amount of tiles. Returns the amount of polygons
+     * appended.
+     */
+    int clipToGrid(const Poligono<T> &subject, const TileGrid<T> &grid, PolygonSet<T> &out, std::vector<int> &tiles);
+};
+
+template<class T>
+void PolygonClipper<T>::emitOnLine(const Punto<double> &p, int k, const Strips &strips, StripRings &out) {
+    if (k > 0)
+    {
+        out.emittedStrip.push_back(k - 1);
+        out.emitted.push_back(p);
+    }
+    if (k < strips.count)
+    {
+        out.emittedStrip.push_back(k);
+        out.emitted.push_back(p);
+    }
+}
+
+template<class T>
+void PolygonClipper<T>::emit(const Punto<double> &p, double across, const Strips &strips, StripRings &out) {
+    // the strip below the point, checked against the lines themselves
+    int k{ static_cast<int>(std::floor((across - static_cast<double>(strips.origin)) / static_cast<double>(strips.size))) };
+    k = std::max(-1, std::min(strips.count, k));
+    while (k >= 0 && across < static_cast<double>(strips.line(k)))
+    {
+        --k;
+    }
+    while (k < strips.count && across >= static_cast<double>(strips.line(k + 1)))
+    {
+        ++k;
+    }
+    if (k >= 0 && across == static_cast<double>(strips.line(k)))
+    {
+        emitOnLine(p, k, strips, out);
+    }
+    else if (k >= 0 && k < strips.count)
+    {
+        out.emittedStrip.push_back(k);
+        out.emitted.push_back(p);
+    }
+}
+
+template<class T>
+template<bool Vertical, class U>
+void PolygonClipper<T>::cutInStrips(const Punto<U>* ring, int length, const Strips &strips, StripRings &out) {
+    out.emittedStrip.clear();
+    out.emitted.clear();
+    auto along{ [](const Punto<U> &p) { return Vertical ? p.getY() : p.getX(); } };
+    auto across{ [](const Punto<U> &p) { return Vertical ? p.getX() : p.getY(); } };
+    auto point{ [](double alongValue, double acrossValue) {
+        return Vertical ? Punto<double>{ acrossValue, alongValue } : Punto<double>{ alongValue, acrossValue };
+    } };
+
+    for(int i{}; i < length; ++i)
+    {
+        const Punto<U> &s{ ring[(i == 0) ? length - 1 : i - 1] };
+        const Punto<U> &e{ ring[i] };
+        double a{ static_cast<double>(across(s)) };
+        double b{ static_cast<double>(across(e)) };
+        if (a != b)
+        {
+            // every line strictly between both ends, in the order the edge
+            // crosses them
+            double low{ std::min(a, b) };
+            double high{ std::max(a, b) };
+            int first{ static_cast<int>(std::floor((low - static_cast<double>(strips.origin)) / static_cast<double>(strips.size))) };
+            first = std::max(0, std::min(strips.count + 1, first));
+            while (first > 0 && static_cast<double>(strips.line(first - 1)) > low)
+            {
+                --first;
+            }
+            while (first <= strips.count && static_cast<double>(strips.line(first)) <= low)
+            {
+                ++first;
+            }
+            int last{ first - 1 };
+            while (last < strips.count && static_cast<double>(strips.line(last + 1)) < high)
+            {
+                ++last;
+            }
+
+            // the edge with its axes swapped for vertical lines, so the
+            // crossing is always a horizontal intersection
+            Segmento<U> edge{ Punto<U>{ along(s), across(s) }, Punto<U>{ along(e), across(e) } };
+            double alongLow{ static_cast<double>(std::min(along(s), along(e))) };
+            double alongHigh{ static_cast<double>(std::max(along(s), along(e))) };
+            for(int j{}; j <= last - first; ++j)
+            {
+                int k{ (a < b) ? first + j : last - j };
+                U line{ static_cast<U>(strips.line(k)) };
+                double crossing{ std::max(alongLow, std::min(alongHigh, edge.horizontalIntersect(line))) };
+                emitOnLine(point(crossing, static_cast<double>(line)), k, strips, out);
+            }
+        }
+        emit(point(static_cast<double>(along(e)), b), b, strips, out);
+    }
+
+    // stable counting sort by strip, over the strips actually touched
+    int emitted{ static_cast<int>(out.emitted.size()) };
+    out.first = 0;
+    out.count = 0;
+    if (emitted == 0)
+    {
+        return;
+    }
+    auto range{ std::minmax_element(out.emittedStrip.begin(), out.emittedStrip.end()) };
+    out.first = *range.first;
+    out.count = *range.second - *range.first + 1;
+    out.start.assign(static_cast<std::size_t>(out.count) + 1, 0);
+    for(int strip: out.emittedStrip)
+    {
+        ++out.start[strip - out.first + 1];
+    }
+    for(int j{}; j < out.count; ++j)
+    {
+        out.start[j + 1] += out.start[j];
+    }
+    out.points.resize(out.emitted.size());
+    for(int i{}; i < emitted; ++i)
+    {
+        out.points[out.start[out.emittedStrip[i] - out.first]++] = out.emitted[i];
+    }
+    // the counters ended at the start of the next strip
+    for(int j{ out.count }; j > 0; --j)
+    {
+        out.start[j] = out.start[j - 1];
+    }
+    out.start[0] = 0;
+}
+
+template<class T>
+bool PolygonClipper<T>::emitPolygon(const Punto<double>* ring, int length, PolygonSet<T> &out) {
+    m_output.clear();
+    for(int i{}; i < length; ++i)
+    {
+        Punto<T> p;
+        if constexpr (std::is_integral<T>::value)
+        {
+            p = Punto<T>{ static_cast<T>(std::llround(ring[i].getX())), static_cast<T>(std::llround(ring[i].getY())) };
+        }
+        else
+        {
+            p = Punto<T>{ static_cast<T>(ring[i].getX()), static_cast<T>(ring[i].getY()) };
+        }
+        if (m_output.empty() || !sameCoordinates(m_output.back(), p))
+        {
+            m_output.push_back(p);
+        }
+    }
+    while (m_output.size() > 1 && sameCoordinates(m_output.back(), m_output.front()))
+    {
+        m_output.pop_back();
+    }
+    int count{ static_cast<int>(m_output.size()) };
+    if (count < 3)
+    {
+        return false;
+    }
+    double doubleArea{ };
+    for(int i{}; i < count; ++i)
+    {
+        const Punto<T> &p{ m_output[i] };
+        const Punto<T> &q{ m_output[(i + 1 == count) ? 0 : i + 1] };
+        doubleArea += static_cast<double>(p.getX()) * q.getY() - static_cast<double>(q.getX()) * p.getY();
+    }
+    if (doubleArea == 0)
+    {
+        return false;
+    }
+    out.push_back(m_output.data(), count);
+    return true;
+}
+
+template<class T>
+bool PolygonClipper<T>::clip(const Poligono<T> &subject, const ConvexPoligono<T> &window, PolygonSet<T> &out) {
+    int windowLength{ window.getLength() };
+    if (windowLength < 3)
+    {
+        return false;
+    }
+    m_ring.clear();
+    for(int i{}; i < subject.getLength(); ++i)
+    {
+        m_ring.push_back(Punto<double>{ static_cast<double>(subject[i].getX()), static_cast<double>(subject[i].getY()) });
+    }
+
+    // the window is counter clockwise, so its inner side is the left one
+    for(int w{}; w < windowLength && !m_ring.empty(); ++w)
+    {
+        const Punto<T> &from{ window[w] };
+        const Punto<T> &to{ window[(w + 1 == windowLength) ? 0 : w + 1] };
+        Segmento<double> side{ static_cast<double>(from.getX()), static_cast<double>(from.getY()),
+                               static_cast<double>(to.getX()), static_cast<double>(to.getY()) };
+        m_clipped.clear();
+        int length{ static_cast<int>(m_ring.size()) };
+        for(int i{}; i < length; ++i)
+        {
+            const Punto<double> &s{ m_ring[(i == 0) ? length - 1 : i - 1] };
+            const Punto<double> &e{ m_ring[i] };
+            double ds{ side.lineDeterminant(s) };
+            double de{ side.lineDeterminant(e) };
+            if ((ds < 0 && de > 0) || (ds > 0 && de < 0))
+            {
+                double t{ ds / (ds - de) };
+                Punto<double> crossing{ s + (e - s)*t };
+                m_clipped.push_back(crossing);
+            }
+            if (de >= 0)
+            {
+                m_clipped.push_back(e);
+            }
+        }
+        std::swap(m_ring, m_clipped);
+    }
+    return emitPolygon(m_ring.data(), static_cast<int>(m_ring.size()), out);
+}
+
+template<class T>
+bool PolygonClipper<T>::clipRectangle(const Poligono<T> &subject, T minX, T minY, T maxX, T maxY, PolygonSet<T> &out) {
+    if (!(minX < maxX) || !(minY < maxY))
+    {
+        return false;
+    }
+    // a grid of a single tile
+    std::vector<int> tiles;
+    TileGrid<T> grid{ minX, minY, static_cast<T>(maxX - minX), static_cast<T>(maxY - minY), 1, 1 };
+    return clipToGrid(subject, grid, out, tiles) > 0;
+}
+
+template<class T>
+int PolygonClipper<T>::clipToGrid(const Poligono<T> &subject, const TileGrid<T> &grid,
+                                  PolygonSet<T> &out, std::vector<int> &tiles) {
+    if (subject.getLength() < 3 || grid.columns <= 0 || grid.rows <= 0)
+    {
+        return 0;
+    }
+    Strips rows{ grid.minY, grid.tileHeight, grid.rows };
+    Strips columns{ grid.minX, grid.tileWidth, grid.columns };
+    cutInStrips<false>(&subject[0], subject.getLength(), rows, m_rows);
+
+    int appended{ };
+    for(int r{}; r < m_rows.count; ++r)
+    {
+        int rowLength{ m_rows.start[r + 1] - m_rows.start[r] };
+        if (rowLength < 3)
+        {
+            continue;
+        }
+        cutInStrips<true>(m_rows.points.data() + m_rows.start[r], rowLength, columns, m_columns);
+        for(int c{}; c < m_columns.count; ++c)
+        {
+            int length{ m_columns.start[c + 1] - m_columns.start[c] };
+            if (length >= 3 && emitPolygon(m_columns.points.data() + m_columns.start[c], length, out))
+            {
+                tiles.push_back((m_rows.first + r) * grid.columns + m_columns.first + c);
+                ++appended;
+            }
+        }
+    }
+    return appended;
+}
+
+/*
+ * Returns the part of subject inside window, which is empty when they don't
+ * overlap.
+ */
+template <class T>
+PolygonSet<T> clip(const Poligono<T> &subject, const ConvexPoligono<T> &window)
+{
+    PolygonSet<T> out;
+    PolygonClipper<T>{}.clip(subject, window, out);
+    return out;
+}
+
+/*
+ * Runs task(clipper, i, out, sources) for every polygon i of the set, split
+ * across threads by their amount of vertices, and appends what each range of
+ * polygons left to out and sources in the order of the set.
+ */
+template <class T, class Source, class Task>
+void clipEach(const PolygonSet<T> &set, PolygonSet<T> &out, std::vector<Source> &sources,
+              Task task, int threads)
+{
+    struct Part
+    {
+        int begin;
+        PolygonSet<T> polygons;
+        std::vector<Source> sources;
+    };
+    std::vector<Part> parts;
+    std::mutex partsMutex;
+    parallelForBalanced(set.getOffsets(), set.getLength(), [&](int begin, int end) {
+        Part part{ begin, PolygonSet<T>{}, std::vector<Source>{} };
+        PolygonClipper<T> clipper;
+        for(int i{ begin }; i < end; ++i)
+        {
+            task(clipper, i, part.polygons, part.sources);
+        }
+        std::lock_guard<std::mutex> lock{ partsMutex };
+        parts.push_back(std::move(part));
+    }, threads, 1 << 12);
+
+    std::sort(parts.begin(), parts.end(), [](const Part &a, const Part &b) { return a.begin < b.begin; });
+    for(const Part &part: parts)
+    {
+        for(int i{}; i < part.polygons.getLength(); ++i)
+        {
+            out.push_back(part.polygons[i]);
+        }
+        sources.insert(sources.end(), part.sources.begin(), part.sources.end());
+    }
+}
+
+/*
+ * Clips every polygon of the set against window, appending the results to
+ * out and the index in the set of the polygon each one comes from to
+ * sources, in the order of the set. The polygons are split across threads
+ * so that every thread gets about the same amount of vertices. When threads
+ * is 0 one per hardware thread is used.
+ */
+template <class T>
+void batchClip(const PolygonSet<T> &set, const ConvexPoligono<T> &window, PolygonSet<T> &out,
+               std::vector<int> &sources, int threads = 0)
+{
+    clipEach(set, out, sources, [&](PolygonClipper<T> &clipper, int i, PolygonSet<T> &polygons,
+                                    std::vector<int> &from) {
+        if (clipper.clip(set[i], window, polygons))
+        {
+            from.push_back(i);
+        }
+    }, threads);
+}
+
+/*
+ * Cuts every polygon of the set in the tiles of grid, appending the pieces
+ * to out and where each one comes from to pieces, ordered by polygon and
+ * then by tile. Threads are used as in batchClip.
+ */
+template <class T>
+void batchClipToGrid(const PolygonSet<T> &set, const TileGrid<T> &grid, PolygonSet<T> &out,
+                     std::vector<ClippedPiece> &pieces, int threads = 0)
+{
+    clipEach(set, out, pieces, [&](PolygonClipper<T> &clipper, int i, PolygonSet<T> &polygons,
+                                   std::vector<ClippedPiece> &from) {
+        std::vector<int> tiles;
+        clipper.clipToGrid(set[i], grid, polygons, tiles);
+        for(int tile: tiles)
+        {
+            from.push_back(ClippedPiece{ i, tile });
+        }
+    }, threads);
+}
+
+#endif //ELEM_GEOMETRICOS_CLIPPING_H
@@ -0,0 +1,234 @@
+//
+// Convex hull of large point sets.
+//
+
+#ifndef ELEM_GEOMETRICOS_CONVEXHULL_H
+#define ELEM_GEOMETRICOS_CONVEXHULL_H
+
+#include "Poligono.h"
+#include "PointBuffer.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <vector>
+
+/*
+ * Returns double the signed area of the triangle (o, a, b), that is, the cross
+ * product of the vectors from o to a and from o to b. It's positive when b is
+ * to the left of the directed line from o to a. Integer turns are exact.
+ */
+template <class T>
+OrientationType<T> hullTurn(const Punto<T> &o, const Punto<T> &a, const Punto<T> &b)
+{
+    if constexpr (std::is_integral<T>::value)
+    {
+        return wideOrientation(o.getX(), o.getY(), a.getX(), a.getY(), b.getX(), b.getY());
+    }
+    else
+    {
+        return crossProdValue(Vector<T>{ a.getX() - o.getX(), a.getY() - o.getY() },
+                              Vector<T>{ b.getX() - o.getX(), b.getY() - o.getY() });
+    }
+}
+
+/*
+ * Returns the convex hull of the given points using Andrew's monotone chain.
+ * The points are sorted in place. The hull is given in counter clockwise
+ * order starting from the lowest of the leftmost points, without collinear
+ * vertices.
+ */
+template <class T>
+std::vector<Punto<T>> monotoneChain(std::vector<Punto<T>> &puntos)
+{
+    std::sort(puntos.begin(), puntos.end(), [](const Punto<T> &p1, const Punto<T> &p2) {
+        return (p1.getX() < p2.getX()) || ((p1.getX() == p2.getX()) && (p1.getY() < p2.getY()));
+    });
+    puntos.erase(std::unique(puntos.begin(), puntos.end(), [](const Punto<T> &p1, const Punto<T> &p2) {
+        return (p1.getX() == p2.getX()) && (p1.getY() == p2.getY());
+    }), puntos.end());
+
+    int count{ static_cast<int>(puntos.size()) };
+    if (count < 3)
+    {
+        return puntos;
+    }
+
+    std::vector<Punto<T>> hull(2 * static_cast<std::size_t>(count));
+    int length{ };
+    // lower chain from left to right
+    for(int i{}; i < count; ++i)
+    {
+        while (length >= 2 && hullTurn(hull[length - 2], hull[length - 1], puntos[i]) <= 0)
+        {
+            --length;
+        }
+        hull[length++] = puntos[i];
+    }
+    // upper chain from right to left, the rightmost point is already there
+    int lowerLength{ length + 1 };
+    for(int i{ count - 2 }; i >= 0; --i)
+    {
+        while (length >= lowerLength && hullTurn(hull[length - 2], hull[length - 1], puntos[i]) <= 0)
+        {
+            --length;
+        }
+        hull[length++] = puntos[i];
+    }
+    // the leftmost point was added again at the end
+    hull.resize(static_cast<std::size_t>(length - 1));
+    return hull;
+}
+
+/*
+ * Returns the points of the set that are extreme in the eight directions
+ * multiple of 45 degrees, in counter clockwise order and without repeated
+ * points. Every point strictly inside the polygon they form is not a vertex
+ * of the hull (Akl-Toussaint heuristic).
+ */
+template <class T>
+std::vector<Punto<T>> extremePoints(const Punto<T>* puntos, int count)
+{
+    // directions (1,0), (1,1), (0,1), (-1,1), (-1,0), (-1,-1), (0,-1), (1,-1)
+    const int dx[8]{ 1, 1, 0, -1, -1, -1, 0, 1 };
+    const int dy[8]{ 0, 1, 1, 1, 0, -1, -1, -1 };
+    int best[8]{};
+    for(int i{ 1 }; i < count; ++i)
+    {
+        for(int k{}; k < 8; ++k)
+        {
+            const Punto<T> &p{ puntos[i] };
+            const Punto<T> &b{ puntos[best[k]] };
+            // the sum of two coordinates may not fit in T
+            WideType<T> projection{ dx[k] * static_cast<WideType<T>>(p.getX())
+                                    + dy[k] * static_cast<WideType<T>>(p.getY()) };
+            WideType<T> bestProjection{ dx[k] * static_cast<WideType<T>>(b.getX())
+                                        + dy[k] * static_cast<WideType<T>>(b.getY()) };
+            if (projection > bestProjection)
+            {
+                best[k] = i;
+            }
+        }
+    }
+
+    std::vector<Punto<T>> extremes;
+    for(int k{}; k < 8; ++k)
+    {
+        const Punto<T> &p{ puntos[best[k]] };
+        if (extremes.empty() || !(extremes.back().getX() == p.getX() && extremes.back().getY() == p.getY()))
+        {
+            extremes.push_back(p);
+        }
+    }
+    while (extremes.size() > 1 && extremes.front().getX() == extremes.back().getX()
+           && extremes.front().getY() == extremes.back().getY())
+    {
+        extremes.pop_back();
+    }
+    return extremes;
+}
+
+/*
+ * Returns whether p is strictly inside the convex polygon given by its
+ * vertices in counter clockwise order.
+ */
+template <class T>
+bool strictlyInsideConvex(const std::vector<Punto<T>> &convex, const Punto<T> &p)
+{
+    int length{ static_cast<int>(convex.size()) };
+    for(int i{}; i < length; ++i)
+    {
+        if (hullTurn(convex[i], convex[(i+1 == length) ? 0 : i+1], p) <= 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Returns the convex hull of the count given points as a Poligono in counter
+ * clockwise order, starting from the lowest of the leftmost points and
+ * without collinear vertices. Fewer than three distinct points give a
+ * degenerate polygon with those points.
+ * When prefilter is set, points inside the polygon of the extreme points are
+ * discarded before sorting. With more than one thread the points are split
+ * in chunks whose hulls are computed in parallel and then merged.
+ */
+template <class T>
+Poligono<T> convexHull(const Punto<T>* puntos, int count, bool prefilter = true, int threads = 0)
+{
+    if (count <= 0)
+    {
+        return Poligono<T>{};
+    }
+    if (threads <= 0)
+    {
+        threads = defaultThreadCount();
+    }
+    // below this amount of points per chunk the threads cost more than they save
+    const int minChunk{ 1 << 16 };
+    int chunks{ std::max(1, std::min(threads, count / minChunk)) };
+
+    // the extremes of all points are the extremes of the extremes of each chunk
+    std::vector<Punto<T>> extremes;
+    if (prefilter)
+    {
+        std::vector<std::vector<Punto<T>>> chunkExtremes(static_cast<std::size_t>(chunks));
+        parallelFor(chunks, [&](int begin, int end) {
+            for(int c{ begin }; c < end; ++c)
+            {
+                int first{ static_cast<int>(static_cast<long>(count) * c / chunks) };
+                int last{ static_cast<int>(static_cast<long>(count) * (c + 1) / chunks) };
+                chunkExtremes[c] = extremePoints(puntos + first, last - first);
+            }
+        }, chunks, 1);
+        for(const std::vector<Punto<T>> &chunk: chunkExtremes)
+        {
+            extremes.insert(extremes.end(), chunk.begin(), chunk.end());
+        }
+        extremes = extremePoints(extremes.data(), static_cast<int>(extremes.size()));
+    }
+    bool filter{ extremes.size() >= 3 };
+
+    std::vector<std::vector<Punto<T>>> chunkHulls(static_cast<std::size_t>(chunks));
+    parallelFor(chunks, [&](int begin, int end) {
+        for(int c{ begin }; c < end; ++c)
+        {
+            int first{ static_cast<int>(static_cast<long>(count) * c / chunks) };
+            int last{ static_cast<int>(static_cast<long>(count) * (c + 1) / chunks) };
+            std::vector<Punto<T>> candidates;
+            candidates.reserve(static_cast<std::size_t>(filter ? (last - first) / 4 : last - first));
+            for(int i{ first }; i < last; ++i)
+            {
+                if (!filter || !strictlyInsideConvex(extremes, puntos[i]))
+                {
+                    candidates.push_back(puntos[i]);
+                }
+            }
+            chunkHulls[c] = monotoneChain(candidates);
+        }
+    }, chunks, 1);
+
+    if (chunks == 1)
+    {
+        return Poligono<T>{ chunkHulls[0].begin(), chunkHulls[0].end() };
+    }
+    std::vector<Punto<T>> merged;
+    for(const std::vector<Punto<T>> &hull: chunkHulls)
+    {
+        merged.insert(merged.end(), hull.begin(), hull.end());
+    }
+    std::vector<Punto<T>> hull{ monotoneChain(merged) };
+    return Poligono<T>{ hull.begin(), hull.end() };
+}
+
+/*
+ * Same as above for the points of a PointBuffer.
+ */
+template <class T>
+Poligono<T> convexHull(const PointBuffer<T> &puntos, bool prefilter = true, int threads = 0)
+{
+    std::vector<Punto<T>> array{ puntos.toVector() };
+    return convexHull(array.data(), static_cast<int>(array.size()), prefilter, threads);
+}
+
+#endif //ELEM_GEOMETRICOS_CONVEXHULL_H
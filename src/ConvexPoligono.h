@@ -0,0 +1,323 @@
+//
+// Convex polygon with logarithmic time queries.
+//
+
+#ifndef ELEM_GEOMETRICOS_CONVEXPOLIGONO_H
+#define ELEM_GEOMETRICOS_CONVEXPOLIGONO_H
+
+#include "Poligono.h"
+#include "ConvexHull.h"
+#include "Predicates.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/*
+ * Read only convex polygon. Its vertices are kept in counter clockwise order
+ * without repeated or collinear vertices, which lets every query below run
+ * in O(log n) by binary search instead of walking all the edges.
+ * Indices given by the queries refer to the vertices of the ConvexPoligono,
+ * which may start at a different vertex than the Poligono it was built from.
+ */
+template <class T>
+class ConvexPoligono
+{
+private:
+    std::vector<Punto<T>> m_vertices;
+
+    /*
+     * Returns the vertex at index, taking index length as vertex 0.
+     */
+    const Punto<T>& vertex(int index) const { return m_vertices[(index == getLength()) ? 0 : index]; }
+
+    /*
+     * Sets the vertices to the convex hull of the length given points.
+     */
+    void build(const Punto<T>* puntos, int length);
+
+    /*
+     * Returns the dot product of the direction d and the vector from q to p.
+     */
+    static T dotDiff(const Vector<T> &d, const Punto<T> &p, const Punto<T> &q);
+
+    /*
+     * Linear time versions of extremeVertex and tangents, used for small
+     * polygons.
+     */
+    int scanExtremeVertex(const Vector<T> &direction) const;
+    std::pair<int, int> scanTangents(const Punto<T> &p) const;
+
+public:
+    /*
+     * Creates the convex polygon with the vertices of pol, which should be
+     * convex (see Poligono::isConvex). The vertices are taken from the
+     * convex hull of pol, so for a polygon that isn't convex the result is
+     * its hull.
+     */
+    explicit ConvexPoligono(const Poligono<T> &pol);
+
+    /*
+     * Same as above for the length points of the given array.
+     */
+    ConvexPoligono(const Punto<T>* puntos, int length);
+
+    /*
+     * Returns the amount of vertices of the polygon.
+     */
+    int getLength() const { return static_cast<int>(m_vertices.size()); }
+
+    /*
+     * Gets the vertex at the position given by index.
+     */
+    const Punto<T>& operator[] (int index) const { return m_vertices[index]; }
+
+    /*
+     * Returns 1 when p lies strictly inside the polygon, 0 when it's on its
+     * boundary and -1 when it's outside. The triangle of the fan from vertex
+     * 0 holding p is found by binary search. Orientations are computed as
+     * told by the Predicates policy, see Predicates.h.
+     */
+    template <class Predicates = FastPredicates>
+    int locate(const Punto<T> &p) const;
+
+    /*
+     * Checks if a Punto p lies inside the polygon or on its boundary.
+     */
+    template <class Predicates = FastPredicates>
+    bool pointInside(const Punto<T> &p) const { return locate<Predicates>(p) >= 0; }
+
+    /*
+     * Returns the index of a vertex with the greatest projection over the
+     * given direction, that is, the vertex furthest in that direction.
+     */
+    int extremeVertex(const Vector<T> &direction) const;
+
+    /*
+     * Returns the indices of the two vertices touched by the tangents to the
+     * polygon from p. The whole polygon lies to the left of the line from p
+     * to the first vertex, and to the right of the line from p to the
+     * second. When p is not outside the polygon both are -1.
+     */
+    std::pair<int, int> tangents(const Punto<T> &p) const;
+};
+
+template<class T>
+ConvexPoligono<T>::ConvexPoligono(const Poligono<T> &pol) {
+    if (pol.getLength() > 0)
+    {
+        build(&pol[0], pol.getLength());
+    }
+}
+
+template<class T>
+ConvexPoligono<T>::ConvexPoligono(const Punto<T>* puntos, int length) {
+    build(puntos, length);
+}
+
+template<class T>
+void ConvexPoligono<T>::build(const Punto<T>* puntos, int length) {
+    std::vector<Punto<T>> vertices(puntos, puntos + length);
+    m_vertices = monotoneChain(vertices);
+}
+
+template<class T>
+T ConvexPoligono<T>::dotDiff(const Vector<T> &d, const Punto<T> &p, const Punto<T> &q) {
+    return d.getX() * (p.getX() - q.getX()) + d.getY() * (p.getY() - q.getY());
+}
+
+template<class T>
+int ConvexPoligono<T>::scanExtremeVertex(const Vector<T> &direction) const {
+    int best{ };
+    for(int i{ 1 }; i < getLength(); ++i)
+    {
+        if (dotDiff(direction, m_vertices[i], m_vertices[best]) > 0)
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+template<class T>
+std::pair<int, int> ConvexPoligono<T>::scanTangents(const Punto<T> &p) const {
+    int right{ };
+    int left{ };
+    for(int i{ 1 }; i < getLength(); ++i)
+    {
+        if (hullTurn(p, m_vertices[right], m_vertices[i]) < 0)
+        {
+            right = i;
+        }
+        if (hullTurn(p, m_vertices[left], m_vertices[i]) > 0)
+        {
+            left = i;
+        }
+    }
+    return std::pair<int, int>{ right, left };
+}
+
+template<class T>
+template<class Predicates>
+int ConvexPoligono<T>::locate(const Punto<T> &p) const {
+    int length{ getLength() };
+    if (length < 3)
+    {
+        if (length == 0)
+        {
+            return -1;
+        }
+        const Punto<T> &a{ m_vertices[0] };
+        const Punto<T> &b{ m_vertices[length - 1] };
+        bool onSegment{ Predicates::orientation(a, b, p) == 0
+                        && std::min(a.getX(), b.getX()) <= p.getX() && p.getX() <= std::max(a.getX(), b.getX())
+                        && std::min(a.getY(), b.getY()) <= p.getY() && p.getY() <= std::max(a.getY(), b.getY()) };
+        return onSegment ? 0 : -1;
+    }
+
+    const Punto<T> &origin{ m_vertices[0] };
+    auto first{ Predicates::orientation(origin, m_vertices[1], p) };
+    auto last{ Predicates::orientation(origin, m_vertices[length - 1], p) };
+    if (first < 0 || last > 0)
+    {
+        return -1;
+    }
+    // p is in the line of one of the edges at vertex 0
+    if (first == 0 || last == 0)
+    {
+        const Punto<T> &end{ (first == 0) ? m_vertices[1] : m_vertices[length - 1] };
+        T along{ dotDiff(Vector<T>{ end.getX() - origin.getX(), end.getY() - origin.getY() }, p, origin) };
+        T edge{ dotDiff(Vector<T>{ end.getX() - origin.getX(), end.getY() - origin.getY() }, end, origin) };
+        return (along >= 0 && along <= edge) ? 0 : -1;
+    }
+
+    // the last fan diagonal from vertex 0 that leaves p to its left
+    int low{ 1 };
+    int high{ length - 1 };
+    while (high - low > 1)
+    {
+        int middle{ (low + high) / 2 };
+        if (Predicates::orientation(origin, m_vertices[middle], p) >= 0)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    auto side{ Predicates::orientation(m_vertices[low], m_vertices[high], p) };
+    return (side > 0) ? 1 : ((side == 0) ? 0 : -1);
+}
+
+template<class T>
+int ConvexPoligono<T>::extremeVertex(const Vector<T> &direction) const {
+    int length{ getLength() };
+    if (length < 10)
+    {
+        return scanExtremeVertex(direction);
+    }
+
+    // binary search over the chain [a, b] holding the maximum, as in
+    // Sunday's polyMax_2D. An edge goes up when it advances along direction
+    int a{ };
+    int b{ length };
+    bool upA{ dotDiff(direction, vertex(1), vertex(0)) > 0 };
+    if (!upA && !(dotDiff(direction, vertex(length - 1), vertex(0)) > 0))
+    {
+        return 0;
+    }
+    while (b > a + 1)
+    {
+        int c{ (a + b) / 2 };
+        bool upC{ dotDiff(direction, vertex(c + 1), vertex(c)) > 0 };
+        if (!upC && !(dotDiff(direction, vertex(c - 1), vertex(c)) > 0))
+        {
+            return c;
+        }
+        bool aAboveC{ dotDiff(direction, vertex(a), vertex(c)) > 0 };
+        bool aBelowC{ dotDiff(direction, vertex(a), vertex(c)) < 0 };
+        if ((upA && (!upC || aAboveC)) || (!upA && !upC && aBelowC))
+        {
+            b = c;
+        }
+        else
+        {
+            a = c;
+            upA = upC;
+        }
+    }
+    // only reached when rounding broke the convexity of the vertices
+    return scanExtremeVertex(direction);
+}
+
+template<class T>
+std::pair<int, int> ConvexPoligono<T>::tangents(const Punto<T> &p) const {
+    int length{ getLength() };
+    if (locate(p) >= 0)
+    {
+        return std::pair<int, int>{ -1, -1 };
+    }
+    if (length < 10)
+    {
+        return scanTangents(p);
+    }
+
+    // binary searches as in Sunday's tangent_PointPolyC: vertex i is above
+    // vertex j, as seen from p, when j is to the left of the ray to i
+    auto above = [&](int i, int j) { return hullTurn(p, vertex(i), vertex(j)) > 0; };
+    auto below = [&](int i, int j) { return hullTurn(p, vertex(i), vertex(j)) < 0; };
+
+    int right{ -1 };
+    if (below(1, 0) && !above(length - 1, 0))
+    {
+        right = 0;
+    }
+    for(int a{ }, b{ length }; right < 0 && b > a + 1;)
+    {
+        int c{ (a + b) / 2 };
+        bool downC{ below(c + 1, c) };
+        if (downC && !above(c - 1, c))
+        {
+            right = c;
+        }
+        else if (above(a + 1, a) ? (downC || above(a, c)) : (downC && below(a, c)))
+        {
+            b = c;
+        }
+        else
+        {
+            a = c;
+        }
+    }
+
+    int left{ -1 };
+    if (above(length - 1, 0) && !below(1, 0))
+    {
+        left = 0;
+    }
+    for(int a{ }, b{ length }; left < 0 && b > a + 1;)
+    {
+        int c{ (a + b) / 2 };
+        bool downC{ below(c + 1, c) };
+        if (above(c - 1, c) && !downC)
+        {
+            left = c;
+        }
+        else if (below(a + 1, a) ? (!downC || below(a, c)) : (!downC && above(a, c)))
+        {
+            b = c;
+        }
+        else
+        {
+            a = c;
+        }
+    }
+    if (right < 0 || left < 0)
+    {
+        // only reached when rounding broke the convexity of the vertices
+        return scanTangents(p);
+    }
+    return std::pair<int, int>{ right, left };
+}
+
+#endif //ELEM_GEOMETRICOS_CONVEXPOLIGONO_H
@@ -0,0 +1,253 @@
+//
+// Expression templates for the arithmetic of Punto and Vector. Adding,
+// subtracting, negating or scaling them returns a small node that holds its
+// operands by value and computes its coordinates when asked for them, so a
+// chain like (a - b)*s + c is evaluated in a single pass with no temporary
+// points. A node converts to the Punto or Vector of its coordinate type, and
+// that type follows the usual arithmetic conversions of the coordinates, so
+// Punto<int> + Punto<double> still gives a Punto<double>. Punto3D and
+// Vector3D use the same nodes, which also compute a Z coordinate for them.
+//
+
+#ifndef ELEM_GEOMETRICOS_COORDINATEEXPRESSION_H
+#define ELEM_GEOMETRICOS_COORDINATEEXPRESSION_H
+
+#include <ostream>
+#include <type_traits>
+
+template <class T> class Punto;
+template <class T> class Vector;
+template <class T> class Punto3D;
+template <class T> class Vector3D;
+
+/*
+ * Kinds of values an expression evaluates to, with their amount of
+ * coordinates. Points and vectors don't mix, and neither do 2D and 3D.
+ */
+struct PointKind
+{
+    template <class V> using result = Punto<V>;
+    static constexpr int dimension{ 2 };
+};
+
+struct VectorKind
+{
+    template <class V> using result = Vector<V>;
+    static constexpr int dimension{ 2 };
+};
+
+struct Point3DKind
+{
+    template <class V> using result = Punto3D<V>;
+    static constexpr int dimension{ 3 };
+};
+
+struct Vector3DKind
+{
+    template <class V> using result = Vector3D<V>;
+    static constexpr int dimension{ 3 };
+};
+
+template <class Kind, class L, class R> class CoordinateSum;
+template <class Kind, class L, class R> class CoordinateDifference;
+template <class Kind, class E> class CoordinateNegation;
+template <class Kind, class E, class S> class CoordinateScale;
+
+/*
+ * Kind of a coordinate expression as its type member. It has none for
+ * anything else, which keeps the operators below away from other types.
+ */
+template <class E> struct ExpressionKind {};
+template <class T> struct ExpressionKind<Punto<T>> { using type = PointKind; };
+template <class T> struct ExpressionKind<Vector<T>> { using type = VectorKind; };
+template <class T> struct ExpressionKind<Punto3D<T>> { using type = Point3DKind; };
+template <class T> struct ExpressionKind<Vector3D<T>> { using type = Vector3DKind; };
+template <class Kind, class L, class R> struct ExpressionKind<CoordinateSum<Kind, L, R>> { using type = Kind; };
+template <class Kind, class L, class R> struct ExpressionKind<CoordinateDifference<Kind, L, R>> { using type = Kind; };
+template <class Kind, class E> struct ExpressionKind<CoordinateNegation<Kind, E>> { using type = Kind; };
+template <class Kind, class E, class S> struct ExpressionKind<CoordinateScale<Kind, E, S>> { using type = Kind; };
+
+/*
+ * Whether E is an expression node, as opposed to a Punto, a Vector or their
+ * 3D versions.
+ */
+template <class E> struct IsCoordinateNode : std::false_type {};
+template <class Kind, class L, class R> struct IsCoordinateNode<CoordinateSum<Kind, L, R>> : std::true_type {};
+template <class Kind, class L, class R> struct IsCoordinateNode<CoordinateDifference<Kind, L, R>> : std::true_type {};
+template <class Kind, class E> struct IsCoordinateNode<CoordinateNegation<Kind, E>> : std::true_type {};
+template <class Kind, class E, class S> struct IsCoordinateNode<CoordinateScale<Kind, E, S>> : std::true_type {};
+
+/*
+ * The common kind of L and R, only when both are expressions of that kind.
+ */
+template <class L, class R>
+using CommonKind = std::enable_if_t<std::is_same<typename ExpressionKind<L>::type,
+                                                 typename ExpressionKind<R>::type>::value,
+                                    typename ExpressionKind<L>::type>;
+
+/*
+ * Whether E is an expression node that evaluates to the given kind.
+ */
+template <class E, class Kind>
+constexpr bool isNodeOfKind()
+{
+    if constexpr (IsCoordinateNode<E>::value)
+    {
+        return std::is_same<typename ExpressionKind<E>::type, Kind>::value;
+    }
+    return false;
+}
+
+template <class Kind, class L, class R>
+class CoordinateSum
+{
+private:
+    L m_left;
+    R m_right;
+
+public:
+    constexpr CoordinateSum(const L &left, const R &right) noexcept
+            : m_left{ left }, m_right{ right }
+    {};
+
+    constexpr auto getX() const noexcept { return m_left.getX() + m_right.getX(); }
+    constexpr auto getY() const noexcept { return m_left.getY() + m_right.getY(); }
+    constexpr auto getZ() const noexcept { return m_left.getZ() + m_right.getZ(); }
+};
+
+template <class Kind, class L, class R>
+class CoordinateDifference
+{
+private:
+    L m_left;
+    R m_right;
+
+public:
+    constexpr CoordinateDifference(const L &left, const R &right) noexcept
+            : m_left{ left }, m_right{ right }
+    {};
+
+    constexpr auto getX() const noexcept { return m_left.getX() - m_right.getX(); }
+    constexpr auto getY() const noexcept { return m_left.getY() - m_right.getY(); }
+    constexpr auto getZ() const noexcept { return m_left.getZ() - m_right.getZ(); }
+};
+
+template <class Kind, class E>
+class CoordinateNegation
+{
+private:
+    E m_expression;
+
+public:
+    constexpr explicit CoordinateNegation(const E &expression) noexcept
+            : m_expression{ expression }
+    {};
+
+    constexpr auto getX() const noexcept { return -m_expression.getX(); }
+    constexpr auto getY() const noexcept { return -m_expression.getY(); }
+    constexpr auto getZ() const noexcept { return -m_expression.getZ(); }
+};
+
+template <class Kind, class E, class S>
+class CoordinateScale
+{
+private:
+    E m_expression;
+    S m_scalar;
+
+public:
+    constexpr CoordinateScale(const E &expression, S scalar) noexcept
+            : m_expression{ expression }, m_scalar{ scalar }
+    {};
+
+    constexpr auto getX() const noexcept { return m_expression.getX() * m_scalar; }
+    constexpr auto getY() const noexcept { return m_expression.getY() * m_scalar; }
+    constexpr auto getZ() const noexcept { return m_expression.getZ() * m_scalar; }
+};
+
+/*
+ * Returns the Punto, Vector, Punto3D or Vector3D an expression evaluates to.
+ */
+template <class E, class Kind = typename ExpressionKind<E>::type>
+constexpr auto evaluate(const E &expression) noexcept
+{
+    using Result = typename Kind::template result<decltype(expression.getX())>;
+    if constexpr (Kind::dimension == 3)
+    {
+        return Result{ expression.getX(), expression.getY(), expression.getZ() };
+    }
+    else
+    {
+        return Result{ expression.getX(), expression.getY() };
+    }
+}
+
+/*
+ * Coordinate wise addition. Both sides can have different types, the result
+ * has whatever type the implicit conversion gives.
+ */
+template <class L, class R, class Kind = CommonKind<L, R>>
+constexpr CoordinateSum<Kind, L, R> operator+(const L &left, const R &right) noexcept {
+    return CoordinateSum<Kind, L, R>{ left, right };
+}
+
+/*
+ * Coordinate wise subtraction, with the same conversions as the addition.
+ */
+template <class L, class R, class Kind = CommonKind<L, R>>
+constexpr CoordinateDifference<Kind, L, R> operator-(const L &left, const R &right) noexcept {
+    return CoordinateDifference<Kind, L, R>{ left, right };
+}
+
+/*
+ * Unary minus, swapping the signs of all coordinates.
+ */
+template <class E, class Kind = typename ExpressionKind<E>::type>
+constexpr CoordinateNegation<Kind, E> operator-(const E &expression) noexcept {
+    return CoordinateNegation<Kind, E>{ expression };
+}
+
+/*
+ * Product between an expression and a scalar s, on either side. The
+ * coordinates are multiplied by s.
+ */
+template <class E, class S, class Kind = typename ExpressionKind<E>::type,
+          class = std::enable_if_t<std::is_arithmetic<S>::value>>
+constexpr CoordinateScale<Kind, E, S> operator*(const E &expression, S s) noexcept {
+    return CoordinateScale<Kind, E, S>{ expression, s };
+}
+
+template <class E, class S, class Kind = typename ExpressionKind<E>::type,
+          class = std::enable_if_t<std::is_arithmetic<S>::value>>
+constexpr CoordinateScale<Kind, E, S> operator*(S s, const E &expression) noexcept {
+    return CoordinateScale<Kind, E, S>{ expression, s };
+}
+
+/*
+ * Equality when a side is an expression node: both sides are evaluated to
+ * their common coordinate type and compared as the Punto or Vector (2D or
+ * 3D) they give, tolerances included.
+ */
+template <class L, class R, class Kind = CommonKind<L, R>,
+          class = std::enable_if_t<IsCoordinateNode<L>::value || IsCoordinateNode<R>::value>>
+constexpr bool operator==(const L &left, const R &right) noexcept {
+    using Common = std::common_type_t<decltype(left.getX()), decltype(right.getX())>;
+    using Result = typename Kind::template result<Common>;
+    if constexpr (Kind::dimension == 3)
+    {
+        return Result(left.getX(), left.getY(), left.getZ()) == Result(right.getX(), right.getY(), right.getZ());
+    }
+    else
+    {
+        return Result(left.getX(), left.getY()) == Result(right.getX(), right.getY());
+    }
+}
+
+template <class E, class = std::enable_if_t<IsCoordinateNode<E>::value>>
+std::ostream& operator<<(std::ostream &out, const E &expression)
+{
+    out << evaluate(expression);
+    return out;
+}
+
+#endif //ELEM_GEOMETRICOS_COORDINATEEXPRESSION_H
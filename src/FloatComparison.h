@@ -7,15 +7,26 @@
 #ifndef ELEM_GEOMETRICOS_FLOATCOMPARISON_H
 #define ELEM_GEOMETRICOS_FLOATCOMPARISON_H
 
-#include<math.h>
+#include <algorithm>
+#include <math.h>
+
+/*
+ * Returns the absolute value of x. Unlike std::fabs it can be evaluated at
+ * compile time.
+ */
+template <class T>
+constexpr T magnitude(T x) noexcept
+{
+    return (x < 0) ? -x : x;
+}
 
 /*
  * Returns the distance between x and y
  */
 template <class T>
-T distance(T x, T y)
+constexpr T distance(T x, T y) noexcept
 {
-    return std::fabs(x-y);
+    return (x < y) ? y - x : x - y;
 }
 
 /*
@@ -25,7 +36,7 @@ T distance(T x, T y)
  * epsilon to the magnitude of the variables instead.
  */
 template <class T>
-bool withinEpsAbs(T x, T y, T absEpsilon)
+constexpr bool withinEpsAbs(T x, T y, T absEpsilon) noexcept
 {
     T d{distance(x,y)};
     return (d < absEpsilon);
@@ -38,10 +49,10 @@ bool withinEpsAbs(T x, T y, T absEpsilon)
  * Won't work properly when x and y are close to zero
  */
 template <class T>
-bool withinEpsRel(T x,T y, T relEpsilon)
+constexpr bool withinEpsRel(T x,T y, T relEpsilon) noexcept
 {
     T d{distance(x,y)};
-    return (d <= (std::max(std::fabs(x), std::fabs(y)) * relEpsilon));
+    return (d <= (std::max(magnitude(x), magnitude(y)) * relEpsilon));
 }
 
 /*
@@ -50,7 +61,7 @@ bool withinEpsRel(T x,T y, T relEpsilon)
  * method.
  */
 template <class T>
-bool withinEps(T x, T y, T absEpsilon, T relEpsilon)
+constexpr bool withinEps(T x, T y, T absEpsilon, T relEpsilon) noexcept
 {
     if (withinEpsAbs(x,y,absEpsilon))
     {
@@ -0,0 +1,428 @@
+//
+// Helpers to spread the batch algorithms of the library across threads. The
+// loops run on a shared pool of worker threads, each one with its own slab of
+// chunks to work through and free to steal chunks from the others once it
+// runs out.
+//
+
+#ifndef ELEM_GEOMETRICOS_PARALLEL_H
+#define ELEM_GEOMETRICOS_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Amount of threads the batch algorithms use when none is given: one per
+ * hardware thread.
+ */
+inline int defaultThreadCount()
+{
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+/*
+ * Amount of chunks a loop is cut in per thread. Having more chunks than
+ * threads lets the threads that finish early steal work from the slow ones.
+ */
+const int CHUNKS_PER_THREAD{ 8 };
+
+/*
+ * Chunks of more items than this are rounded up to a multiple of it, so
+ * chunks start on a multiple of it as well. Threads writing one result per
+ * item then write to different cache lines, even for one byte results.
+ */
+const int CHUNK_ALIGNMENT{ 64 };
+
+/*
+ * Pool of worker threads running the chunks of parallel loops. A loop for t
+ * threads gives each of its t slots a contiguous slab of chunks: the thread
+ * taking a slot works through its slab from the front and, when it's empty,
+ * steals chunks from the back of the other slabs. Contiguous slabs keep most
+ * of the memory each thread touches on its own NUMA node and in its own
+ * caches, and stealing from the back leaves alone the part the owner is
+ * about to reach.
+ *
+ * The thread calling run takes the first slot and then waits for the loop to
+ * finish, so loops may be nested: a chunk running in a worker can start a
+ * loop of its own. Workers are started as loops ask for them and live as long
+ * as the pool.
+ *
+ * When a chunk throws, no more chunks of its loop are started, and run throws
+ * the first exception once the chunks already running are done.
+ */
+class WorkStealingPool
+{
+public:
+    WorkStealingPool();
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /*
+     * The pool used by parallelFor and parallelForBalanced.
+     */
+    static WorkStealingPool& shared();
+
+    /*
+     * Amount of worker threads started so far.
+     */
+    int getWorkerCount();
+
+    /*
+     * Calls task(bounds[c], bounds[c+1]) for each of the chunks c, sharing
+     * them among up to threads threads, the calling one included. Returns
+     * once all of them are done, or throws what a chunk threw.
+     */
+    template <class Task>
+    void run(const int* bounds, int chunks, int threads, Task &task);
+
+private:
+    /*
+     * Chunks [front, back) of a slot, packed as front << 32 | back so the
+     * owner and the thieves can take them with one compare and swap. Slabs
+     * are kept in their own cache lines.
+     */
+    struct alignas(64) Slab
+    {
+        std::atomic<std::uint64_t> range;
+    };
+
+    struct Job
+    {
+        void (*invoke)(void*, int, int);
+        void* task;
+        const int* bounds;
+        int threads;
+        std::vector<Slab> slabs;
+        // slots taken so far, under the mutex of the pool
+        int joined;
+        // workers running chunks of the job, under its own mutex
+        int inside;
+        std::mutex mutex;
+        std::condition_variable done;
+        // the first exception thrown by a chunk, under the mutex of the job
+        std::exception_ptr error;
+        std::atomic<bool> failed;
+    };
+
+    static int takeFront(Slab &slab);
+    static int takeBack(Slab &slab);
+    static void runChunks(Job &job, int slot);
+
+    void start(int workers);
+    void work();
+    void finish(Job &job);
+
+    std::vector<std::thread> m_workers;
+    std::vector<Job*> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop;
+};
+
+inline WorkStealingPool::WorkStealingPool() : m_stop{ false }
+{
+}
+
+inline WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for(std::thread &worker: m_workers)
+    {
+        worker.join();
+    }
+}
+
+inline WorkStealingPool &WorkStealingPool::shared() {
+    static WorkStealingPool pool;
+    return pool;
+}
+
+inline int WorkStealingPool::getWorkerCount() {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    return static_cast<int>(m_workers.size());
+}
+
+template <class Task>
+void WorkStealingPool::run(const int* bounds, int chunks, int threads, Task &task) {
+    threads = std::max(1, std::min(threads, chunks));
+    if (threads == 1)
+    {
+        for(int c{}; c < chunks; ++c)
+        {
+            task(bounds[c], bounds[c + 1]);
+        }
+        return;
+    }
+    // the calling thread takes one of the slots
+    start(threads - 1);
+
+    Job job;
+    job.invoke = [](void* erased, int begin, int end) { (*static_cast<Task*>(erased))(begin, end); };
+    job.task = &task;
+    job.bounds = bounds;
+    job.threads = threads;
+    job.slabs = std::vector<Slab>(static_cast<std::size_t>(threads));
+    for(int s{}; s < threads; ++s)
+    {
+        auto front{ static_cast<std::uint64_t>(static_cast<long>(chunks) * s / threads) };
+        auto back{ static_cast<std::uint64_t>(static_cast<long>(chunks) * (s + 1) / threads) };
+        job.slabs[s].range.store(front << 32 | back, std::memory_order_relaxed);
+    }
+    job.joined = 1;
+    job.inside = 0;
+    job.failed.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        m_jobs.push_back(&job);
+    }
+    m_wake.notify_all();
+
+    // chunks don't let exceptions out, so the job is always finished
+    // before it goes out of scope
+    runChunks(job, 0);
+    finish(job);
+    if (job.error)
+    {
+        std::rethrow_exception(job.error);
+    }
+}
+
+inline int WorkStealingPool::takeFront(Slab &slab) {
+    std::uint64_t range{ slab.range.load(std::memory_order_relaxed) };
+    while (true)
+    {
+        std::uint64_t front{ range >> 32 };
+        std::uint64_t back{ range & 0xffffffffu };
+        if (front >= back)
+        {
+            return -1;
+        }
+        if (slab.range.compare_exchange_weak(range, (front + 1) << 32 | back, std::memory_order_acq_rel))
+        {
+            return static_cast<int>(front);
+        }
+    }
+}
+
+inline int WorkStealingPool::takeBack(Slab &slab) {
+    std::uint64_t range{ slab.range.load(std::memory_order_relaxed) };
+    while (true)
+    {
+        std::uint64_t front{ range >> 32 };
+        std::uint64_t back{ range & 0xffffffffu };
+        if (front >= back)
+        {
+            return -1;
+        }
+        if (slab.range.compare_exchange_weak(range, front << 32 | (back - 1), std::memory_order_acq_rel))
+        {
+            return static_cast<int>(back - 1);
+        }
+    }
+}
+
+inline void WorkStealingPool::runChunks(Job &job, int slot) {
+    while (!job.failed.load(std::memory_order_relaxed))
+    {
+        int chunk{ takeFront(job.slabs[slot]) };
+        // the victims are tried starting from the next slot, whose slab
+        // follows this one in memory
+        for(int k{ 1 }; chunk < 0 && k < job.threads; ++k)
+        {
+            chunk = takeBack(job.slabs[(slot + k) % job.threads]);
+        }
+        if (chunk < 0)
+        {
+            return;
+        }
+        try
+        {
+            job.invoke(job.task, job.bounds[chunk], job.bounds[chunk + 1]);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock{ job.mutex };
+            if (!job.error)
+            {
+                job.error = std::current_exception();
+            }
+            job.failed.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+inline void WorkStealingPool::start(int workers) {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    while (static_cast<int>(m_workers.size()) < workers)
+    {
+        m_workers.emplace_back(&WorkStealingPool::work, this);
+    }
+}
+
+inline void WorkStealingPool::work() {
+    std::unique_lock<std::mutex> lock{ m_mutex };
+    while (true)
+    {
+        Job* job{ nullptr };
+        for(Job* open: m_jobs)
+        {
+            if (open->joined < open->threads)
+            {
+                job = open;
+                break;
+            }
+        }
+        if (job == nullptr)
+        {
+            if (m_stop)
+            {
+                return;
+            }
+            m_wake.wait(lock);
+            continue;
+        }
+
+        // joining under the mutex of the pool, the job can't be finished
+        // before this worker is counted in
+        int slot{ job->joined++ };
+        {
+            std::lock_guard<std::mutex> jobLock{ job->mutex };
+            ++job->inside;
+        }
+        lock.unlock();
+        runChunks(*job, slot);
+        {
+            // the job may be gone as soon as the mutex is released
+            std::lock_guard<std::mutex> jobLock{ job->mutex };
+            --job->inside;
+            job->done.notify_all();
+        }
+        lock.lock();
+    }
+}
+
+inline void WorkStealingPool::finish(Job &job) {
+    // every chunk was taken, or none will be after a failure, so once no
+    // worker can join the job it's enough to wait for the ones inside
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        m_jobs.erase(std::find(m_jobs.begin(), m_jobs.end(), &job));
+    }
+    std::unique_lock<std::mutex> jobLock{ job.mutex };
+    job.done.wait(jobLock, [&job] { return job.inside == 0; });
+}
+
+/*
+ * Returns the bounds of the chunks [0, count) is cut in for a loop on
+ * threads threads, see CHUNKS_PER_THREAD and CHUNK_ALIGNMENT. Chunk c is
+ * [bounds[c], bounds[c+1]).
+ */
+inline std::vector<int> chunkBounds(int count, int threads)
+{
+    long target{ static_cast<long>(threads) * CHUNKS_PER_THREAD };
+    auto size{ static_cast<int>((count + target - 1) / target) };
+    if (size > CHUNK_ALIGNMENT)
+    {
+        size = (size + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT;
+    }
+    std::vector<int> bounds;
+    bounds.reserve(static_cast<std::size_t>((count + size - 1) / size) + 1);
+    for(long begin{}; begin < count; begin += size)
+    {
+        bounds.push_back(static_cast<int>(begin));
+    }
+    bounds.push_back(count);
+    return bounds;
+}
+
+/*
+ * Splits the items [0, count) in contiguous ranges of about the same weight
+ * and calls task(begin, end) for each range, on up to threads threads of the
+ * shared pool. The weights are given by their prefix sums: item i weighs
+ * prefix[i+1] - prefix[i], so prefix must have count+1 elements. When
+ * threads is 0 defaultThreadCount() threads are used, and work lighter than
+ * minWeight per thread is not worth a thread at all. Each thread gets about
+ * CHUNKS_PER_THREAD ranges, so task must not assume there is one per thread.
+ * An exception thrown by task stops the loop and is thrown again here.
+ */
+template <class Task>
+void parallelForBalanced(const int* prefix, int count, Task task,
+                         int threads = 0, int minWeight = 1 << 15)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    if (threads <= 0)
+    {
+        threads = defaultThreadCount();
+    }
+    long total{ static_cast<long>(prefix[count]) - prefix[0] };
+    threads = static_cast<int>(std::min<long>(threads, std::max<long>(1, total / minWeight)));
+    threads = std::min(threads, count);
+    if (threads == 1)
+    {
+        task(0, count);
+        return;
+    }
+
+    // chunk c starts at the first item whose prefix reaches c/chunks of the
+    // total weight, and empty chunks are dropped
+    int chunks{ std::min(count, threads * CHUNKS_PER_THREAD) };
+    std::vector<int> bounds;
+    bounds.reserve(static_cast<std::size_t>(chunks) + 1);
+    bounds.push_back(0);
+    for(int c{ 1 }; c < chunks; ++c)
+    {
+        long target{ prefix[0] + total * c / chunks };
+        auto bound{ static_cast<int>(std::lower_bound(prefix, prefix + count, target) - prefix) };
+        if (bound > bounds.back())
+        {
+            bounds.push_back(bound);
+        }
+    }
+    bounds.push_back(count);
+    WorkStealingPool::shared().run(bounds.data(), static_cast<int>(bounds.size()) - 1, threads, task);
+}
+
+/*
+ * Splits the items [0, count) in contiguous ranges of about the same amount
+ * of items and calls task(begin, end) for each range, on up to threads
+ * threads of the shared pool. Each thread gets at least minCount items, cut
+ * in about CHUNKS_PER_THREAD ranges. As above, exceptions thrown by task are
+ * thrown again here.
+ */
+template <class Task>
+void parallelFor(int count, Task task, int threads = 0, int minCount = 1 << 15)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    if (threads <= 0)
+    {
+        threads = defaultThreadCount();
+    }
+    threads = std::max(1, std::min(threads, count / std::max(1, minCount)));
+    if (threads == 1)
+    {
+        task(0, count);
+        return;
+    }
+
+    std::vector<int> bounds{ chunkBounds(count, threads) };
+    WorkStealingPool::shared().run(bounds.data(), static_cast<int>(bounds.size()) - 1, threads, task);
+}
+
+#endif //ELEM_GEOMETRICOS_PARALLEL_H
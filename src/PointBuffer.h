@@ -0,0 +1,320 @@
+//
+// Structure of arrays storage for large amounts of points.
+//
+
+#ifndef ELEM_GEOMETRICOS_POINTBUFFER_H
+#define ELEM_GEOMETRICOS_POINTBUFFER_H
+
+#include "Punto.h"
+#include "Vector.h"
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <vector>
+
+/*
+ * Allocator returning memory aligned to Alignment bytes, by default a cache
+ * line, which is also enough for any SSE or AVX load.
+ */
+template <class T, std::size_t Alignment = 64>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <class S>
+    struct rebind { using other = AlignedAllocator<S, Alignment>; };
+
+    AlignedAllocator() = default;
+
+    template <class S>
+    AlignedAllocator(const AlignedAllocator<S, Alignment>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ Alignment }));
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        ::operator delete(p, std::align_val_t{ Alignment });
+    }
+};
+
+template <class T, class S, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<S, Alignment>&) { return true; }
+
+template <class T, class S, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<S, Alignment>&) { return false; }
+
+/*
+ * Class for storing many points. Instead of an array of Punto, where the X and
+ * Y coordinates are interleaved, the X coordinates of all points are stored
+ * in one aligned array and the Y coordinates in another, so the bulk
+ * operations below and the batch kernels of the library can process several
+ * points per instruction.
+ */
+template <class T>
+class PointBuffer
+{
+private:
+    std::vector<T, AlignedAllocator<T>> m_x;
+    std::vector<T, AlignedAllocator<T>> m_y;
+
+public:
+    /*
+     * Creates a buffer holding length points at the origin.
+     */
+    explicit PointBuffer(int length = 0)
+            : m_x(static_cast<std::size_t>(length)), m_y(static_cast<std::size_t>(length))
+    {};
+
+    /*
+     * Creates a buffer with a copy of the count points of the given array.
+     */
+    PointBuffer(const Punto<T>* puntos, int count)
+            : PointBuffer(puntos, puntos + count)
+    {};
+
+    /*
+     * Creates a buffer with a copy of the points of the range [first, last).
+     * The range must hold Punto of the same type as the buffer.
+     */
+    template <class InputIt>
+    PointBuffer(InputIt first, InputIt last)
+    {
+        for(; first != last; ++first)
+        {
+            push_back(*first);
+        }
+    };
+
+    /*
+     * Creates a buffer given a list of points Punto.
+     */
+    PointBuffer(std::initializer_list<Punto<T>> puntos)
+            : PointBuffer(puntos.begin(), puntos.end())
+    {};
+
+    /*
+     * Returns the amount of points in the buffer.
+     */
+    int getLength() const { return static_cast<int>(m_x.size()); }
+
+    /*
+     * Returns the array of X coordinates. It's aligned to 64 bytes.
+     */
+    T* getXs() { return m_x.data(); }
+    const T* getXs() const { return m_x.data(); }
+
+    /*
+     * Returns the array of Y coordinates. It's aligned to 64 bytes.
+     */
+    T* getYs() { return m_y.data(); }
+    const T* getYs() const { return m_y.data(); }
+
+    /*
+     * Returns a copy of the point at the position given by index.
+     */
+    Punto<T> operator[] (int index) const { return Punto<T>{ m_x[index], m_y[index] }; }
+
+    /*
+     * Replaces the point at the position given by index.
+     */
+    void set(int index, const Punto<T> &p);
+
+    /*
+     * Appends a point at the end of the buffer.
+     */
+    void push_back(const Punto<T> &p);
+
+    /*
+     * Reserves room for capacity points, so that many push_back calls
+     * don't need to reallocate.
+     */
+    void reserve(int capacity);
+
+    /*
+     * Changes the amount of points in the buffer. New points are placed at the
+     * origin.
+     */
+    void resize(int length);
+
+    /*
+     * Removes every point from the buffer.
+     */
+    void clear();
+
+    /*
+     * Writes every point of the buffer as a Punto through the output iterator
+     * out, in order. Returns the iterator past the last written point.
+     */
+    template <class OutputIt>
+    OutputIt toPuntos(OutputIt out) const;
+
+    /*
+     * Returns a vector with a Punto for every point of the buffer.
+     */
+    std::vector<Punto<T>> toVector() const;
+
+    /*
+     * Moves every point by the vector v.
+     */
+    PointBuffer<T>& translate(const Vector<T> &v);
+
+    /*
+     * Multiplies the coordinates of every point by s.
+     */
+    PointBuffer<T>& scale(T s);
+
+    /*
+     * Swaps the sign of the coordinates of every point.
+     */
+    PointBuffer<T>& negate();
+
+    /*
+     * Adds to each point the point at the same position of other. Both
+     * buffers must have the same length.
+     */
+    PointBuffer<T>& add(const PointBuffer<T> &other);
+};
+
+template<class T>
+void PointBuffer<T>::set(int index, const Punto<T> &p) {
+    m_x[index] = p.getX();
+    m_y[index] = p.getY();
+}
+
+template<class T>
+void PointBuffer<T>::push_back(const Punto<T> &p) {
+    m_x.push_back(p.getX());
+    m_y.push_back(p.getY());
+}
+
+template<class T>
+void PointBuffer<T>::reserve(int capacity) {
+    m_x.reserve(static_cast<std::size_t>(capacity));
+    m_y.reserve(static_cast<std::size_t>(capacity));
+}
+
+template<class T>
+void PointBuffer<T>::resize(int length) {
+    m_x.resize(static_cast<std::size_t>(length));
+    m_y.resize(static_cast<std::size_t>(length));
+}
+
+template<class T>
+void PointBuffer<T>::clear() {
+    m_x.clear();
+    m_y.clear();
+}
+
+template<class T>
+template<class OutputIt>
+OutputIt PointBuffer<T>::toPuntos(OutputIt out) const {
+    int length{ getLength() };
+    for(int i{}; i < length; ++i)
+    {
+        *out = Punto<T>{ m_x[i], m_y[i] };
+        ++out;
+    }
+    return out;
+}
+
+template<class T>
+std::vector<Punto<T>> PointBuffer<T>::toVector() const {
+    std::vector<Punto<T>> puntos;
+    puntos.reserve(m_x.size());
+    toPuntos(std::back_inserter(puntos));
+    return puntos;
+}
+
+// the bulk operations work on raw pointers with the length in a local so the
+// compiler sees independent, contiguous loops it can vectorize
+
+template<class T>
+PointBuffer<T>& PointBuffer<T>::translate(const Vector<T> &v) {
+    T* xs{ m_x.data() };
+    T* ys{ m_y.data() };
+    const T dx{ v.getX() };
+    const T dy{ v.getY() };
+    const int length{ getLength() };
+    for(int i{}; i < length; ++i)
+    {
+        xs[i] += dx;
+    }
+    for(int i{}; i < length; ++i)
+    {
+        ys[i] += dy;
+    }
+    return *this;
+}
+
+template<class T>
+PointBuffer<T>& PointBuffer<T>::scale(T s) {
+    T* xs{ m_x.data() };
+    T* ys{ m_y.data() };
+    const int length{ getLength() };
+    for(int i{}; i < length; ++i)
+    {
+        xs[i] *= s;
+    }
+    for(int i{}; i < length; ++i)
+    {
+        ys[i] *= s;
+    }
+    return *this;
+}
+
+template<class T>
+PointBuffer<T>& PointBuffer<T>::negate() {
+    T* xs{ m_x.data() };
+    T* ys{ m_y.data() };
+    const int length{ getLength() };
+    for(int i{}; i < length; ++i)
+    {
+        xs[i] = -xs[i];
+    }
+    for(int i{}; i < length; ++i)
+    {
+        ys[i] = -ys[i];
+    }
+    return *this;
+}
+
+template<class T>
+PointBuffer<T>& PointBuffer<T>::add(const PointBuffer<T> &other) {
+    T* xs{ m_x.data() };
+    T* ys{ m_y.data() };
+    const T* otherXs{ other.getXs() };
+    const T* otherYs{ other.getYs() };
+    const int length{ getLength() };
+    for(int i{}; i < length; ++i)
+    {
+        xs[i] += otherXs[i];
+    }
+    for(int i{}; i < length; ++i)
+    {
+        ys[i] += otherYs[i];
+    }
+    return *this;
+}
+
+template <class T>
+std::ostream& operator<<(std::ostream &out, const PointBuffer<T> &buffer)
+{
+    out << "[";
+    for(int i{}; i < buffer.getLength(); ++i)
+    {
+        out << buffer[i];
+        if (i != (buffer.getLength()-1))
+        {
+            out << ", ";
+        }
+    }
+    out << "]";
+    return out;
+}
+
+#endif //ELEM_GEOMETRICOS_POINTBUFFER_H
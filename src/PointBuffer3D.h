@@ -0,0 +1,279 @@
+//
+// Structure of arrays storage for large amounts of 3D points, such as
+// terrain samples or LiDAR returns.
+//
+
+#ifndef ELEM_GEOMETRICOS_POINTBUFFER3D_H
+#define ELEM_GEOMETRICOS_POINTBUFFER3D_H
+
+#include "Batch3D.h"
+#include "BatchOrientation.h"
+#include "PointBuffer.h"
+#include "Punto.h"
+#include "Vector.h"
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+/*
+ * Class for storing many 3D points, the X, Y and Z coordinates each in their
+ * own aligned array as in PointBuffer. Besides the bulk operations it runs
+ * the kernels of Batch3D.h over all of its points, taking each one as a point
+ * or as the vector from the origin to it.
+ */
+template <class T>
+class PointBuffer3D
+{
+private:
+    std::vector<T, AlignedAllocator<T>> m_x;
+    std::vector<T, AlignedAllocator<T>> m_y;
+    std::vector<T, AlignedAllocator<T>> m_z;
+
+public:
+    /*
+     * Creates a buffer holding length points at the origin.
+     */
+    explicit PointBuffer3D(int length = 0)
+            : m_x(static_cast<std::size_t>(length)), m_y(static_cast<std::size_t>(length)),
+              m_z(static_cast<std::size_t>(length))
+    {};
+
+    /*
+     * Creates a buffer with a copy of the count points of the given array.
+     */
+    PointBuffer3D(const Punto3D<T>* puntos, int count)
+            : PointBuffer3D(puntos, puntos + count)
+    {};
+
+    /*
+     * Creates a buffer with a copy of the points of the range [first, last).
+     * The range must hold Punto3D of the same type as the buffer.
+     */
+    template <class InputIt>
+    PointBuffer3D(InputIt first, InputIt last)
+    {
+        for(; first != last; ++first)
+        {
+            push_back(*first);
+        }
+    };
+
+    /*
+     * Creates a buffer given a list of points Punto3D.
+     */
+    PointBuffer3D(std::initializer_list<Punto3D<T>> puntos)
+            : PointBuffer3D(puntos.begin(), puntos.end())
+    {};
+
+    /*
+     * Returns the amount of points in the buffer.
+     */
+    int getLength() const { return static_cast<int>(m_x.size()); }
+
+    /*
+     * Returns the arrays of X, Y and Z coordinates, aligned to 64 bytes.
+     */
+    T* getXs() { return m_x.data(); }
+    const T* getXs() const { return m_x.data(); }
+    T* getYs() { return m_y.data(); }
+    const T* getYs() const { return m_y.data(); }
+    T* getZs() { return m_z.data(); }
+    const T* getZs() const { return m_z.data(); }
+
+    /*
+     * Returns a copy of the point at the position given by index.
+     */
+    Punto3D<T> operator[] (int index) const { return Punto3D<T>{ m_x[index], m_y[index], m_z[index] }; }
+
+    /*
+     * Replaces the point at the position given by index.
+     */
+    void set(int index, const Punto3D<T> &p);
+
+    /*
+     * Appends a point at the end of the buffer.
+     */
+    void push_back(const Punto3D<T> &p);
+
+    /*
+     * Reserves room for capacity points, so that many push_back calls
+     * don't need to reallocate.
+     */
+    void reserve(int capacity);
+
+    /*
+     * Changes the amount of points in the buffer. New points are placed at the
+     * origin.
+     */
+    void resize(int length);
+
+    /*
+     * Removes every point from the buffer.
+     */
+    void clear();
+
+    /*
+     * Returns a vector with a Punto3D for every point of the buffer.
+     */
+    std::vector<Punto3D<T>> toVector() const;
+
+    /*
+     * Moves every point by the vector v.
+     */
+    PointBuffer3D<T>& translate(const Vector3D<T> &v);
+
+    /*
+     * Multiplies the coordinates of every point by s.
+     */
+    PointBuffer3D<T>& scale(T s);
+
+    /*
+     * Stores in out[i] the euclidean norm of the vector to point i, as
+     * Vector3D::euclideanNorm.
+     */
+    void norms(double* out) const;
+
+    /*
+     * Stores in out[i] the dot product of v and the vector to point i, as
+     * dotProduct.
+     */
+    void dotProducts(const Vector3D<T> &v, OrientationType<T>* out) const;
+
+    /*
+     * Stores in out[i] the side of the plane through p, q and r where point i
+     * lies: ABOVE when orient3d(p, q, r, point) is positive. Floating point
+     * values within the tolerance of Segmento::isPointInLine are ON the
+     * plane, integer ones are exact.
+     */
+    void planeSides(const Punto3D<T> &p, const Punto3D<T> &q, const Punto3D<T> &r, PlaneSide* out) const;
+};
+
+template<class T>
+void PointBuffer3D<T>::set(int index, const Punto3D<T> &p) {
+    m_x[index] = p.getX();
+    m_y[index] = p.getY();
+    m_z[index] = p.getZ();
+}
+
+template<class T>
+void PointBuffer3D<T>::push_back(const Punto3D<T> &p) {
+    m_x.push_back(p.getX());
+    m_y.push_back(p.getY());
+    m_z.push_back(p.getZ());
+}
+
+template<class T>
+void PointBuffer3D<T>::reserve(int capacity) {
+    m_x.reserve(static_cast<std::size_t>(capacity));
+    m_y.reserve(static_cast<std::size_t>(capacity));
+    m_z.reserve(static_cast<std::size_t>(capacity));
+}
+
+template<class T>
+void PointBuffer3D<T>::resize(int length) {
+    m_x.resize(static_cast<std::size_t>(length));
+    m_y.resize(static_cast<std::size_t>(length));
+    m_z.resize(static_cast<std::size_t>(length));
+}
+
+template<class T>
+void PointBuffer3D<T>::clear() {
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+}
+
+template<class T>
+std::vector<Punto3D<T>> PointBuffer3D<T>::toVector() const {
+    std::vector<Punto3D<T>> puntos;
+    puntos.reserve(m_x.size());
+    for(int i{}; i < getLength(); ++i)
+    {
+        puntos.push_back((*this)[i]);
+    }
+    return puntos;
+}
+
+// like in PointBuffer, each coordinate gets its own loop so the compiler
+// vectorizes them
+
+template<class T>
+PointBuffer3D<T>& PointBuffer3D<T>::translate(const Vector3D<T> &v) {
+    T* xs{ m_x.data() };
+    T* ys{ m_y.data() };
+    T* zs{ m_z.data() };
+    const T dx{ v.getX() };
+    const T dy{ v.getY() };
+    const T dz{ v.getZ() };
+    const int length{ getLength() };
+    for(int i{}; i < length; ++i)
+    {
+        xs[i] += dx;
+    }
+    for(int i{}; i < length; ++i)
+    {
+        ys[i] += dy;
+    }
+    for(int i{}; i < length; ++i)
+    {
+        zs[i] += dz;
+    }
+    return *this;
+}
+
+template<class T>
+PointBuffer3D<T>& PointBuffer3D<T>::scale(T s) {
+    T* xs{ m_x.data() };
+    T* ys{ m_y.data() };
+    T* zs{ m_z.data() };
+    const int length{ getLength() };
+    for(int i{}; i < length; ++i)
+    {
+        xs[i] *= s;
+    }
+    for(int i{}; i < length; ++i)
+    {
+        ys[i] *= s;
+    }
+    for(int i{}; i < length; ++i)
+    {
+        zs[i] *= s;
+    }
+    return *this;
+}
+
+template<class T>
+void PointBuffer3D<T>::norms(double* out) const {
+    batchNorm(m_x.data(), m_y.data(), m_z.data(), getLength(), out);
+}
+
+template<class T>
+void PointBuffer3D<T>::dotProducts(const Vector3D<T> &v, OrientationType<T>* out) const {
+    batchDotProduct(v.getX(), v.getY(), v.getZ(), m_x.data(), m_y.data(), m_z.data(), getLength(), out);
+}
+
+template<class T>
+void PointBuffer3D<T>::planeSides(const Punto3D<T> &p, const Punto3D<T> &q, const Punto3D<T> &r,
+                                  PlaneSide* out) const {
+    batchPlaneSide(planeThrough(p, q, r), LineTolerance<T>::value, m_x.data(), m_y.data(), m_z.data(),
+                   getLength(), out);
+}
+
+template <class T>
+std::ostream& operator<<(std::ostream &out, const PointBuffer3D<T> &buffer)
+{
+    out << "[";
+    for(int i{}; i < buffer.getLength(); ++i)
+    {
+        out << buffer[i];
+        if (i != (buffer.getLength()-1))
+        {
+            out << ", ";
+        }
+    }
+    out << "]";
+    return out;
+}
+
+#endif //ELEM_GEOMETRICOS_POINTBUFFER3D_H
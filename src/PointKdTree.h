@@ -0,0 +1,415 @@
+//
+// Static k-d tree over a set of points, for snapping points to the nearest
+// of a set of reference points and for finding the points around a place.
+//
+
+#ifndef ELEM_GEOMETRICOS_POINTKDTREE_H
+#define ELEM_GEOMETRICOS_POINTKDTREE_H
+
+#include "Punto.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+/*
+ * Most points a range of the tree holds without being split any further.
+ * Searches go through them one after the other.
+ */
+const int KDTREE_LEAF_SIZE{ 8 };
+
+/*
+ * Room for the ranges pending in a search: every split leaves at most one
+ * range behind, and a tree of up to 2^31 points has less than 32 levels.
+ */
+const int KDTREE_STACK_SIZE{ 64 };
+
+/*
+ * Balanced k-d tree over a copy of a set of points, splitting alternately by
+ * X and by Y. The points are stored reordered so that every node is the
+ * median of a range of the array: the node of range [begin, end) is at
+ * mid = begin + (end-begin)/2, and its children are the ranges [begin, mid)
+ * and [mid+1, end). Ranges of up to KDTREE_LEAF_SIZE points are leaves.
+ * Nodes are found from the bounds of their range alone, so the tree takes
+ * no more memory than the points and their original indices, and the points
+ * of every subtree are contiguous.
+ * Building takes O(n log n): the medians of each level are found with
+ * nth_element, the ranges of a level on several threads. Distances are
+ * computed in double, as in BoundingBox::distance2, and queries answer with
+ * the positions the points had in the array the tree was built from. Equal
+ * distances are broken by the smaller position.
+ */
+template <class T>
+class PointKdTree
+{
+private:
+    // the points in tree order and where each one was given
+    std::vector<Punto<T>> m_points;
+    std::vector<int> m_ids;
+
+    /*
+     * Point found by a search, ordered by distance and then by position.
+     */
+    struct Candidate
+    {
+        double distance2;
+        int id;
+
+        bool operator<(const Candidate &other) const
+        {
+            return distance2 < other.distance2 || (distance2 == other.distance2 && id < other.id);
+        }
+    };
+
+    /*
+     * Sets m_ids to the tree order of the count given points, on up to
+     * threads threads.
+     */
+    void build(const Punto<T>* puntos, int count, int threads);
+
+    /*
+     * Calls visit(position, distance2) for the points of the tree at a
+     * squared distance of up to limit2 from p, nearest ranges first. visit
+     * may lower limit2 to skip the ranges that can't hold a better point.
+     */
+    template <class Visit>
+    void search(const Punto<T> &p, double &limit2, Visit visit) const;
+
+    /*
+     * Leaves in heap the k points nearest to p, or all of them when there
+     * are less, nearest first. Returns how many were found.
+     */
+    int nearestCandidates(const Punto<T> &p, int k, Candidate* heap) const;
+
+public:
+    /*
+     * Builds the tree over a copy of the count given points, on up to threads
+     * threads. When threads is 0 one per hardware thread is used.
+     */
+    PointKdTree(const Punto<T>* puntos, int count, int threads = 0);
+
+    PointKdTree(const PointKdTree&) = delete;
+    PointKdTree& operator=(const PointKdTree&) = delete;
+    PointKdTree(PointKdTree&&) noexcept = default;
+    PointKdTree& operator=(PointKdTree&&) noexcept = default;
+
+    /*
+     * Returns the amount of points indexed.
+     */
+    int getLength() const { return static_cast<int>(m_points.size()); }
+
+    /*
+     * Returns the position of the point nearest to p, or -1 when the tree
+     * is empty.
+     */
+    int nearest(const Punto<T> &p) const;
+
+    /*
+     * Appends to out the positions of the k points nearest to p, nearest
+     * first. All of them are appended when there are less than k.
+     */
+    void nearest(const Punto<T> &p, int k, std::vector<int> &out) const;
+
+    /*
+     * Appends to out the positions of the points at a distance of up to
+     * radius from p, in no particular order.
+     */
+    void withinRadius(const Punto<T> &p, double radius, std::vector<int> &out) const;
+
+    /*
+     * Stores in out[i] nearest(puntos[i]) for the count given points,
+     * splitting them across threads. When threads is 0 one per hardware
+     * thread is used.
+     */
+    void nearestAll(const Punto<T>* puntos, int count, int* out, int threads = 0) const;
+
+    /*
+     * Stores in out[i*k] to out[i*k+k-1] the positions of the k points
+     * nearest to puntos[i], nearest first, for the count given points. The
+     * places left when the tree has less than k points are set to -1.
+     */
+    void nearestAll(const Punto<T>* puntos, int count, int k, int* out, int threads = 0) const;
+
+    /*
+     * Finds withinRadius(puntos[i], radius) for the count given points. The
+     * positions found for point i are left in ids, from offsets[i] to
+     * offsets[i+1], as in PolygonSet.
+     */
+    void withinRadiusAll(const Punto<T>* puntos, int count, double radius, std::vector<int> &offsets,
+                         std::vector<int> &ids, int threads = 0) const;
+};
+
+template<class T>
+PointKdTree<T>::PointKdTree(const Punto<T>* puntos, int count, int threads)
+        : m_points(static_cast<std::size_t>(count)), m_ids(static_cast<std::size_t>(count))
+{
+    build(puntos, count, threads);
+    Punto<T>* points{ m_points.data() };
+    const int* ids{ m_ids.data() };
+    parallelFor(count, [=](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            points[i] = puntos[ids[i]];
+        }
+    }, threads);
+}
+
+template<class T>
+void PointKdTree<T>::build(const Punto<T>* puntos, int count, int threads) {
+    int* ids{ m_ids.data() };
+    for(int i{}; i < count; ++i)
+    {
+        ids[i] = i;
+    }
+    // the ranges of a level differ in at most one point, so the largest one
+    // halves from each level to the next
+    int level{ };
+    for(int largest{ count }; largest > KDTREE_LEAF_SIZE; largest /= 2, ++level)
+    {
+        int minNodes{ std::max(1, (1 << 15) / largest) };
+        parallelFor(1 << level, [=](int first, int last) {
+            auto byX{ [=](int a, int b) { return puntos[a].getX() < puntos[b].getX(); } };
+            auto byY{ [=](int a, int b) { return puntos[a].getY() < puntos[b].getY(); } };
+            for(int node{ first }; node < last; ++node)
+            {
+                // the bits of node tell the way down from the root
+                int begin{ };
+                int end{ count };
+                for(int bit{ level - 1 }; bit >= 0; --bit)
+                {
+                    int mid{ begin + (end - begin) / 2 };
+                    if ((node >> bit) & 1)
+                    {
+                        begin = mid + 1;
+                    }
+                    else
+                    {
+                        end = mid;
+                    }
+                }
+                if (end - begin <= KDTREE_LEAF_SIZE)
+                {
+                    continue;
+                }
+                int* mid{ ids + begin + (end - begin) / 2 };
+                if (level % 2 == 0)
+                {
+                    std::nth_element(ids + begin, mid, ids + end, byX);
+                }
+                else
+                {
+                    std::nth_element(ids + begin, mid, ids + end, byY);
+                }
+            }
+        }, threads, minNodes);
+    }
+}
+
+template<class T>
+template<class Visit>
+void PointKdTree<T>::search(const Punto<T> &p, double &limit2, Visit visit) const {
+    if (m_points.empty())
+    {
+        return;
+    }
+    // pending ranges with their depth and the least squared distance from p
+    // to any of their points
+    struct Range
+    {
+        int begin;
+        int end;
+        int depth;
+        double distance2;
+    };
+    Range stack[KDTREE_STACK_SIZE];
+    stack[0] = Range{ 0, getLength(), 0, 0.0 };
+    int top{ 1 };
+    const Punto<T>* points{ m_points.data() };
+    double x{ static_cast<double>(p.getX()) };
+    double y{ static_cast<double>(p.getY()) };
+    while (top > 0)
+    {
+        Range range{ stack[--top] };
+        if (range.distance2 > limit2)
+        {
+            continue;
+        }
+        if (range.end - range.begin <= KDTREE_LEAF_SIZE)
+        {
+            for(int i{ range.begin }; i < range.end; ++i)
+            {
+                double dx{ static_cast<double>(points[i].getX()) - x };
+                double dy{ static_cast<double>(points[i].getY()) - y };
+                double distance2{ dx * dx + dy * dy };
+                if (distance2 <= limit2)
+                {
+                    visit(i, distance2);
+                }
+            }
+            continue;
+        }
+        int mid{ range.begin + (range.end - range.begin) / 2 };
+        double dx{ static_cast<double>(points[mid].getX()) - x };
+        double dy{ static_cast<double>(points[mid].getY()) - y };
+        double distance2{ dx * dx + dy * dy };
+        if (distance2 <= limit2)
+        {
+            visit(mid, distance2);
+        }
+        // the side of p is searched first, the other one is as far as the
+        // splitting line
+        double split{ (range.depth % 2 == 0) ? -dx : -dy };
+        Range left{ range.begin, mid, range.depth + 1, range.distance2 };
+        Range right{ mid + 1, range.end, range.depth + 1, range.distance2 };
+        if (split < 0)
+        {
+            right.distance2 = std::max(range.distance2, split * split);
+            stack[top++] = right;
+            stack[top++] = left;
+        }
+        else
+        {
+            left.distance2 = std::max(range.distance2, split * split);
+            stack[top++] = left;
+            stack[top++] = right;
+        }
+    }
+}
+
+template<class T>
+int PointKdTree<T>::nearest(const Punto<T> &p) const {
+    Candidate best{ std::numeric_limits<double>::infinity(), -1 };
+    double limit2{ best.distance2 };
+    search(p, limit2, [&](int position, double distance2) {
+        Candidate candidate{ distance2, m_ids[position] };
+        if (candidate < best)
+        {
+            best = candidate;
+            limit2 = distance2;
+        }
+    });
+    return best.id;
+}
+
+template<class T>
+int PointKdTree<T>::nearestCandidates(const Punto<T> &p, int k, Candidate* heap) const {
+    k = std::min(k, getLength());
+    if (k <= 0)
+    {
+        return 0;
+    }
+    // max heap of the k best so far, the worst of them on top
+    int found{ };
+    double limit2{ std::numeric_limits<double>::infinity() };
+    search(p, limit2, [&](int position, double distance2) {
+        Candidate candidate{ distance2, m_ids[position] };
+        if (found < k)
+        {
+            heap[found++] = candidate;
+            std::push_heap(heap, heap + found);
+        }
+        else if (candidate < heap[0])
+        {
+            std::pop_heap(heap, heap + k);
+            heap[k - 1] = candidate;
+            std::push_heap(heap, heap + k);
+        }
+        if (found == k)
+        {
+            limit2 = heap[0].distance2;
+        }
+    });
+    std::sort_heap(heap, heap + found);
+    return found;
+}
+
+template<class T>
+void PointKdTree<T>::nearest(const Punto<T> &p, int k, std::vector<int> &out) const {
+    std::vector<Candidate> heap(static_cast<std::size_t>(std::max(0, std::min(k, getLength()))));
+    int found{ nearestCandidates(p, k, heap.data()) };
+    for(int i{}; i < found; ++i)
+    {
+        out.push_back(heap[i].id);
+    }
+}
+
+template<class T>
+void PointKdTree<T>::withinRadius(const Punto<T> &p, double radius, std::vector<int> &out) const {
+    if (radius < 0)
+    {
+        return;
+    }
+    double limit2{ radius * radius };
+    search(p, limit2, [&](int position, double) { out.push_back(m_ids[position]); });
+}
+
+template<class T>
+void PointKdTree<T>::nearestAll(const Punto<T>* puntos, int count, int* out, int threads) const {
+    parallelFor(count, [=](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            out[i] = nearest(puntos[i]);
+        }
+    }, threads, 1 << 10);
+}
+
+template<class T>
+void PointKdTree<T>::nearestAll(const Punto<T>* puntos, int count, int k, int* out, int threads) const {
+    if (k <= 0)
+    {
+        return;
+    }
+    parallelFor(count, [=](int begin, int end) {
+        // one heap for all the points of the range
+        std::vector<Candidate> heap(static_cast<std::size_t>(std::min(k, getLength())));
+        for(int i{ begin }; i < end; ++i)
+        {
+            int found{ nearestCandidates(puntos[i], k, heap.data()) };
+            int* row{ out + static_cast<long>(i) * k };
+            for(int j{}; j < k; ++j)
+            {
+                row[j] = (j < found) ? heap[j].id : -1;
+            }
+        }
+    }, threads, 1 << 10);
+}
+
+template<class T>
+void PointKdTree<T>::withinRadiusAll(const Punto<T>* puntos, int count, double radius, std::vector<int> &offsets,
+                                     std::vector<int> &ids, int threads) const {
+    offsets.assign(static_cast<std::size_t>(count) + 1, 0);
+    if (radius < 0)
+    {
+        ids.clear();
+        return;
+    }
+    // the points are counted first, so each query writes its own part of ids
+    int* counts{ offsets.data() + 1 };
+    parallelFor(count, [=](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            double limit2{ radius * radius };
+            int found{ };
+            search(puntos[i], limit2, [&](int, double) { ++found; });
+            counts[i] = found;
+        }
+    }, threads, 1 << 10);
+    for(int i{}; i < count; ++i)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+
+    ids.resize(static_cast<std::size_t>(offsets[count]));
+    const int* starts{ offsets.data() };
+    int* found{ ids.data() };
+    parallelFor(count, [=](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            double limit2{ radius * radius };
+            int* next{ found + starts[i] };
+            search(puntos[i], limit2, [&](int position, double) { *next++ = m_ids[position]; });
+        }
+    }, threads, 1 << 10);
+}
+
+#endif //ELEM_GEOMETRICOS_POINTKDTREE_H
@@ -8,41 +8,90 @@
 
 #include "elem_geometricos.h"
 #include "Segmento.h"
+#include "Predicates.h"
+#include "BatchContainment.h"
+#include "PointBuffer.h"
 #include <math.h>
 #include <initializer_list>
+#include <utility>
+#include <vector>
 
 /*
  * Class for storing a polygon. The polygon's vertices are stored in the array
  * m_puntos and the edges are symbolically given by connecting the vertices in
  * order (vi with v(i+1) until the last vertex) and closing the figure with the
  * edge from the last point to v0.
+ * A Poligono either owns its vertex array, or is a view over an array owned
+ * by someone else (see view). Views over const arrays are read only: they
+ * copy their vertices before any of them is edited. Polygons can be moved
+ * but not copied.
  */
 template <class T>
 class Poligono
 {
 private:
     int m_length{};
-    Punto<T>* m_puntos{};
+    const Punto<T>* m_puntos{};
+    // the same vertices when they may be edited, nullptr for read only views
+    Punto<T>* m_writable{};
+    // holds the vertices of owning polygons, it's empty for views
+    std::vector<Punto<T>> m_storage;
+    bool m_view{};
+
+    /*
+     * Copies the vertices of a view into storage owned by this polygon.
+     */
+    void makeOwning();
 
 public:
+    /*
+     * Creates an empty polygon. Vertices may be added later with push_back.
+     */
+    Poligono() = default;
+
     /*
      * Creates a polygon given a list of points Punto of the same type as the
      * Poligono.
      */
     Poligono(std::initializer_list<Punto<T>> puntos)
-    {
-        int length = static_cast<int>(puntos.size());
-        m_length = length;
-        m_puntos = new Punto<T>[static_cast<unsigned long>(length)]{};
+            : Poligono(puntos.begin(), puntos.end())
+    {};
 
-        Punto<T>* ppunto{m_puntos};
-        for(Punto<T> punto: puntos)
-        {
-            *ppunto = punto;
-            ++ppunto;
-        }
+    /*
+     * Creates a polygon with a copy of the points of the range [first, last).
+     * The range must hold Punto of the same type as the Poligono.
+     */
+    template <class InputIt>
+    Poligono(InputIt first, InputIt last)
+            : m_storage(first, last)
+    {
+        m_length = static_cast<int>(m_storage.size());
+        m_puntos = m_writable = m_storage.data();
     };
 
+    /*
+     * Creates a polygon with a copy of the length points of the given array.
+     */
+    Poligono(const Punto<T>* puntos, int length)
+            : Poligono(puntos, puntos + length)
+    {};
+
+    /*
+     * Creates a polygon that uses the length points of the given array as its
+     * vertices without copying them. The array must outlive the polygon, and
+     * editing the vertices of the polygon edits the array. Growing a view
+     * copies its vertices into storage of its own first.
+     */
+    static Poligono<T> view(Punto<T>* puntos, int length);
+
+    /*
+     * Creates a read only view over the length points of the given array,
+     * which must outlive the polygon. The array is never written: editing a
+     * vertex or growing the view copies its vertices into storage of its own
+     * first.
+     */
+    static Poligono<T> view(const Punto<T>* puntos, int length);
+
     /*
      * Disallow copies of polygons
      */
@@ -53,9 +102,21 @@ public:
      */
     Poligono& operator=(const Poligono<T>&) = delete;
 
+    /*
+     * Move constructor. The vertices are taken from other without copying
+     * them, leaving other empty.
+     */
+    Poligono(Poligono<T>&& other) noexcept;
+
+    /*
+     * Move assignment. The vertices are taken from other without copying
+     * them, leaving other empty.
+     */
+    Poligono& operator=(Poligono<T>&& other) noexcept;
+
     /*
      * Gets the point from the vertex list at the position given by index.
-     * This Punto can be edited.
+     * This Punto can be edited. Read only views are copied first.
      */
     Punto<T>& operator[] (int index);
 
@@ -66,10 +127,20 @@ public:
     const Punto<T>& operator[] (int index) const;
 
     /*
-     * Defines the destructor for Poligono. Deallocates the memory of the
-     * vertex array.
+     * Returns whether this polygon is a view over vertices it doesn't own.
+     */
+    bool isView() const { return m_view; }
+
+    /*
+     * Reserves room for capacity vertices, so that the following push_back
+     * calls don't need to reallocate.
+     */
+    void reserve(int capacity);
+
+    /*
+     * Appends a vertex at the end of the polygon, right before v0.
      */
-    ~Poligono();
+    void push_back(const Punto<T> &p);
 
     /*
      * Returns the amount of vertices this polygon has.
@@ -81,12 +152,26 @@ public:
      * positions previous to centerIndex, centerIndex itself, and the one next
      * to it.
      */
-    T signedAngle(int centerIndex) const;
+    OrientationType<T> signedAngle(int centerIndex) const;
 
     /*
-     * Returns double the signed area of the whole polygon.
+     * Same as above for the given three points. It's positive when next is
+     * to the left of the line from prev to center.
      */
-    T doubleSignedArea() const;
+    static OrientationType<T> signedAngle(const Punto<T> &prevP, const Punto<T> &centerP, const Punto<T> &nextP);
+
+    /*
+     * Returns double the signed area of the whole polygon. Integer polygons
+     * add it up in their WideType, so it's exact while it fits there.
+     */
+    WideType<T> doubleSignedArea() const;
+
+    /*
+     * Checks whether the polygon is convex: every signedAngle has the same
+     * sign, or is 0 for collinear vertices, and the boundary winds around
+     * only once, so its edges change their direction along X at most twice.
+     */
+    bool isConvex() const;
 
     /*
      * Calculates the area of the polygon. Returned value is positive.
@@ -102,10 +187,31 @@ public:
 
     /*
      * Checks if a Punto p lies inside this Poligono using the odd-even
-     * algorithm
+     * algorithm. The crossings of the edges are decided as told by the
+     * Predicates policy, see Predicates.h: RobustPredicates gives the exact
+     * answer for points very close to an edge.
      */
+    template <class Predicates = FastPredicates>
     bool pointInside(const Punto<T> &p) const;
 
+    /*
+     * Checks which of the count points given by the coordinate arrays xs and
+     * ys lie inside this Poligono, storing the answer for (xs[i], ys[i]) in
+     * inside[i]. Gives the same results as pointInside but walks the edges
+     * once per block of points.
+     */
+    void pointsInside(const T* xs, const T* ys, int count, bool* inside) const;
+
+    /*
+     * Same as above for an array of count points Punto.
+     */
+    void pointsInside(const Punto<T>* puntos, int count, bool* inside) const;
+
+    /*
+     * Same as above for the points of a PointBuffer.
+     */
+    void pointsInside(const PointBuffer<T> &puntos, bool* inside) const;
+
     template <class S>
     friend std::ostream& operator<< (std::ostream &out, const Poligono<S> &pol);
 
@@ -114,7 +220,11 @@ public:
 
 template<class T>
 Punto<T> &Poligono<T>::operator[](int index) {
-    return m_puntos[index];
+    if (m_view && !m_writable)
+    {
+        makeOwning();
+    }
+    return m_writable[index];
 }
 
 template<class T>
@@ -123,42 +233,179 @@ const Punto<T> &Poligono<T>::operator[](int index) const {
 }
 
 template<class T>
-Poligono<T>::~Poligono()
+Poligono<T> Poligono<T>::view(Punto<T>* puntos, int length) {
+    Poligono<T> pol{};
+    pol.m_length = length;
+    pol.m_puntos = pol.m_writable = puntos;
+    pol.m_view = true;
+    return pol;
+}
+
+template<class T>
+Poligono<T> Poligono<T>::view(const Punto<T>* puntos, int length) {
+    Poligono<T> pol{};
+    pol.m_length = length;
+    pol.m_puntos = puntos;
+    pol.m_view = true;
+    return pol;
+}
+
+template<class T>
+Poligono<T>::Poligono(Poligono<T>&& other) noexcept
+        : m_length{ other.m_length }, m_puntos{ other.m_puntos }, m_writable{ other.m_writable },
+          m_storage{ std::move(other.m_storage) }, m_view{ other.m_view }
 {
-    delete[] m_puntos;
+    other.m_length = 0;
+    other.m_puntos = nullptr;
+    other.m_writable = nullptr;
+    other.m_view = false;
+}
+
+template<class T>
+Poligono<T>& Poligono<T>::operator=(Poligono<T>&& other) noexcept {
+    if (this != &other)
+    {
+        // moving a vector keeps its buffer, so m_puntos stays valid
+        m_storage = std::move(other.m_storage);
+        m_length = other.m_length;
+        m_puntos = other.m_puntos;
+        m_writable = other.m_writable;
+        m_view = other.m_view;
+        other.m_length = 0;
+        other.m_puntos = nullptr;
+        other.m_writable = nullptr;
+        other.m_view = false;
+    }
+    return *this;
+}
+
+template<class T>
+void Poligono<T>::makeOwning() {
+    if (m_view)
+    {
+        m_storage.assign(m_puntos, m_puntos + m_length);
+        m_puntos = m_writable = m_storage.data();
+        m_view = false;
+    }
+}
+
+template<class T>
+void Poligono<T>::reserve(int capacity) {
+    makeOwning();
+    m_storage.reserve(static_cast<std::size_t>(capacity));
+    m_puntos = m_writable = m_storage.data();
+}
+
+template<class T>
+void Poligono<T>::push_back(const Punto<T> &p) {
+    makeOwning();
+    m_storage.push_back(p);
+    m_puntos = m_writable = m_storage.data();
+    ++m_length;
 }
 
 template<class T>
-T Poligono<T>::signedAngle(int centerIndex) const {
+OrientationType<T> Poligono<T>::signedAngle(int centerIndex) const {
     int prevIndex{ ((centerIndex-1)%m_length + m_length)%m_length };
     int nextIndex{ (centerIndex+1)%m_length};
 
-    Punto<T> centerP{m_puntos[centerIndex]};
-    Punto<T> prevP{m_puntos[prevIndex]};
-    Punto<T> nextP{m_puntos[nextIndex]};
+    return signedAngle(m_puntos[prevIndex], m_puntos[centerIndex], m_puntos[nextIndex]);
+}
 
-    T firstCofactor{ crossProdValue(Vector<T>(centerP), Vector<T>(nextP))} ;
-    T secondCofactor{ prevP.getX() * crossProdValue(Vector<T>(1,centerP.getY()),
-                                                    Vector<T>(1, nextP.getY()))} ;
-    T thirdCofactor{ prevP.getY() * crossProdValue(Vector<T>(1,centerP.getX()),
-                                                   Vector<T>(1, nextP.getX()))};
+template<class T>
+OrientationType<T> Poligono<T>::signedAngle(const Punto<T> &prevP, const Punto<T> &centerP, const Punto<T> &nextP) {
+    if constexpr (std::is_integral<T>::value)
+    {
+        // the cofactors below multiply three coordinates, which would need
+        // even wider integers
+        return wideOrientation(prevP.getX(), prevP.getY(), centerP.getX(), centerP.getY(),
+                               nextP.getX(), nextP.getY());
+    }
+    else
+    {
+        T firstCofactor{ crossProdValue(Vector<T>(centerP), Vector<T>(nextP))} ;
+        T secondCofactor{ prevP.getX() * crossProdValue(Vector<T>(1,centerP.getY()),
+                                                        Vector<T>(1, nextP.getY()))} ;
+        T thirdCofactor{ prevP.getY() * crossProdValue(Vector<T>(1,centerP.getX()),
+                                                       Vector<T>(1, nextP.getX()))};
 
-    return firstCofactor - secondCofactor + thirdCofactor;
+        return firstCofactor - secondCofactor + thirdCofactor;
+    }
 }
 
 template<class T>
-T Poligono<T>::doubleSignedArea() const {
-    T area{ };
-    for(int i{}; i < m_length; ++i)
+WideType<T> Poligono<T>::doubleSignedArea() const {
+    // same terms as crossProdValue(Vector(vi), Vector(vi+1)), without
+    // building the vectors, and the closing edge is added last instead of
+    // wrapping the index
+    using Wide = WideType<T>;
+    Wide area{ };
+    for(int i{}; i + 1 < m_length; ++i)
     {
-        int nexti{ (i+1)%m_length};
-        T det{ crossProdValue(Vector<T>(m_puntos[i]), Vector<T>(m_puntos[nexti]))};
-        area += det;
+        const Punto<T> &p{ m_puntos[i] };
+        const Punto<T> &q{ m_puntos[i + 1] };
+        area += static_cast<Wide>(p.getX()) * q.getY() - static_cast<Wide>(p.getY()) * q.getX();
+    }
+    if (m_length > 0)
+    {
+        const Punto<T> &p{ m_puntos[m_length - 1] };
+        const Punto<T> &q{ m_puntos[0] };
+        area += static_cast<Wide>(p.getX()) * q.getY() - static_cast<Wide>(p.getY()) * q.getX();
     }
     return area;
 }
 
 
+template<class T>
+bool Poligono<T>::isConvex() const {
+    if (m_length < 3)
+    {
+        return false;
+    }
+    int turn{ };
+    for(int i{}; i < m_length; ++i)
+    {
+        int sign{ signOf(signedAngle(i)) };
+        if (sign != 0)
+        {
+            if (turn != 0 && sign != turn)
+            {
+                return false;
+            }
+            turn = sign;
+        }
+    }
+
+    // a star polygon turns the same way at every vertex too, but goes back
+    // and forth along X more than twice
+    int firstDirection{ };
+    int direction{ };
+    int changes{ };
+    for(int i{}; i < m_length; ++i)
+    {
+        // the sign of the difference, without computing it
+        T nextX{ m_puntos[(i+1 == m_length) ? 0 : i+1].getX() };
+        int sign{ (nextX > m_puntos[i].getX()) - (nextX < m_puntos[i].getX()) };
+        if (sign != 0)
+        {
+            if (direction == 0)
+            {
+                firstDirection = sign;
+            }
+            else if (sign != direction)
+            {
+                ++changes;
+            }
+            direction = sign;
+        }
+    }
+    if (direction != firstDirection)
+    {
+        ++changes;
+    }
+    return turn != 0 && changes <= 2;
+}
+
 template<class T>
 bool Poligono<T>::isCCW() const {
     return (doubleSignedArea() >= 0);
@@ -166,10 +413,11 @@ bool Poligono<T>::isCCW() const {
 
 template<class T>
 double Poligono<T>::area() const {
-    return std::abs(doubleSignedArea())*0.5;
+    return std::abs(static_cast<double>(doubleSignedArea()))*0.5;
 }
 
 template<class T>
+template<class Predicates>
 bool Poligono<T>::pointInside(const Punto<T> &p) const {
     int rightCrosses{ };
 
@@ -180,8 +428,7 @@ bool Poligono<T>::pointInside(const Punto<T> &p) const {
         Segmento<T> s{ m_puntos[i], m_puntos[nexti] };
         if (s.straddleHorizontally(xAx) || s.swapSegmento().straddleHorizontally(xAx))
         {
-            double intersectX{ s.horizontalIntersect(xAx) };
-            if (intersectX - p.getX() > 0)
+            if (Predicates::crossesToTheRight(m_puntos[i], m_puntos[nexti], p))
             {
                 ++rightCrosses;
             }
@@ -191,11 +438,26 @@ bool Poligono<T>::pointInside(const Punto<T> &p) const {
     return (rightCrosses & 1);
 }
 
+template<class T>
+void Poligono<T>::pointsInside(const T* xs, const T* ys, int count, bool* inside) const {
+    batchPointInside(m_puntos, m_length, xs, ys, count, inside);
+}
+
+template<class T>
+void Poligono<T>::pointsInside(const PointBuffer<T> &puntos, bool* inside) const {
+    pointsInside(puntos.getXs(), puntos.getYs(), puntos.getLength(), inside);
+}
+
+template<class T>
+void Poligono<T>::pointsInside(const Punto<T>* puntos, int count, bool* inside) const {
+    batchPointInside(m_puntos, m_length, puntos, count, inside);
+}
+
 template <class T>
 std::ostream &operator<<(std::ostream &out, const Poligono<T> &pol) {
     out << "[";
 
-    Punto<T>* ppunto{ pol.m_puntos };
+    const Punto<T>* ppunto{ pol.m_puntos };
     for(int i{ 0 }; i < pol.m_length; i++)
     {
         out << "v" << i << ": " << *ppunto;
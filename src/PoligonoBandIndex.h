@@ -0,0 +1,237 @@
+//
+// Band decomposition index for point location on large polygons.
+//
+
+#ifndef ELEM_GEOMETRICOS_POLIGONOBANDINDEX_H
+#define ELEM_GEOMETRICOS_POLIGONOBANDINDEX_H
+
+#include "Poligono.h"
+#include "BatchContainment.h"
+#include "PointBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/*
+ * Index that answers point in polygon queries in near constant time. The y
+ * range of the polygon is split in bands of the same height and every band
+ * stores a copy of the edges whose y range reaches it, so a query only
+ * tests the edges of the band the point falls in instead of the whole
+ * polygon. Edges of the same band are contiguous in memory.
+ * Construction takes O(n + e) time and memory, with e the total of band
+ * entries, which is about 2n with the automatic amount of bands. A query
+ * then tests about twice the edges a horizontal line crosses on average.
+ * Answers are the same as the ones given by Poligono::pointInside.
+ */
+template <class T>
+class PoligonoBandIndex
+{
+private:
+    T m_minX{};
+    T m_minY{};
+    T m_maxX{};
+    T m_maxY{};
+    int m_bandCount{};
+    double m_bandScale{};
+    // edges of band b are m_edges[m_bandOffsets[b]] to m_edges[m_bandOffsets[b+1]-1]
+    std::vector<int> m_bandOffsets;
+    std::vector<ContainmentEdge<T>> m_edges;
+
+    void build(const Punto<T>* vertices, int length, int bandCount);
+
+    static int automaticBandCount(const Punto<T>* vertices, int length, double height);
+
+public:
+    /*
+     * Builds the index for the given polygon. When bandCount is 0 it is
+     * chosen so that the index stores about two entries per edge.
+     */
+    explicit PoligonoBandIndex(const Poligono<T> &pol, int bandCount = 0);
+
+    /*
+     * Builds the index for the polygon given by its length vertices.
+     */
+    PoligonoBandIndex(const Punto<T>* vertices, int length, int bandCount = 0);
+
+    /*
+     * Returns the amount of bands the y range was split in.
+     */
+    int getBandCount() const { return m_bandCount; }
+
+    /*
+     * Returns the amount of edges stored across all bands. An edge reaching
+     * several bands is counted once per band.
+     */
+    int getEntryCount() const { return static_cast<int>(m_edges.size()); }
+
+    /*
+     * Returns the band the horizontal line at y falls in. Values out of the
+     * y range of the polygon are clamped to the first or last band.
+     */
+    int bandOf(T y) const;
+
+    /*
+     * Checks if a Punto p lies inside the polygon using the odd-even
+     * algorithm over the edges of the band of p.
+     */
+    bool pointInside(const Punto<T> &p) const;
+
+    /*
+     * Checks which of the count points given by the coordinate arrays xs and
+     * ys lie inside the polygon, storing the answer for (xs[i], ys[i]) in
+     * inside[i].
+     */
+    void pointsInside(const T* xs, const T* ys, int count, bool* inside) const;
+
+    /*
+     * Same as above for the points of a PointBuffer.
+     */
+    void pointsInside(const PointBuffer<T> &puntos, bool* inside) const;
+};
+
+template<class T>
+PoligonoBandIndex<T>::PoligonoBandIndex(const Poligono<T> &pol, int bandCount) {
+    if (pol.getLength() > 0)
+    {
+        build(&pol[0], pol.getLength(), bandCount);
+    }
+}
+
+template<class T>
+PoligonoBandIndex<T>::PoligonoBandIndex(const Punto<T>* vertices, int length, int bandCount) {
+    if (length > 0)
+    {
+        build(vertices, length, bandCount);
+    }
+}
+
+template<class T>
+void PoligonoBandIndex<T>::build(const Punto<T>* vertices, int length, int bandCount) {
+    m_minX = m_maxX = vertices[0].getX();
+    m_minY = m_maxY = vertices[0].getY();
+    for(int i{ 1 }; i < length; ++i)
+    {
+        m_minX = std::min(m_minX, vertices[i].getX());
+        m_maxX = std::max(m_maxX, vertices[i].getX());
+        m_minY = std::min(m_minY, vertices[i].getY());
+        m_maxY = std::max(m_maxY, vertices[i].getY());
+    }
+
+    double height{ static_cast<double>(m_maxY) - static_cast<double>(m_minY) };
+    m_bandCount = (bandCount > 0) ? bandCount : automaticBandCount(vertices, length, height);
+    m_bandScale = (height > 0) ? m_bandCount / height : 0.0;
+
+    // first pass counts the entries of each band, second one fills them in
+    m_bandOffsets.assign(static_cast<std::size_t>(m_bandCount) + 1, 0);
+    for(int i{}; i < length; ++i)
+    {
+        T startY{ vertices[i].getY() };
+        T endY{ vertices[(i+1 == length) ? 0 : i+1].getY() };
+        if (startY == endY)
+        {
+            continue;
+        }
+        int last{ bandOf(std::max(startY, endY)) };
+        for(int b{ bandOf(std::min(startY, endY)) }; b <= last; ++b)
+        {
+            ++m_bandOffsets[b + 1];
+        }
+    }
+    for(int b{}; b < m_bandCount; ++b)
+    {
+        m_bandOffsets[b + 1] += m_bandOffsets[b];
+    }
+
+    m_edges.resize(static_cast<std::size_t>(m_bandOffsets[m_bandCount]));
+    std::vector<int> filled{ m_bandOffsets.begin(), m_bandOffsets.end() - 1 };
+    for(int i{}; i < length; ++i)
+    {
+        const Punto<T> &start{ vertices[i] };
+        const Punto<T> &end{ vertices[(i+1 == length) ? 0 : i+1] };
+        if (start.getY() == end.getY())
+        {
+            continue;
+        }
+        ContainmentEdge<T> e{ containmentEdge(start, end) };
+        int last{ bandOf(std::max(e.startY, e.endY)) };
+        for(int b{ bandOf(std::min(e.startY, e.endY)) }; b <= last; ++b)
+        {
+            m_edges[filled[b]++] = e;
+        }
+    }
+}
+
+template<class T>
+int PoligonoBandIndex<T>::automaticBandCount(const Punto<T>* vertices, int length, double height) {
+    // with k bands an edge is stored in about 1 + k*|diffY|/height bands, so
+    // the total is length + k*variation with variation = sum(|diffY|)/height.
+    // k = length/variation keeps that at twice the edges, and leaves in each
+    // band about twice the edges any horizontal line crosses on average
+    double variation{ };
+    for(int i{}; i < length; ++i)
+    {
+        T startY{ vertices[i].getY() };
+        T endY{ vertices[(i+1 == length) ? 0 : i+1].getY() };
+        variation += std::fabs(static_cast<double>(startY) - static_cast<double>(endY));
+    }
+    if (!(height > 0))
+    {
+        return 1;
+    }
+    variation /= height;
+    return std::max(1, static_cast<int>(length / variation));
+}
+
+template<class T>
+int PoligonoBandIndex<T>::bandOf(T y) const {
+    // the mapping is monotonic in y, so an edge registered in the bands of
+    // its endpoints is also found from any y in between
+    double band{ std::floor((static_cast<double>(y) - static_cast<double>(m_minY)) * m_bandScale) };
+    if (!(band > 0))
+    {
+        return 0;
+    }
+    if (band >= m_bandCount)
+    {
+        return m_bandCount - 1;
+    }
+    return static_cast<int>(band);
+}
+
+template<class T>
+bool PoligonoBandIndex<T>::pointInside(const Punto<T> &p) const {
+    T x{ p.getX() };
+    T y{ p.getY() };
+    if ((m_bandCount == 0) || (x < m_minX) || (x > m_maxX) || (y < m_minY) || (y >= m_maxY))
+    {
+        return false;
+    }
+
+    int band{ bandOf(y) };
+    int rightCrosses{ };
+    for(int i{ m_bandOffsets[band] }; i < m_bandOffsets[band + 1]; ++i)
+    {
+        const ContainmentEdge<T> &e{ m_edges[i] };
+        if ((e.startY > y) != (e.endY > y) && crossesToTheRight(e, x, y))
+        {
+            ++rightCrosses;
+        }
+    }
+    // true if rightCrosses is odd (binary representation ends in 1)
+    return (rightCrosses & 1);
+}
+
+template<class T>
+void PoligonoBandIndex<T>::pointsInside(const T* xs, const T* ys, int count, bool* inside) const {
+    for(int i{}; i < count; ++i)
+    {
+        inside[i] = pointInside(Punto<T>{ xs[i], ys[i] });
+    }
+}
+
+template<class T>
+void PoligonoBandIndex<T>::pointsInside(const PointBuffer<T> &puntos, bool* inside) const {
+    pointsInside(puntos.getXs(), puntos.getYs(), puntos.getLength(), inside);
+}
+
+#endif //ELEM_GEOMETRICOS_POLIGONOBANDINDEX_H
@@ -0,0 +1,270 @@
+//
+// Area and orientation of whole collections of polygons.
+//
+
+#ifndef ELEM_GEOMETRICOS_POLYGONAREA_H
+#define ELEM_GEOMETRICOS_POLYGONAREA_H
+
+#include "Poligono.h"
+#include "PolygonSet.h"
+#include "Parallel.h"
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * How the terms of the shoelace formula are added up. FAST uses several
+ * partial sums (vector lanes for doubles) and thus rounds slightly
+ * differently than Poligono::doubleSignedArea. COMPENSATED uses Neumaier's
+ * variant of Kahan summation, which keeps the error of huge float polygons
+ * independent of their amount of vertices.
+ */
+enum class AreaSummation
+{
+    FAST,
+    COMPENSATED
+};
+
+/*
+ * Returns the shoelace term of the edge from p to q, which is double the
+ * signed area of the triangle formed by the edge and the origin. Integer
+ * terms are computed exactly in their WideType.
+ */
+template <class T>
+WideType<T> shoelaceTerm(const Punto<T> &p, const Punto<T> &q)
+{
+    using Wide = WideType<T>;
+    return static_cast<Wide>(p.getX()) * q.getY() - static_cast<Wide>(p.getY()) * q.getX();
+}
+
+template <class T>
+WideType<T> shoelaceDoubleArea(const Punto<T>* vertices, int length);
+
+/*
+ * Returns double the signed area of the polygon given by its length
+ * vertices, adding up the terms with Neumaier summation. Integer sums are
+ * exact already, so they are just added up.
+ */
+template <class T>
+WideType<T> compensatedDoubleArea(const Punto<T>* vertices, int length)
+{
+    if constexpr (std::is_integral<T>::value)
+    {
+        return shoelaceDoubleArea(vertices, length);
+    }
+    else
+    {
+        T sum{ };
+        T compensation{ };
+        for(int i{}; i < length; ++i)
+        {
+            T term{ shoelaceTerm(vertices[i], vertices[(i+1 == length) ? 0 : i+1]) };
+            T t{ sum + term };
+            if (std::abs(sum) >= std::abs(term))
+            {
+                compensation += (sum - t) + term;
+            }
+            else
+            {
+                compensation += (term - t) + sum;
+            }
+            sum = t;
+        }
+        return sum + compensation;
+    }
+}
+
+/*
+ * Returns double the signed area of the polygon given by its length
+ * vertices. Four partial sums are kept so consecutive additions don't wait
+ * on each other, and the closing edge is added apart instead of wrapping the
+ * index with %.
+ */
+template <class T>
+WideType<T> shoelaceDoubleArea(const Punto<T>* vertices, int length)
+{
+    if (length < 2)
+    {
+        return WideType<T>{};
+    }
+    WideType<T> sums[4]{};
+    int i{};
+    for(; i + 4 < length; i += 4)
+    {
+        sums[0] += shoelaceTerm(vertices[i], vertices[i + 1]);
+        sums[1] += shoelaceTerm(vertices[i + 1], vertices[i + 2]);
+        sums[2] += shoelaceTerm(vertices[i + 2], vertices[i + 3]);
+        sums[3] += shoelaceTerm(vertices[i + 3], vertices[i + 4]);
+    }
+    for(; i + 1 < length; ++i)
+    {
+        sums[0] += shoelaceTerm(vertices[i], vertices[i + 1]);
+    }
+    sums[1] += shoelaceTerm(vertices[length - 1], vertices[0]);
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+#if defined(__AVX__) || defined(__SSE2__)
+
+static_assert(sizeof(Punto<double>) == 2 * sizeof(double) && std::is_standard_layout<Punto<double>>::value,
+              "the vectorized shoelace loads Punto<double> as a pair of doubles");
+
+/*
+ * Vectorized version for doubles. Each edge term is computed in one lane
+ * pair as (xi*yj, yi*xj) and the difference of both lanes is accumulated,
+ * so every term is rounded as in the scalar formula.
+ */
+template <>
+inline double shoelaceDoubleArea(const Punto<double>* vertices, int length)
+{
+    if (length < 2)
+    {
+        return 0.0;
+    }
+    const double* coords{ reinterpret_cast<const double*>(vertices) };
+    int i{};
+    double sum{ };
+
+#if defined(__AVX__)
+    // four edges per iteration: points i..i+4
+    __m256d acc{ _mm256_setzero_pd() };
+    for(; i + 4 < length; i += 4)
+    {
+        __m256d first{ _mm256_loadu_pd(coords + 2 * i) };        // p_i, p_i+1
+        __m256d second{ _mm256_loadu_pd(coords + 2 * i + 2) };   // p_i+1, p_i+2
+        __m256d third{ _mm256_loadu_pd(coords + 2 * i + 4) };    // p_i+2, p_i+3
+        __m256d fourth{ _mm256_loadu_pd(coords + 2 * i + 6) };   // p_i+3, p_i+4
+        __m256d products01{ _mm256_mul_pd(first, _mm256_permute_pd(second, 0x5)) };
+        __m256d products23{ _mm256_mul_pd(third, _mm256_permute_pd(fourth, 0x5)) };
+        acc = _mm256_add_pd(acc, _mm256_hsub_pd(products01, products23));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    // two edges per iteration: points i..i+2
+    __m128d acc{ _mm_setzero_pd() };
+    for(; i + 2 < length; i += 2)
+    {
+        __m128d first{ _mm_loadu_pd(coords + 2 * i) };
+        __m128d second{ _mm_loadu_pd(coords + 2 * i + 2) };
+        __m128d third{ _mm_loadu_pd(coords + 2 * i + 4) };
+        __m128d products0{ _mm_mul_pd(first, _mm_shuffle_pd(second, second, 0x1)) };
+        __m128d products1{ _mm_mul_pd(second, _mm_shuffle_pd(third, third, 0x1)) };
+        acc = _mm_add_pd(acc, _mm_sub_pd(_mm_unpacklo_pd(products0, products1),
+                                         _mm_unpackhi_pd(products0, products1)));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, acc);
+    sum = lanes[0] + lanes[1];
+#endif
+
+    for(; i + 1 < length; ++i)
+    {
+        sum += shoelaceTerm(vertices[i], vertices[i + 1]);
+    }
+    return sum + shoelaceTerm(vertices[length - 1], vertices[0]);
+}
+
+#endif
+
+/*
+ * Returns double the signed area of the polygon given by its length
+ * vertices, added up as told by summation.
+ */
+template <class T>
+WideType<T> shoelaceDoubleArea(const Punto<T>* vertices, int length, AreaSummation summation)
+{
+    if (summation == AreaSummation::COMPENSATED)
+    {
+        return compensatedDoubleArea(vertices, length);
+    }
+    return shoelaceDoubleArea(vertices, length);
+}
+
+/*
+ * Stores in out[i] double the signed area of the polygon i of the set. The
+ * polygons are split across threads so that every thread gets about the
+ * same amount of vertices. When threads is 0 one per hardware thread is
+ * used. Integer areas are stored in their WideType, see doubleSignedArea.
+ */
+template <class T>
+void batchDoubleSignedArea(const PolygonSet<T> &set, WideType<T>* out,
+                           AreaSummation summation = AreaSummation::FAST, int threads = 0)
+{
+    const Punto<T>* vertices{ set.getVertices() };
+    const int* offsets{ set.getOffsets() };
+    parallelForBalanced(offsets, set.getLength(), [=](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            out[i] = shoelaceDoubleArea(vertices + offsets[i], offsets[i + 1] - offsets[i], summation);
+        }
+    }, threads);
+}
+
+/*
+ * Stores in out[i] the (positive) area of the polygon i of the set.
+ */
+template <class T>
+void batchArea(const PolygonSet<T> &set, double* out,
+               AreaSummation summation = AreaSummation::FAST, int threads = 0)
+{
+    const Punto<T>* vertices{ set.getVertices() };
+    const int* offsets{ set.getOffsets() };
+    parallelForBalanced(offsets, set.getLength(), [=](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            auto doubleArea{ shoelaceDoubleArea(vertices + offsets[i], offsets[i + 1] - offsets[i], summation) };
+            out[i] = std::abs(static_cast<double>(doubleArea)) * 0.5;
+        }
+    }, threads);
+}
+
+/*
+ * Stores in out[i] whether the vertices of the polygon i of the set are
+ * given in counter clockwise order, see Poligono::isCCW.
+ */
+template <class T>
+void batchIsCCW(const PolygonSet<T> &set, bool* out,
+                AreaSummation summation = AreaSummation::FAST, int threads = 0)
+{
+    const Punto<T>* vertices{ set.getVertices() };
+    const int* offsets{ set.getOffsets() };
+    parallelForBalanced(offsets, set.getLength(), [=](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            out[i] = shoelaceDoubleArea(vertices + offsets[i], offsets[i + 1] - offsets[i], summation) >= 0;
+        }
+    }, threads);
+}
+
+/*
+ * Stores in out[i] double the signed area of polygons[i], for the count
+ * polygons of the array.
+ */
+template <class T>
+void batchDoubleSignedArea(const Poligono<T>* polygons, int count, WideType<T>* out,
+                           AreaSummation summation = AreaSummation::FAST, int threads = 0)
+{
+    std::vector<int> prefix(static_cast<std::size_t>(count) + 1, 0);
+    for(int i{}; i < count; ++i)
+    {
+        prefix[i + 1] = prefix[i] + polygons[i].getLength();
+    }
+    parallelForBalanced(prefix.data(), count, [=](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            int length{ polygons[i].getLength() };
+            out[i] = (length == 0) ? WideType<T>{} : shoelaceDoubleArea(&polygons[i][0], length, summation);
+        }
+    }, threads);
+}
+
+#endif //ELEM_GEOMETRICOS_POLYGONAREA_H
@@ -0,0 +1,671 @@
+//
+// Streaming parser for polygons written as WKT or GeoJSON.
+//
+
+#ifndef ELEM_GEOMETRICOS_POLYGONPARSER_H
+#define ELEM_GEOMETRICOS_POLYGONPARSER_H
+
+#include "PolygonSet.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <vector>
+
+enum class TextFormat
+{
+    WKT,
+    GEOJSON
+};
+
+/*
+ * Rings kept from each polygon. A Poligono has no holes, so by default only
+ * the outer ring is kept; ALL stores every ring as a polygon of its own.
+ */
+enum class RingSelection
+{
+    OUTER,
+    ALL
+};
+
+/*
+ * Totals of a parse. Geometries that can't be parsed are skipped and
+ * counted as errors.
+ */
+struct ParseStats
+{
+    std::size_t bytes{};
+    long polygons{};
+    long vertices{};
+    long errors{};
+    double seconds{};
+
+    double megabytesPerSecond() const { return (seconds > 0) ? static_cast<double>(bytes) / 1e6 / seconds : 0.0; }
+};
+
+/*
+ * Reads the polygons of WKT (POLYGON and MULTIPOLYGON) or GeoJSON (the
+ * "coordinates" of the objects whose "type" is Polygon or MultiPolygon,
+ * whichever member comes first) text into
+ * PolygonSets. The closing vertex repeated at the end of each ring is
+ * dropped, since Poligono closes itself.
+ * Text is taken in chunks: each chunk is first scanned for the byte ranges
+ * of its geometries, which are then parsed by several threads, every thread
+ * into its own PolygonSet. The sets are kept between chunks, so once they
+ * have grown parsing allocates nothing. Numbers are read with
+ * std::from_chars, without locales or copies.
+ */
+template <class T>
+class PolygonParser
+{
+private:
+    struct Record
+    {
+        int begin;
+        int end;
+        // nesting depth of the brackets of each ring in the record
+        int ringDepth;
+    };
+
+    /*
+     * GeoJSON object open while scanning. ringDepth is told by its "type":
+     * 0 while it's unknown and -1 for types other than Polygon and
+     * MultiPolygon. Coordinates found before the type wait in coordinates,
+     * and decided is set once the coordinates are kept or dropped.
+     */
+    struct JsonObject
+    {
+        int begin;
+        int ringDepth;
+        bool decided;
+        Record coordinates;
+    };
+
+    TextFormat m_format;
+    RingSelection m_rings;
+    int m_threads;
+    std::vector<Record> m_records;
+    std::vector<JsonObject> m_objects;
+    std::vector<int> m_prefix;
+    std::vector<PolygonSet<T>> m_sets;
+    std::vector<long> m_errors;
+    int m_usedSets{};
+
+    static bool isLetter(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+    static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    /*
+     * Checks if the length letters of text spell the upper case word, in any
+     * case.
+     */
+    static bool isWord(const char* text, int length, const char* word);
+
+    /*
+     * Finds the bracket closing the one at text[begin], giving its position
+     * and the deepest nesting inside. Returns false when the text ends first.
+     */
+    static bool matchBrackets(const char* text, int begin, int size, char open, char close,
+                              int &end, int &maxDepth);
+
+    /*
+     * Scans the size bytes of text for complete geometries, and returns how
+     * many bytes can be dropped before the next scan.
+     */
+    int scanWkt(const char* text, int size, bool last);
+    int scanGeoJson(const char* text, int size, bool last);
+
+    /*
+     * Sets the ring depth told by the "type" of the innermost open object,
+     * keeping the coordinates it was waiting with when they match.
+     */
+    void setJsonType(int ringDepth);
+
+    /*
+     * Parses the rings of a record into set. On failure the set is left as
+     * it was.
+     */
+    bool parseRecord(const char* text, const Record &record, PolygonSet<T> &set) const;
+
+public:
+    explicit PolygonParser(TextFormat format, RingSelection rings = RingSelection::OUTER, int threads = 0);
+
+    /*
+     * Parses the complete geometries of the size bytes of text, replacing
+     * the polygons of the previous chunk. Returns the amount of bytes used:
+     * the rest start a geometry that continues in the next chunk, and should
+     * be given again at its start. When last is set every byte is used.
+     */
+    int parseChunk(const char* text, int size, bool last);
+
+    /*
+     * Returns the polygons of the last chunk, which are split in several
+     * sets kept in the order of the text.
+     */
+    int getSetCount() const { return m_usedSets; }
+    const PolygonSet<T>& getSet(int index) const { return m_sets[index]; }
+
+    /*
+     * Returns the amount of geometries skipped in the last chunk.
+     */
+    long getErrorCount() const;
+
+    /*
+     * Reads the whole stream chunk by chunk, calling sink(const
+     * PolygonSet<T>&) with the polygons found, in order. Only one chunk is
+     * held at a time, so the stream may be larger than memory when sink
+     * doesn't keep every polygon.
+     */
+    template <class Sink>
+    ParseStats stream(std::istream &in, Sink sink, int chunkSize = 1 << 22);
+};
+
+template<class T>
+PolygonParser<T>::PolygonParser(TextFormat format, RingSelection rings, int threads)
+        : m_format{ format }, m_rings{ rings }, m_threads{ (threads > 0) ? threads : defaultThreadCount() }
+{}
+
+template<class T>
+bool PolygonParser<T>::isWord(const char* text, int length, const char* word) {
+    for(int i{}; i < length; ++i)
+    {
+        char upper{ (text[i] >= 'a' && text[i] <= 'z') ? static_cast<char>(text[i] - 'a' + 'A') : text[i] };
+        if (upper != word[i])
+        {
+            return false;
+        }
+    }
+    return word[length] == '\0';
+}
+
+template<class T>
+bool PolygonParser<T>::matchBrackets(const char* text, int begin, int size, char open, char close,
+                                     int &end, int &maxDepth) {
+    int depth{ };
+    maxDepth = 0;
+    for(int i{ begin }; i < size; ++i)
+    {
+        if (text[i] == open)
+        {
+            maxDepth = std::max(maxDepth, ++depth);
+        }
+        else if (text[i] == close && --depth == 0)
+        {
+            end = i + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class T>
+int PolygonParser<T>::scanWkt(const char* text, int size, bool last) {
+    int safe{ };
+    int i{ };
+    while (i < size)
+    {
+        if (!isLetter(text[i]))
+        {
+            safe = ++i;
+            continue;
+        }
+        int wordBegin{ i };
+        while (i < size && isLetter(text[i]))
+        {
+            ++i;
+        }
+        int wordLength{ i - wordBegin };
+        int ringDepth{ };
+        if (isWord(text + wordBegin, wordLength, "POLYGON"))
+        {
+            ringDepth = 2;
+        }
+        else if (isWord(text + wordBegin, wordLength, "MULTIPOLYGON"))
+        {
+            ringDepth = 3;
+        }
+        if (ringDepth == 0)
+        {
+            continue;
+        }
+        // dimension tags and spaces up to the body, which may be EMPTY
+        while (i < size && (isSpace(text[i]) || text[i] == 'Z' || text[i] == 'M' || text[i] == 'z' || text[i] == 'm'))
+        {
+            ++i;
+        }
+        if (i < size && text[i] != '(')
+        {
+            continue;
+        }
+        int end{ };
+        int maxDepth{ };
+        if (i == size || !matchBrackets(text, i, size, '(', ')', end, maxDepth))
+        {
+            if (last)
+            {
+                m_records.push_back(Record{ i, size, ringDepth });
+                return size;
+            }
+            return std::max(safe, m_records.empty() ? 0 : m_records.back().end);
+        }
+        m_records.push_back(Record{ i, end, ringDepth });
+        i = end;
+        safe = end;
+    }
+    return last ? size : std::max(safe, m_records.empty() ? 0 : m_records.back().end);
+}
+
+template<class T>
+void PolygonParser<T>::setJsonType(int ringDepth) {
+    JsonObject &object{ m_objects.back() };
+    object.ringDepth = ringDepth;
+    if (object.coordinates.begin >= 0)
+    {
+        if (object.coordinates.ringDepth == ringDepth)
+        {
+            // records stay in the order of the text
+            auto next{ std::upper_bound(m_records.begin(), m_records.end(), object.coordinates.begin,
+                                        [](int begin, const Record &r) { return begin < r.begin; }) };
+            m_records.insert(next, object.coordinates);
+        }
+        object.coordinates.begin = -1;
+        object.decided = true;
+    }
+}
+
+template<class T>
+int PolygonParser<T>::scanGeoJson(const char* text, int size, bool last) {
+    m_objects.clear();
+    // position of the quote closing the string starting at begin
+    auto stringEnd = [&](int begin) {
+        int j{ begin };
+        while (j < size && text[j] != '"')
+        {
+            j += (text[j] == '\\') ? 2 : 1;
+        }
+        return j;
+    };
+    int safe{ };
+    int i{ };
+    while (i < size)
+    {
+        if (text[i] == '{')
+        {
+            m_objects.push_back(JsonObject{ i, 0, false, Record{ -1, -1, 0 } });
+        }
+        else if (text[i] == '}' && !m_objects.empty())
+        {
+            // coordinates still waiting belong to an object without a type
+            m_objects.pop_back();
+        }
+        if (text[i] != '"')
+        {
+            safe = ++i;
+            continue;
+        }
+        int keyBegin{ i + 1 };
+        i = stringEnd(keyBegin);
+        if (i >= size)
+        {
+            break;
+        }
+        bool isCoordinates{ i - keyBegin == 11 && std::memcmp(text + keyBegin, "coordinates", 11) == 0 };
+        bool isType{ i - keyBegin == 4 && std::memcmp(text + keyBegin, "type", 4) == 0 };
+        ++i;
+        if (!isCoordinates && !isType)
+        {
+            continue;
+        }
+        while (i < size && (isSpace(text[i]) || text[i] == ':'))
+        {
+            ++i;
+        }
+        if (isType)
+        {
+            if (i < size && text[i] != '"')
+            {
+                continue;
+            }
+            int valueBegin{ i + 1 };
+            i = stringEnd(valueBegin);
+            if (i >= size)
+            {
+                break;
+            }
+            int length{ i - valueBegin };
+            int ringDepth{ -1 };
+            if (length == 7 && std::memcmp(text + valueBegin, "Polygon", 7) == 0)
+            {
+                ringDepth = 2;
+            }
+            else if (length == 12 && std::memcmp(text + valueBegin, "MultiPolygon", 12) == 0)
+            {
+                ringDepth = 3;
+            }
+            if (!m_objects.empty())
+            {
+                setJsonType(ringDepth);
+            }
+            ++i;
+            continue;
+        }
+        if (i < size && text[i] != '[')
+        {
+            continue;
+        }
+        int end{ };
+        int maxDepth{ };
+        if (i == size || !matchBrackets(text, i, size, '[', ']', end, maxDepth))
+        {
+            break;
+        }
+        // Polygon nests its positions three arrays deep, MultiPolygon four
+        if (!m_objects.empty() && (maxDepth == 3 || maxDepth == 4))
+        {
+            JsonObject &object{ m_objects.back() };
+            Record record{ i, end, maxDepth - 1 };
+            if (object.ringDepth == 0)
+            {
+                object.coordinates = record;
+            }
+            else
+            {
+                if (object.ringDepth == record.ringDepth)
+                {
+                    m_records.push_back(record);
+                }
+                object.decided = true;
+            }
+        }
+        i = end;
+        safe = end;
+    }
+    if (last)
+    {
+        return size;
+    }
+    int used{ std::max(safe, m_records.empty() ? 0 : m_records.back().end) };
+    // an object that may still give a polygon is scanned again from its
+    // start in the next chunk, along with the records found inside it
+    for(const JsonObject &object: m_objects)
+    {
+        if (object.ringDepth >= 0 && !object.decided)
+        {
+            used = std::min(used, object.begin);
+            break;
+        }
+    }
+    while (!m_records.empty() && m_records.back().begin >= used)
+    {
+        m_records.pop_back();
+    }
+    return used;
+}
+
+template<class T>
+bool PolygonParser<T>::parseRecord(const char* text, const Record &record, PolygonSet<T> &set) const {
+    bool json{ m_format == TextFormat::GEOJSON };
+    char open{ json ? '[' : '(' };
+    char close{ json ? ']' : ')' };
+    // positions are arrays of their own in GeoJSON, and ',' separated in WKT
+    int positionDepth{ json ? record.ringDepth + 1 : record.ringDepth };
+    int startLength{ set.getLength() };
+
+    int depth{ };
+    int ringInPolygon{ };
+    bool keepRing{ };
+    int ringLength{ };
+    T coordinates[2]{};
+    int coordinateCount{ };
+    Punto<T> first{};
+    Punto<T> pending{};
+
+    // the previous vertex is held back, since the last one closes the ring
+    auto endPosition = [&]() {
+        if (coordinateCount >= 2 && keepRing)
+        {
+            Punto<T> p{ coordinates[0], coordinates[1] };
+            if (ringLength == 0)
+            {
+                first = p;
+            }
+            else
+            {
+                set.pushVertex(pending);
+            }
+            pending = p;
+            ++ringLength;
+        }
+        coordinateCount = 0;
+    };
+
+    const char* p{ text + record.begin };
+    const char* last{ text + record.end };
+    while (p < last)
+    {
+        char c{ *p };
+        if (c == open)
+        {
+            ++depth;
+            if (depth == record.ringDepth)
+            {
+                keepRing = (ringInPolygon == 0) || (m_rings == RingSelection::ALL);
+                ringLength = 0;
+                coordinateCount = 0;
+            }
+            ++p;
+        }
+        else if (c == close)
+        {
+            if (depth == positionDepth)
+            {
+                endPosition();
+            }
+            if (depth == record.ringDepth)
+            {
+                if (keepRing && ringLength > 0)
+                {
+                    if (ringLength == 1 || pending.getX() != first.getX() || pending.getY() != first.getY())
+                    {
+                        set.pushVertex(pending);
+                    }
+                    set.endPolygon();
+                }
+                ++ringInPolygon;
+            }
+            else if (depth == record.ringDepth - 1)
+            {
+                ringInPolygon = 0;
+            }
+            if (--depth < 0)
+            {
+                break;
+            }
+            ++p;
+        }
+        else if (c == ',')
+        {
+            if (!json && depth == positionDepth)
+            {
+                endPosition();
+            }
+            ++p;
+        }
+        else if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.')
+        {
+            if (depth != positionDepth)
+            {
+                break;
+            }
+            p += (c == '+') ? 1 : 0;
+            T value{};
+            std::from_chars_result result{ std::from_chars(p, last, value) };
+            if (result.ec != std::errc{})
+            {
+                break;
+            }
+            if (coordinateCount < 2)
+            {
+                coordinates[coordinateCount] = value;
+            }
+            // Z and M values are read and dropped
+            ++coordinateCount;
+            p = result.ptr;
+        }
+        else if (isSpace(c) || (isLetter(c) && depth < positionDepth))
+        {
+            // letters only name EMPTY parts
+            ++p;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (p != last || depth != 0)
+    {
+        set.truncate(startLength);
+        return false;
+    }
+    return true;
+}
+
+template<class T>
+int PolygonParser<T>::parseChunk(const char* text, int size, bool last) {
+    m_records.clear();
+    int used{ (m_format == TextFormat::WKT) ? scanWkt(text, size, last) : scanGeoJson(text, size, last) };
+
+    int count{ static_cast<int>(m_records.size()) };
+    m_prefix.resize(static_cast<std::size_t>(count) + 1);
+    m_prefix[0] = 0;
+    for(int i{}; i < count; ++i)
+    {
+        m_prefix[i + 1] = m_prefix[i] + (m_records[i].end - m_records[i].begin);
+    }
+
+    // below this amount of text per thread the threads cost more than they save
+    const int minBytes{ 1 << 16 };
+    m_usedSets = std::max(1, std::min({ m_threads, count, m_prefix[count] / minBytes }));
+    if (static_cast<int>(m_sets.size()) < m_usedSets)
+    {
+        m_sets.resize(static_cast<std::size_t>(m_usedSets));
+    }
+    m_errors.assign(static_cast<std::size_t>(m_usedSets), 0);
+
+    // set s parses the records whose text starts in its share of the bytes
+    std::vector<int> bounds(static_cast<std::size_t>(m_usedSets) + 1, count);
+    bounds[0] = 0;
+    for(int s{ 1 }; s < m_usedSets; ++s)
+    {
+        long target{ static_cast<long>(m_prefix[count]) * s / m_usedSets };
+        bounds[s] = static_cast<int>(std::lower_bound(m_prefix.begin(), m_prefix.end() - 1, target) - m_prefix.begin());
+    }
+    parallelFor(m_usedSets, [&](int begin, int end) {
+        for(int s{ begin }; s < end; ++s)
+        {
+            m_sets[s].clear();
+            for(int r{ bounds[s] }; r < bounds[s + 1]; ++r)
+            {
+                if (!parseRecord(text, m_records[r], m_sets[s]))
+                {
+                    ++m_errors[s];
+                }
+            }
+        }
+    }, m_usedSets, 1);
+    return used;
+}
+
+template<class T>
+long PolygonParser<T>::getErrorCount() const {
+    long errors{ };
+    for(int s{}; s < m_usedSets; ++s)
+    {
+        errors += m_errors[s];
+    }
+    return errors;
+}
+
+template<class T>
+template<class Sink>
+ParseStats PolygonParser<T>::stream(std::istream &in, Sink sink, int chunkSize) {
+    ParseStats stats{};
+    auto start{ std::chrono::steady_clock::now() };
+    std::vector<char> buffer(static_cast<std::size_t>(std::max(chunkSize, 1 << 10)));
+    int filled{ };
+    bool last{ };
+    while (!last)
+    {
+        in.read(buffer.data() + filled, static_cast<std::streamsize>(buffer.size()) - filled);
+        int read{ static_cast<int>(in.gcount()) };
+        filled += read;
+        stats.bytes += static_cast<std::size_t>(read);
+        last = !in;
+
+        int used{ parseChunk(buffer.data(), filled, last) };
+        for(int s{}; s < getSetCount(); ++s)
+        {
+            stats.polygons += getSet(s).getLength();
+            stats.vertices += getSet(s).getVertexCount();
+            sink(getSet(s));
+        }
+        stats.errors += getErrorCount();
+
+        // the geometry cut by the end of the chunk moves to the front
+        std::memmove(buffer.data(), buffer.data() + used, static_cast<std::size_t>(filled - used));
+        filled -= used;
+        if (filled == static_cast<int>(buffer.size()))
+        {
+            buffer.resize(2 * buffer.size());
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+/*
+ * Appends to out the polygons of the size bytes of text.
+ */
+template <class T>
+ParseStats parsePolygons(const char* text, int size, TextFormat format, PolygonSet<T> &out,
+                         RingSelection rings = RingSelection::OUTER, int threads = 0)
+{
+    ParseStats stats{};
+    auto start{ std::chrono::steady_clock::now() };
+    PolygonParser<T> parser{ format, rings, threads };
+    parser.parseChunk(text, size, true);
+    for(int s{}; s < parser.getSetCount(); ++s)
+    {
+        const PolygonSet<T> &set{ parser.getSet(s) };
+        for(int i{}; i < set.getLength(); ++i)
+        {
+            out.push_back(set.getVertices() + set.getOffsets()[i], set.polygonLength(i));
+        }
+        stats.polygons += set.getLength();
+        stats.vertices += set.getVertexCount();
+    }
+    stats.bytes = static_cast<std::size_t>(size);
+    stats.errors = parser.getErrorCount();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+/*
+ * Appends to out the polygons of the whole stream.
+ */
+template <class T>
+ParseStats parsePolygons(std::istream &in, TextFormat format, PolygonSet<T> &out,
+                         RingSelection rings = RingSelection::OUTER, int threads = 0)
+{
+    PolygonParser<T> parser{ format, rings, threads };
+    return parser.stream(in, [&out](const PolygonSet<T> &set) {
+        for(int i{}; i < set.getLength(); ++i)
+        {
+            out.push_back(set.getVertices() + set.getOffsets()[i], set.polygonLength(i));
+        }
+    });
+}
+
+#endif //ELEM_GEOMETRICOS_POLYGONPARSER_H
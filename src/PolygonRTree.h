@@ -0,0 +1,625 @@
+//
+// Static R-tree over the bounding boxes of a layer of polygons, bulk loaded
+// with Sort-Tile-Recursive packing, for finding the polygons containing,
+// overlapping or nearest to a point.
+//
+
+#ifndef ELEM_GEOMETRICOS_POLYGONRTREE_H
+#define ELEM_GEOMETRICOS_POLYGONRTREE_H
+
+#include "Poligono.h"
+#include "PolygonSet.h"
+#include "BinaryFormat.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <vector>
+
+/*
+ * Children of every node of a PolygonRTree. Part of the file format.
+ */
+const int RTREE_NODE_SIZE{ 16 };
+
+/*
+ * Room for the nodes pending in a depth first search: a tree of up to 2^31
+ * polygons has at most 9 levels, each leaving at most RTREE_NODE_SIZE-1
+ * siblings behind.
+ */
+const int RTREE_STACK_SIZE{ 9 * RTREE_NODE_SIZE };
+
+/*
+ * Axis aligned box, with its bounds included. A box with min above max is
+ * empty, and it's what an empty polygon has.
+ */
+template <class T>
+struct BoundingBox
+{
+    T minX;
+    T minY;
+    T maxX;
+    T maxY;
+
+    /*
+     * Returns the box of the length given points, empty when there are none.
+     */
+    static BoundingBox<T> of(const Punto<T>* puntos, int length);
+
+    bool contains(const Punto<T> &p) const
+    {
+        return (p.getX() >= minX) & (p.getX() <= maxX) & (p.getY() >= minY) & (p.getY() <= maxY);
+    }
+
+    bool intersects(const BoundingBox<T> &box) const
+    {
+        return (box.minX <= maxX) & (box.maxX >= minX) & (box.minY <= maxY) & (box.maxY >= minY);
+    }
+
+    /*
+     * Returns the squared distance from p to the box, 0 when it's inside.
+     */
+    double distance2(const Punto<T> &p) const;
+};
+
+/*
+ * Packed R-tree over the bounding boxes of the polygons of a PolygonSet or a
+ * MappedGeometry, which must outlive it. Queries check the boxes first and
+ * then run pointInside only on the polygons whose box passed.
+ * The boxes are stored level by level in a single array, from the polygon
+ * boxes in leaf order up to the root. Sort-Tile-Recursive packing fills
+ * every node but the last of each level, so the children of entry j of a
+ * level are the entries j*RTREE_NODE_SIZE to (j+1)*RTREE_NODE_SIZE-1 of the
+ * level below, and no child pointers are stored.
+ * Building takes O(n log n). The tree can be written next to the polygon
+ * file and mapped back in place like MappedGeometry.
+ */
+template <class T>
+class PolygonRTree
+{
+private:
+    const Punto<T>* m_vertices{};
+    const int* m_offsets{};
+    int m_length{};
+    BinaryStatus m_status{ BinaryStatus::OK };
+
+    // the boxes and the polygon of each leaf entry, either built here or
+    // mapped from a file
+    std::vector<BoundingBox<T>> m_ownBoxes;
+    std::vector<int> m_ownIds;
+    MappedFile m_file;
+    const BoundingBox<T>* m_boxes{};
+    const int* m_ids{};
+    std::vector<int> m_levelStart;
+
+    /*
+     * Sets where each level starts for the current amount of polygons.
+     */
+    void setLevels();
+
+    int levelCount(int level) const { return m_levelStart[level + 1] - m_levelStart[level]; }
+    int getTopLevel() const { return static_cast<int>(m_levelStart.size()) - 2; }
+
+    /*
+     * Sorts ids, whose boxes have the given centers, so that every run of
+     * capacity of them from the start forms a node, recursively down to the
+     * leaves.
+     */
+    static void sortTiles(int* ids, int count, long capacity, const std::vector<double> &centerX,
+                          const std::vector<double> &centerY);
+
+    void build();
+    BinaryStatus load();
+
+    /*
+     * Calls visit(polygon) for every polygon whose box passes accept(box),
+     * as long as visit returns true.
+     */
+    template <class Accept, class Visit>
+    void search(Accept accept, Visit visit) const;
+
+    /*
+     * Returns the squared distance from p to the polygon, 0 when it's inside.
+     */
+    double polygonDistance2(const Punto<T> &p, int index) const;
+
+public:
+    /*
+     * Builds the tree over the polygons, a PolygonSet or a MappedGeometry.
+     */
+    template <class Polygons>
+    explicit PolygonRTree(const Polygons &polygons);
+
+    /*
+     * Maps the tree written by write over the same polygons from the file at
+     * path. getStatus tells whether it worked; a tree that failed to load
+     * holds no polygon.
+     */
+    template <class Polygons>
+    PolygonRTree(const std::string &path, const Polygons &polygons);
+
+    PolygonRTree(const PolygonRTree&) = delete;
+    PolygonRTree& operator=(const PolygonRTree&) = delete;
+    PolygonRTree(PolygonRTree&&) noexcept = default;
+    PolygonRTree& operator=(PolygonRTree&&) noexcept = default;
+
+    BinaryStatus getStatus() const { return m_status; }
+    bool isValid() const { return m_status == BinaryStatus::OK; }
+
+    /*
+     * Returns the amount of polygons indexed.
+     */
+    int getLength() const { return m_length; }
+
+    /*
+     * Returns the amount of levels of nodes above the polygon boxes.
+     */
+    int getHeight() const { return getTopLevel(); }
+
+    /*
+     * Returns a read only Poligono view of the polygon at the position index.
+     * Editing it copies its vertices, leaving the indexed ones untouched.
+     */
+    const Poligono<T> operator[] (int index) const;
+
+    /*
+     * Returns the index of a polygon containing p, or -1 when there's none.
+     * For polygons that don't overlap, like a partition in postal areas,
+     * it's the only one.
+     */
+    int locate(const Punto<T> &p) const;
+
+    /*
+     * Stores in out[i] locate(puntos[i]) for the count given points,
+     * splitting them across threads. When threads is 0 one per hardware
+     * thread is used.
+     */
+    void locateAll(const Punto<T>* puntos, int count, int* out, int threads = 0) const;
+
+    /*
+     * Appends to out the index of every polygon containing p.
+     */
+    void containing(const Punto<T> &p, std::vector<int> &out) const;
+
+    /*
+     * Appends to out the index of every polygon whose bounding box
+     * intersects box.
+     */
+    void intersecting(const BoundingBox<T> &box, std::vector<int> &out) const;
+
+    /*
+     * Appends to out the indices of the k polygons nearest to p, nearest
+     * first, with the polygons containing p at distance 0. Nodes are visited
+     * best first by the distance to their boxes, and the exact distance is
+     * only computed for polygons that could still be among the k.
+     */
+    void nearest(const Punto<T> &p, int k, std::vector<int> &out) const;
+
+    /*
+     * Writes the tree in the binary format of BinaryFormat.h, with kind
+     * RTREE. Returns whether the stream is still good.
+     */
+    bool write(std::ostream &out) const;
+};
+
+template<class T>
+BoundingBox<T> BoundingBox<T>::of(const Punto<T>* puntos, int length) {
+    BoundingBox<T> box{ std::numeric_limits<T>::max(), std::numeric_limits<T>::max(),
+                        std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest() };
+    for(int i{}; i < length; ++i)
+    {
+        box.minX = std::min(box.minX, puntos[i].getX());
+        box.minY = std::min(box.minY, puntos[i].getY());
+        box.maxX = std::max(box.maxX, puntos[i].getX());
+        box.maxY = std::max(box.maxY, puntos[i].getY());
+    }
+    return box;
+}
+
+template<class T>
+double BoundingBox<T>::distance2(const Punto<T> &p) const {
+    double x{ static_cast<double>(p.getX()) };
+    double y{ static_cast<double>(p.getY()) };
+    double dx{ std::max({ static_cast<double>(minX) - x, 0.0, x - static_cast<double>(maxX) }) };
+    double dy{ std::max({ static_cast<double>(minY) - y, 0.0, y - static_cast<double>(maxY) }) };
+    return dx * dx + dy * dy;
+}
+
+template<class T>
+template<class Polygons>
+PolygonRTree<T>::PolygonRTree(const Polygons &polygons)
+        : m_vertices{ polygons.getVertices() }, m_offsets{ polygons.getOffsets() },
+          m_length{ polygons.getLength() }
+{
+    setLevels();
+    build();
+}
+
+template<class T>
+template<class Polygons>
+PolygonRTree<T>::PolygonRTree(const std::string &path, const Polygons &polygons)
+        : m_vertices{ polygons.getVertices() }, m_offsets{ polygons.getOffsets() },
+          m_length{ polygons.getLength() }, m_file{ path }
+{
+    setLevels();
+    m_status = load();
+    if (m_status != BinaryStatus::OK)
+    {
+        m_length = 0;
+        m_boxes = nullptr;
+        m_ids = nullptr;
+        setLevels();
+    }
+}
+
+template<class T>
+void PolygonRTree<T>::setLevels() {
+    m_levelStart.assign(1, 0);
+    int count{ m_length };
+    do
+    {
+        m_levelStart.push_back(m_levelStart.back() + count);
+        count = (count + RTREE_NODE_SIZE - 1) / RTREE_NODE_SIZE;
+    } while (m_levelStart.back() - m_levelStart[m_levelStart.size() - 2] > 1);
+}
+
+template<class T>
+void PolygonRTree<T>::sortTiles(int* ids, int count, long capacity, const std::vector<double> &centerX,
+                                const std::vector<double> &centerY) {
+    if (capacity <= 1 || count <= 1)
+    {
+        return;
+    }
+    auto byX{ [&](int a, int b) { return centerX[a] < centerX[b] || (centerX[a] == centerX[b] && a < b); } };
+    auto byY{ [&](int a, int b) { return centerY[a] < centerY[b] || (centerY[a] == centerY[b] && a < b); } };
+
+    // vertical slices of whole nodes, then nodes from bottom to top in each
+    long groups{ (count + capacity - 1) / capacity };
+    auto slices{ static_cast<long>(std::ceil(std::sqrt(static_cast<double>(groups)))) };
+    long sliceSize{ (groups + slices - 1) / slices * capacity };
+    std::sort(ids, ids + count, byX);
+    for(long slice{}; slice < count; slice += sliceSize)
+    {
+        int sliceCount{ static_cast<int>(std::min<long>(sliceSize, count - slice)) };
+        std::sort(ids + slice, ids + slice + sliceCount, byY);
+        for(long group{}; group < sliceCount; group += capacity)
+        {
+            int groupCount{ static_cast<int>(std::min<long>(capacity, sliceCount - group)) };
+            sortTiles(ids + slice + group, groupCount, capacity / RTREE_NODE_SIZE, centerX, centerY);
+        }
+    }
+}
+
+template<class T>
+void PolygonRTree<T>::build() {
+    std::vector<BoundingBox<T>> polygonBoxes;
+    std::vector<double> centerX;
+    std::vector<double> centerY;
+    polygonBoxes.reserve(static_cast<std::size_t>(m_length));
+    for(int i{}; i < m_length; ++i)
+    {
+        BoundingBox<T> box{ BoundingBox<T>::of(m_vertices + m_offsets[i], m_offsets[i + 1] - m_offsets[i]) };
+        polygonBoxes.push_back(box);
+        centerX.push_back((static_cast<double>(box.minX) + static_cast<double>(box.maxX)) / 2);
+        centerY.push_back((static_cast<double>(box.minY) + static_cast<double>(box.maxY)) / 2);
+    }
+
+    m_ownIds.resize(static_cast<std::size_t>(m_length));
+    for(int i{}; i < m_length; ++i)
+    {
+        m_ownIds[i] = i;
+    }
+    // the root's children each hold RTREE_NODE_SIZE^(levels-1) polygons
+    long capacity{ 1 };
+    for(int level{ 1 }; level < getTopLevel(); ++level)
+    {
+        capacity *= RTREE_NODE_SIZE;
+    }
+    sortTiles(m_ownIds.data(), m_length, capacity, centerX, centerY);
+
+    m_ownBoxes.resize(static_cast<std::size_t>(m_levelStart.back()));
+    for(int i{}; i < m_length; ++i)
+    {
+        m_ownBoxes[i] = polygonBoxes[m_ownIds[i]];
+    }
+    for(int level{ 1 }; level <= getTopLevel(); ++level)
+    {
+        int below{ m_levelStart[level - 1] };
+        int belowCount{ levelCount(level - 1) };
+        for(int j{}; j < levelCount(level); ++j)
+        {
+            int first{ j * RTREE_NODE_SIZE };
+            int last{ std::min(belowCount, first + RTREE_NODE_SIZE) };
+            BoundingBox<T> box{ m_ownBoxes[below + first] };
+            for(int c{ first + 1 }; c < last; ++c)
+            {
+                const BoundingBox<T> &child{ m_ownBoxes[below + c] };
+                box.minX = std::min(box.minX, child.minX);
+                box.minY = std::min(box.minY, child.minY);
+                box.maxX = std::max(box.maxX, child.maxX);
+                box.maxY = std::max(box.maxY, child.maxY);
+            }
+            m_ownBoxes[m_levelStart[level] + j] = box;
+        }
+    }
+    m_boxes = m_ownBoxes.data();
+    m_ids = m_ownIds.data();
+}
+
+template<class T>
+template<class Accept, class Visit>
+void PolygonRTree<T>::search(Accept accept, Visit visit) const {
+    if (m_length == 0)
+    {
+        return;
+    }
+    // pending nodes as their level and index in it
+    int levels[RTREE_STACK_SIZE];
+    int entries[RTREE_STACK_SIZE];
+    int top{ };
+    levels[0] = getTopLevel();
+    entries[0] = 0;
+    top = 1;
+    while (top > 0)
+    {
+        --top;
+        int level{ levels[top] };
+        int entry{ entries[top] };
+        if (!accept(m_boxes[m_levelStart[level] + entry]))
+        {
+            continue;
+        }
+        if (level == 0)
+        {
+            if (!visit(m_ids[entry]))
+            {
+                return;
+            }
+            continue;
+        }
+        int first{ entry * RTREE_NODE_SIZE };
+        int last{ std::min(levelCount(level - 1), first + RTREE_NODE_SIZE) };
+        // pushed backwards so the children come out in order
+        for(int c{ last - 1 }; c >= first; --c)
+        {
+            levels[top] = level - 1;
+            entries[top] = c;
+            ++top;
+        }
+    }
+}
+
+template<class T>
+const Poligono<T> PolygonRTree<T>::operator[](int index) const {
+    return Poligono<T>::view(m_vertices + m_offsets[index], m_offsets[index + 1] - m_offsets[index]);
+}
+
+template<class T>
+int PolygonRTree<T>::locate(const Punto<T> &p) const {
+    int found{ -1 };
+    search([&](const BoundingBox<T> &box) { return box.contains(p); },
+           [&](int polygon) {
+        if ((*this)[polygon].pointInside(p))
+        {
+            found = polygon;
+            return false;
+        }
+        return true;
+    });
+    return found;
+}
+
+template<class T>
+void PolygonRTree<T>::locateAll(const Punto<T>* puntos, int count, int* out, int threads) const {
+    parallelFor(count, [=](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            out[i] = locate(puntos[i]);
+        }
+    }, threads, 1 << 10);
+}
+
+template<class T>
+void PolygonRTree<T>::containing(const Punto<T> &p, std::vector<int> &out) const {
+    search([&](const BoundingBox<T> &box) { return box.contains(p); },
+           [&](int polygon) {
+        if ((*this)[polygon].pointInside(p))
+        {
+            out.push_back(polygon);
+        }
+        return true;
+    });
+}
+
+template<class T>
+void PolygonRTree<T>::intersecting(const BoundingBox<T> &box, std::vector<int> &out) const {
+    search([&](const BoundingBox<T> &node) { return node.intersects(box); },
+           [&](int polygon) {
+        out.push_back(polygon);
+        return true;
+    });
+}
+
+template<class T>
+double PolygonRTree<T>::polygonDistance2(const Punto<T> &p, int index) const {
+    const Poligono<T> pol{ (*this)[index] };
+    int length{ pol.getLength() };
+    if (length == 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (pol.pointInside(p))
+    {
+        return 0;
+    }
+    double x{ static_cast<double>(p.getX()) };
+    double y{ static_cast<double>(p.getY()) };
+    double best{ std::numeric_limits<double>::infinity() };
+    for(int i{}; i < length; ++i)
+    {
+        const Punto<T> &a{ pol[i] };
+        const Punto<T> &b{ pol[(i + 1 == length) ? 0 : i + 1] };
+        double ax{ static_cast<double>(a.getX()) };
+        double ay{ static_cast<double>(a.getY()) };
+        double dx{ static_cast<double>(b.getX()) - ax };
+        double dy{ static_cast<double>(b.getY()) - ay };
+        double length2{ dx * dx + dy * dy };
+        double t{ (length2 > 0) ? std::max(0.0, std::min(1.0, ((x - ax) * dx + (y - ay) * dy) / length2)) : 0.0 };
+        double ex{ ax + t * dx - x };
+        double ey{ ay + t * dy - y };
+        best = std::min(best, ex * ex + ey * ey);
+    }
+    return best;
+}
+
+template<class T>
+void PolygonRTree<T>::nearest(const Punto<T> &p, int k, std::vector<int> &out) const {
+    if (m_length == 0 || k <= 0)
+    {
+        return;
+    }
+    // queued by distance: nodes by their box and polygons by their exact
+    // distance once computed, which is never below the one of their box
+    struct Candidate
+    {
+        double distance2;
+        int level;
+        int entry;
+        bool exact;
+
+        bool operator>(const Candidate &other) const
+        {
+            return distance2 > other.distance2 || (distance2 == other.distance2 && exact < other.exact);
+        }
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+    int topLevel{ getTopLevel() };
+    queue.push(Candidate{ m_boxes[m_levelStart[topLevel]].distance2(p), topLevel, 0, false });
+    int found{ };
+    while (!queue.empty() && found < k)
+    {
+        Candidate candidate{ queue.top() };
+        queue.pop();
+        if (candidate.exact)
+        {
+            out.push_back(m_ids[candidate.entry]);
+            ++found;
+        }
+        else if (candidate.level == 0)
+        {
+            double distance2{ polygonDistance2(p, m_ids[candidate.entry]) };
+            if (distance2 != std::numeric_limits<double>::infinity())
+            {
+                queue.push(Candidate{ distance2, 0, candidate.entry, true });
+            }
+        }
+        else
+        {
+            int below{ candidate.level - 1 };
+            int first{ candidate.entry * RTREE_NODE_SIZE };
+            int last{ std::min(levelCount(below), first + RTREE_NODE_SIZE) };
+            for(int c{ first }; c < last; ++c)
+            {
+                queue.push(Candidate{ m_boxes[m_levelStart[below] + c].distance2(p), below, c, false });
+            }
+        }
+    }
+}
+
+/*
+ * Layout of an RTREE file, after the common header of BinaryFormat.h:
+ *
+ *   bytes 8-15   amount of polygons indexed
+ *   bytes 16-23  amount of boxes in all the levels
+ *   bytes 24-31  position of the first box, a multiple of 8
+ *   byte  32     the polygon of each leaf entry, as int32
+ *
+ * followed by the boxes as minX minY maxX maxY, level by level from the
+ * leaves, with RTREE_NODE_SIZE children per node.
+ */
+template<class T>
+bool PolygonRTree<T>::write(std::ostream &out) const {
+    static_assert(BinaryScalar<T>::code != 0, "the binary format stores int32, float and double coordinates");
+    static_assert(sizeof(BoundingBox<T>) == 4 * sizeof(T), "boxes are stored as their four coordinates");
+    std::uint64_t dataOffset{ BINARY_HEADER_SIZE + 4 * static_cast<std::uint64_t>(m_length) };
+    dataOffset = (dataOffset + 7) / 8 * 8;
+    out.write("EGEO", 4);
+    writeLittleEndian(out, &BINARY_FORMAT_VERSION, 1);
+    const unsigned char kindAndScalar[2]{ static_cast<unsigned char>(GeometryKind::RTREE), BinaryScalar<T>::code };
+    out.write(reinterpret_cast<const char*>(kindAndScalar), 2);
+    const std::uint64_t sizes[3]{ static_cast<std::uint64_t>(m_length),
+                                  static_cast<std::uint64_t>(m_levelStart.back()), dataOffset };
+    writeLittleEndian(out, sizes, 3);
+    std::vector<std::int32_t> ids(m_ids, m_ids + m_length);
+    writeLittleEndian(out, ids.data(), ids.size());
+    const char padding[8]{};
+    out.write(padding, static_cast<std::streamsize>(dataOffset - BINARY_HEADER_SIZE - 4 * ids.size()));
+    writeLittleEndian(out, reinterpret_cast<const T*>(m_boxes), 4 * static_cast<std::size_t>(m_levelStart.back()));
+    return out.good();
+}
+
+template<class T>
+BinaryStatus PolygonRTree<T>::load() {
+    static_assert(BinaryScalar<T>::code != 0, "the binary format stores int32, float and double coordinates");
+    static_assert(sizeof(BoundingBox<T>) == 4 * sizeof(T), "boxes are stored as their four coordinates");
+    if (!m_file.isOpen())
+    {
+        return BinaryStatus::CANT_OPEN;
+    }
+    char* data{ m_file.data() };
+    std::size_t size{ m_file.size() };
+    if (size < static_cast<std::size_t>(BINARY_HEADER_SIZE))
+    {
+        return BinaryStatus::TOO_SHORT;
+    }
+    if (std::memcmp(data, "EGEO", 4) != 0 || static_cast<unsigned char>(data[6]) != static_cast<unsigned char>(GeometryKind::RTREE))
+    {
+        return BinaryStatus::BAD_MAGIC;
+    }
+    std::uint16_t version{};
+    std::memcpy(&version, data + 4, sizeof(version));
+    swapToLittleEndian(&version, sizeof(version), 1);
+    if (version == 0 || version > BINARY_FORMAT_VERSION)
+    {
+        return BinaryStatus::BAD_VERSION;
+    }
+    if (static_cast<unsigned char>(data[7]) != BinaryScalar<T>::code)
+    {
+        return BinaryStatus::WRONG_SCALAR;
+    }
+    std::uint64_t sizes[3]{};
+    std::memcpy(sizes, data + 8, sizeof(sizes));
+    swapToLittleEndian(sizes, sizeof(std::uint64_t), 3);
+    std::uint64_t dataOffset{ sizes[2] };
+    // the tree must be the one of these polygons
+    if (sizes[0] != static_cast<std::uint64_t>(m_length)
+        || sizes[1] != static_cast<std::uint64_t>(m_levelStart.back()) || dataOffset % 8 != 0)
+    {
+        return BinaryStatus::BAD_OFFSETS;
+    }
+    if (dataOffset < BINARY_HEADER_SIZE + 4 * sizes[0] || dataOffset > size
+        || (size - dataOffset) / sizeof(BoundingBox<T>) < sizes[1])
+    {
+        return BinaryStatus::TOO_SHORT;
+    }
+
+    // the mapping is private, so converting in place doesn't touch the file
+    swapToLittleEndian(data + BINARY_HEADER_SIZE, 4, static_cast<std::size_t>(sizes[0]));
+    swapToLittleEndian(data + dataOffset, sizeof(T), 4 * static_cast<std::size_t>(sizes[1]));
+    m_ids = reinterpret_cast<const int*>(data + BINARY_HEADER_SIZE);
+    m_boxes = reinterpret_cast<const BoundingBox<T>*>(data + dataOffset);
+    for(int i{}; i < m_length; ++i)
+    {
+        if (m_ids[i] < 0 || m_ids[i] >= m_length)
+        {
+            return BinaryStatus::BAD_OFFSETS;
+        }
+    }
+    return BinaryStatus::OK;
+}
+
+#endif //ELEM_GEOMETRICOS_POLYGONRTREE_H
@@ -0,0 +1,191 @@
+//
+// Storage for many polygons in a single contiguous buffer.
+//
+
+#ifndef ELEM_GEOMETRICOS_POLYGONSET_H
+#define ELEM_GEOMETRICOS_POLYGONSET_H
+
+#include "Poligono.h"
+#include <functional>
+#include <iostream>
+#include <vector>
+
+/*
+ * Class for storing a whole layer of polygons. The vertices of every polygon
+ * are stored one after the other in a single array, and an offsets array
+ * tells where each polygon starts: polygon i has the vertices from
+ * offsets[i] to offsets[i+1]-1. Loading a layer thus needs two allocations
+ * instead of one per polygon, and since Punto needs no destruction, freeing
+ * the set releases every polygon at once.
+ * Polygons are accessed as Poligono views over the shared array, so all the
+ * Poligono operations work on them without copying any vertex.
+ */
+template <class T>
+class PolygonSet
+{
+private:
+    std::vector<Punto<T>> m_vertices;
+    std::vector<int> m_offsets{ 0 };
+
+public:
+    /*
+     * Creates an empty set.
+     */
+    PolygonSet() = default;
+
+    /*
+     * Returns the amount of polygons in the set.
+     */
+    int getLength() const { return static_cast<int>(m_offsets.size()) - 1; }
+
+    /*
+     * Returns the amount of vertices of all polygons in the set.
+     */
+    int getVertexCount() const { return static_cast<int>(m_vertices.size()); }
+
+    /*
+     * Returns the amount of vertices of the polygon at the position index.
+     */
+    int polygonLength(int index) const { return m_offsets[index + 1] - m_offsets[index]; }
+
+    /*
+     * Returns the shared vertex array.
+     */
+    const Punto<T>* getVertices() const { return m_vertices.data(); }
+
+    /*
+     * Returns the offsets array, which has getLength()+1 elements.
+     */
+    const int* getOffsets() const { return m_offsets.data(); }
+
+    /*
+     * Returns a Poligono view of the polygon at the position index. Its
+     * vertices can be edited, but it can't grow without leaving the set.
+     * The view is invalidated when polygons are added to the set.
+     */
+    Poligono<T> operator[] (int index);
+
+    /*
+     * Returns a read only Poligono view of the polygon at the position index.
+     * Editing it copies its vertices, leaving the set untouched.
+     */
+    const Poligono<T> operator[] (int index) const;
+
+    /*
+     * Reserves room for the given amount of polygons and vertices in total.
+     */
+    void reserve(int polygons, int vertices);
+
+    /*
+     * Appends a copy of the polygon pol at the end of the set. It may be a
+     * view of a polygon of the set itself.
+     */
+    void push_back(const Poligono<T> &pol);
+
+    /*
+     * Appends a polygon with a copy of the length points of the given array.
+     */
+    void push_back(const Punto<T>* puntos, int length);
+
+    /*
+     * Appends a vertex to the polygon currently being built. Once all of its
+     * vertices are added, endPolygon closes it.
+     */
+    void pushVertex(const Punto<T> &p) { m_vertices.push_back(p); }
+
+    /*
+     * Closes the polygon built with the vertices given to pushVertex since
+     * the last polygon was added.
+     */
+    void endPolygon() { m_offsets.push_back(getVertexCount()); }
+
+    /*
+     * Removes every polygon from the set, keeping the allocated memory for
+     * the next layer.
+     */
+    void clear();
+
+    /*
+     * Keeps only the first length polygons, dropping the rest along with any
+     * vertex given to pushVertex after the last endPolygon.
+     */
+    void truncate(int length);
+};
+
+template<class T>
+Poligono<T> PolygonSet<T>::operator[](int index) {
+    return Poligono<T>::view(m_vertices.data() + m_offsets[index], polygonLength(index));
+}
+
+template<class T>
+const Poligono<T> PolygonSet<T>::operator[](int index) const {
+    return Poligono<T>::view(m_vertices.data() + m_offsets[index], polygonLength(index));
+}
+
+template<class T>
+void PolygonSet<T>::reserve(int polygons, int vertices) {
+    m_offsets.reserve(static_cast<std::size_t>(polygons) + 1);
+    m_vertices.reserve(static_cast<std::size_t>(vertices));
+}
+
+template<class T>
+void PolygonSet<T>::push_back(const Poligono<T> &pol) {
+    if (pol.getLength() == 0)
+    {
+        endPolygon();
+        return;
+    }
+    push_back(&pol[0], pol.getLength());
+}
+
+template<class T>
+void PolygonSet<T>::push_back(const Punto<T>* puntos, int length) {
+    const Punto<T>* begin{ m_vertices.data() };
+    std::less<const Punto<T>*> before{};
+    if (length > 0 && !before(puntos, begin) && before(puntos, begin + m_vertices.size()))
+    {
+        // the points belong to the set, as for push_back(set[i]), so they
+        // are copied by position once growing can't move them any more
+        std::size_t first{ static_cast<std::size_t>(puntos - begin) };
+        m_vertices.reserve(m_vertices.size() + static_cast<std::size_t>(length));
+        for(std::size_t i{ first }; i < first + static_cast<std::size_t>(length); ++i)
+        {
+            m_vertices.push_back(m_vertices[i]);
+        }
+    }
+    else
+    {
+        m_vertices.insert(m_vertices.end(), puntos, puntos + length);
+    }
+    endPolygon();
+}
+
+template<class T>
+void PolygonSet<T>::truncate(int length) {
+    m_offsets.resize(static_cast<std::size_t>(length) + 1);
+    m_vertices.resize(static_cast<std::size_t>(m_offsets.back()));
+}
+
+template<class T>
+void PolygonSet<T>::clear() {
+    m_vertices.clear();
+    m_offsets.assign(1, 0);
+}
+
+template <class T>
+std::ostream& operator<<(std::ostream &out, const PolygonSet<T> &set)
+{
+    out << "{";
+    for(int i{}; i < set.getLength(); ++i)
+    {
+        out << set[i];
+        if (i != (set.getLength()-1))
+        {
+            out << ", ";
+        }
+    }
+    out << "}";
+    return out;
+}
+
+#endif //ELEM_GEOMETRICOS_POLYGONSET_H
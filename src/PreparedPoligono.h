@@ -0,0 +1,270 @@
+//
+// Polygon prepared for repeated point queries.
+//
+
+#ifndef ELEM_GEOMETRICOS_PREPAREDPOLIGONO_H
+#define ELEM_GEOMETRICOS_PREPAREDPOLIGONO_H
+
+#include "Poligono.h"
+#include "BatchContainment.h"
+#include "PointBuffer.h"
+#include <algorithm>
+#include <vector>
+
+/*
+ * Amount of edges from which batches of points against a convex polygon are
+ * answered with the binary searches over its chains. Below it the vectorized
+ * walk over every edge is faster.
+ */
+const int CONVEX_BATCH_MIN_EDGES{ 64 };
+
+/*
+ * Read only copy of a Poligono meant to be queried many times. It keeps the
+ * bounding box of the polygon and a flat table with the data of every edge
+ * (its y range, diffX, diffY and doubleAreaSegment), so queries do not build
+ * any Segmento and points outside the bounding box are rejected right away.
+ * The edges are sorted by the lowest y they reach, so a query only scans the
+ * edges starting below the point.
+ * The edges of a convex polygon form a chain going up and a chain going
+ * down, and the horizontal ray of a point crosses at most one edge of each.
+ * Those two edges are found by binary search, so queries take O(log n), and
+ * they are tested with the same crossesToTheRight rule as every other edge.
+ * Either way answers are the same as the ones given by Poligono::pointInside.
+ */
+template <class T>
+class PreparedPoligono
+{
+private:
+    T m_minX{};
+    T m_minY{};
+    T m_maxX{};
+    T m_maxY{};
+    std::vector<ContainmentEdge<T>> m_edges;
+    // lowest y of each edge of m_edges, ascending
+    std::vector<T> m_edgeMinY;
+    bool m_convex{};
+    // positions in m_edges of the edges going up and of the edges going
+    // down, when the polygon is convex. The y ranges of the edges of a chain
+    // follow one another without overlapping
+    std::vector<int> m_rising;
+    std::vector<int> m_falling;
+
+    /*
+     * Walks the edges starting below p, as Poligono::pointInside does.
+     */
+    bool crossingsInside(const Punto<T> &p) const;
+
+    /*
+     * Returns whether the horizontal ray of p crosses to its right the one
+     * edge of the chain that may straddle it.
+     */
+    bool chainCrosses(const std::vector<int> &chain, const Punto<T> &p) const;
+
+public:
+    /*
+     * Prepares the given polygon. The Poligono is not referenced afterwards,
+     * so it may be destroyed or edited without affecting this object.
+     */
+    explicit PreparedPoligono(const Poligono<T> &pol);
+
+    /*
+     * Returns the amount of edges kept by the prepared polygon. Horizontal
+     * edges are never crossed by the ray and thus are not stored.
+     */
+    int getEdgeCount() const { return static_cast<int>(m_edges.size()); }
+
+    /*
+     * Returns whether the polygon was found convex, so queries take the
+     * logarithmic path.
+     */
+    bool isConvex() const { return m_convex; }
+
+    /*
+     * Returns the corners of the bounding box of the polygon.
+     */
+    Punto<T> getMin() const { return Punto<T>{ m_minX, m_minY }; }
+    Punto<T> getMax() const { return Punto<T>{ m_maxX, m_maxY }; }
+
+    /*
+     * Returns whether p lies in the bounding box of the polygon.
+     */
+    bool inBoundingBox(const Punto<T> &p) const;
+
+    /*
+     * Checks if a Punto p lies inside the polygon using the odd-even
+     * algorithm.
+     */
+    bool pointInside(const Punto<T> &p) const;
+
+    /*
+     * Checks which of the count points given by the coordinate arrays xs and
+     * ys lie inside the polygon, storing the answer for (xs[i], ys[i]) in
+     * inside[i].
+     */
+    void pointsInside(const T* xs, const T* ys, int count, bool* inside) const;
+
+    /*
+     * Same as above for an array of count points Punto.
+     */
+    void pointsInside(const Punto<T>* puntos, int count, bool* inside) const;
+
+    /*
+     * Same as above for the points of a PointBuffer.
+     */
+    void pointsInside(const PointBuffer<T> &puntos, bool* inside) const;
+};
+
+template<class T>
+PreparedPoligono<T>::PreparedPoligono(const Poligono<T> &pol)
+{
+    int length{ pol.getLength() };
+    if (length == 0)
+    {
+        return;
+    }
+
+    m_minX = m_maxX = pol[0].getX();
+    m_minY = m_maxY = pol[0].getY();
+    for(int i{ 1 }; i < length; ++i)
+    {
+        m_minX = std::min(m_minX, pol[i].getX());
+        m_maxX = std::max(m_maxX, pol[i].getX());
+        m_minY = std::min(m_minY, pol[i].getY());
+        m_maxY = std::max(m_maxY, pol[i].getY());
+    }
+
+    m_edges.reserve(static_cast<std::size_t>(length));
+    for(int i{}; i < length; ++i)
+    {
+        const Punto<T> &start{ pol[i] };
+        const Punto<T> &end{ pol[(i+1 == length) ? 0 : i+1] };
+        if (start.getY() != end.getY())
+        {
+            m_edges.push_back(containmentEdge(start, end));
+        }
+    }
+
+    std::sort(m_edges.begin(), m_edges.end(),
+              [](const ContainmentEdge<T> &e1, const ContainmentEdge<T> &e2) {
+        return std::min(e1.startY, e1.endY) < std::min(e2.startY, e2.endY);
+    });
+
+    m_edgeMinY.reserve(m_edges.size());
+    for(const ContainmentEdge<T> &e: m_edges)
+    {
+        m_edgeMinY.push_back(std::min(e.startY, e.endY));
+    }
+
+    if (!pol.isConvex())
+    {
+        return;
+    }
+    for(int i{}; i < getEdgeCount(); ++i)
+    {
+        (m_edges[i].startY < m_edges[i].endY ? m_rising : m_falling).push_back(i);
+    }
+    // rounding may let isConvex accept a polygon whose chains overlap, which
+    // then takes the walk over the edges
+    auto disjoint = [this](const std::vector<int> &chain) {
+        for(std::size_t i{ 1 }; i < chain.size(); ++i)
+        {
+            const ContainmentEdge<T> &previous{ m_edges[chain[i - 1]] };
+            if (std::max(previous.startY, previous.endY) > m_edgeMinY[chain[i]])
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    m_convex = disjoint(m_rising) && disjoint(m_falling);
+    if (!m_convex)
+    {
+        m_rising.clear();
+        m_falling.clear();
+    }
+}
+
+template<class T>
+bool PreparedPoligono<T>::inBoundingBox(const Punto<T> &p) const {
+    return (p.getX() >= m_minX) & (p.getX() <= m_maxX)
+           & (p.getY() >= m_minY) & (p.getY() <= m_maxY);
+}
+
+template<class T>
+bool PreparedPoligono<T>::pointInside(const Punto<T> &p) const {
+    // the ray at the top of the box crosses no edge either
+    if (!inBoundingBox(p) || p.getY() == m_maxY)
+    {
+        return false;
+    }
+    if (m_convex)
+    {
+        return chainCrosses(m_rising, p) != chainCrosses(m_falling, p);
+    }
+    return crossingsInside(p);
+}
+
+template<class T>
+bool PreparedPoligono<T>::chainCrosses(const std::vector<int> &chain, const Punto<T> &p) const {
+    T y{ p.getY() };
+    // the last edge starting below p, the earlier ones end below it too
+    auto next{ std::upper_bound(chain.begin(), chain.end(), y,
+                                [this](T value, int edge) { return value < m_edgeMinY[edge]; }) };
+    if (next == chain.begin())
+    {
+        return false;
+    }
+    const ContainmentEdge<T> &e{ m_edges[*(next - 1)] };
+    return (e.startY > y) != (e.endY > y) && crossesToTheRight(e, p.getX(), y);
+}
+
+template<class T>
+bool PreparedPoligono<T>::crossingsInside(const Punto<T> &p) const {
+    T y{ p.getY() };
+    int candidates{ static_cast<int>(std::upper_bound(m_edgeMinY.begin(), m_edgeMinY.end(), y)
+                                     - m_edgeMinY.begin()) };
+    int rightCrosses{ };
+    for(int i{}; i < candidates; ++i)
+    {
+        const ContainmentEdge<T> &e{ m_edges[i] };
+        if ((e.startY > y) != (e.endY > y) && crossesToTheRight(e, p.getX(), y))
+        {
+            ++rightCrosses;
+        }
+    }
+    // true if rightCrosses is odd (binary representation ends in 1)
+    return (rightCrosses & 1);
+}
+
+template<class T>
+void PreparedPoligono<T>::pointsInside(const T* xs, const T* ys, int count, bool* inside) const {
+    if (m_convex && getEdgeCount() >= CONVEX_BATCH_MIN_EDGES)
+    {
+        for(int i{}; i < count; ++i)
+        {
+            inside[i] = pointInside(Punto<T>{ xs[i], ys[i] });
+        }
+        return;
+    }
+    batchPointInside(m_edges.data(), getEdgeCount(), xs, ys, count, inside);
+}
+
+template<class T>
+void PreparedPoligono<T>::pointsInside(const PointBuffer<T> &puntos, bool* inside) const {
+    pointsInside(puntos.getXs(), puntos.getYs(), puntos.getLength(), inside);
+}
+
+template<class T>
+void PreparedPoligono<T>::pointsInside(const Punto<T>* puntos, int count, bool* inside) const {
+    if (m_convex && getEdgeCount() >= CONVEX_BATCH_MIN_EDGES)
+    {
+        for(int i{}; i < count; ++i)
+        {
+            inside[i] = pointInside(puntos[i]);
+        }
+        return;
+    }
+    batchPointInside(m_edges.data(), getEdgeCount(), puntos, count, inside);
+}
+
+#endif //ELEM_GEOMETRICOS_PREPAREDPOLIGONO_H
@@ -5,6 +5,7 @@
 #ifndef ELEM_GEOMETRICOS_PUNTO_H
 #define ELEM_GEOMETRICOS_PUNTO_H
 
+#include "CoordinateExpression.h"
 #include "FloatComparison.h"
 #include <iostream>
 
@@ -18,8 +19,37 @@ private:
     T m_x;
     T m_y;
     T m_z;
-private:
 
+public:
+    /*
+     * Creates a point Punto3D given the X, Y and Z coordinates, all of the
+     * same type.
+     */
+    constexpr Punto3D(T x = 0, T y = 0, T z = 0) noexcept
+            : m_x{ x }, m_y{ y }, m_z{ z }
+    {};
+
+    /*
+     * Copy constructor. Defaulted, so Punto3D stays trivially copyable like
+     * Punto.
+     */
+    constexpr Punto3D(const Punto3D<T>& copy) noexcept = default;
+
+    /*
+     * Evaluates an arithmetic expression of 3D points, see
+     * CoordinateExpression.h. Its coordinates must convert to T without
+     * narrowing.
+     */
+    template <class E, class = std::enable_if_t<isNodeOfKind<E, Point3DKind>()>>
+    constexpr Punto3D(const E &expression) noexcept
+            : m_x{ expression.getX() }, m_y{ expression.getY() }, m_z{ expression.getZ() }
+    {};
+
+    constexpr T getX() const noexcept { return m_x; }
+    constexpr T getY() const noexcept { return m_y; }
+    constexpr T getZ() const noexcept { return m_z; }
+
+    constexpr Punto3D<T>& operator= (const Punto3D<T>& punto) noexcept = default;
 };
 
 /*
@@ -37,131 +67,113 @@ public:
      * Creates a point Punto given the X and Y coordinates.
      * X and Y's types must be the same.
      */
-    Punto(T x = 0, T y=0)
+    constexpr Punto(T x = 0, T y=0) noexcept
             :  m_x{ x }, m_y{ y }
     {
     };
 
     /*
      * Copy constructor. Generates a new Punto with the same (x,y) coordinates
-     * as copy argument
+     * as copy argument. Defaulted, so Punto stays trivially copyable and
+     * lives in registers inside the loops.
      */
-    Punto(const Punto<T>& copy)
-            : m_x { copy.m_x }, m_y { copy.m_y }
-    {
-    };
-
+    constexpr Punto(const Punto<T>& copy) noexcept = default;
 
-    T getX() const { return m_x; }
-    T getY() const { return m_y; }
+    /*
+     * Evaluates an arithmetic expression of points, see
+     * CoordinateExpression.h. Its coordinates must convert to T without
+     * narrowing.
+     */
+    template <class E, class = std::enable_if_t<isNodeOfKind<E, PointKind>()>>
+    constexpr Punto(const E &expression) noexcept
+            : m_x{ expression.getX() }, m_y{ expression.getY() }
+    {};
 
-    // reminder that it's not ok to use Punto& here since we are creating a new
-    // object that will be out of scope and become garbage when the function
-    // returns
-    Punto<T> operator- () const;
+    constexpr T getX() const noexcept { return m_x; }
+    constexpr T getY() const noexcept { return m_y; }
 
     // reminder that it's ok to use Punto& here since we are returning this and
     // this will be properly destroyed when the (default) destructor is called
-    Punto<T>& operator= (const Punto<T>& punto);
+    constexpr Punto<T>& operator= (const Punto<T>& punto) noexcept = default;
 
 };
 
-/*
- * Assignment operator for Punto through another punto. Returns the newly
- * updated object to chain the = operator.
- */
-template<class T>
-Punto<T>& Punto<T>::operator=(const Punto<T> &punto) {
-    m_x = punto.m_x;
-    m_y = punto.m_y;
-
-    return *this;
-}
-
-/*
- * Unary minus for Punto
- * Returns a new Punto with coordinates whose signs where swapped
- */
-template<class T>
-Punto<T> Punto<T>::operator-() const {
-    return Punto<T>(-getX(), -getY());
-}
+// addition, subtraction, unary minus and the product by a scalar of points,
+// 2D and 3D, are the expression templates of CoordinateExpression.h
 
 /*
- * Addition between two points. The resulting Punto is obtained through
- * addition of the corresponding coordinates.
- * Both Punto can have different types. The result will be of whatever type
- * given by the implicit conversion (if there's any)
+ * Punto equality. Two points are equal if their coordinates are the same.
  */
-template <class T, class S>
-auto operator+(const Punto<T> &p1, const Punto<S> &p2) {
-    auto sumX{ p1.getX()+p2.getX() };
-    Punto<decltype(sumX)> res{ sumX, p1.getY()+p2.getY() };
-    return res;
+template <class T>
+constexpr bool operator==(const Punto<T> &p1, const Punto<T> &p2) noexcept {
+    return ((p1.getX() == p2.getX()) & (p1.getY() == p2.getY()));
 }
 
-
 /*
- * Binary substraction between two points.
+ * Specialization of equality for double Punto.
+ * Both coordinates must be close enough (by 1e-10) to be considered equal.
  */
-template <class T, class S>
-auto operator-(const Punto<T> &p1, const Punto<S> &p2) {
-    return p1 + (-p2);
+template<>
+constexpr bool operator==(const Punto<double> &p1, const Punto<double> &p2) noexcept
+{
+    return (withinEps(p1.getX(), p2.getX(), 1e-10, 1e-10)
+    & withinEps(p1.getY(), p2.getY(), 1e-10, 1e-10));
 }
 
 /*
- * Product between a point and a scalar s.
- * The result is a Punto with it's coordinates multiplied by s.
+ * Specialization of equality for float Punto.
+ * Both coordinates must be close enough (by 1e-7) to be considered equal.
  */
-template <class T, class S>
-auto operator*(const Punto<T> &p, S s) {
-    auto prodX{ p.getX()*s };
-    Punto<decltype(prodX)> res{ prodX, p.getY()*s };
-    return res;
+template<>
+constexpr bool operator==(const Punto<float> &p1, const Punto<float> &p2) noexcept
+{
+    return (withinEps(p1.getX(), p2.getX(), 1e-7f, 1e-7f)
+            & withinEps(p1.getY(), p2.getY(), 1e-7f, 1e-7f));
 }
 
-/*
- * Make scalar product commutative
- */
-template <class T, class S>
-auto operator*(S s, const Punto<T> &p) {
-    return p*s;
+template<class T>
+std::ostream& operator<< (std::ostream &out, const Punto<T> &p)
+{
+    out << "(" << p.getX() << ", " << p.getY() << ")";
+    return out;
 }
 
 /*
- * Punto equality. Two points are equal if their coordinates are the same.
+ * Punto3D equality. Two points are equal if their coordinates are the same.
  */
 template <class T>
-bool operator==(const Punto<T> &p1, const Punto<T> &p2) {
-    return ((p1.getX() == p2.getX()) & (p2.getY() == p2.getY()));
+constexpr bool operator==(const Punto3D<T> &p1, const Punto3D<T> &p2) noexcept {
+    return ((p1.getX() == p2.getX()) & (p1.getY() == p2.getY()) & (p1.getZ() == p2.getZ()));
 }
 
 /*
- * Specialization of equality for double Punto.
- * Both coordinates must be close enough (by 1e-10) to be considered equal.
+ * Specialization of equality for double Punto3D, with the tolerance of
+ * Punto<double>.
  */
 template<>
-bool operator==(const Punto<double> &p1, const Punto<double> &p2)
+constexpr bool operator==(const Punto3D<double> &p1, const Punto3D<double> &p2) noexcept
 {
     return (withinEps(p1.getX(), p2.getX(), 1e-10, 1e-10)
-    & withinEps(p1.getY(), p2.getY(), 1e-10, 1e-10));
+            & withinEps(p1.getY(), p2.getY(), 1e-10, 1e-10)
+            & withinEps(p1.getZ(), p2.getZ(), 1e-10, 1e-10));
 }
 
 /*
- * Specialization of equality for float Punto.
- * Both coordinates must be close enough (by 1e-7) to be considered equal.
+ * Specialization of equality for float Punto3D, with the tolerance of
+ * Punto<float>.
  */
 template<>
-bool operator==(const Punto<float> &p1, const Punto<float> &p2)
+constexpr bool operator==(const Punto3D<float> &p1, const Punto3D<float> &p2) noexcept
 {
     return (withinEps(p1.getX(), p2.getX(), 1e-7f, 1e-7f)
-            & withinEps(p1.getY(), p2.getY(), 1e-7f, 1e-7f));
+            & withinEps(p1.getY(), p2.getY(), 1e-7f, 1e-7f)
+            & withinEps(p1.getZ(), p2.getZ(), 1e-7f, 1e-7f));
 }
 
 template<class T>
-std::ostream& operator<< (std::ostream &out, const Punto<T> &p)
+std::ostream& operator<< (std::ostream &out, const Punto3D<T> &p)
 {
-    out << "(" << p.getX() << ", " << p.getY() << ")";
+    out << "(" << p.getX() << ", " << p.getY() << ", " << p.getZ() << ")";
     return out;
 }
 
@@ -0,0 +1,571 @@
+//
+// All pairs intersection of large amounts of segments.
+//
+
+#ifndef ELEM_GEOMETRICOS_SEGMENTINTERSECTION_H
+#define ELEM_GEOMETRICOS_SEGMENTINTERSECTION_H
+
+#include "Punto.h"
+#include "Segmento.h"
+#include "Predicates.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/*
+ * A pair of intersecting segments, given by their positions in the input
+ * array (first < second), and a point where they meet. When the segments
+ * overlap along a collinear stretch the point is the leftmost (and then
+ * lowest) point of the overlap.
+ */
+struct SegmentIntersection
+{
+    int first;
+    int second;
+    Punto<double> point;
+};
+
+/*
+ * Returns whether point p, collinear with the segment from a to b, lies
+ * inside the bounding box of the segment.
+ */
+inline bool withinSegmentBox(const Punto<double> &a, const Punto<double> &b, const Punto<double> &p)
+{
+    return std::min(a.getX(), b.getX()) <= p.getX() && p.getX() <= std::max(a.getX(), b.getX())
+           && std::min(a.getY(), b.getY()) <= p.getY() && p.getY() <= std::max(a.getY(), b.getY());
+}
+
+/*
+ * Returns whether the closed segments from a to b and from c to d have some
+ * point in common. The answer is exact, see orient2d.
+ */
+inline bool segmentsIntersect(const Punto<double> &a, const Punto<double> &b,
+                              const Punto<double> &c, const Punto<double> &d)
+{
+    double o1{ orient2d(a, b, c) };
+    double o2{ orient2d(a, b, d) };
+    double o3{ orient2d(c, d, a) };
+    double o4{ orient2d(c, d, b) };
+    if (((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)) && ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0)))
+    {
+        return true;
+    }
+    return (o1 == 0 && withinSegmentBox(a, b, c)) || (o2 == 0 && withinSegmentBox(a, b, d))
+           || (o3 == 0 && withinSegmentBox(c, d, a)) || (o4 == 0 && withinSegmentBox(c, d, b));
+}
+
+/*
+ * Bentley-Ottmann sweep over a set of segments. A vertical line sweeps the
+ * plane from left to right (and, at equal x, from bottom to top), stopping
+ * at the endpoints of the segments and at the crossings found so far, kept
+ * in the event queue. The status, a balanced tree, holds the segments cut by
+ * the sweep line ordered from bottom to top, and only segments that become
+ * neighbours there are tested against each other.
+ * At every event point all the segments through it are reported as
+ * intersecting each other, which handles shared endpoints and collinear
+ * overlaps. Orientation tests use the exact orient2d, so the points given as
+ * input are handled exactly; crossings in the interior of two segments are
+ * rounded to double.
+ * Use segmentIntersections below instead of this class.
+ */
+class SegmentSweep
+{
+private:
+    using Point = std::pair<double, double>;
+
+    /*
+     * Orders segments in the status by their height right after the current
+     * event point. Index -1 stands for the event point itself.
+     */
+    struct StatusOrder
+    {
+        const SegmentSweep* sweep;
+        bool operator()(int a, int b) const { return sweep->below(a, b); }
+    };
+
+    struct Event
+    {
+        std::vector<int> starting;
+        std::vector<int> ending;
+        std::vector<int> crossing;
+    };
+
+    int m_count;
+    std::vector<Punto<double>> m_left;
+    std::vector<Punto<double>> m_right;
+    Punto<double> m_sweep;
+    // the endpoints are known up front and sorted once, with the segment
+    // starting there, or -1-s for the right endpoint of segment s; crossings
+    // are queued apart
+    std::vector<std::pair<Point, int>> m_endpoints;
+    std::map<Point, std::vector<int>> m_crossings;
+    Event m_event;
+    std::vector<int> m_through;
+    std::vector<int> m_involved;
+    std::vector<int> m_inserted;
+    std::set<int, StatusOrder> m_status;
+    std::vector<std::set<int, StatusOrder>::iterator> m_positions;
+    std::vector<char> m_inStatus;
+    std::vector<char> m_atSweep;
+    std::unordered_set<long long> m_reported;
+    std::vector<SegmentIntersection> m_result;
+
+    /*
+     * Returns the position of the point p in the sweep order.
+     */
+    static Point key(const Punto<double> &p) { return Point{ p.getX(), p.getY() }; }
+
+    /*
+     * Sign of the position of the event point relative to segment s: positive
+     * when the point is above s, negative when below and zero when on it.
+     */
+    double sideOfSweep(int s) const { return orient2d(m_left[s], m_right[s], m_sweep); }
+
+    /*
+     * Returns the height of segment s at the x of the event point, rounded.
+     * Vertical segments give the height of the event point.
+     */
+    double heightAtSweep(int s) const;
+
+    /*
+     * Returns whether segment s passes through the event point up to the
+     * rounding error of a computed crossing.
+     */
+    bool nearSweep(int s) const;
+
+    /*
+     * Returns whether segment s passes exactly through the event point.
+     */
+    bool containsSweep(int s) const;
+
+    /*
+     * Strict order of the status, see StatusOrder.
+     */
+    bool below(int a, int b) const;
+
+    /*
+     * Records that a and b intersect at p, unless they were already reported.
+     * Returns whether they were new.
+     */
+    bool report(int a, int b, const Punto<double> &p);
+
+    /*
+     * Tests two neighbours of the status, scheduling their crossing when it's
+     * ahead of the sweep line. A crossing rounded onto or behind it is
+     * scheduled at the event point, to handle it again and swap them.
+     */
+    void checkNeighbours(int a, int b);
+
+    /*
+     * Processes the event at the given point.
+     */
+    void handle(const Punto<double> &p, const Event &event);
+
+public:
+    /*
+     * Prepares the sweep over the count segments given by pairs of points:
+     * segment i goes from endpoints[2*i] to endpoints[2*i+1].
+     */
+    template <class T>
+    SegmentSweep(const Punto<T>* endpoints, int count);
+
+    /*
+     * Runs the sweep and returns every intersecting pair.
+     */
+    std::vector<SegmentIntersection> run();
+};
+
+template <class T>
+SegmentSweep::SegmentSweep(const Punto<T>* endpoints, int count)
+        : m_count{ count }, m_status{ StatusOrder{ this } },
+          m_inStatus(static_cast<std::size_t>(count)), m_atSweep(static_cast<std::size_t>(count))
+{
+    m_left.reserve(static_cast<std::size_t>(count));
+    m_right.reserve(static_cast<std::size_t>(count));
+    m_endpoints.reserve(2 * static_cast<std::size_t>(count));
+    m_positions.resize(static_cast<std::size_t>(count), m_status.end());
+    for(int i{}; i < count; ++i)
+    {
+        Punto<double> start{ static_cast<double>(endpoints[2 * i].getX()), static_cast<double>(endpoints[2 * i].getY()) };
+        Punto<double> end{ static_cast<double>(endpoints[2 * i + 1].getX()), static_cast<double>(endpoints[2 * i + 1].getY()) };
+        if (key(end) < key(start))
+        {
+            std::swap(start, end);
+        }
+        m_left.push_back(start);
+        m_right.push_back(end);
+        m_endpoints.push_back(std::pair<Point, int>{ key(start), i });
+        // the segment leaves the status at the event of its right endpoint
+        m_endpoints.push_back(std::pair<Point, int>{ key(end), -1 - i });
+    }
+    std::sort(m_endpoints.begin(), m_endpoints.end());
+}
+
+inline double SegmentSweep::heightAtSweep(int s) const
+{
+    const Punto<double> &l{ m_left[s] };
+    const Punto<double> &r{ m_right[s] };
+    if (l.getX() == r.getX())
+    {
+        return m_sweep.getY();
+    }
+    double t{ (m_sweep.getX() - l.getX()) / (r.getX() - l.getX()) };
+    return l.getY() + t * (r.getY() - l.getY());
+}
+
+inline bool SegmentSweep::nearSweep(int s) const
+{
+    const Punto<double> &l{ m_left[s] };
+    const Punto<double> &r{ m_right[s] };
+    if (l.getX() == r.getX())
+    {
+        return false;
+    }
+    double scale{ std::max({ std::fabs(l.getX()), std::fabs(l.getY()), std::fabs(r.getX()), std::fabs(r.getY()),
+                             std::fabs(m_sweep.getX()), std::fabs(m_sweep.getY()) }) };
+    return std::fabs(heightAtSweep(s) - m_sweep.getY()) <= scale * 0x1p-40;
+}
+
+inline bool SegmentSweep::containsSweep(int s) const
+{
+    return sideOfSweep(s) == 0 && key(m_left[s]) <= key(m_sweep) && key(m_sweep) <= key(m_right[s]);
+}
+
+inline bool SegmentSweep::below(int a, int b) const
+{
+    if (a == b)
+    {
+        return false;
+    }
+    if (a == -1)
+    {
+        return sideOfSweep(b) < 0;
+    }
+    if (b == -1)
+    {
+        return sideOfSweep(a) > 0;
+    }
+    // a segment being inserted passes through the event point, so comparing
+    // it with any other segment is an exact orientation test
+    if (m_atSweep[a] && !m_atSweep[b])
+    {
+        double side{ sideOfSweep(b) };
+        if (side != 0)
+        {
+            return side < 0;
+        }
+    }
+    else if (m_atSweep[b] && !m_atSweep[a])
+    {
+        double side{ sideOfSweep(a) };
+        if (side != 0)
+        {
+            return side > 0;
+        }
+    }
+    else if (!m_atSweep[a] && !m_atSweep[b])
+    {
+        double sideA{ sideOfSweep(a) };
+        double sideB{ sideOfSweep(b) };
+        if ((sideA > 0) != (sideB > 0) || (sideA < 0) != (sideB < 0))
+        {
+            return sideA > sideB;
+        }
+        double heightA{ heightAtSweep(a) };
+        double heightB{ heightAtSweep(b) };
+        if (heightA != heightB)
+        {
+            return heightA < heightB;
+        }
+    }
+    // both go through the event point: the lower one right after it is the
+    // one whose direction turns clockwise from the other
+    double turn{ orient2d(m_sweep, m_right[a], m_right[b]) };
+    if (turn != 0)
+    {
+        return turn > 0;
+    }
+    return a < b;
+}
+
+inline bool SegmentSweep::report(int a, int b, const Punto<double> &p)
+{
+    if (a > b)
+    {
+        std::swap(a, b);
+    }
+    if (!m_reported.insert(static_cast<long long>(a) * m_count + b).second)
+    {
+        return false;
+    }
+    m_result.push_back(SegmentIntersection{ a, b, p });
+    return true;
+}
+
+inline void SegmentSweep::checkNeighbours(int a, int b)
+{
+    const Punto<double> &la{ m_left[a] };
+    const Punto<double> &ra{ m_right[a] };
+    const Punto<double> &lb{ m_left[b] };
+    const Punto<double> &rb{ m_right[b] };
+    if (!segmentsIntersect(la, ra, lb, rb))
+    {
+        return;
+    }
+    double o3{ orient2d(lb, rb, la) };
+    double o4{ orient2d(lb, rb, ra) };
+    Punto<double> q{};
+    if (o3 == 0 && o4 == 0)
+    {
+        // collinear overlap, it starts at the rightmost left endpoint
+        q = (key(la) < key(lb)) ? lb : la;
+    }
+    else if (o3 == 0)
+    {
+        q = la;
+    }
+    else if (o4 == 0)
+    {
+        q = ra;
+    }
+    else if (orient2d(la, ra, lb) == 0)
+    {
+        q = lb;
+    }
+    else if (orient2d(la, ra, rb) == 0)
+    {
+        q = rb;
+    }
+    else
+    {
+        double t{ o3 / (o3 - o4) };
+        q = Punto<double>{ la.getX() + t * (ra.getX() - la.getX()), la.getY() + t * (ra.getY() - la.getY()) };
+        // the crossing with a vertical segment is taken at its x, as any
+        // other x puts it far along the sweep order
+        const Punto<double>* vertical{ (la.getX() == ra.getX()) ? &la : (lb.getX() == rb.getX()) ? &lb : nullptr };
+        if (vertical != nullptr)
+        {
+            const Punto<double> &l{ (vertical == &la) ? lb : la };
+            const Punto<double> &r{ (vertical == &la) ? rb : ra };
+            const Punto<double> &top{ (vertical == &la) ? ra : rb };
+            double x{ vertical->getX() };
+            double y{ l.getY() + (x - l.getX()) / (r.getX() - l.getX()) * (r.getY() - l.getY()) };
+            q = Punto<double>{ x, std::max(vertical->getY(), std::min(top.getY(), y)) };
+        }
+        // rounding may leave it past the end of one of them, where that one
+        // has already left the status
+        const Punto<double> &start{ (key(la) < key(lb)) ? lb : la };
+        const Punto<double> &end{ (key(ra) < key(rb)) ? ra : rb };
+        if (key(q) < key(start))
+        {
+            q = start;
+        }
+        if (key(end) < key(q))
+        {
+            q = end;
+        }
+    }
+    if (key(m_sweep) < key(q))
+    {
+        std::vector<int> &crossing{ m_crossings[key(q)] };
+        crossing.push_back(a);
+        crossing.push_back(b);
+    }
+    else if (report(a, b, q))
+    {
+        // they were never at an event together, so they are still in the
+        // order they had before crossing. Handling the event point again
+        // as their crossing inserts them again in their order after it
+        std::vector<int> &crossing{ m_crossings[key(m_sweep)] };
+        crossing.push_back(a);
+        crossing.push_back(b);
+    }
+}
+
+inline void SegmentSweep::handle(const Punto<double> &p, const Event &event)
+{
+    m_sweep = p;
+
+    // the segments of the status through p are together around the first
+    // one that isn't below p. Crossings found earlier were rounded and may
+    // not be exactly at p, and the ones before p may have left segments
+    // passing within rounding distance of p on either side of it, so those
+    // count as going through p, as do the segments crossing or ending at p
+    auto isThrough = [&](int s) {
+        return containsSweep(s) || nearSweep(s)
+               || std::find(event.crossing.begin(), event.crossing.end(), s) != event.crossing.end()
+               || std::find(event.ending.begin(), event.ending.end(), s) != event.ending.end();
+    };
+    std::vector<int> &through{ m_through };
+    through.clear();
+    auto first{ m_status.lower_bound(-1) };
+    while (first != m_status.begin() && isThrough(*std::prev(first)))
+    {
+        --first;
+    }
+    for(auto it{ first }; it != m_status.end() && isThrough(*it); ++it)
+    {
+        through.push_back(*it);
+    }
+    for(const std::vector<int>* listed: { &event.crossing, &event.ending })
+    {
+        for(int s: *listed)
+        {
+            if (m_inStatus[s] && std::find(through.begin(), through.end(), s) == through.end())
+            {
+                through.push_back(s);
+            }
+        }
+    }
+
+    std::vector<int> &involved{ m_involved };
+    involved.assign(through.begin(), through.end());
+    involved.insert(involved.end(), event.starting.begin(), event.starting.end());
+    for(std::size_t i{}; i < involved.size(); ++i)
+    {
+        for(std::size_t j{ i + 1 }; j < involved.size(); ++j)
+        {
+            int a{ involved[i] };
+            int b{ involved[j] };
+            if (segmentsIntersect(m_left[a], m_right[a], m_left[b], m_right[b]))
+            {
+                report(a, b, p);
+            }
+        }
+    }
+
+    for(int s: through)
+    {
+        m_status.erase(m_positions[s]);
+        m_positions[s] = m_status.end();
+        m_inStatus[s] = false;
+    }
+
+    // the segments that go on past p are inserted again in their order right
+    // after p, together with the ones starting at p
+    std::vector<int> &inserted{ m_inserted };
+    inserted.clear();
+    for(int s: involved)
+    {
+        if (key(p) < key(m_right[s]) && !m_inStatus[s])
+        {
+            m_atSweep[s] = true;
+            inserted.push_back(s);
+        }
+    }
+    for(int s: inserted)
+    {
+        m_positions[s] = m_status.insert(s).first;
+        m_inStatus[s] = true;
+    }
+
+    if (inserted.empty())
+    {
+        auto above{ m_status.lower_bound(-1) };
+        if (above != m_status.end() && above != m_status.begin())
+        {
+            checkNeighbours(*std::prev(above), *above);
+        }
+    }
+    else
+    {
+        auto lowest{ m_positions[inserted[0]] };
+        auto highest{ lowest };
+        for(int s: inserted)
+        {
+            if (below(s, *lowest))
+            {
+                lowest = m_positions[s];
+            }
+            if (below(*highest, s))
+            {
+                highest = m_positions[s];
+            }
+        }
+        if (lowest != m_status.begin())
+        {
+            checkNeighbours(*std::prev(lowest), *lowest);
+        }
+        if (std::next(highest) != m_status.end())
+        {
+            checkNeighbours(*highest, *std::next(highest));
+        }
+    }
+    for(int s: inserted)
+    {
+        m_atSweep[s] = false;
+    }
+}
+
+inline std::vector<SegmentIntersection> SegmentSweep::run()
+{
+    std::size_t next{};
+    while (next < m_endpoints.size() || !m_crossings.empty())
+    {
+        // the next event is the lowest of the next endpoint and the next
+        // crossing, gathering everything that happens at that point
+        Point point{ (next < m_endpoints.size()) ? m_endpoints[next].first : m_crossings.begin()->first };
+        if (!m_crossings.empty() && m_crossings.begin()->first < point)
+        {
+            point = m_crossings.begin()->first;
+        }
+        m_event.starting.clear();
+        m_event.ending.clear();
+        m_event.crossing.clear();
+        for(; next < m_endpoints.size() && m_endpoints[next].first == point; ++next)
+        {
+            int s{ m_endpoints[next].second };
+            if (s >= 0)
+            {
+                m_event.starting.push_back(s);
+            }
+            else
+            {
+                m_event.ending.push_back(-1 - s);
+            }
+        }
+        if (!m_crossings.empty() && m_crossings.begin()->first == point)
+        {
+            m_event.crossing.swap(m_crossings.begin()->second);
+            m_crossings.erase(m_crossings.begin());
+        }
+        handle(Punto<double>{ point.first, point.second }, m_event);
+    }
+    return std::move(m_result);
+}
+
+/*
+ * Returns every pair of intersecting segments among the count given ones,
+ * in O((n + k) log n) time for k pairs. Segment i goes from endpoints[2*i]
+ * to endpoints[2*i+1], so the whole set is a single contiguous array.
+ * Segments touching at an endpoint and collinear segments that overlap are
+ * reported as well. Coordinates are converted to double.
+ */
+template <class T>
+std::vector<SegmentIntersection> segmentIntersections(const Punto<T>* endpoints, int count)
+{
+    SegmentSweep sweep{ endpoints, count };
+    return sweep.run();
+}
+
+/*
+ * Same as above for an array of count segments Segmento.
+ */
+template <class T>
+std::vector<SegmentIntersection> segmentIntersections(const Segmento<T>* segments, int count)
+{
+    std::vector<Punto<T>> endpoints;
+    endpoints.reserve(2 * static_cast<std::size_t>(count));
+    for(int i{}; i < count; ++i)
+    {
+        endpoints.push_back(segments[i].getStart().getEnd());
+        endpoints.push_back(segments[i].getEnd().getEnd());
+    }
+    return segmentIntersections(endpoints.data(), count);
+}
+
+#endif //ELEM_GEOMETRICOS_SEGMENTINTERSECTION_H
@@ -6,6 +6,9 @@
 #define ELEM_GEOMETRICOS_SEGMENTO_H
 
 #include "../include/elem_geometricos.h"
+#include "Predicates.h"
+#include "BatchOrientation.h"
+#include "PointBuffer.h"
 #include <iostream>
 
 /*
@@ -25,50 +28,48 @@ public:
      * Creates a Segmento given four values: the (x,y) coordinates for the
      * start point and the (x,y) coordinates for the end point
      */
-    Segmento(T startX = 0, T startY = 0, T endX = 0, T endY = 0):
-            m_start{ Vector<T>{startX, startY}}, m_end{ Vector<T>{ endX, endY }}
+    constexpr Segmento(T startX = 0, T startY = 0, T endX = 0, T endY = 0) noexcept:
+            m_start{ startX, startY }, m_end{ endX, endY }
     {};
 
     /*
      * Creates a Segmento with coordinates for its start and end specified by
      * the given points. Both points must match the Segmento type.
      */
-    Segmento(const Punto<T> &startPoint, const Punto<T> &endPoint):
-            m_start{ Vector<T>{startPoint} }, m_end{ Vector<T>{endPoint} }
+    constexpr Segmento(const Punto<T> &startPoint, const Punto<T> &endPoint) noexcept:
+            m_start{ startPoint }, m_end{ endPoint }
     {};
 
     /*
      * Creates a Segmento given two vectors, one that points to the start and
      * one that points to the end. Both vectors must match the Segmento type.
      */
-    Segmento(const Vector<T> &startPoint, const Vector<T> &endPoint):
+    constexpr Segmento(const Vector<T> &startPoint, const Vector<T> &endPoint) noexcept:
             m_start{ startPoint }, m_end{ endPoint }
     {};
 
     /*
      * Copy constructor for segmento
      */
-    Segmento(const Vector<T> &copy)
-            : Segmento(copy.getStart(), copy.getEnd())
-    {};
+    constexpr Segmento(const Segmento<T> &copy) noexcept = default;
 
     /*
      * Returns the Vector corresponding to the start point of the Segmento.
      * This reference may not be edited.
      */
-    const Vector<T>& getStart() const { return m_start; }
+    constexpr const Vector<T>& getStart() const noexcept { return m_start; }
 
     /*
      * Returns the Punto corresponding to the end point of the vector.
      * This reference may not be edited.
      */
-    const Vector<T>& getEnd() const { return m_end; }
+    constexpr const Vector<T>& getEnd() const noexcept { return m_end; }
 
     /*
      * Returns a new Segmento with the same start and end points as this
      * but swapped
     */
-    Segmento<T> swapSegmento() const;
+    constexpr Segmento<T> swapSegmento() const noexcept;
 
     /*
      * Returns the length of the Segmento.
@@ -77,48 +78,82 @@ public:
 
     /*
      * Returns double of the area enclosed in the triangle formed by this
-     * Segmento and the plane origin
+     * Segmento and the plane origin. It's exact for integer coordinates,
+     * which are multiplied in their WideType.
      */
-    T doubleAreaSegment() const;
+    constexpr WideType<T> doubleAreaSegment() const noexcept;
 
     /*
      * Returns double the (signed) area enclosed by the segment and a given
-     * point p
+     * point p. It's exact for integer coordinates, see OrientationType.
      */
-    T lineDeterminant(const Punto<T> &p) const;
+    constexpr OrientationType<T> lineDeterminant(const Punto<T> &p) const noexcept;
 
     /*
-     * Returns whether a point p is to the left of this Segmento
+     * Returns whether a point p is to the left of this Segmento. The
+     * orientation is computed as told by the Predicates policy, see
+     * Predicates.h: RobustPredicates gives the exact answer for nearly
+     * collinear floating point points.
      */
+    template <class Predicates = FastPredicates>
     const bool isPointToTheLeft(const Punto<T> &p) const;
 
     /*
-     * Returns whether a point p is to the right of this Segmento
+     * Returns whether a point p is to the right of this Segmento, using the
+     * given Predicates policy as above.
      */
+    template <class Predicates = FastPredicates>
     const bool isPointToTheRight(const Punto<T> &p) const;
 
     /*
      * Returns whether a point is in the line that passes through this
      * segment.
      */
-    bool isPointInLine(const Punto<T> &p) const;
+    constexpr bool isPointInLine(const Punto<T> &p) const noexcept;
+
+    /*
+     * Stores in out[i] the lineDeterminant of the point (xs[i], ys[i]), for
+     * the count given points. The determinant is expanded as a*x + b*y + c
+     * with the coefficients computed once for the whole batch, so results
+     * may differ from lineDeterminant in the last bits for floating point
+     * types. Integer results are exact, as the ones of lineDeterminant.
+     */
+    void lineDeterminants(const T* xs, const T* ys, int count, OrientationType<T>* out) const;
+
+    /*
+     * Same as above for the points of a PointBuffer.
+     */
+    void lineDeterminants(const PointBuffer<T> &puntos, OrientationType<T>* out) const;
+
+    /*
+     * Stores in out[i] whether the point (xs[i], ys[i]) lies to the left, to
+     * the right or in the line of this segment, for the count given points.
+     * A point is in the line under the same tolerance as isPointInLine,
+     * which takes precedence over the sides. Integer sides are exact.
+     */
+    void classifyPoints(const T* xs, const T* ys, int count, LineSide* out) const;
+
+    /*
+     * Same as above for the points of a PointBuffer.
+     */
+    void classifyPoints(const PointBuffer<T> &puntos, LineSide* out) const;
 
     /*
      * Returns whether this segment straddles some horizontal axis or not
      */
-    bool straddleHorizontally(T xAxis = 0) const;
+    constexpr bool straddleHorizontally(T xAxis = 0) const noexcept;
 
     /*
      * Returns the difference in the X coordinate between the start point and
      * the end point
      */
-    T diffX() const { return getStart().getX() - getEnd().getX(); };
+    constexpr T diffX() const noexcept { return getStart().getX() - getEnd().getX(); };
 
     /*
      * Returns the difference in the Y coordinate between the start point and
      * the end point
      */
-    T diffY() const { return getStart().getY() - getEnd().getY(); };
+    constexpr T diffY() const noexcept { return getStart().getY() - getEnd().getY(); };
 
     /*
      * Returns the coordinate x of the intersection between the line containing
@@ -128,83 +163,136 @@ public:
      */
     double horizontalIntersect(T xAxis = 0) const;
 
-    Segmento<T>& operator= (const Segmento<T>& segmento);
+    constexpr Segmento<T>& operator= (const Segmento<T>& segmento) noexcept = default;
 
 };
 
 template<class T>
 double Segmento<T>::length() const {
-    return (getEnd() - getStart()).euclideanNorm();
+    // the difference is never stored, it's computed inside the dot product
+    auto direction{ getEnd() - getStart() };
+    return std::sqrt(static_cast<double>(dotProduct(direction, direction)));
 }
 
 template <class T>
-T Segmento<T>::doubleAreaSegment() const {
+constexpr WideType<T> Segmento<T>::doubleAreaSegment() const noexcept {
     return crossProdValue(getStart(), getEnd());
 }
 
 template <class T>
-T Segmento<T>::lineDeterminant(const Punto<T> &p) const
+constexpr OrientationType<T> Segmento<T>::lineDeterminant(const Punto<T> &p) const noexcept
 {
-    T doubleAreaS          { doubleAreaSegment() };
-    T doubleAreaPointStart { crossProdValue(Vector<T>{ p }, getStart())};
-    T doubleAreaEndPoint   { crossProdValue(getEnd(),       Vector<T>{ p } )};
+    OrientationType<T> doubleAreaS          { doubleAreaSegment() };
+    OrientationType<T> doubleAreaPointStart { crossProdValue(Vector<T>{ p }, getStart())};
+    OrientationType<T> doubleAreaEndPoint   { crossProdValue(getEnd(),       Vector<T>{ p } )};
     return doubleAreaS + doubleAreaPointStart + doubleAreaEndPoint;
 
 }
 
 template <class T>
+template <class Predicates>
 bool const Segmento<T>::isPointToTheLeft(const Punto<T> &p) const
 {
-    return lineDeterminant(p) > 0;
+    return Predicates::orientation(getStart().getEnd(), getEnd().getEnd(), p) > 0;
 }
 
 template <class T>
+template <class Predicates>
 const bool Segmento<T>::isPointToTheRight(const Punto<T> &p) const
 {
-    return lineDeterminant(p) < 0;
+    return Predicates::orientation(getStart().getEnd(), getEnd().getEnd(), p) < 0;
 }
 
 template<class T>
-bool Segmento<T>::isPointInLine(const Punto<T> &p) const
+constexpr bool Segmento<T>::isPointInLine(const Punto<T> &p) const noexcept
 {
     return lineDeterminant(p) == 0;
 }
 
 template<class T>
-Segmento<T> Segmento<T>::swapSegmento() const {
+constexpr Segmento<T> Segmento<T>::swapSegmento() const noexcept {
     return Segmento<T>( getEnd(), getStart() );
 }
 
 template<>
-bool Segmento<double>::isPointInLine(const Punto<double> &p) const
+constexpr bool Segmento<double>::isPointInLine(const Punto<double> &p) const noexcept
 {
-    return withinEps(lineDeterminant(p), 0.0, 1e-10, 1e-10);
+    return withinEps(lineDeterminant(p), 0.0, LineTolerance<double>::value, LineTolerance<double>::value);
 }
 
 template<>
-bool Segmento<float>::isPointInLine(const Punto<float> &p) const
+constexpr bool Segmento<float>::isPointInLine(const Punto<float> &p) const noexcept
 {
-    return withinEps(lineDeterminant(p), 0.0f, 1e-7f, 1e-7f);
+    return withinEps(lineDeterminant(p), 0.0f, LineTolerance<float>::value, LineTolerance<float>::value);
 }
 
+// the line determinant of (x, y) is a*x + b*y + c, with a = diffY(),
+// b = -diffX() and c = doubleAreaSegment()
+
 template<class T>
-Segmento<T>& Segmento<T>::operator=(const Segmento<T> &segmento) {
-    m_start = segmento.getStart();
-    m_end = segmento.getEnd();
+void Segmento<T>::lineDeterminants(const T* xs, const T* ys, int count, OrientationType<T>* out) const {
+    if constexpr (std::is_integral<T>::value)
+    {
+        // a*x + b*y + c would overflow T, so the determinants are computed
+        // exactly as in classifyPoints
+        const Punto<T> &a{ getStart().getEnd() };
+        const Punto<T> &b{ getEnd().getEnd() };
+        for(int i{}; i < count; ++i)
+        {
+            out[i] = wideOrientation(a.getX(), a.getY(), b.getX(), b.getY(), xs[i], ys[i]);
+        }
+    }
+    else
+    {
+        T b{ getEnd().getX() - getStart().getX() };
+        batchLineDeterminant(diffY(), b, doubleAreaSegment(), xs, ys, count, out);
+    }
+}
 
-    return *this;
+template<class T>
+void Segmento<T>::lineDeterminants(const PointBuffer<T> &puntos, OrientationType<T>* out) const {
+    lineDeterminants(puntos.getXs(), puntos.getYs(), puntos.getLength(), out);
+}
+
+template<class T>
+void Segmento<T>::classifyPoints(const T* xs, const T* ys, int count, LineSide* out) const {
+    if constexpr (std::is_integral<T>::value)
+    {
+        // integer sides come from the exact determinant, and LineSide values
+        // are its signs
+        const Punto<T> &a{ getStart().getEnd() };
+        const Punto<T> &b{ getEnd().getEnd() };
+        for(int i{}; i < count; ++i)
+        {
+            out[i] = static_cast<LineSide>(signOf(wideOrientation(a.getX(), a.getY(), b.getX(), b.getY(),
+                                                                  xs[i], ys[i])));
+        }
+    }
+    else
+    {
+        T b{ getEnd().getX() - getStart().getX() };
+        batchLineSide(diffY(), b, doubleAreaSegment(), LineTolerance<T>::value, xs, ys, count, out);
+    }
+}
+
+template<class T>
+void Segmento<T>::classifyPoints(const PointBuffer<T> &puntos, LineSide* out) const {
+    classifyPoints(puntos.getXs(), puntos.getYs(), puntos.getLength(), out);
 }
 
 template<class T>
-bool Segmento<T>::straddleHorizontally(T xAxis) const {
+constexpr bool Segmento<T>::straddleHorizontally(T xAxis) const noexcept {
     T pi { getEnd().getY() };
     T pi1{ getStart().getY() };
-    return ((pi - xAxis) > 0) && ((pi1 - xAxis) <= 0);
+    // compared directly, the differences could overflow for integers
+    return (pi > xAxis) && (pi1 <= xAxis);
 }
 
 template<class T>
 double Segmento<T>::horizontalIntersect(T xAxis) const {
-    double xIntersect{ (xAxis * diffX() - doubleAreaSegment())/(static_cast<double>(diffY())) };
+    // widened like doubleAreaSegment, so integer products don't overflow
+    WideType<T> diffXWide{ static_cast<WideType<T>>(getStart().getX()) - getEnd().getX() };
+    double xIntersect{ (xAxis * diffXWide - doubleAreaSegment())/(static_cast<double>(diffY())) };
     return xIntersect;
 }
 
@@ -0,0 +1,471 @@
+//
+// Simplification of polygons for levels of detail: Douglas–Peucker and
+// Visvalingam–Whyatt, computed once as an importance ranking of the
+// vertices from which any tolerance is extracted.
+//
+
+#ifndef ELEM_GEOMETRICOS_SIMPLIFICATION_H
+#define ELEM_GEOMETRICOS_SIMPLIFICATION_H
+
+#include "Poligono.h"
+#include "PolygonSet.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/*
+ * How the importance of the vertices is measured.
+ * DOUGLAS_PEUCKER: distance from the vertex to the segment that would
+ * replace it, splitting first at the furthest vertex. Tolerances are
+ * distances.
+ * VISVALINGAM: area of the triangle the vertex forms with its neighbours
+ * when it's removed, removing first the smallest one. Tolerances are areas.
+ */
+enum class SimplificationMethod : char
+{
+    DOUGLAS_PEUCKER,
+    VISVALINGAM
+};
+
+/*
+ * Vertices of a ring that are kept at every tolerance: the simplified
+ * polygons never have less than three vertices.
+ */
+const int RANKING_ANCHORS{ 3 };
+
+template <class T> class Simplifier;
+
+/*
+ * Importance of every vertex of a set of polygons, aligned with the
+ * vertices of the set. The vertices kept at a tolerance are the ones whose
+ * importance is greater than it.
+ * The importances are made monotone while ranking, so the vertices of each
+ * polygon form a binary tree where every vertex is at least as important as
+ * the ones below it and the in order traversal follows the polygon. A
+ * tolerance is thus extracted by a traversal that stops at the first vertex
+ * dropped of every branch, in time proportional to the vertices kept.
+ */
+class VertexRanking
+{
+private:
+    std::vector<double> m_importance;
+    std::vector<int> m_left;
+    std::vector<int> m_right;
+    std::vector<int> m_offsets{ 0 };
+    // RANKING_ANCHORS per polygon, -1 when it has less vertices, and the
+    // root of the tree of the vertices between each anchor and the next
+    std::vector<int> m_anchors;
+    std::vector<int> m_anchorChild;
+
+    template <class T> friend class Simplifier;
+
+    /*
+     * Appends to out the vertices of polygon kept at tolerance, as indices
+     * relative to the polygon. stack is the buffer for the traversal.
+     */
+    void collect(int polygon, double tolerance, std::vector<int> &stack, std::vector<int> &out) const;
+
+public:
+    /*
+     * Creates an empty ranking.
+     */
+    VertexRanking() = default;
+
+    /*
+     * Makes room for polygons with the given vertex offsets, as those of a
+     * PolygonSet, to be ranked one by one with Simplifier::rank.
+     */
+    void resize(const int* offsets, int polygons);
+
+    /*
+     * Returns the amount of polygons ranked.
+     */
+    int getLength() const { return static_cast<int>(m_offsets.size()) - 1; }
+
+    /*
+     * Returns the importance of every vertex, in the order of the vertices
+     * of the ranked set. Anchors have infinite importance.
+     */
+    const double* getImportance() const { return m_importance.data(); }
+
+    /*
+     * Returns the indices of the vertices of polygon kept at tolerance,
+     * relative to the polygon and in its order, which may start at a
+     * different vertex than the polygon.
+     */
+    std::vector<int> kept(int polygon, double tolerance) const;
+
+    /*
+     * Appends to out every polygon of set simplified to tolerance. The set
+     * must be the one ranked.
+     */
+    template <class T>
+    void extract(const PolygonSet<T> &set, double tolerance, PolygonSet<T> &out) const;
+};
+
+/*
+ * Ranks the vertices of polygons with either method. The buffers are kept
+ * between calls, so a Simplifier is meant to be reused for many polygons,
+ * one per thread. Distances come from Segmento::lineDeterminant and areas
+ * from Poligono::signedAngle, both exact for integer coordinates before
+ * they are turned into double.
+ */
+template <class T>
+class Simplifier
+{
+private:
+    struct Interval
+    {
+        int from;
+        int to;
+        int slot;
+        double importance;
+    };
+
+    std::vector<Interval> m_stack;
+    std::vector<int> m_prev;
+    std::vector<int> m_next;
+    std::vector<int> m_edgeRoot;
+    std::vector<double> m_area;
+    std::vector<std::pair<double, int>> m_heap;
+
+    /*
+     * Stores node in the child slot: side 0 or 1 of the vertex slot/2 when
+     * slot isn't negative, and the child of anchor -slot-1 otherwise.
+     */
+    static void link(int slot, int node, int* left, int* right, int* anchorChild);
+
+    /*
+     * Returns the area of the triangle of the vertex v and its neighbours.
+     */
+    double effectiveArea(const Punto<T>* puntos, int v) const;
+
+    void douglasPeucker(const Punto<T>* puntos, int length, double* importance,
+                        int* left, int* right, int* anchors, int* anchorChild);
+    void visvalingam(const Punto<T>* puntos, int length, double* importance,
+                     int* left, int* right, int* anchors, int* anchorChild);
+
+public:
+    Simplifier() = default;
+    Simplifier(const Simplifier&) = delete;
+    Simplifier& operator=(const Simplifier&) = delete;
+
+    /*
+     * Ranks the vertices of the polygon at position polygon of ranking,
+     * which has the given length points. Douglas–Peucker takes O(n log n)
+     * for most polygons, O(n^2) at worst, and Visvalingam O(n log n) with a
+     * heap of the effective areas.
+     */
+    void rank(const Punto<T>* puntos, int length, SimplificationMethod method,
+              VertexRanking &ranking, int polygon);
+};
+
+inline void VertexRanking::resize(const int* offsets, int polygons) {
+    int vertices{ offsets[polygons] - offsets[0] };
+    m_importance.assign(static_cast<std::size_t>(vertices), 0.0);
+    m_left.assign(static_cast<std::size_t>(vertices), -1);
+    m_right.assign(static_cast<std::size_t>(vertices), -1);
+    m_offsets.resize(static_cast<std::size_t>(polygons) + 1);
+    for(int i{}; i <= polygons; ++i)
+    {
+        m_offsets[i] = offsets[i] - offsets[0];
+    }
+    m_anchors.assign(static_cast<std::size_t>(polygons) * RANKING_ANCHORS, -1);
+    m_anchorChild.assign(static_cast<std::size_t>(polygons) * RANKING_ANCHORS, -1);
+}
+
+inline void VertexRanking::collect(int polygon, double tolerance, std::vector<int> &stack, std::vector<int> &out) const {
+    int first{ m_offsets[polygon] };
+    const int* anchors{ m_anchors.data() + polygon * RANKING_ANCHORS };
+    const int* anchorChild{ m_anchorChild.data() + polygon * RANKING_ANCHORS };
+    for(int a{}; a < RANKING_ANCHORS && anchors[a] >= 0; ++a)
+    {
+        out.push_back(anchors[a]);
+        // in order traversal, not going below the dropped vertices
+        stack.clear();
+        int node{ anchorChild[a] };
+        while (node >= 0 || !stack.empty())
+        {
+            while (node >= 0 && m_importance[first + node] > tolerance)
+            {
+                stack.push_back(node);
+                node = m_left[first + node];
+            }
+            if (stack.empty())
+            {
+                break;
+            }
+            node = stack.back();
+            stack.pop_back();
+            out.push_back(node);
+            node = m_right[first + node];
+        }
+    }
+}
+
+inline std::vector<int> VertexRanking::kept(int polygon, double tolerance) const {
+    std::vector<int> stack;
+    std::vector<int> out;
+    collect(polygon, tolerance, stack, out);
+    return out;
+}
+
+template<class T>
+void VertexRanking::extract(const PolygonSet<T> &set, double tolerance, PolygonSet<T> &out) const {
+    std::vector<int> stack;
+    std::vector<int> indices;
+    const Punto<T>* vertices{ set.getVertices() };
+    const int* offsets{ set.getOffsets() };
+    for(int i{}; i < getLength(); ++i)
+    {
+        indices.clear();
+        collect(i, tolerance, stack, indices);
+        for(int index: indices)
+        {
+            out.pushVertex(vertices[offsets[i] + index]);
+        }
+        out.endPolygon();
+    }
+}
+
+template<class T>
+void Simplifier<T>::link(int slot, int node, int* left, int* right, int* anchorChild) {
+    if (slot < 0)
+    {
+        anchorChild[-slot - 1] = node;
+    }
+    else if (slot % 2 == 0)
+    {
+        left[slot / 2] = node;
+    }
+    else
+    {
+        right[slot / 2] = node;
+    }
+}
+
+template<class T>
+double Simplifier<T>::effectiveArea(const Punto<T>* puntos, int v) const {
+    double doubleArea{ static_cast<double>(Poligono<T>::signedAngle(puntos[m_prev[v]], puntos[v], puntos[m_next[v]])) };
+    return std::fabs(doubleArea) / 2;
+}
+
+template<class T>
+void Simplifier<T>::douglasPeucker(const Punto<T>* puntos, int length, double* importance,
+                                   int* left, int* right, int* anchors, int* anchorChild) {
+    const double infinity{ std::numeric_limits<double>::infinity() };
+    auto distance2{ [&](int i, int j) {
+        double dx{ static_cast<double>(puntos[i].getX()) - static_cast<double>(puntos[j].getX()) };
+        double dy{ static_cast<double>(puntos[i].getY()) - static_cast<double>(puntos[j].getY()) };
+        return dx * dx + dy * dy;
+    } };
+
+    // the anchors: the first vertex, the one furthest from it and the one
+    // furthest from the line through both
+    int far{ 1 };
+    for(int i{ 2 }; i < length; ++i)
+    {
+        if (distance2(i, 0) > distance2(far, 0))
+        {
+            far = i;
+        }
+    }
+    const Segmento<T> base{ puntos[0], puntos[far] };
+    int third{ (far == 1) ? 2 : 1 };
+    double thirdDeterminant{ -1 };
+    for(int i{ 1 }; i < length; ++i)
+    {
+        double determinant{ std::fabs(static_cast<double>(base.lineDeterminant(puntos[i]))) };
+        if (i != far && determinant > thirdDeterminant)
+        {
+            third = i;
+            thirdDeterminant = determinant;
+        }
+    }
+    anchors[0] = 0;
+    anchors[1] = std::min(far, third);
+    anchors[2] = std::max(far, third);
+
+    m_stack.clear();
+    for(int a{}; a < RANKING_ANCHORS; ++a)
+    {
+        importance[anchors[a]] = infinity;
+        int to{ (a + 1 < RANKING_ANCHORS) ? anchors[a + 1] : length };
+        m_stack.push_back(Interval{ anchors[a], to, -a - 1, infinity });
+    }
+    while (!m_stack.empty())
+    {
+        Interval interval{ m_stack.back() };
+        m_stack.pop_back();
+        if (interval.to - interval.from < 2)
+        {
+            continue;
+        }
+        const Segmento<T> chord{ puntos[interval.from], puntos[interval.to % length] };
+        double chordLength{ chord.length() };
+        int furthest{ interval.from + 1 };
+        double distance{ -1 };
+        for(int i{ interval.from + 1 }; i < interval.to; ++i)
+        {
+            // a closed loop has no line, the distances are to its start
+            double d{ (chordLength > 0) ? std::fabs(static_cast<double>(chord.lineDeterminant(puntos[i])))
+                                        : std::sqrt(distance2(i, interval.from)) };
+            if (d > distance)
+            {
+                furthest = i;
+                distance = d;
+            }
+        }
+        if (chordLength > 0)
+        {
+            // the determinants are only divided by the length for the
+            // furthest vertex
+            distance /= chordLength;
+        }
+        double value{ std::min(distance, interval.importance) };
+        importance[furthest] = value;
+        link(interval.slot, furthest, left, right, anchorChild);
+        m_stack.push_back(Interval{ furthest, interval.to, 2 * furthest + 1, value });
+        m_stack.push_back(Interval{ interval.from, furthest, 2 * furthest, value });
+    }
+}
+
+template<class T>
+void Simplifier<T>::visvalingam(const Punto<T>* puntos, int length, double* importance,
+                                int* left, int* right, int* anchors, int* anchorChild) {
+    m_prev.resize(static_cast<std::size_t>(length));
+    m_next.resize(static_cast<std::size_t>(length));
+    m_area.resize(static_cast<std::size_t>(length));
+    m_edgeRoot.assign(static_cast<std::size_t>(length), -1);
+    m_heap.clear();
+    for(int i{}; i < length; ++i)
+    {
+        m_prev[i] = (i == 0) ? length - 1 : i - 1;
+        m_next[i] = (i + 1 == length) ? 0 : i + 1;
+    }
+    for(int i{}; i < length; ++i)
+    {
+        m_area[i] = effectiveArea(puntos, i);
+        m_heap.push_back(std::make_pair(m_area[i], i));
+    }
+    // a min heap, with the stale entries skipped when they come out
+    std::greater<std::pair<double, int>> after;
+    std::make_heap(m_heap.begin(), m_heap.end(), after);
+
+    int alive{ length };
+    double removed{ };
+    while (alive > RANKING_ANCHORS)
+    {
+        std::pop_heap(m_heap.begin(), m_heap.end(), after);
+        std::pair<double, int> top{ m_heap.back() };
+        m_heap.pop_back();
+        int v{ top.second };
+        if (m_prev[v] < 0 || top.first != m_area[v])
+        {
+            continue;
+        }
+        int p{ m_prev[v] };
+        int q{ m_next[v] };
+        removed = std::max(removed, top.first);
+        importance[v] = removed;
+        // v goes between p and q, above whatever was removed around it
+        left[v] = m_edgeRoot[p];
+        right[v] = m_edgeRoot[v];
+        m_edgeRoot[p] = v;
+        m_next[p] = q;
+        m_prev[q] = p;
+        m_prev[v] = -1;
+        --alive;
+        for(int neighbour: { p, q })
+        {
+            m_area[neighbour] = effectiveArea(puntos, neighbour);
+            m_heap.push_back(std::make_pair(m_area[neighbour], neighbour));
+            std::push_heap(m_heap.begin(), m_heap.end(), after);
+        }
+    }
+
+    int a{ };
+    for(int i{}; i < length; ++i)
+    {
+        if (m_prev[i] >= 0)
+        {
+            importance[i] = std::numeric_limits<double>::infinity();
+            anchors[a] = i;
+            anchorChild[a] = m_edgeRoot[i];
+            ++a;
+        }
+    }
+}
+
+template<class T>
+void Simplifier<T>::rank(const Punto<T>* puntos, int length, SimplificationMethod method,
+                         VertexRanking &ranking, int polygon) {
+    int first{ ranking.m_offsets[polygon] };
+    double* importance{ ranking.m_importance.data() + first };
+    int* left{ ranking.m_left.data() + first };
+    int* right{ ranking.m_right.data() + first };
+    int* anchors{ ranking.m_anchors.data() + polygon * RANKING_ANCHORS };
+    int* anchorChild{ ranking.m_anchorChild.data() + polygon * RANKING_ANCHORS };
+    if (length <= RANKING_ANCHORS)
+    {
+        for(int i{}; i < length; ++i)
+        {
+            importance[i] = std::numeric_limits<double>::infinity();
+            anchors[i] = i;
+        }
+        return;
+    }
+    if (method == SimplificationMethod::DOUGLAS_PEUCKER)
+    {
+        douglasPeucker(puntos, length, importance, left, right, anchors, anchorChild);
+    }
+    else
+    {
+        visvalingam(puntos, length, importance, left, right, anchors, anchorChild);
+    }
+}
+
+/*
+ * Ranks the vertices of every polygon of the set. The polygons are split
+ * across threads so that every thread gets about the same amount of
+ * vertices. When threads is 0 one per hardware thread is used.
+ */
+template <class T>
+VertexRanking rankVertices(const PolygonSet<T> &set, SimplificationMethod method, int threads = 0)
+{
+    VertexRanking ranking;
+    ranking.resize(set.getOffsets(), set.getLength());
+    const Punto<T>* vertices{ set.getVertices() };
+    const int* offsets{ set.getOffsets() };
+    VertexRanking* out{ &ranking };
+    parallelForBalanced(offsets, set.getLength(), [=](int begin, int end) {
+        Simplifier<T> simplifier;
+        for(int i{ begin }; i < end; ++i)
+        {
+            simplifier.rank(vertices + offsets[i], offsets[i + 1] - offsets[i], method, *out, i);
+        }
+    }, threads, 1 << 12);
+    return ranking;
+}
+
+/*
+ * Returns pol simplified to tolerance, a distance for Douglas–Peucker and
+ * an area for Visvalingam. Polygons of more than three vertices keep at
+ * least three of them. When the same polygon is needed at several
+ * tolerances, rank it once with rankVertices instead.
+ */
+template <class T>
+Poligono<T> simplify(const Poligono<T> &pol, SimplificationMethod method, double tolerance)
+{
+    PolygonSet<T> set;
+    set.push_back(pol);
+    PolygonSet<T> simplified;
+    rankVertices(set, method, 1).extract(set, tolerance, simplified);
+    return Poligono<T>{ simplified.getVertices(), simplified.polygonLength(0) };
+}
+
+#endif //ELEM_GEOMETRICOS_SIMPLIFICATION_H
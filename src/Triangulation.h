@@ -0,0 +1,827 @@
+//
+// Triangulation of simple polygons.
+//
+
+#ifndef ELEM_GEOMETRICOS_TRIANGULATION_H
+#define ELEM_GEOMETRICOS_TRIANGULATION_H
+
+#include "Poligono.h"
+#include "PolygonSet.h"
+#include "PolygonArea.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <vector>
+
+/*
+ * Triangle given by the indices of its vertices in the polygon it was taken
+ * from, in counter clockwise order.
+ */
+struct Triangle
+{
+    int a;
+    int b;
+    int c;
+};
+
+/*
+ * Polygons with up to this amount of vertices are triangulated by ear
+ * clipping, which needs almost no setup. Larger ones are split in monotone
+ * pieces, which takes O(n log n) instead of up to O(n^2).
+ */
+const int EAR_CLIPPING_MAX_VERTICES{ 64 };
+
+/*
+ * Triangulates simple polygons, given in either orientation, into length-2
+ * triangles. The buffers used by each method are kept between calls, so a
+ * Triangulator is meant to be reused for many polygons, one per thread.
+ * Vertices are classified as convex or reflex by the sign of
+ * Poligono::signedAngle.
+ */
+template <class T>
+class Triangulator
+{
+private:
+    enum class VertexType : char
+    {
+        START,
+        SPLIT,
+        END,
+        MERGE,
+        REGULAR
+    };
+
+    struct SweepEvent
+    {
+        T y;
+        T x;
+        int position;
+    };
+
+    /*
+     * Orders the edges crossing the sweep line from left to right, by their
+     * X at the current event. Index -1 stands for the event vertex itself.
+     */
+    struct EdgeOrder
+    {
+        const Triangulator* triangulator;
+        bool operator()(int a, int b) const { return triangulator->leftOf(a, b); }
+    };
+
+    const Punto<T>* m_puntos{};
+    int m_length{};
+    bool m_ccw{};
+    Triangle* m_out{};
+    int m_emitted{};
+
+    // ear clipping: the polygon left as a linked list, and the reflex
+    // vertices hashed in a grid of cells, stored one cell after the other
+    std::vector<int> m_prev;
+    std::vector<int> m_next;
+    std::vector<char> m_reflex;
+    std::vector<int> m_cellStart;
+    std::vector<int> m_cellVertices;
+    double m_gridX{};
+    double m_gridY{};
+    double m_cellWidth{};
+    double m_cellHeight{};
+    int m_columns{};
+    int m_rows{};
+
+    // monotone decomposition: positions walk the polygon counter clockwise
+    std::vector<Punto<T>> m_walk;
+    std::vector<SweepEvent> m_events;
+    std::vector<VertexType> m_types;
+    std::vector<int> m_helper;
+    std::set<int, EdgeOrder> m_status{ EdgeOrder{ this } };
+    std::vector<typename std::set<int, EdgeOrder>::iterator> m_edges;
+    double m_sweepX{};
+    double m_sweepY{};
+    std::vector<std::pair<int, int>> m_diagonals;
+    std::vector<int> m_adjacencyStart;
+    std::vector<int> m_adjacency;
+    std::vector<double> m_angles;
+    std::vector<char> m_visited;
+    std::vector<int> m_piece;
+    std::vector<int> m_chain;
+    std::vector<char> m_onLeft;
+    std::vector<int> m_stack;
+
+    /*
+     * Returns the vertex at the given position of the counter clockwise walk.
+     */
+    const Punto<T>& at(int position) const { return m_walk[position]; }
+
+    /*
+     * Returns the index in the polygon of the vertex at the given position.
+     */
+    int index(int position) const { return m_ccw ? position : m_length - 1 - position; }
+
+    int nextPosition(int position) const { return (position + 1 == m_length) ? 0 : position + 1; }
+    int prevPosition(int position) const { return (position == 0) ? m_length - 1 : position - 1; }
+
+    static bool samePoint(const Punto<T> &p, const Punto<T> &q)
+    {
+        return p.getX() == q.getX() && p.getY() == q.getY();
+    }
+
+    /*
+     * Turn of the vertices at the given indices, positive when they are
+     * convex in the walk of the polygon given by m_ccw.
+     */
+    OrientationType<T> turn(int a, int b, int c) const;
+
+    /*
+     * Appends the triangle of the given vertex indices, counter clockwise.
+     * Triangles past the length-2 the output has room for are counted but
+     * not stored.
+     */
+    void emit(int a, int b, int c);
+
+    /*
+     * Ear clipping helpers.
+     */
+    void buildReflexHash();
+    int cellColumn(double x) const;
+    int cellRow(double y) const;
+    bool isEar(int vertex) const;
+    void clipEar(int vertex);
+
+    /*
+     * Monotone decomposition helpers, working over positions.
+     */
+    bool above(int a, int b) const;
+    double edgeX(int edge) const;
+    bool leftOf(int a, int b) const;
+    int edgeLeftOf() const;
+    void insertEdge(int edge, int helper);
+    void removeEdge(int edge);
+    void connectToHelper(int position, int edge, bool onlyMerge);
+    void findDiagonals();
+    void splitPieces();
+    void triangulateMonotone();
+
+public:
+    Triangulator() = default;
+
+    /*
+     * The status of the sweep refers to its Triangulator, so they can't be
+     * copied.
+     */
+    Triangulator(const Triangulator&) = delete;
+    Triangulator& operator=(const Triangulator&) = delete;
+
+    /*
+     * Stores in out the triangles of the polygon of the length given
+     * vertices, clipping one ear at a time. Reflex vertices are kept in a
+     * grid hash, so each candidate ear is only checked against the reflex
+     * vertices near it.
+     */
+    void earClipping(const Punto<T>* puntos, int length, Triangle* out);
+
+    /*
+     * Stores in out the triangles of the polygon of the length given
+     * vertices. A sweep adds the diagonals that split the polygon in
+     * y-monotone pieces, and each piece is triangulated in linear time.
+     */
+    void monotone(const Punto<T>* puntos, int length, Triangle* out);
+
+    /*
+     * Stores in out the triangles of the polygon, choosing the method by its
+     * amount of vertices (see EAR_CLIPPING_MAX_VERTICES).
+     */
+    void triangulate(const Punto<T>* puntos, int length, Triangle* out);
+};
+
+template<class T>
+OrientationType<T> Triangulator<T>::turn(int a, int b, int c) const {
+    auto angle{ Poligono<T>::signedAngle(m_puntos[a], m_puntos[b], m_puntos[c]) };
+    return m_ccw ? angle : -angle;
+}
+
+template<class T>
+void Triangulator<T>::emit(int a, int b, int c) {
+    if (Poligono<T>::signedAngle(m_puntos[a], m_puntos[b], m_puntos[c]) < 0)
+    {
+        std::swap(b, c);
+    }
+    // the sweep may find more pieces in a polygon that isn't simple
+    if (m_emitted < m_length - 2)
+    {
+        m_out[m_emitted] = Triangle{ a, b, c };
+    }
+    ++m_emitted;
+}
+
+template<class T>
+int Triangulator<T>::cellColumn(double x) const {
+    return std::min(m_columns - 1, std::max(0, static_cast<int>((x - m_gridX) / m_cellWidth)));
+}
+
+template<class T>
+int Triangulator<T>::cellRow(double y) const {
+    return std::min(m_rows - 1, std::max(0, static_cast<int>((y - m_gridY) / m_cellHeight)));
+}
+
+template<class T>
+void Triangulator<T>::buildReflexHash() {
+    double minX{ static_cast<double>(m_puntos[0].getX()) };
+    double maxX{ minX };
+    double minY{ static_cast<double>(m_puntos[0].getY()) };
+    double maxY{ minY };
+    int reflexCount{ };
+    for(int i{}; i < m_length; ++i)
+    {
+        minX = std::min(minX, static_cast<double>(m_puntos[i].getX()));
+        maxX = std::max(maxX, static_cast<double>(m_puntos[i].getX()));
+        minY = std::min(minY, static_cast<double>(m_puntos[i].getY()));
+        maxY = std::max(maxY, static_cast<double>(m_puntos[i].getY()));
+        reflexCount += m_reflex[i];
+    }
+    // about one reflex vertex per cell
+    int side{ std::max(1, static_cast<int>(std::sqrt(static_cast<double>(reflexCount)))) };
+    m_columns = side;
+    m_rows = side;
+    m_gridX = minX;
+    m_gridY = minY;
+    m_cellWidth = (maxX > minX) ? (maxX - minX) / side : 1.0;
+    m_cellHeight = (maxY > minY) ? (maxY - minY) / side : 1.0;
+
+    m_cellStart.assign(static_cast<std::size_t>(side) * side + 1, 0);
+    for(int i{}; i < m_length; ++i)
+    {
+        if (m_reflex[i])
+        {
+            ++m_cellStart[cellRow(m_puntos[i].getY()) * side + cellColumn(m_puntos[i].getX()) + 1];
+        }
+    }
+    for(int cell{}; cell < side * side; ++cell)
+    {
+        m_cellStart[cell + 1] += m_cellStart[cell];
+    }
+    m_cellVertices.resize(static_cast<std::size_t>(reflexCount));
+    std::vector<int> filled(m_cellStart.begin(), m_cellStart.end() - 1);
+    for(int i{}; i < m_length; ++i)
+    {
+        if (m_reflex[i])
+        {
+            m_cellVertices[filled[cellRow(m_puntos[i].getY()) * side + cellColumn(m_puntos[i].getX())]++] = i;
+        }
+    }
+}
+
+template<class T>
+bool Triangulator<T>::isEar(int vertex) const {
+    int a{ m_prev[vertex] };
+    int c{ m_next[vertex] };
+    if (turn(a, vertex, c) <= 0)
+    {
+        return false;
+    }
+    const Punto<T> &pa{ m_puntos[a] };
+    const Punto<T> &pb{ m_puntos[vertex] };
+    const Punto<T> &pc{ m_puntos[c] };
+    int firstColumn{ cellColumn(std::min({ pa.getX(), pb.getX(), pc.getX() })) };
+    int lastColumn{ cellColumn(std::max({ pa.getX(), pb.getX(), pc.getX() })) };
+    int firstRow{ cellRow(std::min({ pa.getY(), pb.getY(), pc.getY() })) };
+    int lastRow{ cellRow(std::max({ pa.getY(), pb.getY(), pc.getY() })) };
+    for(int row{ firstRow }; row <= lastRow; ++row)
+    {
+        for(int column{ firstColumn }; column <= lastColumn; ++column)
+        {
+            int cell{ row * m_columns + column };
+            for(int k{ m_cellStart[cell] }; k < m_cellStart[cell + 1]; ++k)
+            {
+                int r{ m_cellVertices[k] };
+                const Punto<T> &p{ m_puntos[r] };
+                // clipped vertices and those that turned convex are no longer reflex
+                if (!m_reflex[r] || r == a || r == vertex || r == c
+                    || samePoint(p, pa) || samePoint(p, pb) || samePoint(p, pc))
+                {
+                    continue;
+                }
+                if (turn(a, vertex, r) >= 0 && turn(vertex, c, r) >= 0 && turn(c, a, r) >= 0)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+template<class T>
+void Triangulator<T>::clipEar(int vertex) {
+    int a{ m_prev[vertex] };
+    int c{ m_next[vertex] };
+    emit(a, vertex, c);
+    m_next[a] = c;
+    m_prev[c] = a;
+    m_reflex[vertex] = false;
+    // a reflex vertex can only become convex as its neighbours are clipped
+    if (m_reflex[a] && turn(m_prev[a], a, c) > 0)
+    {
+        m_reflex[a] = false;
+    }
+    if (m_reflex[c] && turn(a, c, m_next[c]) > 0)
+    {
+        m_reflex[c] = false;
+    }
+}
+
+template<class T>
+void Triangulator<T>::earClipping(const Punto<T>* puntos, int length, Triangle* out) {
+    if (length < 3)
+    {
+        return;
+    }
+    m_puntos = puntos;
+    m_length = length;
+    m_ccw = shoelaceDoubleArea(puntos, length) >= 0;
+    m_out = out;
+    m_emitted = 0;
+    m_prev.resize(static_cast<std::size_t>(length));
+    m_next.resize(static_cast<std::size_t>(length));
+    m_reflex.resize(static_cast<std::size_t>(length));
+    for(int i{}; i < length; ++i)
+    {
+        m_prev[i] = (i == 0) ? length - 1 : i - 1;
+        m_next[i] = (i + 1 == length) ? 0 : i + 1;
+    }
+    for(int i{}; i < length; ++i)
+    {
+        // collinear vertices may lie on a diagonal, so they are hashed too
+        m_reflex[i] = turn(m_prev[i], i, m_next[i]) <= 0;
+    }
+    buildReflexHash();
+
+    int vertex{ };
+    int remaining{ length };
+    int tried{ };
+    while (remaining > 3)
+    {
+        if (isEar(vertex))
+        {
+            int next{ m_next[vertex] };
+            clipEar(vertex);
+            vertex = next;
+            --remaining;
+            tried = 0;
+        }
+        else if (++tried > remaining)
+        {
+            // only degenerate polygons have no ear left; clipping a vertex
+            // anyway keeps the amount of triangles
+            int next{ m_next[vertex] };
+            clipEar(vertex);
+            vertex = next;
+            --remaining;
+            tried = 0;
+        }
+        else
+        {
+            vertex = m_next[vertex];
+        }
+    }
+    emit(m_prev[vertex], vertex, m_next[vertex]);
+}
+
+template<class T>
+bool Triangulator<T>::above(int a, int b) const {
+    const Punto<T> &p{ at(a) };
+    const Punto<T> &q{ at(b) };
+    return (p.getY() > q.getY()) || ((p.getY() == q.getY()) && (p.getX() < q.getX()));
+}
+
+template<class T>
+double Triangulator<T>::edgeX(int edge) const {
+    if (edge < 0)
+    {
+        return m_sweepX;
+    }
+    const Punto<T> &p{ at(edge) };
+    const Punto<T> &q{ at(nextPosition(edge)) };
+    double px{ static_cast<double>(p.getX()) };
+    double qx{ static_cast<double>(q.getX()) };
+    if (p.getY() == q.getY())
+    {
+        // horizontal edges are taken as slightly tilted, so they pass by the event
+        return std::min(std::max(m_sweepX, std::min(px, qx)), std::max(px, qx));
+    }
+    double t{ (m_sweepY - p.getY()) / (static_cast<double>(q.getY()) - p.getY()) };
+    return px + t * (qx - px);
+}
+
+template<class T>
+bool Triangulator<T>::leftOf(int a, int b) const {
+    double xa{ edgeX(a) };
+    double xb{ edgeX(b) };
+    if (xa != xb)
+    {
+        return xa < xb;
+    }
+    return a < b;
+}
+
+template<class T>
+int Triangulator<T>::edgeLeftOf() const {
+    auto it{ m_status.lower_bound(-1) };
+    return (it == m_status.begin()) ? -1 : *std::prev(it);
+}
+
+template<class T>
+void Triangulator<T>::insertEdge(int edge, int helper) {
+    m_edges[edge] = m_status.insert(edge).first;
+    m_helper[edge] = helper;
+}
+
+template<class T>
+void Triangulator<T>::removeEdge(int edge) {
+    // only missing when the polygon is not simple
+    if (m_edges[edge] != m_status.end())
+    {
+        m_status.erase(m_edges[edge]);
+        m_edges[edge] = m_status.end();
+    }
+}
+
+template<class T>
+void Triangulator<T>::connectToHelper(int position, int edge, bool onlyMerge) {
+    if (edge >= 0 && (!onlyMerge || m_types[m_helper[edge]] == VertexType::MERGE))
+    {
+        m_diagonals.push_back(std::pair<int, int>{ position, m_helper[edge] });
+    }
+}
+
+template<class T>
+void Triangulator<T>::findDiagonals() {
+    m_types.resize(static_cast<std::size_t>(m_length));
+    m_events.resize(static_cast<std::size_t>(m_length));
+    for(int k{}; k < m_length; ++k)
+    {
+        int prev{ prevPosition(k) };
+        int next{ nextPosition(k) };
+        bool prevBelow{ above(k, prev) };
+        bool nextBelow{ above(k, next) };
+        bool convex{ Poligono<T>::signedAngle(at(prev), at(k), at(next)) >= 0 };
+        if (prevBelow && nextBelow)
+        {
+            m_types[k] = convex ? VertexType::START : VertexType::SPLIT;
+        }
+        else if (!prevBelow && !nextBelow)
+        {
+            m_types[k] = convex ? VertexType::END : VertexType::MERGE;
+        }
+        else
+        {
+            m_types[k] = VertexType::REGULAR;
+        }
+        m_events[k] = SweepEvent{ at(k).getY(), at(k).getX(), k };
+    }
+    // same order as above, sorting the keys instead of reaching the vertices
+    std::sort(m_events.begin(), m_events.end(), [](const SweepEvent &a, const SweepEvent &b) {
+        return (a.y > b.y) || ((a.y == b.y) && (a.x < b.x));
+    });
+
+    // edge k goes from position k to the next one; only edges with the
+    // interior of the polygon to their right are kept in the status
+    m_status.clear();
+    m_helper.resize(static_cast<std::size_t>(m_length));
+    m_edges.assign(static_cast<std::size_t>(m_length), m_status.end());
+    m_diagonals.clear();
+    for(const SweepEvent &event: m_events)
+    {
+        int k{ event.position };
+        m_sweepX = at(k).getX();
+        m_sweepY = at(k).getY();
+        int prev{ prevPosition(k) };
+        switch (m_types[k])
+        {
+            case VertexType::START:
+                insertEdge(k, k);
+                break;
+            case VertexType::END:
+                connectToHelper(k, prev, true);
+                removeEdge(prev);
+                break;
+            case VertexType::SPLIT:
+            {
+                int left{ edgeLeftOf() };
+                connectToHelper(k, left, false);
+                if (left >= 0)
+                {
+                    m_helper[left] = k;
+                }
+                insertEdge(k, k);
+                break;
+            }
+            case VertexType::MERGE:
+            {
+                connectToHelper(k, prev, true);
+                removeEdge(prev);
+                int left{ edgeLeftOf() };
+                connectToHelper(k, left, true);
+                if (left >= 0)
+                {
+                    m_helper[left] = k;
+                }
+                break;
+            }
+            case VertexType::REGULAR:
+                if (above(prev, k))
+                {
+                    // the interior is to the right of the vertex
+                    connectToHelper(k, prev, true);
+                    removeEdge(prev);
+                    insertEdge(k, k);
+                }
+                else
+                {
+                    int left{ edgeLeftOf() };
+                    connectToHelper(k, left, true);
+                    if (left >= 0)
+                    {
+                        m_helper[left] = k;
+                    }
+                }
+                break;
+        }
+    }
+}
+
+template<class T>
+void Triangulator<T>::splitPieces() {
+    // neighbours of every position sorted by angle, with the edges that may
+    // be walked with the interior on their left not visited yet
+    m_adjacencyStart.assign(static_cast<std::size_t>(m_length) + 1, 2);
+    m_adjacencyStart[0] = 0;
+    for(const std::pair<int, int> &diagonal: m_diagonals)
+    {
+        ++m_adjacencyStart[diagonal.first + 1];
+        ++m_adjacencyStart[diagonal.second + 1];
+    }
+    for(int k{}; k < m_length; ++k)
+    {
+        m_adjacencyStart[k + 1] += m_adjacencyStart[k];
+    }
+    int slots{ m_adjacencyStart[m_length] };
+    m_adjacency.resize(static_cast<std::size_t>(slots));
+    m_angles.resize(static_cast<std::size_t>(slots));
+    m_visited.assign(static_cast<std::size_t>(slots), false);
+    std::vector<int> filled(m_adjacencyStart.begin(), m_adjacencyStart.end() - 1);
+    for(int k{}; k < m_length; ++k)
+    {
+        m_adjacency[filled[k]++] = nextPosition(k);
+        m_adjacency[filled[k]++] = prevPosition(k);
+    }
+    for(const std::pair<int, int> &diagonal: m_diagonals)
+    {
+        m_adjacency[filled[diagonal.first]++] = diagonal.second;
+        m_adjacency[filled[diagonal.second]++] = diagonal.first;
+    }
+    for(int k{}; k < m_length; ++k)
+    {
+        int begin{ m_adjacencyStart[k] };
+        int end{ m_adjacencyStart[k + 1] };
+        for(int s{ begin }; s < end; ++s)
+        {
+            const Punto<T> &p{ at(m_adjacency[s]) };
+            m_angles[s] = std::atan2(static_cast<double>(p.getY()) - at(k).getY(),
+                                     static_cast<double>(p.getX()) - at(k).getX());
+        }
+        // few neighbours per vertex, so a simple insertion sort by angle
+        for(int s{ begin + 1 }; s < end; ++s)
+        {
+            for(int r{ s }; r > begin && m_angles[r] < m_angles[r - 1]; --r)
+            {
+                std::swap(m_angles[r], m_angles[r - 1]);
+                std::swap(m_adjacency[r], m_adjacency[r - 1]);
+            }
+        }
+        for(int s{ begin }; s < end; ++s)
+        {
+            // the boundary edge back to the previous vertex has the interior on its right
+            if (m_adjacency[s] == prevPosition(k))
+            {
+                m_visited[s] = true;
+            }
+        }
+    }
+
+    // walk every face: after arriving to v from u, the face continues along
+    // the first neighbour of v clockwise from u
+    for(int k{}; k < m_length; ++k)
+    {
+        for(int s{ m_adjacencyStart[k] }; s < m_adjacencyStart[k + 1]; ++s)
+        {
+            if (m_visited[s])
+            {
+                continue;
+            }
+            m_piece.clear();
+            int u{ k };
+            int slot{ s };
+            while (!m_visited[slot])
+            {
+                m_visited[slot] = true;
+                m_piece.push_back(u);
+                int v{ m_adjacency[slot] };
+                int begin{ m_adjacencyStart[v] };
+                int degree{ m_adjacencyStart[v + 1] - begin };
+                int index{ };
+                while (m_adjacency[begin + index] != u)
+                {
+                    ++index;
+                }
+                slot = begin + (index + degree - 1) % degree;
+                u = v;
+            }
+            triangulateMonotone();
+        }
+    }
+}
+
+template<class T>
+void Triangulator<T>::triangulateMonotone() {
+    int length{ static_cast<int>(m_piece.size()) };
+    if (length < 3)
+    {
+        return;
+    }
+    int top{ };
+    int bottom{ };
+    for(int i{ 1 }; i < length; ++i)
+    {
+        if (above(m_piece[i], m_piece[top]))
+        {
+            top = i;
+        }
+        if (above(m_piece[bottom], m_piece[i]))
+        {
+            bottom = i;
+        }
+    }
+
+    // merge both chains from top to bottom; going counter clockwise from the
+    // top walks down the left chain
+    m_chain.clear();
+    m_onLeft.clear();
+    m_chain.push_back(m_piece[top]);
+    m_onLeft.push_back(true);
+    int left{ (top + 1) % length };
+    int right{ (top + length - 1) % length };
+    while (left != bottom || right != bottom)
+    {
+        bool takeLeft{ right == bottom || (left != bottom && above(m_piece[left], m_piece[right])) };
+        if (takeLeft)
+        {
+            m_chain.push_back(m_piece[left]);
+            left = (left + 1) % length;
+        }
+        else
+        {
+            m_chain.push_back(m_piece[right]);
+            right = (right + length - 1) % length;
+        }
+        m_onLeft.push_back(takeLeft);
+    }
+    m_chain.push_back(m_piece[bottom]);
+    m_onLeft.push_back(true);
+
+    m_stack.clear();
+    m_stack.push_back(0);
+    m_stack.push_back(1);
+    for(int j{ 2 }; j + 1 < length; ++j)
+    {
+        if (m_onLeft[j] != m_onLeft[m_stack.back()])
+        {
+            for(std::size_t s{ 1 }; s < m_stack.size(); ++s)
+            {
+                emit(index(m_chain[j]), index(m_chain[m_stack[s - 1]]), index(m_chain[m_stack[s]]));
+            }
+            m_stack.clear();
+            m_stack.push_back(j - 1);
+            m_stack.push_back(j);
+        }
+        else
+        {
+            int last{ m_stack.back() };
+            m_stack.pop_back();
+            while (!m_stack.empty())
+            {
+                auto angle{ Poligono<T>::signedAngle(at(m_chain[m_stack.back()]), at(m_chain[last]), at(m_chain[j])) };
+                if (!(m_onLeft[j] ? angle > 0 : angle < 0))
+                {
+                    break;
+                }
+                emit(index(m_chain[j]), index(m_chain[last]), index(m_chain[m_stack.back()]));
+                last = m_stack.back();
+                m_stack.pop_back();
+            }
+            m_stack.push_back(last);
+            m_stack.push_back(j);
+        }
+    }
+    for(std::size_t s{ 1 }; s < m_stack.size(); ++s)
+    {
+        emit(index(m_chain[length - 1]), index(m_chain[m_stack[s - 1]]),
+             index(m_chain[m_stack[s]]));
+    }
+}
+
+template<class T>
+void Triangulator<T>::monotone(const Punto<T>* puntos, int length, Triangle* out) {
+    if (length < 3)
+    {
+        return;
+    }
+    m_puntos = puntos;
+    m_length = length;
+    m_ccw = shoelaceDoubleArea(puntos, length) >= 0;
+    m_out = out;
+    m_emitted = 0;
+    m_walk.resize(static_cast<std::size_t>(length));
+    for(int k{}; k < length; ++k)
+    {
+        m_walk[k] = puntos[index(k)];
+    }
+
+    findDiagonals();
+    splitPieces();
+    if (m_emitted != length - 2)
+    {
+        // the sweep assumes a simple polygon; anything else is clipped
+        // instead, over whatever the sweep stored
+        earClipping(puntos, length, out);
+    }
+}
+
+template<class T>
+void Triangulator<T>::triangulate(const Punto<T>* puntos, int length, Triangle* out) {
+    if (length <= EAR_CLIPPING_MAX_VERTICES)
+    {
+        earClipping(puntos, length, out);
+    }
+    else
+    {
+        monotone(puntos, length, out);
+    }
+}
+
+/*
+ * Returns the triangles of the simple polygon pol, given by the indices of
+ * its vertices. A polygon of n vertices gives n-2 triangles.
+ */
+template <class T>
+std::vector<Triangle> triangulate(const Poligono<T> &pol)
+{
+    int length{ pol.getLength() };
+    std::vector<Triangle> triangles(static_cast<std::size_t>(std::max(0, length - 2)));
+    if (length >= 3)
+    {
+        Triangulator<T>{}.triangulate(&pol[0], length, triangles.data());
+    }
+    return triangles;
+}
+
+/*
+ * Returns where the triangles of each polygon of the set start in the output
+ * of batchTriangulate: polygon i gets the triangles from offsets[i] to
+ * offsets[i+1]-1. It has set.getLength()+1 elements.
+ */
+template <class T>
+std::vector<int> triangleOffsets(const PolygonSet<T> &set)
+{
+    std::vector<int> offsets(static_cast<std::size_t>(set.getLength()) + 1, 0);
+    for(int i{}; i < set.getLength(); ++i)
+    {
+        offsets[i + 1] = offsets[i] + std::max(0, set.polygonLength(i) - 2);
+    }
+    return offsets;
+}
+
+/*
+ * Triangulates every polygon of the set, storing the triangles of polygon i
+ * from out[triangleOffsets(set)[i]] on. Vertex indices are relative to the
+ * polygon. The polygons are split across threads so that every thread gets
+ * about the same amount of vertices. When threads is 0 one per hardware
+ * thread is used.
+ */
+template <class T>
+void batchTriangulate(const PolygonSet<T> &set, Triangle* out, int threads = 0)
+{
+    const Punto<T>* vertices{ set.getVertices() };
+    const int* offsets{ set.getOffsets() };
+    std::vector<int> outOffsets{ triangleOffsets(set) };
+    const int* first{ outOffsets.data() };
+    parallelForBalanced(offsets, set.getLength(), [=](int begin, int end) {
+        Triangulator<T> triangulator;
+        for(int i{ begin }; i < end; ++i)
+        {
+            triangulator.triangulate(vertices + offsets[i], offsets[i + 1] - offsets[i], out + first[i]);
+        }
+    }, threads, 1 << 12);
+}
+
+#endif //ELEM_GEOMETRICOS_TRIANGULATION_H
@@ -6,19 +6,73 @@
 #define ELEM_GEOMETRICOS_VECTOR_H
 
 #include "Punto.h"
+#include "WideArithmetic.h"
 #include <math.h>
 
 
 /*
- * Class for holding vectors with 3D coordinates
+ * Class for holding vectors with 3D coordinates. Like Vector, it starts at
+ * the origin and is given by its endpoint.
  */
 template <class T>
 class Vector3D
 {
 private:
-    Punto<T> m_end;
+    Punto3D<T> m_end;
+
 public:
+    /*
+     * Creates a Vector3D given the x, y and z coordinates of the endpoint
+     */
+    constexpr Vector3D(T endX = 0, T endY = 0, T endZ = 0) noexcept:
+    m_end{ endX, endY, endZ }
+    {};
+
+    /*
+     * Creates a Vector3D with its endpoint at the given point, of the same
+     * type as the vector.
+     */
+    constexpr Vector3D(const Punto3D<T> &endPoint) noexcept:
+    m_end{ endPoint }
+    {};
+
+    /*
+     * Copy constructor for Vector3D
+     */
+    constexpr Vector3D(const Vector3D<T> &copy) noexcept = default;
+
+    /*
+     * Evaluates an arithmetic expression of 3D vectors, see
+     * CoordinateExpression.h. Its coordinates must convert to T without
+     * narrowing.
+     */
+    template <class E, class = std::enable_if_t<isNodeOfKind<E, Vector3DKind>()>>
+    constexpr Vector3D(const E &expression) noexcept
+            : m_end{ expression.getX(), expression.getY(), expression.getZ() }
+    {};
+
+    /*
+     * Returns the Punto3D corresponding to the end point of the vector.
+     * This reference may not be edited.
+     */
+    constexpr const Punto3D<T>& getEnd() const noexcept { return m_end; }
+
+    constexpr T getX() const noexcept { return m_end.getX(); }
+    constexpr T getY() const noexcept { return m_end.getY(); }
+    constexpr T getZ() const noexcept { return m_end.getZ(); }
+
+    /*
+     * Returns the euclidean Norm of the Vector3D.
+     */
+    double euclideanNorm() const;
+
+    /*
+     * Returns the Vector3D obtained after performing normalization on this
+     * vector.
+     */
+    Vector3D<double> vecNorm() const;
 
+    constexpr Vector3D<T>& operator= (const Vector3D<T>& vector) noexcept = default;
 };
 
 /*
@@ -36,8 +90,8 @@ public:
     /*
      * Creates a Vector given the x and y coordinates of the endpoint
      */
-    Vector(T endX = 0, T endY = 0):
-    m_end{ Punto<T>{ endX, endY }}
+    constexpr Vector(T endX = 0, T endY = 0) noexcept:
+    m_end{ endX, endY }
     {
     };
 
@@ -45,32 +99,40 @@ public:
      * Creates a Vector with coordinates for its endpoint specified by the
      * given point argument. Endpoint Punto type must match the vector type.
      */
-    Vector(const Punto<T> &endPoint):
-    m_end{ Punto<T>{ endPoint.getX(), endPoint.getY() }}
+    constexpr Vector(const Punto<T> &endPoint) noexcept:
+    m_end{ endPoint }
     {};
 
     /*
      * Copy constructor for Vector
      */
-    Vector(const Vector<T> &copy)
-            : Vector(copy.getEnd())
+    constexpr Vector(const Vector<T> &copy) noexcept = default;
+
+    /*
+     * Evaluates an arithmetic expression of vectors, see
+     * CoordinateExpression.h. Its coordinates must convert to T without
+     * narrowing.
+     */
+    template <class E, class = std::enable_if_t<isNodeOfKind<E, VectorKind>()>>
+    constexpr Vector(const E &expression) noexcept
+            : m_end{ expression.getX(), expression.getY() }
     {};
 
     /*
      * Returns the Punto corresponding to the end point of the vector.
      * This reference may not be edited.
      */
-    const Punto<T>& getEnd() const { return m_end; }
+    constexpr const Punto<T>& getEnd() const noexcept { return m_end; }
 
     /*
      * Returns the X coordinate of the endpoint
      */
-    T getX() const { return getEnd().getX(); }
+    constexpr T getX() const noexcept { return m_end.getX(); }
 
     /*
      * Returns the Y coordinate of the endpoint
      */
-    T getY() const { return getEnd().getY(); }
+    constexpr T getY() const noexcept { return m_end.getY(); }
 
     /*
      * Returns the euclidean Norm of the Vector.
@@ -83,12 +145,12 @@ public:
      */
     Vector<double> vecNorm() const;
 
-    Vector<T>& operator= (const Vector<T>& vector);
+    constexpr Vector<T>& operator= (const Vector<T>& vector) noexcept = default;
 };
 
 template<class T>
 double Vector<T>::euclideanNorm() const {
-    return std::sqrt(dotProduct(*this, *this));
+    return std::sqrt(static_cast<double>(dotProduct(*this, *this)));
 }
 
 template<class T>
@@ -96,86 +158,85 @@ Vector<double> Vector<T>::vecNorm() const {
     return (*this)*(1/((*this).euclideanNorm()));
 }
 
-/*
-* Vector addition done coordinate-wise of the endpoints.
-* Both Vector can have different types. The result will be of whatever type
-* given by the implicit conversion (if there's any)
-*/
-template<class T, class S>
-auto operator+(const Vector<T> &v1, const Vector<S> &v2) {
-    auto sumV{ v1.getEnd() + v2.getEnd() };
-    Vector<decltype(sumV.getX())> res{ sumV };
-    return res;
+template<class T>
+double Vector3D<T>::euclideanNorm() const {
+    return std::sqrt(static_cast<double>(dotProduct(*this, *this)));
 }
 
-/*
-* Vector subtraction done coordinate-wise of the endpoints.
-* Both Vector can have different types. The result will be of whatever type
-* given by the implicit conversion (if there's any)
-*/
-template<class T, class S>
-auto operator-(const Vector<T> &v1, const Vector<S> &v2) {
-    auto minV{ -v2.getEnd() };
-    Vector<decltype(minV.getX())> res{ v1+Vector(minV) };
-    return res;
+template<class T>
+Vector3D<double> Vector3D<T>::vecNorm() const {
+    return (*this)*(1/((*this).euclideanNorm()));
 }
 
+// addition, subtraction, unary minus and the product by a scalar of vectors,
+// 2D and 3D, are the expression templates of CoordinateExpression.h, and the
+// products below take those expressions as well
+
 /*
- * Calculates the dot product between two vectors. The result is a scalar
- * corresponding to the sum of the products between all coordinates.
+ * Calculates the dot product between two vectors, both 2D or both 3D. The
+ * result is a scalar corresponding to the sum of the products between all
+ * coordinates. Integer products are computed in their WideType, and the sum
+ * of three of them in the next wider type, so the result is exact.
  */
-template <class T, class S>
-auto dotProduct(const Vector<T> &v1, const Vector<S> &v2)
+template <class L, class R, class Kind = CommonKind<L, R>,
+          class = std::enable_if_t<std::is_same<Kind, VectorKind>::value || std::is_same<Kind, Vector3DKind>::value>>
+constexpr auto dotProduct(const L &v1, const R &v2) noexcept
 {
-    auto prodX{ v1.getEnd().getX() * v2.getEnd().getX() };
-    auto prodY { v1.getEnd().getY() * v2.getEnd().getY() };
-    return prodX + prodY;
+    using Wide = WideType<decltype(v1.getX() * v2.getX())>;
+    Wide prodX{ static_cast<Wide>(v1.getX()) * v2.getX() };
+    Wide prodY { static_cast<Wide>(v1.getY()) * v2.getY() };
+    if constexpr (Kind::dimension == 3)
+    {
+        Wide prodZ{ static_cast<Wide>(v1.getZ()) * v2.getZ() };
+        return static_cast<WideType<Wide>>(prodX) + prodY + prodZ;
+    }
+    else
+    {
+        return prodX + prodY;
+    }
 }
 
 /*
- * Scalar product between a vector and a value s.
- * see: scalar product between Punto and values.
+ * Returns the value in coordinate Z after performing cross product between two
+ * vectors (considering them as 3D with Z=0). This is equivalent as just taking
+ * the determinant between v1 and v2. Integer products are widened as in
+ * dotProduct.
  */
-template <class T, class S>
-auto operator*(const Vector<T> &v, S s)
+template <class L, class R, class = std::enable_if_t<std::is_same<CommonKind<L, R>, VectorKind>::value>>
+constexpr auto crossProdValue(const L &v1, const R &v2) noexcept
 {
-    auto scaledPoint{ v.getEnd()*s };
-    auto scaledVec = Vector(scaledPoint);
-    return scaledVec;
-}
-
-template <class T, class S>
-auto operator*(S s, const Vector<T> &v)
-{
-    return v*s;
+    using Wide = WideType<decltype(v1.getX() * v2.getX())>;
+    Wide firstCross{ static_cast<Wide>(v1.getX()) * v2.getY() };
+    Wide secondCross{ static_cast<Wide>(v1.getY()) * v2.getX() };
+    return firstCross - secondCross;
 }
 
 /*
- * Returns the value in coordinate Z after performing cross product between two
- * vectors (considering them as 3D with Z=0). This is equivalent as just taking
- * the determinant between v1 and v2.
+ * Returns the cross product of two 3D vectors, perpendicular to both and
+ * following the right hand rule. Integer products are widened as in
+ * dotProduct, so the coordinates of the result are of the WideType.
  */
-template <class T, class S>
-auto crossProdValue(const Vector<T> &v1, const Vector<S> &v2)
+template <class L, class R, class = std::enable_if_t<std::is_same<CommonKind<L, R>, Vector3DKind>::value>>
+constexpr auto crossProduct(const L &v1, const R &v2) noexcept
 {
-    auto firstCross{ v1.getEnd().getX() * v2.getEnd().getY() };
-    auto secondCross{ v1.getEnd().getY() * v2.getEnd().getX() };
-    return firstCross - secondCross;
+    using Wide = WideType<decltype(v1.getX() * v2.getX())>;
+    Wide crossX{ static_cast<Wide>(v1.getY()) * v2.getZ() - static_cast<Wide>(v1.getZ()) * v2.getY() };
+    Wide crossY{ static_cast<Wide>(v1.getZ()) * v2.getX() - static_cast<Wide>(v1.getX()) * v2.getZ() };
+    Wide crossZ{ static_cast<Wide>(v1.getX()) * v2.getY() - static_cast<Wide>(v1.getY()) * v2.getX() };
+    return Vector3D<Wide>{ crossX, crossY, crossZ };
 }
 
 /*
  * Vector equality. Endpoints must match to be considered equal.
  */
 template <class T>
-bool operator==(const Vector<T> &v1, const Vector<T> &v2) {
+constexpr bool operator==(const Vector<T> &v1, const Vector<T> &v2) noexcept {
     return (v1.getEnd() == v2.getEnd());
 }
 
-template<class T>
-Vector<T>& Vector<T>::operator=(const Vector<T> &vector) {
-    m_end = vector.getEnd();
-
-    return *this;
+template <class T>
+constexpr bool operator==(const Vector3D<T> &v1, const Vector3D<T> &v2) noexcept {
+    return (v1.getEnd() == v2.getEnd());
 }
 
 template <class T>
@@ -185,4 +246,11 @@ std::ostream& operator<<(std::ostream &out, const Vector<T> &v)
     return out;
 }
 
+template <class T>
+std::ostream& operator<<(std::ostream &out, const Vector3D<T> &v)
+{
+    out << "(start=(0,0,0), end=" <<v.getEnd() << ")";
+    return out;
+}
+
 #endif //ELEM_GEOMETRICOS_VECTOR_H
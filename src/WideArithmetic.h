@@ -0,0 +1,69 @@
+//
+// Wider types for the products of integer coordinates. A product of two
+// 32 bit coordinates needs 64 bits and a determinant of differences of them
+// needs 66, so integer determinants and area sums are computed in a type
+// with room for them and are exact, instead of silently overflowing. Floating
+// point types are kept as they are.
+//
+
+#ifndef ELEM_GEOMETRICOS_WIDEARITHMETIC_H
+#define ELEM_GEOMETRICOS_WIDEARITHMETIC_H
+
+#include <type_traits>
+
+/*
+ * Type with room for the product of two T and for the sum of two of those
+ * products: int32 goes to int64 and int64 to __int128, where the compiler
+ * has it.
+ */
+template <class T> struct Widened { using type = T; };
+template <> struct Widened<short> { using type = long long; };
+template <> struct Widened<int> { using type = long long; };
+
+#if defined(__SIZEOF_INT128__)
+template <> struct Widened<long> { using type = std::conditional_t<sizeof(long) == sizeof(int), long long, __int128>; };
+template <> struct Widened<long long> { using type = __int128; };
+#endif
+
+template <class T>
+using WideType = typename Widened<T>::type;
+
+/*
+ * Type of the orientation determinant (b - a) x (c - a) of three points with
+ * coordinates in T. The differences take one more bit than the coordinates,
+ * so integers are widened twice: the determinant of int32 points is exact in
+ * __int128, and the one of int64 points while the coordinates stay below
+ * 2^62 in absolute value.
+ */
+template <class T>
+using OrientationType = WideType<WideType<T>>;
+
+/*
+ * Returns the exact orientation determinant of the points (ax, ay), (bx, by)
+ * and (cx, cy): positive when c is to the left of the directed line from a
+ * to b, negative when it is to the right and zero when they are collinear.
+ * Meant for integer coordinates; for floating point ones it's just the
+ * rounded cross product of the differences.
+ */
+template <class T>
+constexpr OrientationType<T> wideOrientation(T ax, T ay, T bx, T by, T cx, T cy) noexcept
+{
+    using Difference = WideType<T>;
+    using Product = OrientationType<T>;
+    Difference abX{ static_cast<Difference>(bx) - ax };
+    Difference abY{ static_cast<Difference>(by) - ay };
+    Difference acX{ static_cast<Difference>(cx) - ax };
+    Difference acY{ static_cast<Difference>(cy) - ay };
+    return static_cast<Product>(abX) * acY - static_cast<Product>(abY) * acX;
+}
+
+/*
+ * Returns -1, 0 or 1 as the sign of value, without branches.
+ */
+template <class V>
+constexpr int signOf(V value) noexcept
+{
+    return (value > 0) - (value < 0);
+}
+
+#endif //ELEM_GEOMETRICOS_WIDEARITHMETIC_H
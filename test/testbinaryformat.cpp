@@ -0,0 +1,203 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace setup
+{
+    const Poligono<double> polA {{   1,1.8}, {-0.3,2.3}, {  -2,2.2 }, {-2.6,1.2}, {-1.6,  1},
+                                 {-0.9,1.6}, {-0.2,1.3}, {-0.7,-0.3}, {-1.6,-0.2},{-1.6,0.4},
+                                 {-2.5,0.3}, {-1.5,-1.9},{0.02727272727,-1.3}, {1.3,-0.8}};
+
+    const Poligono<double> square {{0,0}, {2,0}, {2,2}, {0,2}};
+
+    const std::string polygonsPath{ "testbinaryformat_polygons.bin" };
+    const std::string pointsPath{ "testbinaryformat_points.bin" };
+    const std::string segmentsPath{ "testbinaryformat_segments.bin" };
+    const std::string brokenPath{ "testbinaryformat_broken.bin" };
+
+    /*
+     * Writes the given bytes to the file at path.
+     */
+    void writeFile(const std::string &path, const std::string &bytes)
+    {
+        std::ofstream out{ path, std::ios::binary };
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    /*
+     * Returns the whole contents of the file at path.
+     */
+    std::string readFile(const std::string &path)
+    {
+        std::ifstream in{ path, std::ios::binary };
+        std::ostringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+}
+
+void testPolygonSetRoundTrip()
+{
+    PolygonSet<double> set;
+    set.push_back(setup::polA);
+    set.push_back(Poligono<double>{});
+    set.push_back(setup::square);
+    {
+        std::ofstream out{ setup::polygonsPath, std::ios::binary };
+        ASSERT_EQUALS(true, writePolygonSet(out, set));
+    }
+
+    MappedGeometry<double> mapped{ setup::polygonsPath };
+    ASSERT_EQUALS(true, mapped.isValid());
+    ASSERT_EQUALS(true, mapped.getKind() == GeometryKind::POLYGONS);
+    ASSERT_EQUALS(3, mapped.getLength());
+    ASSERT_EQUALS(18, mapped.getVertexCount());
+    ASSERT_EQUALS(0, mapped.getOffsets()[0]);
+    ASSERT_EQUALS(14, mapped.getOffsets()[1]);
+    ASSERT_EQUALS(14, mapped.getOffsets()[2]);
+    ASSERT_EQUALS(18, mapped.getOffsets()[3]);
+
+    bool sameVertices{ true };
+    for(int i{}; i < set.getVertexCount(); ++i)
+    {
+        sameVertices = sameVertices && set.getVertices()[i].getX() == mapped.getVertices()[i].getX()
+                       && set.getVertices()[i].getY() == mapped.getVertices()[i].getY();
+    }
+    ASSERT_EQUALS(true, sameVertices);
+
+    // polygons are views over the mapped vertices
+    const Poligono<double> first{ mapped[0] };
+    ASSERT_EQUALS(true, first.isView());
+    ASSERT_EQUALS(true, &first[0] == mapped.getVertices());
+    ASSERT_EQUALS(14, first.getLength());
+    ASSERT_EQUALS(setup::polA.area(), first.area());
+    ASSERT_EQUALS(0, mapped[1].getLength());
+    ASSERT_EQUALS(true, mapped[2].pointInside(Punto<double>{ 1, 1 }));
+    ASSERT_EQUALS(false, mapped[2].pointInside(Punto<double>{ 3, 1 }));
+
+    // editing a polygon leaves the mapped vertices as they were
+    auto edited{ mapped[2] };
+    edited[0] = Punto<double>{ 42, 42 };
+    ASSERT_EQUALS(false, edited.isView());
+    ASSERT_EQUALS(true, set.getVertices()[14].getX() == mapped.getVertices()[14].getX());
+
+    // the header is little endian
+    std::string bytes{ setup::readFile(setup::polygonsPath) };
+    ASSERT_EQUALS("EGEO", bytes.substr(0, 4));
+    ASSERT_EQUALS(1, static_cast<int>(bytes[4]));
+    ASSERT_EQUALS(0, static_cast<int>(bytes[5]));
+    ASSERT_EQUALS(3, static_cast<int>(bytes[6]));
+    ASSERT_EQUALS(3, static_cast<int>(bytes[8]));
+
+    std::remove(setup::polygonsPath.c_str());
+}
+
+void testPointsRoundTrip()
+{
+    std::vector<Punto<float>> points{ Punto<float>{ 1.5f, -2.0f }, Punto<float>{ 0.25f, 8.0f },
+                                      Punto<float>{ -3.0f, 0.0f } };
+    {
+        std::ofstream out{ setup::pointsPath, std::ios::binary };
+        ASSERT_EQUALS(true, writePoints(out, points.data(), 3));
+    }
+
+    MappedGeometry<float> mapped{ setup::pointsPath };
+    ASSERT_EQUALS(true, mapped.isValid());
+    ASSERT_EQUALS(true, mapped.getKind() == GeometryKind::POINTS);
+    ASSERT_EQUALS(3, mapped.getLength());
+    ASSERT_EQUALS(true, mapped.getOffsets() == nullptr);
+    ASSERT_EQUALS(0.25f, mapped.getVertices()[1].getX());
+    ASSERT_EQUALS(8.0f, mapped.getVertices()[1].getY());
+    ASSERT_EQUALS(-3.0f, mapped.getVertices()[2].getX());
+
+    std::remove(setup::pointsPath.c_str());
+}
+
+void testSegmentsRoundTrip()
+{
+    std::vector<Segmento<int>> segments{ Segmento<int>{ 0, 0, 4, 4 }, Segmento<int>{ 0, 4, 4, 0 },
+                                         Segmento<int>{ 5, 5, 6, 7 } };
+    {
+        std::ofstream out{ setup::segmentsPath, std::ios::binary };
+        ASSERT_EQUALS(true, writeSegments(out, segments.data(), 3));
+    }
+
+    MappedGeometry<int> mapped{ setup::segmentsPath };
+    ASSERT_EQUALS(true, mapped.isValid());
+    ASSERT_EQUALS(true, mapped.getKind() == GeometryKind::SEGMENTS);
+    ASSERT_EQUALS(3, mapped.getLength());
+    ASSERT_EQUALS(6, mapped.getVertexCount());
+    Segmento<int> last{ mapped.segment(2) };
+    ASSERT_EQUALS(5, last.getStart().getEnd().getX());
+    ASSERT_EQUALS(7, last.getEnd().getEnd().getY());
+
+    // the mapped endpoints go straight to the algorithms taking arrays
+    std::vector<SegmentIntersection> crossings{ segmentIntersections(mapped.getVertices(), 3) };
+    ASSERT_EQUALS(1, static_cast<int>(crossings.size()));
+
+    std::remove(setup::segmentsPath.c_str());
+}
+
+void testBrokenFiles()
+{
+    MappedGeometry<double> missing{ "testbinaryformat_missing.bin" };
+    ASSERT_EQUALS(false, missing.isValid());
+    ASSERT_EQUALS(true, missing.getStatus() == BinaryStatus::CANT_OPEN);
+    ASSERT_EQUALS(0, missing.getLength());
+
+    PolygonSet<double> set;
+    set.push_back(setup::polA);
+    std::ostringstream out;
+    writePolygonSet(out, set);
+    std::string bytes{ out.str() };
+
+    setup::writeFile(setup::brokenPath, bytes);
+    MappedGeometry<float> wrongScalar{ setup::brokenPath };
+    ASSERT_EQUALS(true, wrongScalar.getStatus() == BinaryStatus::WRONG_SCALAR);
+
+    setup::writeFile(setup::brokenPath, bytes.substr(0, bytes.size() - 8));
+    MappedGeometry<double> truncated{ setup::brokenPath };
+    ASSERT_EQUALS(true, truncated.getStatus() == BinaryStatus::TOO_SHORT);
+    ASSERT_EQUALS(true, truncated.getVertices() == nullptr);
+
+    std::string badMagic{ bytes };
+    badMagic[0] = 'X';
+    setup::writeFile(setup::brokenPath, badMagic);
+    ASSERT_EQUALS(true, MappedGeometry<double>{ setup::brokenPath }.getStatus() == BinaryStatus::BAD_MAGIC);
+
+    std::string newerVersion{ bytes };
+    newerVersion[4] = 2;
+    setup::writeFile(setup::brokenPath, newerVersion);
+    ASSERT_EQUALS(true, MappedGeometry<double>{ setup::brokenPath }.getStatus() == BinaryStatus::BAD_VERSION);
+
+    // the last offset must match the amount of vertices
+    std::string badOffsets{ bytes };
+    badOffsets[36] = 15;
+    setup::writeFile(setup::brokenPath, badOffsets);
+    ASSERT_EQUALS(true, MappedGeometry<double>{ setup::brokenPath }.getStatus() == BinaryStatus::BAD_OFFSETS);
+
+    // a vertex array starting far past the end of the file
+    std::string farOffset{ bytes };
+    farOffset.replace(24, 8, "\xf0\xff\xff\xff\xff\xff\xff\xff", 8);
+    setup::writeFile(setup::brokenPath, farOffset);
+    ASSERT_EQUALS(true, MappedGeometry<double>{ setup::brokenPath }.getStatus() == BinaryStatus::TOO_SHORT);
+
+    std::remove(setup::brokenPath.c_str());
+}
+
+int main() {
+    RUN(testPolygonSetRoundTrip);
+    RUN(testPointsRoundTrip);
+    RUN(testSegmentsRoundTrip);
+    RUN(testBrokenFiles);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,226 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include "testshapes.h"
+#include <vector>
+
+namespace setup
+{
+    const Poligono<int> square{{0,0}, {10,0}, {10,10}, {0,10}};
+
+    /*
+     * Sum of the areas of the polygons of the set.
+     */
+    template <class T>
+    double totalArea(const PolygonSet<T> &set)
+    {
+        double area{ };
+        for(int i{}; i < set.getLength(); ++i)
+        {
+            area += set[i].area();
+        }
+        return area;
+    }
+}
+
+void testClip()
+{
+    PolygonClipper<int> clipper;
+    PolygonSet<int> out;
+
+    // a triangle over the corner of the square
+    const ConvexPoligono<int> triangle{ Poligono<int>{{5,5}, {15,5}, {5,15}} };
+    ASSERT_EQUALS(true, clipper.clip(setup::square, triangle, out));
+    ASSERT_EQUALS(1, out.getLength());
+    ASSERT_EQUALS(4, out.polygonLength(0));
+    ASSERT_EQUALS(25.0, out[0].area());
+
+    // a window holding the whole polygon leaves it as it was
+    const ConvexPoligono<int> big{ Poligono<int>{{-1,-1}, {20,-1}, {20,20}, {-1,20}} };
+    ASSERT_EQUALS(true, clipper.clip(setup::square, big, out));
+    ASSERT_EQUALS(4, out.polygonLength(1));
+    ASSERT_EQUALS(100.0, out[1].area());
+
+    // nothing is appended when they don't overlap, or only touch
+    const ConvexPoligono<int> away{ Poligono<int>{{20,20}, {30,20}, {30,30}} };
+    const ConvexPoligono<int> touching{ Poligono<int>{{10,0}, {20,0}, {20,10}} };
+    ASSERT_EQUALS(false, clipper.clip(setup::square, away, out));
+    ASSERT_EQUALS(false, clipper.clip(setup::square, touching, out));
+    ASSERT_EQUALS(2, out.getLength());
+
+    // the corners of the square are cut off
+    const ConvexPoligono<int> diamond{ Poligono<int>{{5,-2}, {12,5}, {5,12}, {-2,5}} };
+    ASSERT_EQUALS(true, clipper.clip(setup::square, diamond, out));
+    ASSERT_EQUALS(8, out.polygonLength(2));
+    ASSERT_EQUALS(82.0, out[2].area());
+
+    // clipping a convex polygon against itself gives it back
+    std::vector<Punto<double>> star{ setup::randomStar(300, 1u) };
+    const ConvexPoligono<double> hull{ star.data(), 300 };
+    PolygonSet<double> hullPolygon;
+    hullPolygon.push_back(&hull[0], hull.getLength());
+    PolygonSet<double> self{ clip(hullPolygon[0], hull) };
+    ASSERT_EQUALS(1, self.getLength());
+    ASSERT_EQUALS(true, withinEps(hullPolygon[0].area(), self[0].area(), 1e-9, 1e-9));
+}
+
+void testClipRectangle()
+{
+    PolygonClipper<int> clipperInt;
+    PolygonSet<int> outInt;
+    ASSERT_EQUALS(true, clipperInt.clipRectangle(setup::square, 2, 3, 5, 9, outInt));
+    ASSERT_EQUALS(1, outInt.getLength());
+    ASSERT_EQUALS(4, outInt.polygonLength(0));
+    ASSERT_EQUALS(18.0, outInt[0].area());
+    ASSERT_EQUALS(false, clipperInt.clipRectangle(setup::square, 10, 0, 20, 10, outInt));
+    ASSERT_EQUALS(false, clipperInt.clipRectangle(setup::square, 3, 3, 3, 5, outInt));
+
+    // the same area as clipping against the rectangle as a convex window,
+    // for polygons in both orientations
+    PolygonClipper<double> clipper;
+    bool allMatch{ true };
+    for(unsigned seed{}; seed < 20; ++seed)
+    {
+        std::vector<Punto<double>> star{ setup::randomStar(200, seed, seed % 2 == 1) };
+        const Poligono<double> pol{ star.begin(), star.end() };
+        const ConvexPoligono<double> window{ Poligono<double>{{-3,-2}, {4,-2}, {4,6}, {-3,6}} };
+        PolygonSet<double> rectangle;
+        PolygonSet<double> convex;
+        clipper.clipRectangle(pol, -3, -2, 4, 6, rectangle);
+        clipper.clip(pol, window, convex);
+        allMatch = allMatch && rectangle.getLength() == 1 && convex.getLength() == 1
+                   && withinEps(convex[0].area(), rectangle[0].area(), 1e-9, 1e-9);
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+void testClipToGrid()
+{
+    PolygonClipper<int> clipperInt;
+    PolygonSet<int> outInt;
+    std::vector<int> tilesInt;
+
+    // the square over a grid of 3x3 tiles of 4 units from (-1, -1)
+    const TileGrid<int> gridInt{ -1, -1, 4, 4, 3, 3 };
+    ASSERT_EQUALS(9, clipperInt.clipToGrid(setup::square, gridInt, outInt, tilesInt));
+    ASSERT_EQUALS(9, static_cast<int>(tilesInt.size()));
+    ASSERT_EQUALS(100.0, setup::totalArea(outInt));
+    ASSERT_EQUALS(9.0, outInt[0].area());
+    ASSERT_EQUALS(12.0, outInt[1].area());
+    ASSERT_EQUALS(16.0, outInt[4].area());
+    bool ordered{ true };
+    for(int i{}; i < 9; ++i)
+    {
+        ordered = ordered && tilesInt[i] == i;
+    }
+    ASSERT_EQUALS(true, ordered);
+
+    // tiles only touched by the polygon get nothing, as do tiles outside it
+    outInt.clear();
+    tilesInt.clear();
+    const TileGrid<int> aligned{ 0, 0, 5, 5, 4, 4 };
+    ASSERT_EQUALS(4, clipperInt.clipToGrid(setup::square, aligned, outInt, tilesInt));
+    ASSERT_EQUALS(0, tilesInt[0]);
+    ASSERT_EQUALS(1, tilesInt[1]);
+    ASSERT_EQUALS(4, tilesInt[2]);
+    ASSERT_EQUALS(5, tilesInt[3]);
+
+    // the pieces cover the polygon, and each one is the polygon clipped
+    // against the rectangle of its tile
+    PolygonClipper<double> clipper;
+    const TileGrid<double> grid{ -10, -10, 20.0 / 7, 4, 7, 5 };
+    bool allMatch{ true };
+    for(unsigned seed{}; seed < 20; ++seed)
+    {
+        std::vector<Punto<double>> star{ setup::randomStar(500, seed, seed % 2 == 1) };
+        const Poligono<double> pol{ star.begin(), star.end() };
+        PolygonSet<double> pieces;
+        std::vector<int> tiles;
+        int count{ clipper.clipToGrid(pol, grid, pieces, tiles) };
+        allMatch = allMatch && count == pieces.getLength() && count == static_cast<int>(tiles.size());
+        allMatch = allMatch && withinEps(pol.area(), setup::totalArea(pieces), 1e-9, 1e-9);
+        for(int i{}; allMatch && i < count; ++i)
+        {
+            int column{ tiles[i] % grid.columns };
+            int row{ tiles[i] / grid.columns };
+            PolygonSet<double> expected;
+            clipper.clipRectangle(pol, grid.minX + column * grid.tileWidth, grid.minY + row * grid.tileHeight,
+                                  grid.minX + (column + 1) * grid.tileWidth,
+                                  grid.minY + (row + 1) * grid.tileHeight, expected);
+            allMatch = expected.getLength() == 1 && withinEps(expected[0].area(), pieces[i].area(), 1e-9, 1e-9);
+        }
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+void testBatchClip()
+{
+    PolygonSet<double> set;
+    set.push_back(Poligono<double>{});
+    for(unsigned seed{}; seed < 200; ++seed)
+    {
+        std::vector<Punto<double>> star{ setup::randomStar(10 + 37 * seed % 400, seed, seed % 3 == 0) };
+        for(Punto<double> &p: star)
+        {
+            p = Punto<double>{ p.getX() + seed % 10 * 5.0, p.getY() };
+        }
+        set.push_back(star.data(), static_cast<int>(star.size()));
+    }
+    const ConvexPoligono<double> window{ Poligono<double>{{0,-5}, {30,-5}, {30,5}, {0,5}} };
+    const TileGrid<double> grid{ -10, -10, 5, 5, 12, 4 };
+
+    PolygonClipper<double> clipper;
+    PolygonSet<double> expectedClip;
+    std::vector<int> expectedSources;
+    PolygonSet<double> expectedPieces;
+    std::vector<int> expectedTiles;
+    std::vector<int> expectedPolygons;
+    for(int i{}; i < set.getLength(); ++i)
+    {
+        if (clipper.clip(set[i], window, expectedClip))
+        {
+            expectedSources.push_back(i);
+        }
+        int count{ clipper.clipToGrid(set[i], grid, expectedPieces, expectedTiles) };
+        expectedPolygons.insert(expectedPolygons.end(), static_cast<std::size_t>(count), i);
+    }
+    ASSERT_EQUALS(true, expectedClip.getLength() > 0 && expectedClip.getLength() < set.getLength());
+
+    for(int threads: { 1, 4 })
+    {
+        PolygonSet<double> clipped;
+        std::vector<int> sources;
+        batchClip(set, window, clipped, sources, threads);
+        bool allMatch{ clipped.getLength() == expectedClip.getLength() && sources == expectedSources };
+        for(int i{}; allMatch && i < clipped.getLength(); ++i)
+        {
+            allMatch = clipped.polygonLength(i) == expectedClip.polygonLength(i)
+                       && clipped[i].area() == expectedClip[i].area();
+        }
+        ASSERT_EQUALS(true, allMatch);
+
+        PolygonSet<double> pieces;
+        std::vector<ClippedPiece> from;
+        batchClipToGrid(set, grid, pieces, from, threads);
+        bool piecesMatch{ pieces.getVertexCount() == expectedPieces.getVertexCount()
+                          && static_cast<int>(from.size()) == expectedPieces.getLength() };
+        for(int i{}; piecesMatch && i < pieces.getLength(); ++i)
+        {
+            piecesMatch = from[i].polygon == expectedPolygons[i] && from[i].tile == expectedTiles[i]
+                          && pieces[i].area() == expectedPieces[i].area();
+        }
+        ASSERT_EQUALS(true, piecesMatch);
+    }
+}
+
+int main() {
+    RUN(testClip);
+    RUN(testClipRectangle);
+    RUN(testClipToGrid);
+    RUN(testBatchClip);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,151 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <random>
+#include <vector>
+
+/*
+ * Checks that hull is strictly convex, counter clockwise, and that every
+ * point lies inside it or on its boundary.
+ */
+template <class T>
+bool isHullOf(const Poligono<T> &hull, const std::vector<Punto<T>> &puntos)
+{
+    int length{ hull.getLength() };
+    for(int i{}; i < length; ++i)
+    {
+        if (hull.signedAngle(i) <= 0)
+        {
+            return false;
+        }
+    }
+    for(const Punto<T> &p: puntos)
+    {
+        for(int i{}; i < length; ++i)
+        {
+            if (hullTurn(hull[i], hull[(i+1) % length], p) < 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <class T>
+bool sameVertices(const Poligono<T> &pol1, const Poligono<T> &pol2)
+{
+    if (pol1.getLength() != pol2.getLength())
+    {
+        return false;
+    }
+    for(int i{}; i < pol1.getLength(); ++i)
+    {
+        if (pol1[i].getX() != pol2[i].getX() || pol1[i].getY() != pol2[i].getY())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testHullSquare()
+{
+    // corners, interior points, points on the edges and duplicates
+    const std::vector<Punto<int>> puntos{{ 2, 2 }, { 0, 0 }, { 4, 4 }, { 1, 3 }, { 4, 0 }, { 2, 0 },
+                                         { 0, 4 }, { 0, 2 }, { 4, 4 }, { 3, 1 }, { 0, 0 }};
+    const Poligono<int> hull{ convexHull(puntos.data(), static_cast<int>(puntos.size())) };
+    ASSERT_EQUALS(4, hull.getLength());
+    ASSERT_EQUALS(Punto<int>(0, 0), hull[0]);
+    ASSERT_EQUALS(Punto<int>(4, 0), hull[1]);
+    ASSERT_EQUALS(Punto<int>(4, 4), hull[2]);
+    ASSERT_EQUALS(Punto<int>(0, 4), hull[3]);
+    ASSERT_EQUALS(true, hull.isCCW());
+    ASSERT_EQUALS(32, hull.doubleSignedArea());
+}
+
+void testHullDegenerate()
+{
+    ASSERT_EQUALS(0, convexHull(static_cast<const Punto<double>*>(nullptr), 0).getLength());
+
+    const std::vector<Punto<double>> single{{ 1.5, 2.5 }, { 1.5, 2.5 }};
+    ASSERT_EQUALS(1, convexHull(single.data(), 2).getLength());
+
+    const std::vector<Punto<double>> collinear{{ 0, 0 }, { 3, 3 }, { 1, 1 }, { 2, 2 }};
+    const Poligono<double> segment{ convexHull(collinear.data(), 4) };
+    ASSERT_EQUALS(2, segment.getLength());
+    ASSERT_EQUALS(Punto<double>(0, 0), segment[0]);
+    ASSERT_EQUALS(Punto<double>(3, 3), segment[1]);
+}
+
+void testExtremePoints()
+{
+    const std::vector<Punto<int>> puntos{{ 0, 0 }, { 4, 0 }, { 4, 4 }, { 0, 4 }, { 2, 2 }};
+    std::vector<Punto<int>> extremes{ extremePoints(puntos.data(), 5) };
+    ASSERT_EQUALS(4, static_cast<int>(extremes.size()));
+    ASSERT_EQUALS(true, strictlyInsideConvex(extremes, Punto<int>{ 2, 2 }));
+    ASSERT_EQUALS(false, strictlyInsideConvex(extremes, Punto<int>{ 4, 2 }));
+
+    // the diagonal directions add two coordinates, past the range of int
+    const int big{ 2000000000 };
+    const std::vector<Punto<int>> far{{ -big, -big }, { big, -big }, { big, big }, { -big, big }, { 0, 0 },
+                                      { big - 1, big - 1 }};
+    std::vector<Punto<int>> farExtremes{ extremePoints(far.data(), 6) };
+    ASSERT_EQUALS(4, static_cast<int>(farExtremes.size()));
+    ASSERT_EQUALS(true, strictlyInsideConvex(farExtremes, Punto<int>{ big - 1, big - 1 }));
+
+    const std::vector<Punto<short>> small{{ 0, 0 }, { 30000, 0 }, { 30000, 30000 }, { 0, 30000 }, { 5, 7 }};
+    ASSERT_EQUALS(4, static_cast<int>(extremePoints(small.data(), 5).size()));
+}
+
+void testHullRandom()
+{
+    std::mt19937 gen{ 17 };
+    std::normal_distribution<double> coord{ 0.0, 10.0 };
+    std::vector<Punto<double>> puntos;
+    for(int i{}; i < 300000; ++i)
+    {
+        puntos.push_back(Punto<double>{ coord(gen), coord(gen) });
+    }
+    const int count{ static_cast<int>(puntos.size()) };
+
+    const Poligono<double> plain{ convexHull(puntos.data(), count, false, 1) };
+    const Poligono<double> filtered{ convexHull(puntos.data(), count, true, 1) };
+    const Poligono<double> parallel{ convexHull(puntos.data(), count, true, 4) };
+    ASSERT_EQUALS(true, isHullOf(plain, puntos));
+    ASSERT_EQUALS(true, sameVertices(plain, filtered));
+    ASSERT_EQUALS(true, sameVertices(plain, parallel));
+
+    const PointBuffer<double> buffer{ puntos.begin(), puntos.end() };
+    ASSERT_EQUALS(true, sameVertices(plain, convexHull(buffer)));
+}
+
+void testHullIntegerGrid()
+{
+    // lots of collinear points on the boundary of the hull
+    std::vector<Punto<int>> puntos;
+    for(int x{}; x < 300; ++x)
+    {
+        for(int y{}; y < 300; ++y)
+        {
+            puntos.push_back(Punto<int>{ x, y });
+        }
+    }
+    const int count{ static_cast<int>(puntos.size()) };
+    const Poligono<int> hull{ convexHull(puntos.data(), count, true, 1) };
+    ASSERT_EQUALS(4, hull.getLength());
+    ASSERT_EQUALS(true, sameVertices(hull, convexHull(puntos.data(), count, false, 3)));
+}
+
+int main() {
+    RUN(testHullSquare);
+    RUN(testHullDegenerate);
+    RUN(testExtremePoints);
+    RUN(testHullRandom);
+    RUN(testHullIntegerGrid);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,152 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace setup
+{
+    const Poligono<int> square{{ 0, 0 }, { 2, 0 }, { 4, 0 }, { 4, 4 }, { 0, 4 }};
+}
+
+/*
+ * Returns a convex polygon with the given amount of vertices on an ellipse,
+ * in clockwise order to check it's reordered.
+ */
+ConvexPoligono<double> ellipse(int sides)
+{
+    std::vector<Punto<double>> puntos;
+    for(int i{}; i < sides; ++i)
+    {
+        double angle{ -2 * M_PI * i / sides + 0.3 };
+        puntos.push_back(Punto<double>{ 10 + 5 * std::cos(angle), -4 + 2 * std::sin(angle) });
+    }
+    return ConvexPoligono<double>{ puntos.data(), sides };
+}
+
+void testConvexInit()
+{
+    const ConvexPoligono<int> square{ setup::square };
+    // the collinear vertex is dropped and the order is counter clockwise
+    ASSERT_EQUALS(4, square.getLength());
+    ASSERT_EQUALS(Punto<int>(0, 0), square[0]);
+    ASSERT_EQUALS(Punto<int>(4, 0), square[1]);
+    ASSERT_EQUALS(Punto<int>(4, 4), square[2]);
+    ASSERT_EQUALS(Punto<int>(0, 4), square[3]);
+
+    const ConvexPoligono<double> big{ ellipse(1000) };
+    ASSERT_EQUALS(1000, big.getLength());
+    ASSERT_EQUALS(true, Poligono<double>(&big[0], big.getLength()).isCCW());
+
+    const ConvexPoligono<int> empty{ Poligono<int>{} };
+    ASSERT_EQUALS(0, empty.getLength());
+    ASSERT_EQUALS(-1, empty.locate(Punto<int>{ 0, 0 }));
+}
+
+void testConvexLocate()
+{
+    const ConvexPoligono<int> square{ setup::square };
+    ASSERT_EQUALS(1, square.locate(Punto<int>{ 2, 2 }));
+    ASSERT_EQUALS(0, square.locate(Punto<int>{ 0, 0 }));
+    ASSERT_EQUALS(0, square.locate(Punto<int>{ 2, 0 }));
+    ASSERT_EQUALS(0, square.locate(Punto<int>{ 0, 3 }));
+    ASSERT_EQUALS(0, square.locate(Punto<int>{ 4, 1 }));
+    ASSERT_EQUALS(0, square.locate(Punto<int>{ 3, 4 }));
+    ASSERT_EQUALS(-1, square.locate(Punto<int>{ 5, 0 }));
+    ASSERT_EQUALS(-1, square.locate(Punto<int>{ -1, 4 }));
+    ASSERT_EQUALS(-1, square.locate(Punto<int>{ 2, 5 }));
+    ASSERT_EQUALS(true, square.pointInside(Punto<int>{ 4, 4 }));
+    ASSERT_EQUALS(true, square.pointInside<RobustPredicates>(Punto<int>{ 1, 3 }));
+
+    const ConvexPoligono<double> big{ ellipse(1000) };
+    const Poligono<double> pol(&big[0], big.getLength());
+    std::mt19937 gen{ 12 };
+    std::uniform_real_distribution<double> x{ 4.0, 16.0 };
+    std::uniform_real_distribution<double> y{ -7.0, -1.0 };
+    int wrong{};
+    for(int i{}; i < 5000; ++i)
+    {
+        Punto<double> p{ x(gen), y(gen) };
+        if (big.pointInside(p) != pol.pointInside(p))
+        {
+            ++wrong;
+        }
+    }
+    ASSERT_EQUALS(0, wrong);
+}
+
+void testExtremeVertex()
+{
+    const ConvexPoligono<int> square{ setup::square };
+    ASSERT_EQUALS(2, square.extremeVertex(Vector<int>{ 1, 1 }));
+    ASSERT_EQUALS(0, square.extremeVertex(Vector<int>{ -1, -1 }));
+
+    for(int sides: { 12, 13, 100, 1001 })
+    {
+        const ConvexPoligono<double> pol{ ellipse(sides) };
+        int wrong{};
+        for(int k{}; k < 360; ++k)
+        {
+            Vector<double> direction{ std::cos(k * M_PI / 180 + 0.01), std::sin(k * M_PI / 180 + 0.01) };
+            int best{ pol.extremeVertex(direction) };
+            for(int i{}; i < pol.getLength(); ++i)
+            {
+                double gain{ direction.getX() * (pol[i].getX() - pol[best].getX())
+                             + direction.getY() * (pol[i].getY() - pol[best].getY()) };
+                if (gain > 1e-12)
+                {
+                    ++wrong;
+                }
+            }
+        }
+        ASSERT_EQUALS(0, wrong);
+    }
+}
+
+void testTangents()
+{
+    const ConvexPoligono<int> square{ setup::square };
+    ASSERT_EQUALS(-1, square.tangents(Punto<int>{ 2, 2 }).first);
+    ASSERT_EQUALS(-1, square.tangents(Punto<int>{ 4, 2 }).second);
+    std::pair<int, int> fromBelow{ square.tangents(Punto<int>{ 2, -2 }) };
+    ASSERT_EQUALS(1, fromBelow.first);
+    ASSERT_EQUALS(0, fromBelow.second);
+
+    for(int sides: { 12, 13, 100, 1001 })
+    {
+        const ConvexPoligono<double> pol{ ellipse(sides) };
+        std::mt19937 gen{ 4 };
+        std::uniform_real_distribution<double> angle{ 0.0, 2 * M_PI };
+        std::uniform_real_distribution<double> distance{ 6.0, 40.0 };
+        int wrong{};
+        for(int k{}; k < 300; ++k)
+        {
+            double a{ angle(gen) };
+            double d{ distance(gen) };
+            Punto<double> p{ 10 + d * std::cos(a), -4 + d * std::sin(a) };
+            std::pair<int, int> tangent{ pol.tangents(p) };
+            for(int i{}; i < pol.getLength(); ++i)
+            {
+                if (hullTurn(p, pol[tangent.first], pol[i]) < -1e-9
+                    || hullTurn(p, pol[tangent.second], pol[i]) > 1e-9)
+                {
+                    ++wrong;
+                }
+            }
+        }
+        ASSERT_EQUALS(0, wrong);
+    }
+}
+
+int main() {
+    RUN(testConvexInit);
+    RUN(testConvexLocate);
+    RUN(testExtremeVertex);
+    RUN(testTangents);
+
+    return TEST_REPORT();
+}
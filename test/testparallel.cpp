@@ -0,0 +1,224 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include "testshapes.h"
+#include <atomic>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace setup
+{
+    std::vector<Punto<double>> randomPoints(int count, unsigned seed)
+    {
+        std::mt19937 generator{ seed };
+        std::uniform_real_distribution<double> coord{ -11.0, 11.0 };
+        std::vector<Punto<double>> points;
+        for(int i{}; i < count; ++i)
+        {
+            points.push_back(Punto<double>{ coord(generator), coord(generator) });
+        }
+        return points;
+    }
+}
+
+void testParallelFor()
+{
+    // every item is visited once, whatever the amount of threads
+    for(int threads: { 1, 2, 4, 16 })
+    {
+        for(int count: { 0, 1, 7, 100, 5000, 100000 })
+        {
+            std::vector<std::atomic<int>> visits(static_cast<std::size_t>(count));
+            std::atomic<int> ranges{ };
+            parallelFor(count, [&](int begin, int end) {
+                ++ranges;
+                for(int i{ begin }; i < end; ++i)
+                {
+                    ++visits[i];
+                }
+            }, threads, 1);
+            bool once{ true };
+            for(const std::atomic<int> &v: visits)
+            {
+                once = once && v == 1;
+            }
+            ASSERT_EQUALS(true, once);
+            ASSERT_EQUALS(true, ranges <= std::max(1, threads * CHUNKS_PER_THREAD));
+        }
+    }
+
+    // chunks of more than CHUNK_ALIGNMENT items start on multiples of it
+    std::vector<int> bounds{ chunkBounds(100000, 4) };
+    bool aligned{ bounds.front() == 0 && bounds.back() == 100000 };
+    for(std::size_t c{ 1 }; c + 1 < bounds.size(); ++c)
+    {
+        aligned = aligned && bounds[c] % CHUNK_ALIGNMENT == 0 && bounds[c] > bounds[c - 1];
+    }
+    ASSERT_EQUALS(true, aligned);
+    ASSERT_EQUALS(4, static_cast<int>(chunkBounds(4, 4).size()) - 1);
+
+    // loops started from inside a loop
+    std::atomic<long> total{ };
+    parallelFor(8, [&](int begin, int end) {
+        for(int i{ begin }; i < end; ++i)
+        {
+            parallelFor(1000, [&](int innerBegin, int innerEnd) {
+                long sum{ };
+                for(int j{ innerBegin }; j < innerEnd; ++j)
+                {
+                    sum += j;
+                }
+                total += sum;
+            }, 4, 1);
+        }
+    }, 4, 1);
+    ASSERT_EQUALS(8L * 999 * 1000 / 2, total.load());
+    ASSERT_EQUALS(true, WorkStealingPool::shared().getWorkerCount() >= 3);
+}
+
+void testExceptions()
+{
+    // the exception gets out of the loop wherever it's thrown, and the pool
+    // keeps working after it
+    for(int failing: { 0, 50000, 99999 })
+    {
+        bool caught{ false };
+        try
+        {
+            parallelFor(100000, [=](int begin, int end) {
+                if (begin <= failing && failing < end)
+                {
+                    throw std::runtime_error{ "chunk failed" };
+                }
+            }, 4, 1);
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+        ASSERT_EQUALS(true, caught);
+    }
+
+    std::atomic<int> visited{ };
+    parallelFor(1000, [&](int begin, int end) { visited += end - begin; }, 4, 1);
+    ASSERT_EQUALS(1000, visited.load());
+}
+
+void testParallelForBalanced()
+{
+    // one heavy item among many light ones
+    std::vector<int> prefix{ 0 };
+    for(int i{}; i < 1000; ++i)
+    {
+        prefix.push_back(prefix.back() + (i == 10 ? 100000 : 1 + i % 5));
+    }
+    for(int threads: { 1, 3, 8 })
+    {
+        std::vector<std::atomic<int>> visits(1000);
+        parallelForBalanced(prefix.data(), 1000, [&](int begin, int end) {
+            for(int i{ begin }; i < end; ++i)
+            {
+                ++visits[i];
+            }
+        }, threads, 1);
+        bool once{ true };
+        for(const std::atomic<int> &v: visits)
+        {
+            once = once && v == 1;
+        }
+        ASSERT_EQUALS(true, once);
+    }
+}
+
+void testBatchQueries()
+{
+    std::vector<Punto<double>> star{ setup::randomStar(300, 1u) };
+    const Poligono<double> pol{ star.begin(), star.end() };
+    std::vector<Punto<double>> points{ setup::randomPoints(20000, 2u) };
+    const PointBuffer<double> buffer{ points.data(), static_cast<int>(points.size()) };
+    const int count{ buffer.getLength() };
+
+    std::vector<char> expected(static_cast<std::size_t>(count));
+    for(int i{}; i < count; ++i)
+    {
+        expected[i] = pol.pointInside(points[i]);
+    }
+
+    for(int threads: { 1, 4 })
+    {
+        std::unique_ptr<bool[]> inside{ new bool[count] };
+        std::unique_ptr<bool[]> insidePuntos{ new bool[count] };
+        batchPointsInside(pol, buffer.getXs(), buffer.getYs(), count, inside.get(), threads);
+        batchPointsInside(pol, points.data(), count, insidePuntos.get(), threads);
+        bool allMatch{ true };
+        for(int i{}; i < count; ++i)
+        {
+            allMatch = allMatch && inside[i] == static_cast<bool>(expected[i])
+                       && insidePuntos[i] == static_cast<bool>(expected[i]);
+        }
+        ASSERT_EQUALS(true, allMatch);
+    }
+
+    // nothing is inside an empty polygon
+    const Poligono<double> empty{};
+    bool emptyInside[3]{ true, true, true };
+    bool emptyInsidePuntos[3]{ true, true, true };
+    batchPointsInside(empty, buffer.getXs(), buffer.getYs(), 3, emptyInside);
+    batchPointsInside(empty, points.data(), 3, emptyInsidePuntos);
+    ASSERT_EQUALS(false, emptyInside[0] || emptyInside[1] || emptyInside[2]
+                         || emptyInsidePuntos[0] || emptyInsidePuntos[1] || emptyInsidePuntos[2]);
+
+    // the line kernels are cheap enough to need many points for a second thread
+    std::vector<Punto<double>> many{ setup::randomPoints(1 << 20, 4u) };
+    const PointBuffer<double> manyBuffer{ many.data(), static_cast<int>(many.size()) };
+    const Segmento<double> line{ -3.0, -2.0, 5.0, 7.0 };
+    std::vector<double> expectedDeterminants(many.size());
+    std::vector<LineSide> expectedSides(many.size());
+    line.lineDeterminants(manyBuffer, expectedDeterminants.data());
+    line.classifyPoints(manyBuffer, expectedSides.data());
+    for(int threads: { 1, 4 })
+    {
+        std::vector<double> determinants(many.size());
+        std::vector<LineSide> sides(many.size());
+        batchLineDeterminants(line, manyBuffer.getXs(), manyBuffer.getYs(), manyBuffer.getLength(),
+                              determinants.data(), threads);
+        batchClassifyPoints(line, manyBuffer.getXs(), manyBuffer.getYs(), manyBuffer.getLength(),
+                            sides.data(), threads);
+        ASSERT_EQUALS(true, determinants == expectedDeterminants && sides == expectedSides);
+    }
+
+    // point i against polygon i, for polygons of very different sizes
+    PolygonSet<double> set;
+    set.push_back(Poligono<double>{});
+    for(unsigned seed{}; seed < 2000; ++seed)
+    {
+        std::vector<Punto<double>> vertices{ setup::randomStar(3 + 37 * seed % 400, seed) };
+        set.push_back(vertices.data(), static_cast<int>(vertices.size()));
+    }
+    std::vector<Punto<double>> probes{ setup::randomPoints(set.getLength(), 3u) };
+    for(int threads: { 1, 4 })
+    {
+        std::unique_ptr<bool[]> inside{ new bool[set.getLength()] };
+        batchPointInPolygon(set, probes.data(), inside.get(), threads);
+        bool allMatch{ !inside[0] };
+        for(int i{}; i < set.getLength(); ++i)
+        {
+            allMatch = allMatch && inside[i] == set[i].pointInside(probes[i]);
+        }
+        ASSERT_EQUALS(true, allMatch);
+    }
+}
+
+int main() {
+    RUN(testParallelFor);
+    RUN(testExceptions);
+    RUN(testParallelForBalanced);
+    RUN(testBatchQueries);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,200 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace setup
+{
+    const Poligono<int> polB {{5,0}, {6,4}, {4,5}, {1,5}, {1,0}};
+}
+
+void testPointBufferInit()
+{
+    const PointBuffer<double> empty{};
+    ASSERT_EQUALS(0, empty.getLength());
+
+    const PointBuffer<int> zeros(3);
+    ASSERT_EQUALS(3, zeros.getLength());
+    ASSERT_EQUALS(Punto<int>(0, 0), zeros[2]);
+
+    const PointBuffer<double> listed{{ 1.5, 2.0 }, { -3.0, 4.25 }};
+    ASSERT_EQUALS(2, listed.getLength());
+    ASSERT_EQUALS(Punto<double>(-3.0, 4.25), listed[1]);
+    ASSERT_EQUALS(1.5, listed.getXs()[0]);
+    ASSERT_EQUALS(4.25, listed.getYs()[1]);
+
+    const std::vector<Punto<float>> puntos{{ 1.0f, 2.0f }, { 3.0f, 4.0f }, { 5.0f, 6.0f }};
+    const PointBuffer<float> fromArray{ puntos.data(), 3 };
+    const PointBuffer<float> fromRange{ puntos.begin() + 1, puntos.end() };
+    ASSERT_EQUALS(Punto<float>(5.0f, 6.0f), fromArray[2]);
+    ASSERT_EQUALS(2, fromRange.getLength());
+    ASSERT_EQUALS(Punto<float>(3.0f, 4.0f), fromRange[0]);
+}
+
+void testPointBufferAlignment()
+{
+    PointBuffer<double> buffer{};
+    for(int i{}; i < 100; ++i)
+    {
+        buffer.push_back(Punto<double>{ 1.0 * i, 2.0 * i });
+    }
+    ASSERT_EQUALS(0, reinterpret_cast<std::uintptr_t>(buffer.getXs()) % 64);
+    ASSERT_EQUALS(0, reinterpret_cast<std::uintptr_t>(buffer.getYs()) % 64);
+    ASSERT_EQUALS(Punto<double>(99.0, 198.0), buffer[99]);
+}
+
+void testPointBufferEdit()
+{
+    PointBuffer<int> buffer{};
+    buffer.reserve(4);
+    buffer.push_back(Punto<int>{ 1, 2 });
+    buffer.push_back(Punto<int>{ 3, 4 });
+    buffer.set(0, Punto<int>{ 7, 8 });
+    ASSERT_EQUALS(Punto<int>(7, 8), buffer[0]);
+
+    buffer.resize(3);
+    ASSERT_EQUALS(3, buffer.getLength());
+    ASSERT_EQUALS(Punto<int>(0, 0), buffer[2]);
+
+    buffer.clear();
+    ASSERT_EQUALS(0, buffer.getLength());
+}
+
+void testPointBufferConversion()
+{
+    const PointBuffer<int> buffer{{ 1, 2 }, { 3, 4 }, { 5, 6 }};
+    std::vector<Punto<int>> puntos{ buffer.toVector() };
+    ASSERT_EQUALS(3, static_cast<int>(puntos.size()));
+    ASSERT_EQUALS(Punto<int>(3, 4), puntos[1]);
+
+    Punto<int> array[3];
+    Punto<int>* end{ buffer.toPuntos(array) };
+    ASSERT_EQUALS(array + 3, end);
+    ASSERT_EQUALS(Punto<int>(5, 6), array[2]);
+}
+
+void testPointBufferArithmetic()
+{
+    PointBuffer<double> buffer{{ 1.1, 2.2 }, { -3.3, 4.4 }, { 0.0, -1.0 }};
+    buffer.translate(Vector<double>{ 1.0, -1.0 });
+    ASSERT_EQUALS(Punto<double>(2.1, 1.2), buffer[0]);
+    ASSERT_EQUALS(Punto<double>(-2.3, 3.4), buffer[1]);
+
+    buffer.scale(2.0);
+    ASSERT_EQUALS(Punto<double>(4.2, 2.4), buffer[0]);
+    ASSERT_EQUALS(Punto<double>(2.0, -4.0), buffer[2]);
+
+    buffer.negate();
+    ASSERT_EQUALS(Punto<double>(-4.2, -2.4), buffer[0]);
+
+    const PointBuffer<double> other{{ 4.2, 2.4 }, { 0.6, 0.8 }, { 1.0, 1.0 }};
+    buffer.add(other);
+    ASSERT_EQUALS(Punto<double>(0.0, 0.0), buffer[0]);
+    ASSERT_EQUALS(Punto<double>(5.2, -6.0), buffer[1]);
+    ASSERT_EQUALS(Punto<double>(-1.0, 5.0), buffer[2]);
+
+    // chained operations behave like the Punto operators
+    PointBuffer<int> ints{{ 1, 2 }};
+    ints.scale(3).translate(Vector<int>{ 1, 1 }).negate();
+    const Punto<int> p{ 1, 2 };
+    ASSERT_EQUALS(-(p*3 + Punto<int>{ 1, 1 }), ints[0]);
+}
+
+void testPointBufferInside()
+{
+    const PointBuffer<int> buffer{{ 2, 1 }, { 2, 0 }, { 1, 0 }, { 0, 1 }, { 6, 1 }};
+    std::unique_ptr<bool[]> inside{ new bool[5] };
+    setup::polB.pointsInside(buffer, inside.get());
+    bool expected[5]{ true, true, true, false, false };
+    for(int i{}; i < 5; ++i)
+    {
+        ASSERT_EQUALS(expected[i], inside[i]);
+    }
+}
+
+/*
+ * The 3D kernels give the same values as Vector3D and orient3d, including
+ * the points past the last full vector of lanes.
+ */
+template <class T>
+bool kernels3DMatch(const PointBuffer3D<T> &buffer)
+{
+    const int count{ buffer.getLength() };
+    std::vector<double> norms(static_cast<std::size_t>(count));
+    std::vector<OrientationType<T>> dots(static_cast<std::size_t>(count));
+    std::vector<PlaneSide> sides(static_cast<std::size_t>(count));
+    const Vector3D<T> v{ 3, -2, 1 };
+    const Punto3D<T> p{ 1, 2, 3 };
+    const Punto3D<T> q{ -4, 5, 2 };
+    const Punto3D<T> r{ 2, -1, 7 };
+    buffer.norms(norms.data());
+    buffer.dotProducts(v, dots.data());
+    buffer.planeSides(p, q, r, sides.data());
+    bool allMatch{ true };
+    for(int i{}; i < count; ++i)
+    {
+        const Vector3D<T> to{ buffer[i] };
+        double orientation{ orient3d(p, q, r, buffer[i]) };
+        allMatch = allMatch && norms[i] == to.euclideanNorm() && dots[i] == dotProduct(v, to)
+                   && static_cast<int>(sides[i]) == (orientation > 0) - (orientation < 0);
+    }
+    return allMatch;
+}
+
+void testPointBuffer3D()
+{
+    PointBuffer3D<double> doubles;
+    PointBuffer3D<float> floats;
+    PointBuffer3D<int> ints;
+    std::mt19937 generator{ 1u };
+    std::uniform_int_distribution<int> coord{ -1000, 1000 };
+    for(int i{}; i < 1003; ++i)
+    {
+        int x{ coord(generator) };
+        int y{ coord(generator) };
+        int z{ coord(generator) };
+        doubles.push_back(Punto3D<double>{ x / 8.0, y / 8.0, z / 8.0 });
+        floats.push_back(Punto3D<float>{ x / 8.0f, y / 8.0f, z / 8.0f });
+        ints.push_back(Punto3D<int>{ x, y, z });
+    }
+    // a few of them exactly on the plane of kernels3DMatch
+    ints.set(5, Punto3D<int>{ 1, 2, 3 });
+    ints.set(6, Punto3D<int>{ -9, 8, 1 });
+    doubles.set(7, Punto3D<double>{ 6, -4, 11 });
+    ASSERT_EQUALS(0, reinterpret_cast<std::uintptr_t>(doubles.getZs()) % 64);
+    ASSERT_EQUALS(true, kernels3DMatch(doubles));
+    ASSERT_EQUALS(true, kernels3DMatch(floats));
+    ASSERT_EQUALS(true, kernels3DMatch(ints));
+
+    // coordinates past the products that fit in 64 bits
+    PointBuffer3D<int> big{{ 2000000000, -2000000000, 2000000000 }, { -2147483647 - 1, 5, 2147483647 }};
+    std::vector<long double> expected{ 1.2e19L, 2147483648.0L * 2147483648.0L + 25.0L + 2147483647.0L * 2147483647.0L };
+    double norms[2];
+    big.norms(norms);
+    ASSERT_EQUALS(true, withinEps(std::sqrt(1.2e19), norms[0], 1e-12, 1e-12));
+    ASSERT_EQUALS(true, withinEps(static_cast<double>(std::sqrt(expected[1])), norms[1], 1e-12, 1e-12));
+
+    big.translate(Vector3D<int>{ 1, 1, 1 }).scale(-1);
+    ASSERT_EQUALS(Punto3D<int>(-2000000001, 1999999999, -2000000001), big[0]);
+    ASSERT_EQUALS(2, static_cast<int>(big.toVector().size()));
+    big.clear();
+    ASSERT_EQUALS(0, big.getLength());
+}
+
+int main() {
+    RUN(testPointBufferInit);
+    RUN(testPointBufferAlignment);
+    RUN(testPointBufferEdit);
+    RUN(testPointBufferConversion);
+    RUN(testPointBufferArithmetic);
+    RUN(testPointBufferInside);
+    RUN(testPointBuffer3D);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,197 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace setup
+{
+    std::vector<Punto<double>> randomPoints(int count, unsigned seed)
+    {
+        std::mt19937 generator{ seed };
+        std::uniform_real_distribution<double> coord{ -100.0, 100.0 };
+        std::vector<Punto<double>> points;
+        for(int i{}; i < count; ++i)
+        {
+            points.push_back(Punto<double>{ coord(generator), coord(generator) });
+        }
+        return points;
+    }
+
+    /*
+     * Positions of the amount points nearest to p, sorted by their distance,
+     * ties by position, as the tree answers.
+     */
+    template <class T>
+    std::vector<int> byDistance(const std::vector<Punto<T>> &points, const Punto<T> &p, int amount)
+    {
+        std::vector<std::pair<double, int>> order;
+        for(int i{}; i < static_cast<int>(points.size()); ++i)
+        {
+            double dx{ static_cast<double>(points[i].getX()) - static_cast<double>(p.getX()) };
+            double dy{ static_cast<double>(points[i].getY()) - static_cast<double>(p.getY()) };
+            order.emplace_back(dx * dx + dy * dy, i);
+        }
+        amount = std::min(amount, static_cast<int>(order.size()));
+        std::partial_sort(order.begin(), order.begin() + amount, order.end());
+        std::vector<int> ids;
+        for(int i{}; i < amount; ++i)
+        {
+            ids.push_back(order[i].second);
+        }
+        return ids;
+    }
+}
+
+void testEmptyAndSmall()
+{
+    const PointKdTree<int> empty{ nullptr, 0 };
+    std::vector<int> out;
+    ASSERT_EQUALS(0, empty.getLength());
+    ASSERT_EQUALS(-1, empty.nearest(Punto<int>{ 1, 2 }));
+    empty.nearest(Punto<int>{ 1, 2 }, 3, out);
+    empty.withinRadius(Punto<int>{ 1, 2 }, 10, out);
+    ASSERT_EQUALS(true, out.empty());
+
+    // the same point twice, the first one wins the tie
+    const std::vector<Punto<int>> points{ {0, 0}, {5, 5}, {2, 1}, {5, 5}, {-3, 4} };
+    const PointKdTree<int> tree{ points.data(), 5 };
+    ASSERT_EQUALS(1, tree.nearest(Punto<int>{ 6, 6 }));
+    ASSERT_EQUALS(2, tree.nearest(Punto<int>{ 2, 2 }));
+    tree.nearest(Punto<int>{ 0, 0 }, 10, out);
+    ASSERT_EQUALS(true, out == (std::vector<int>{ 0, 2, 4, 1, 3 }));
+    out.clear();
+    tree.withinRadius(Punto<int>{ 0, 0 }, 5, out);
+    std::sort(out.begin(), out.end());
+    ASSERT_EQUALS(true, out == (std::vector<int>{ 0, 2, 4 }));
+    out.clear();
+    tree.withinRadius(Punto<int>{ 0, 0 }, -1, out);
+    ASSERT_EQUALS(true, out.empty());
+
+    int nearest[2 * 7];
+    tree.nearestAll(points.data(), 2, 7, nearest);
+    ASSERT_EQUALS(true, std::vector<int>(nearest, nearest + 7) == (std::vector<int>{ 0, 2, 4, 1, 3, -1, -1 }));
+    ASSERT_EQUALS(1, nearest[7]);
+    ASSERT_EQUALS(3, nearest[8]);
+}
+
+void testGrid()
+{
+    // many points share their X or their Y with others
+    std::vector<Punto<int>> points;
+    for(int y{}; y < 60; ++y)
+    {
+        for(int x{}; x < 70; ++x)
+        {
+            points.push_back(Punto<int>{ x * 3, y * 2 });
+        }
+    }
+    const PointKdTree<int> tree{ points.data(), static_cast<int>(points.size()) };
+    bool allMatch{ true };
+    for(int y{ -3 }; y < 125; y += 5)
+    {
+        for(int x{ -4 }; x < 215; x += 7)
+        {
+            const Punto<int> p{ x, y };
+            std::vector<int> expected{ setup::byDistance(points, p, 6) };
+            std::vector<int> found;
+            tree.nearest(p, 6, found);
+            allMatch = allMatch && tree.nearest(p) == expected[0] && found == expected;
+        }
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+void testRandom()
+{
+    std::vector<Punto<double>> points{ setup::randomPoints(20000, 1u) };
+    std::vector<Punto<double>> queries{ setup::randomPoints(300, 2u) };
+    const int count{ static_cast<int>(queries.size()) };
+    const PointKdTree<double> tree{ points.data(), static_cast<int>(points.size()) };
+    ASSERT_EQUALS(20000, tree.getLength());
+
+    const double radius{ 4.5 };
+    const int k{ 9 };
+    std::vector<int> expectedNearest;
+    std::vector<int> expectedK;
+    std::vector<std::vector<int>> expectedWithin;
+    bool allMatch{ true };
+    for(const Punto<double> &p: queries)
+    {
+        std::vector<int> order{ setup::byDistance(points, p, k) };
+        std::vector<int> within;
+        for(int id{}; id < static_cast<int>(points.size()); ++id)
+        {
+            if (Vector<double>{ points[id] - p }.euclideanNorm() <= radius)
+            {
+                within.push_back(id);
+            }
+        }
+        expectedNearest.push_back(order[0]);
+        expectedK.insert(expectedK.end(), order.begin(), order.end());
+        expectedWithin.push_back(within);
+
+        std::vector<int> found;
+        tree.nearest(p, k, found);
+        std::vector<int> foundWithin;
+        tree.withinRadius(p, radius, foundWithin);
+        std::sort(foundWithin.begin(), foundWithin.end());
+        allMatch = allMatch && tree.nearest(p) == order[0]
+                   && found == order && foundWithin == within;
+    }
+    ASSERT_EQUALS(true, allMatch);
+
+    // the batches give the same answers, whatever the amount of threads
+    for(int threads: { 1, 4 })
+    {
+        std::vector<int> nearest(static_cast<std::size_t>(count));
+        std::vector<int> nearestK(static_cast<std::size_t>(count) * k);
+        std::vector<int> offsets;
+        std::vector<int> ids;
+        tree.nearestAll(queries.data(), count, nearest.data(), threads);
+        tree.nearestAll(queries.data(), count, k, nearestK.data(), threads);
+        tree.withinRadiusAll(queries.data(), count, radius, offsets, ids, threads);
+        bool batchMatch{ nearest == expectedNearest && nearestK == expectedK
+                         && static_cast<int>(offsets.size()) == count + 1 };
+        for(int i{}; batchMatch && i < count; ++i)
+        {
+            std::vector<int> within(ids.begin() + offsets[i], ids.begin() + offsets[i + 1]);
+            std::sort(within.begin(), within.end());
+            batchMatch = within == expectedWithin[i];
+        }
+        ASSERT_EQUALS(true, batchMatch);
+    }
+}
+
+void testParallelBuild()
+{
+    // enough points for the lower levels to be split on several threads
+    std::vector<Punto<double>> points{ setup::randomPoints(300000, 3u) };
+    std::vector<Punto<double>> queries{ setup::randomPoints(40, 4u) };
+    const PointKdTree<double> single{ points.data(), static_cast<int>(points.size()), 1 };
+    const PointKdTree<double> parallel{ points.data(), static_cast<int>(points.size()), 4 };
+    bool allMatch{ true };
+    for(const Punto<double> &p: queries)
+    {
+        std::vector<int> order{ setup::byDistance(points, p, 4) };
+        std::vector<int> found;
+        parallel.nearest(p, 4, found);
+        allMatch = allMatch && single.nearest(p) == order[0] && parallel.nearest(p) == order[0]
+                   && found == order;
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+int main() {
+    RUN(testEmptyAndSmall);
+    RUN(testGrid);
+    RUN(testRandom);
+    RUN(testParallelBuild);
+
+    return TEST_REPORT();
+}
@@ -4,6 +4,9 @@
 
 #include <elem_geometricos.h>
 #include <tinytest.h>
+#include <memory>
+#include <random>
+#include <vector>
 
 /*
  * Defines the polygons that will be tested.
@@ -43,6 +46,103 @@ void testPoligonoInit()
     ASSERT_EQUALS(3, setup::polC.getLength());
 }
 
+/*
+ * Builds a polygon at runtime and returns it by value.
+ */
+Poligono<int> squareOfSide(int side)
+{
+    Poligono<int> square{};
+    square.reserve(4);
+    square.push_back(Punto<int>{ 0, 0 });
+    square.push_back(Punto<int>{ side, 0 });
+    square.push_back(Punto<int>{ side, side });
+    square.push_back(Punto<int>{ 0, side });
+    return square;
+}
+
+void testPoligonoBuild()
+{
+    Poligono<int> empty{};
+    ASSERT_EQUALS(0, empty.getLength());
+    ASSERT_EQUALS(false, empty.isView());
+
+    Poligono<int> square{ squareOfSide(3) };
+    ASSERT_EQUALS(4, square.getLength());
+    ASSERT_EQUALS(18, square.doubleSignedArea());
+    ASSERT_EQUALS(Punto<int>(3, 3), square[2]);
+
+    const std::vector<Punto<double>> puntos{{ 0, 0 }, { 2, 0 }, { 2, 1 }, { 0, 1 }};
+    const Poligono<double> fromRange{ puntos.begin(), puntos.end() };
+    const Poligono<double> fromArray{ puntos.data(), 3 };
+    ASSERT_EQUALS(4, fromRange.getLength());
+    ASSERT_EQUALS(true, withinEps(4.0, fromRange.doubleSignedArea(), 1e-10, 1e-10));
+    ASSERT_EQUALS(3, fromArray.getLength());
+    ASSERT_EQUALS(Punto<double>(2, 1), fromArray[2]);
+}
+
+void testPoligonoMove()
+{
+    Poligono<int> square{ squareOfSide(2) };
+    const Punto<int>* vertices{ &square[0] };
+
+    Poligono<int> moved{ std::move(square) };
+    ASSERT_EQUALS(4, moved.getLength());
+    ASSERT_EQUALS(0, square.getLength());
+    // no copy of the vertices was made
+    ASSERT_EQUALS(vertices, &moved[0]);
+
+    Poligono<int> assigned{{ 1, 1 }};
+    assigned = std::move(moved);
+    ASSERT_EQUALS(4, assigned.getLength());
+    ASSERT_EQUALS(0, moved.getLength());
+    ASSERT_EQUALS(vertices, &assigned[0]);
+
+    std::vector<Poligono<int>> polygons;
+    for(int side{ 1 }; side <= 50; ++side)
+    {
+        polygons.push_back(squareOfSide(side));
+    }
+    ASSERT_EQUALS(2 * 37 * 37, polygons[36].doubleSignedArea());
+    ASSERT_EQUALS(true, polygons[49].pointInside(Punto<int>{ 49, 49 }));
+}
+
+void testPoligonoView()
+{
+    Punto<int> vertices[5]{{5,0}, {6,4}, {4,5}, {1,5}, {1,0}};
+    Poligono<int> view{ Poligono<int>::view(vertices, 5) };
+    ASSERT_EQUALS(true, view.isView());
+    ASSERT_EQUALS(5, view.getLength());
+    ASSERT_EQUALS(setup::polB.doubleSignedArea(), view.doubleSignedArea());
+    ASSERT_EQUALS(&vertices[0], &view[0]);
+
+    // edits go through to the caller's array
+    view[0] = Punto<int>{ 5, 1 };
+    ASSERT_EQUALS(Punto<int>(5, 1), vertices[0]);
+
+    Poligono<int> movedView{ std::move(view) };
+    ASSERT_EQUALS(true, movedView.isView());
+    ASSERT_EQUALS(false, view.isView());
+
+    // growing a view copies its vertices first
+    movedView.push_back(Punto<int>{ 1, -1 });
+    ASSERT_EQUALS(false, movedView.isView());
+    ASSERT_EQUALS(6, movedView.getLength());
+    ASSERT_EQUALS(Punto<int>(5, 1), movedView[0]);
+    movedView[0] = Punto<int>{ 9, 9 };
+    ASSERT_EQUALS(Punto<int>(5, 1), vertices[0]);
+
+    // read only views are copied before the first edit
+    const Punto<int>* constVertices{ vertices };
+    Poligono<int> readOnly{ Poligono<int>::view(constVertices, 5) };
+    ASSERT_EQUALS(true, readOnly.isView());
+    ASSERT_EQUALS(constVertices, &static_cast<const Poligono<int>&>(readOnly)[0]);
+    readOnly[1] = Punto<int>{ 7, 4 };
+    ASSERT_EQUALS(false, readOnly.isView());
+    ASSERT_EQUALS(Punto<int>(7, 4), readOnly[1]);
+    ASSERT_EQUALS(Punto<int>(6, 4), vertices[1]);
+    ASSERT_EQUALS(Punto<int>(5, 1), readOnly[0]);
+}
+
 void testSignedAngle()
 {
     const int lenB = 5 ;
@@ -101,6 +201,79 @@ void testPointInPolygon()
     ASSERT_EQUALS(false, setup::polC.pointInside(Punto<float>{  1.99999999f, -0.5f }));
 }
 
+/*
+ * Compares the batched containment against pointInside for every point of
+ * the given arrays.
+ */
+template <class T>
+bool batchMatchesPointInside(const Poligono<T> &pol, const std::vector<Punto<T>> &puntos)
+{
+    int count{ static_cast<int>(puntos.size()) };
+    std::vector<T> xs;
+    std::vector<T> ys;
+    for(const Punto<T> &p: puntos)
+    {
+        xs.push_back(p.getX());
+        ys.push_back(p.getY());
+    }
+
+    std::unique_ptr<bool[]> fromArrays{ new bool[puntos.size()] };
+    std::unique_ptr<bool[]> fromPuntos{ new bool[puntos.size()] };
+    pol.pointsInside(xs.data(), ys.data(), count, fromArrays.get());
+    pol.pointsInside(puntos.data(), count, fromPuntos.get());
+
+    for(int i{}; i < count; ++i)
+    {
+        bool expected{ pol.pointInside(puntos[i]) };
+        if (fromArrays[i] != expected || fromPuntos[i] != expected)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testPointsInside()
+{
+    std::mt19937 gen{ 42 };
+
+    // more than one block, with a partial one at the end, and every vertex of
+    // the polygons to exercise the boundary cases
+    std::uniform_real_distribution<double> coordA{ -3.0, 3.0 };
+    std::vector<Punto<double>> puntosA;
+    for(int i{}; i < 1500; ++i)
+    {
+        puntosA.push_back(Punto<double>{ coordA(gen), coordA(gen) });
+    }
+    for(int i{}; i < setup::polA.getLength(); ++i)
+    {
+        puntosA.push_back(setup::polA[i]);
+    }
+    ASSERT_EQUALS(true, batchMatchesPointInside(setup::polA, puntosA));
+
+    std::uniform_int_distribution<int> coordB{ -1, 7 };
+    std::vector<Punto<int>> puntosB;
+    for(int i{}; i < 700; ++i)
+    {
+        puntosB.push_back(Punto<int>{ coordB(gen), coordB(gen) });
+    }
+    ASSERT_EQUALS(true, batchMatchesPointInside(setup::polB, puntosB));
+
+    std::uniform_real_distribution<float> coordC{ -4.0f, 3.0f };
+    std::vector<Punto<float>> puntosC{ { -2.0f, 0.0f }, { 0.0f, -0.5f }, { -1.6f, -0.5f },
+                                       { -1.6000001f, -0.5f }, { 1.99999999f, -0.5f } };
+    for(int i{}; i < 1029; ++i)
+    {
+        puntosC.push_back(Punto<float>{ coordC(gen), coordC(gen) * 0.3f });
+    }
+    ASSERT_EQUALS(true, batchMatchesPointInside(setup::polC, puntosC));
+
+    // a batch with a single point
+    bool inside{};
+    setup::polB.pointsInside(std::vector<Punto<int>>{{ 2, 1 }}.data(), 1, &inside);
+    ASSERT_EQUALS(true, inside);
+}
+
 void testCCW()
 {
     ASSERT_EQUALS(true, setup::polA.isCCW());
@@ -108,16 +281,39 @@ void testCCW()
     ASSERT_EQUALS( false, setup::polC.isCCW());
 }
 
+void testIsConvex()
+{
+    ASSERT_EQUALS(false, setup::polA.isConvex());
+    ASSERT_EQUALS(true, setup::polB.isConvex());
+    // clockwise triangles are convex as well
+    ASSERT_EQUALS(true, setup::polC.isConvex());
+
+    // a square with a collinear vertex in the middle of an edge
+    const Poligono<int> square{{ 0, 0 }, { 2, 0 }, { 4, 0 }, { 4, 4 }, { 0, 4 }};
+    ASSERT_EQUALS(true, square.isConvex());
+    // a pentagram turns the same way at every vertex but winds twice
+    const Poligono<int> star{{ 0, 10 }, { 6, -8 }, { -9, 3 }, { 9, 3 }, { -6, -8 }};
+    ASSERT_EQUALS(false, star.isConvex());
+    const Poligono<int> line{{ 0, 0 }, { 1, 1 }, { 2, 2 }};
+    ASSERT_EQUALS(false, line.isConvex());
+    ASSERT_EQUALS(false, Poligono<int>{}.isConvex());
+}
+
 
 
 
 int main() {
     RUN(testPoligonoInit);
+    RUN(testPoligonoBuild);
+    RUN(testPoligonoMove);
+    RUN(testPoligonoView);
     RUN(testSignedAngle);
     RUN(testDoubleSignedArea);
     RUN(testArea);
     RUN(testCCW);
+    RUN(testIsConvex);
     RUN(testPointInPolygon);
+    RUN(testPointsInside);
 
     return TEST_REPORT();
 }
@@ -0,0 +1,140 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace setup
+{
+    const Poligono<double> polA {{   1,1.8}, {-0.3,2.3}, {  -2,2.2 }, {-2.6,1.2}, {-1.6,  1},
+                                 {-0.9,1.6}, {-0.2,1.3}, {-0.7,-0.3}, {-1.6,-0.2},{-1.6,0.4},
+                                 {-2.5,0.3}, {-1.5,-1.9},{0.02727272727,-1.3}, {1.3,-0.8}};
+
+    const Poligono<int> polB {{5,0}, {6,4}, {4,5}, {1,5}, {1,0}};
+
+    const Poligono<float> polC{{-3.4, 0.4}, {2, -0.5}, {-1.6, -0.5}};
+
+    /*
+     * Star shaped polygon with a wavy boundary and n vertices.
+     */
+    std::vector<Punto<double>> wavyStar(int n)
+    {
+        std::vector<Punto<double>> vertices;
+        for(int i{}; i < n; ++i)
+        {
+            double angle{ 2 * M_PI * i / n };
+            double radius{ 1 + 0.3 * std::sin(37 * angle) + 0.05 * std::cos(301 * angle) };
+            vertices.push_back(Punto<double>{ radius * std::cos(angle), radius * std::sin(angle) });
+        }
+        return vertices;
+    }
+}
+
+void testBandIndexInit()
+{
+    // the y coordinates travel twice the height of the polygon, so two bands
+    ASSERT_EQUALS(2, PoligonoBandIndex<int>{ setup::polB }.getBandCount());
+
+    const PoligonoBandIndex<int> indexB{ setup::polB, 5 };
+    ASSERT_EQUALS(5, indexB.getBandCount());
+    // (5,0)-(6,4) and (1,5)-(1,0) reach every band, (6,4)-(4,5) only the last
+    ASSERT_EQUALS(11, indexB.getEntryCount());
+    ASSERT_EQUALS(0, indexB.bandOf(0));
+    ASSERT_EQUALS(2, indexB.bandOf(2));
+    ASSERT_EQUALS(4, indexB.bandOf(5));
+    ASSERT_EQUALS(0, indexB.bandOf(-3));
+    ASSERT_EQUALS(4, indexB.bandOf(9));
+
+    const PoligonoBandIndex<double> indexA{ setup::polA, 3 };
+    ASSERT_EQUALS(3, indexA.getBandCount());
+}
+
+void testBandIndexPointInside()
+{
+    const PoligonoBandIndex<int> indexB{ setup::polB };
+    ASSERT_EQUALS(true, indexB.pointInside(Punto<int>{ 2, 1 }));
+    ASSERT_EQUALS(true, indexB.pointInside(Punto<int>{ 2, 0 }));
+    ASSERT_EQUALS(true, indexB.pointInside(Punto<int>{ 1, 0 }));
+    ASSERT_EQUALS(false, indexB.pointInside(Punto<int>{ 0, 1 }));
+    ASSERT_EQUALS(false, indexB.pointInside(Punto<int>{ 6, 1 }));
+
+    const PoligonoBandIndex<float> indexC{ setup::polC };
+    ASSERT_EQUALS(true, indexC.pointInside(Punto<float>{ -2.0f, 0.0f }));
+    ASSERT_EQUALS(true, indexC.pointInside(Punto<float>{ 0.0f, -0.5f }));
+    ASSERT_EQUALS(true, indexC.pointInside(Punto<float>{ -1.6f, -0.5f }));
+    ASSERT_EQUALS(false, indexC.pointInside(Punto<float>{ -1.6000001f, -0.5f }));
+    ASSERT_EQUALS(false, indexC.pointInside(Punto<float>{  1.99999999f, -0.5f }));
+}
+
+void testBandIndexMatchesPoligono()
+{
+    std::mt19937 gen{ 11 };
+    std::uniform_real_distribution<double> coord{ -3.0, 3.0 };
+
+    bool allMatch{ true };
+    for(int bands: { 0, 1, 4, 100 })
+    {
+        const PoligonoBandIndex<double> indexA{ setup::polA, bands };
+        for(int i{}; i < 2000; ++i)
+        {
+            Punto<double> p{ coord(gen), coord(gen) };
+            allMatch = allMatch && (indexA.pointInside(p) == setup::polA.pointInside(p));
+        }
+        for(int i{}; i < setup::polA.getLength(); ++i)
+        {
+            allMatch = allMatch && (indexA.pointInside(setup::polA[i]) == setup::polA.pointInside(setup::polA[i]));
+        }
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+void testBandIndexLargePolygon()
+{
+    std::vector<Punto<double>> star{ setup::wavyStar(20000) };
+    const int length{ static_cast<int>(star.size()) };
+    const PoligonoBandIndex<double> index{ star.data(), length };
+
+    std::mt19937 gen{ 5 };
+    std::uniform_real_distribution<double> coord{ -1.4, 1.4 };
+    const int count{ 5000 };
+    std::vector<double> xs;
+    std::vector<double> ys;
+    for(int i{}; i < count; ++i)
+    {
+        xs.push_back(coord(gen));
+        ys.push_back(coord(gen));
+    }
+    // every vertex lies on the boundary, the hardest case for the bands
+    for(int i{}; i < length; i += 7)
+    {
+        xs.push_back(star[i].getX());
+        ys.push_back(star[i].getY());
+    }
+
+    const int total{ static_cast<int>(xs.size()) };
+    std::unique_ptr<bool[]> expected{ new bool[total] };
+    std::unique_ptr<bool[]> inside{ new bool[total] };
+    batchPointInside(star.data(), length, xs.data(), ys.data(), total, expected.get());
+    index.pointsInside(xs.data(), ys.data(), total, inside.get());
+
+    bool allMatch{ true };
+    for(int i{}; i < total; ++i)
+    {
+        allMatch = allMatch && (inside[i] == expected[i]);
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+int main() {
+    RUN(testBandIndexInit);
+    RUN(testBandIndexPointInside);
+    RUN(testBandIndexMatchesPoligono);
+    RUN(testBandIndexLargePolygon);
+
+    return TEST_REPORT();
+}
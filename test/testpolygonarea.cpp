@@ -0,0 +1,143 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace setup
+{
+    const Poligono<double> polA {{   1,1.8}, {-0.3,2.3}, {  -2,2.2 }, {-2.6,1.2}, {-1.6,  1},
+                                 {-0.9,1.6}, {-0.2,1.3}, {-0.7,-0.3}, {-1.6,-0.2},{-1.6,0.4},
+                                 {-2.5,0.3}, {-1.5,-1.9},{0.02727272727,-1.3}, {1.3,-0.8}};
+
+    const Poligono<int> polB {{5,0}, {6,4}, {4,5}, {1,5}, {1,0}};
+
+    const Poligono<float> polC{{-3.4, 0.4}, {2, -0.5}, {-1.6, -0.5}};
+
+    /*
+     * Regular polygon with n vertices around (cx, cy), clockwise when cw.
+     */
+    template <class T>
+    std::vector<Punto<T>> regular(int n, T radius, T cx, T cy, bool cw = false)
+    {
+        std::vector<Punto<T>> vertices;
+        for(int i{}; i < n; ++i)
+        {
+            double angle{ (cw ? -2 : 2) * M_PI * i / n };
+            vertices.push_back(Punto<T>{ static_cast<T>(cx + radius * std::cos(angle)),
+                                         static_cast<T>(cy + radius * std::sin(angle)) });
+        }
+        return vertices;
+    }
+}
+
+void testShoelaceDoubleArea()
+{
+    ASSERT_EQUALS(44, shoelaceDoubleArea(&setup::polB[0], 5));
+    ASSERT_EQUALS(44, shoelaceDoubleArea(&setup::polB[0], 5, AreaSummation::COMPENSATED));
+    ASSERT_EQUALS(true, withinEps(19.11, shoelaceDoubleArea(&setup::polA[0], 14), 1e-10, 1e-10));
+    ASSERT_EQUALS(true, withinEps(19.11, shoelaceDoubleArea(&setup::polA[0], 14, AreaSummation::COMPENSATED),
+                                  1e-10, 1e-10));
+    ASSERT_EQUALS(true, withinEps(-3.24f, shoelaceDoubleArea(&setup::polC[0], 3), 1e-6f, 1e-6f));
+
+    // degenerate polygons have no area
+    ASSERT_EQUALS(0.0, shoelaceDoubleArea(&setup::polA[0], 1));
+    ASSERT_EQUALS(0, shoelaceDoubleArea(&setup::polB[0], 2));
+
+    // every length, to go through all the remainders of the unrolled loops
+    for(int n{ 3 }; n < 40; ++n)
+    {
+        std::vector<Punto<double>> vertices{ setup::regular(n, 2.0, 1.0, -3.0) };
+        Poligono<double> pol{ vertices.begin(), vertices.end() };
+        ASSERT_EQUALS(true, withinEps(pol.doubleSignedArea(), shoelaceDoubleArea(vertices.data(), n),
+                                      1e-10, 1e-10));
+    }
+}
+
+void testCompensatedFloatArea()
+{
+    // lots of small terms adding up to a large area: plain float sums lose
+    // the low bits of every term
+    const int n{ 1000000 };
+    std::vector<Punto<float>> vertices{ setup::regular(n, 1000.0f, 0.0f, 0.0f) };
+    std::vector<Punto<double>> exact;
+    for(const Punto<float> &p: vertices)
+    {
+        exact.push_back(Punto<double>{ p.getX(), p.getY() });
+    }
+    double expected{ compensatedDoubleArea(exact.data(), n) };
+    float compensated{ compensatedDoubleArea(vertices.data(), n) };
+    float fast{ shoelaceDoubleArea(vertices.data(), n) };
+    ASSERT_EQUALS(true, std::fabs(compensated - expected) <= std::fabs(fast - expected));
+    ASSERT_EQUALS(true, withinEps(expected, static_cast<double>(compensated), 1e-5, 1e-5));
+}
+
+void testBatchArea()
+{
+    std::mt19937 gen{ 3 };
+    std::uniform_int_distribution<int> sides{ 3, 90 };
+    std::uniform_real_distribution<double> coord{ -100.0, 100.0 };
+
+    // enough vertices to be split across threads
+    PolygonSet<double> set{};
+    for(int i{}; i < 3000; ++i)
+    {
+        std::vector<Punto<double>> vertices{ setup::regular(sides(gen), 1.0 + i % 7, coord(gen), coord(gen), i % 3 == 0) };
+        set.push_back(vertices.data(), static_cast<int>(vertices.size()));
+    }
+    set.push_back(setup::polA);
+
+    const int count{ set.getLength() };
+    std::vector<double> doubleAreas(count);
+    std::vector<double> areas(count);
+    std::unique_ptr<bool[]> ccw{ new bool[count] };
+    for(int threads: { 1, 4 })
+    {
+        batchDoubleSignedArea(set, doubleAreas.data(), AreaSummation::FAST, threads);
+        batchArea(set, areas.data(), AreaSummation::COMPENSATED, threads);
+        batchIsCCW(set, ccw.get(), AreaSummation::FAST, threads);
+
+        bool allMatch{ true };
+        for(int i{}; i < count; ++i)
+        {
+            const Poligono<double> pol{ set[i] };
+            allMatch = allMatch && withinEps(pol.doubleSignedArea(), doubleAreas[i], 1e-9, 1e-9)
+                       && withinEps(pol.area(), areas[i], 1e-9, 1e-9)
+                       && (pol.isCCW() == ccw[i]);
+        }
+        ASSERT_EQUALS(true, allMatch);
+    }
+}
+
+void testBatchAreaPoligonoArray()
+{
+    std::vector<Poligono<int>> polygons;
+    polygons.push_back(Poligono<int>{{5,0}, {6,4}, {4,5}, {1,5}, {1,0}});
+    polygons.push_back(Poligono<int>{{0,0}, {0,4}, {3,0}});
+    polygons.push_back(Poligono<int>{});
+    // 2^31 wide, its double area needs 64 bits
+    polygons.push_back(Poligono<int>{{-1073741824, -1073741824}, {1073741823, -1073741824},
+                                     {1073741823, 1073741823}, {-1073741824, 1073741823}});
+
+    long long doubleAreas[4]{};
+    batchDoubleSignedArea(polygons.data(), 4, doubleAreas);
+    ASSERT_EQUALS(44, doubleAreas[0]);
+    ASSERT_EQUALS(-12, doubleAreas[1]);
+    ASSERT_EQUALS(0, doubleAreas[2]);
+    ASSERT_EQUALS(2 * 2147483647LL * 2147483647LL, doubleAreas[3]);
+    ASSERT_EQUALS(doubleAreas[3], polygons[3].doubleSignedArea());
+}
+
+int main() {
+    RUN(testShoelaceDoubleArea);
+    RUN(testCompensatedFloatArea);
+    RUN(testBatchArea);
+    RUN(testBatchAreaPoligonoArray);
+
+    return TEST_REPORT();
+}
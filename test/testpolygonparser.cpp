@@ -0,0 +1,252 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace setup
+{
+    const std::string wkt{
+        "POLYGON ((5 0, 6 4, 4 5, 1 5, 1 0, 5 0))\n"
+        "LINESTRING (0 0, 1 1)\n"
+        "polygon((0 0,10 0,10 10,0 10,0 0),(2 2,2 4,4 4,2 2))\n"
+        "MULTIPOLYGON (((0 0, 1 0, 1 1, 0 0)), ((5 5, 7 5, 7 7, 5 5), (6 6, 6.5 6, 6 6.5, 6 6)))\n"
+        "POLYGON EMPTY\n"
+        "POLYGON Z ((0 0 1, 2 0 1, 2 2 1, 0 0 1))\n" };
+
+    const std::string geoJson{
+        "{\"type\": \"FeatureCollection\", \"features\": [\n"
+        "{\"type\": \"Feature\", \"properties\": {\"name\": \"a \\\"coordinates\\\" [[[ ]]]\"},\n"
+        " \"geometry\": {\"type\": \"Polygon\", \"coordinates\": [[[5, 0], [6, 4], [4, 5], [1, 5], [1, 0], [5, 0]]]}},\n"
+        "{\"type\": \"Feature\", \"geometry\": {\"type\": \"Point\", \"coordinates\": [3, 3]}},\n"
+        "{\"type\": \"Feature\", \"geometry\": {\"type\": \"MultiPolygon\", \"coordinates\":\n"
+        "  [[[[0, 0], [1, 0], [1, 1], [0, 0]]], [[[5, 5], [7, 5], [7, 7], [5, 5]], [[6, 6], [6.5, 6], [6, 6.5], [6, 6]]]]}},\n"
+        "{\"type\": \"Feature\", \"geometry\": {\"type\": \"Polygon\", \"coordinates\": [[[-1.5e1, 2], [0, 2, 7], [0, 3]]]}}\n"
+        "]}\n" };
+
+    /*
+     * Text of count copies of a square ring, one per line, each moved by its
+     * position.
+     */
+    std::string manySquares(int count, bool json)
+    {
+        std::ostringstream text;
+        for(int i{}; i < count; ++i)
+        {
+            if (json)
+            {
+                text << "{\"type\": \"Polygon\", \"coordinates\": [[[" << i << ", 0], [" << i + 1 << ", 0], ["
+                     << i + 1 << ", 1], [" << i << ", 1], [" << i << ", 0]]]}\n";
+            }
+            else
+            {
+                text << "POLYGON ((" << i << " 0, " << i + 1 << " 0, " << i + 1 << " 1, " << i << " 1, "
+                     << i << " 0))\n";
+            }
+        }
+        return text.str();
+    }
+}
+
+void testParseWkt()
+{
+    PolygonSet<double> set;
+    ParseStats stats{ parsePolygons(setup::wkt.data(), static_cast<int>(setup::wkt.size()), TextFormat::WKT, set) };
+    ASSERT_EQUALS(0, stats.errors);
+    ASSERT_EQUALS(5, set.getLength());
+    ASSERT_EQUALS(5, stats.polygons);
+
+    // closing vertices are dropped
+    ASSERT_EQUALS(5, set.polygonLength(0));
+    ASSERT_EQUALS(44, set[0].doubleSignedArea());
+    // only outer rings by default
+    ASSERT_EQUALS(4, set.polygonLength(1));
+    ASSERT_EQUALS(200, set[1].doubleSignedArea());
+    ASSERT_EQUALS(3, set.polygonLength(2));
+    ASSERT_EQUALS(3, set.polygonLength(3));
+    ASSERT_EQUALS(Punto<double>(5, 5), set[3][0]);
+    // Z values are dropped
+    ASSERT_EQUALS(3, set.polygonLength(4));
+    ASSERT_EQUALS(Punto<double>(2, 2), set[4][2]);
+
+    PolygonSet<double> rings;
+    parsePolygons(setup::wkt.data(), static_cast<int>(setup::wkt.size()), TextFormat::WKT, rings, RingSelection::ALL);
+    ASSERT_EQUALS(7, rings.getLength());
+    ASSERT_EQUALS(Punto<double>(2, 4), rings[2][1]);
+    ASSERT_EQUALS(Punto<double>(6.5, 6), rings[5][1]);
+}
+
+void testParseGeoJson()
+{
+    PolygonSet<float> set;
+    ParseStats stats{ parsePolygons(setup::geoJson.data(), static_cast<int>(setup::geoJson.size()),
+                                    TextFormat::GEOJSON, set, RingSelection::ALL) };
+    ASSERT_EQUALS(0, stats.errors);
+    ASSERT_EQUALS(5, set.getLength());
+    ASSERT_EQUALS(5, set.polygonLength(0));
+    ASSERT_EQUALS(44.0f, set[0].doubleSignedArea());
+    ASSERT_EQUALS(3, set.polygonLength(1));
+    ASSERT_EQUALS(3, set.polygonLength(3));
+    ASSERT_EQUALS(Punto<float>(6.5f, 6.0f), set[3][1]);
+    // exponents, and positions with a third value
+    ASSERT_EQUALS(3, set.polygonLength(4));
+    ASSERT_EQUALS(Punto<float>(-15.0f, 2.0f), set[4][0]);
+    ASSERT_EQUALS(Punto<float>(0.0f, 2.0f), set[4][1]);
+}
+
+void testParseGeoJsonTypes()
+{
+    // lines nest their coordinates as deep as polygons, and the type of a
+    // geometry may come after its coordinates
+    const std::string json{
+        "{\"type\": \"FeatureCollection\", \"features\": [\n"
+        "{\"type\": \"Feature\", \"geometry\": {\"type\": \"MultiLineString\",\n"
+        "  \"coordinates\": [[[0, 0], [1, 1]], [[2, 2], [3, 3]]]}},\n"
+        "{\"type\": \"Feature\", \"geometry\": {\"coordinates\": [[0, 0], [1, 1]], \"type\": \"LineString\"}},\n"
+        "{\"geometry\": {\"coordinates\": [[[[0, 0], [1, 1]]]], \"type\": \"MultiLineString\"}, \"type\": \"Feature\"},\n"
+        "{\"geometry\": {\"coordinates\": [[[5, 0], [6, 4], [4, 5], [1, 5], [5, 0]]], \"type\": \"Polygon\"},\n"
+        "  \"type\": \"Feature\"},\n"
+        "{\"type\": \"Feature\", \"geometry\": {\"coordinates\": [[[0, 0], [1, 0], [0, 1], [0, 0]]]}},\n"
+        "{\"type\": \"Feature\", \"geometry\": {\"type\": \"Polygon\", \"coordinates\": [[[0, 0], [2, 0], [0, 2]]]}}\n"
+        "]}\n" };
+    PolygonSet<double> set;
+    ParseStats stats{ parsePolygons(json.data(), static_cast<int>(json.size()), TextFormat::GEOJSON, set) };
+    ASSERT_EQUALS(0, stats.errors);
+    ASSERT_EQUALS(2, set.getLength());
+    ASSERT_EQUALS(4, set.polygonLength(0));
+    ASSERT_EQUALS(Punto<double>(5, 0), set[0][0]);
+    ASSERT_EQUALS(3, set.polygonLength(1));
+    ASSERT_EQUALS(Punto<double>(2, 0), set[1][1]);
+
+    // geometries whose type comes last, cut by the chunks anywhere
+    std::string features{ "{\"type\": \"FeatureCollection\", \"features\": [\n" };
+    for(int i{}; i < 1000; ++i)
+    {
+        std::string ring{ "[[[" + std::to_string(i) + ", 0], [" + std::to_string(i + 1) + ", 0], ["
+                          + std::to_string(i) + ", 1]]]" };
+        features += "{\"geometry\": {\"coordinates\": " + ring + ", \"type\": \"LineString\"}},\n";
+        features += "{\"geometry\": {\"coordinates\": " + ring + ", \"type\": \"Polygon\"}},\n";
+    }
+    features += "{}]}\n";
+    for(int chunkSize: { 1024, 1500 })
+    {
+        std::istringstream in{ features };
+        PolygonParser<double> parser{ TextFormat::GEOJSON };
+        int next{ };
+        bool inOrder{ true };
+        stats = parser.stream(in, [&](const PolygonSet<double> &chunk) {
+            for(int i{}; i < chunk.getLength(); ++i)
+            {
+                inOrder = inOrder && chunk.polygonLength(i) == 3 && chunk[i][0].getX() == next;
+                ++next;
+            }
+        }, chunkSize);
+        ASSERT_EQUALS(true, inOrder);
+        ASSERT_EQUALS(1000, next);
+        ASSERT_EQUALS(0, stats.errors);
+    }
+}
+
+void testParseErrors()
+{
+    const std::string wkt{ "POLYGON ((0 0, 1 0, 1 x1, 0 0))\nPOLYGON ((0 0, 2 0, 2 2, 0 0))\nPOLYGON ((1 1, 2" };
+    PolygonSet<double> set;
+    ParseStats stats{ parsePolygons(wkt.data(), static_cast<int>(wkt.size()), TextFormat::WKT, set) };
+    ASSERT_EQUALS(2, stats.errors);
+    ASSERT_EQUALS(1, set.getLength());
+    ASSERT_EQUALS(3, set.getVertexCount());
+
+    // int coordinates don't take fractions, so the whole multipolygon is skipped
+    PolygonSet<int> ints;
+    stats = parsePolygons(setup::wkt.data(), static_cast<int>(setup::wkt.size()), TextFormat::WKT, ints);
+    ASSERT_EQUALS(1, stats.errors);
+    ASSERT_EQUALS(3, ints.getLength());
+}
+
+void testStreamChunks()
+{
+    // chunks much smaller than the text cut geometries in every place
+    for(bool json: { false, true })
+    {
+        std::string text{ setup::manySquares(3000, json) };
+        for(int chunkSize: { 1024, 1500, 4096 })
+        {
+            std::istringstream in{ text };
+            PolygonParser<double> parser{ json ? TextFormat::GEOJSON : TextFormat::WKT };
+            int next{ };
+            bool inOrder{ true };
+            ParseStats stats{ parser.stream(in, [&](const PolygonSet<double> &set) {
+                for(int i{}; i < set.getLength(); ++i)
+                {
+                    inOrder = inOrder && set.polygonLength(i) == 4 && set[i][0].getX() == next;
+                    ++next;
+                }
+            }, chunkSize) };
+            ASSERT_EQUALS(true, inOrder);
+            ASSERT_EQUALS(3000, next);
+            ASSERT_EQUALS(3000, stats.polygons);
+            ASSERT_EQUALS(12000, stats.vertices);
+            ASSERT_EQUALS(0, stats.errors);
+            ASSERT_EQUALS(text.size(), stats.bytes);
+        }
+    }
+
+    // a geometry larger than the chunk makes it grow
+    std::string big{ "POLYGON ((" };
+    for(int i{}; i < 1000; ++i)
+    {
+        big += std::to_string(i) + " " + std::to_string(i % 7) + ", ";
+    }
+    big += "0 0))";
+    std::istringstream in{ big };
+    PolygonSet<double> set;
+    PolygonParser<double> parser{ TextFormat::WKT };
+    parser.stream(in, [&](const PolygonSet<double> &chunk) {
+        for(int i{}; i < chunk.getLength(); ++i)
+        {
+            set.push_back(chunk[i]);
+        }
+    }, 1024);
+    ASSERT_EQUALS(1, set.getLength());
+    ASSERT_EQUALS(1000, set.polygonLength(0));
+}
+
+void testParseThreads()
+{
+    std::string text{ setup::manySquares(50000, false) };
+    PolygonSet<double> single;
+    PolygonSet<double> parallel;
+    parsePolygons(text.data(), static_cast<int>(text.size()), TextFormat::WKT, single, RingSelection::OUTER, 1);
+    ParseStats stats{ parsePolygons(text.data(), static_cast<int>(text.size()), TextFormat::WKT, parallel,
+                                    RingSelection::OUTER, 4) };
+    ASSERT_EQUALS(single.getVertexCount(), parallel.getVertexCount());
+    bool same{ single.getLength() == 50000 && parallel.getLength() == 50000 };
+    for(int i{}; same && i < single.getVertexCount(); ++i)
+    {
+        same = single.getVertices()[i].getX() == parallel.getVertices()[i].getX()
+               && single.getVertices()[i].getY() == parallel.getVertices()[i].getY();
+    }
+    ASSERT_EQUALS(true, same);
+    ASSERT_EQUALS(true, stats.megabytesPerSecond() > 0);
+
+    std::istringstream in{ text };
+    PolygonSet<double> streamed;
+    stats = parsePolygons(in, TextFormat::WKT, streamed, RingSelection::OUTER, 4);
+    ASSERT_EQUALS(50000, streamed.getLength());
+    ASSERT_EQUALS(text.size(), stats.bytes);
+}
+
+int main() {
+    RUN(testParseWkt);
+    RUN(testParseGeoJson);
+    RUN(testParseGeoJsonTypes);
+    RUN(testParseErrors);
+    RUN(testStreamChunks);
+    RUN(testParseThreads);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,301 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace setup
+{
+    const std::string treePath{ "testpolygonrtree_tree.bin" };
+    const std::string polygonsPath{ "testpolygonrtree_polygons.bin" };
+
+    /*
+     * Partition of the rectangle [0, 50] x [0, 40] in unit squares, square
+     * (x, y) at position y*50 + x.
+     */
+    PolygonSet<int> squares()
+    {
+        PolygonSet<int> set;
+        for(int y{}; y < 40; ++y)
+        {
+            for(int x{}; x < 50; ++x)
+            {
+                set.push_back(Poligono<int>{{x, y}, {x + 1, y}, {x + 1, y + 1}, {x, y + 1}});
+            }
+        }
+        return set;
+    }
+
+    /*
+     * Overlapping random triangles and quads in [0, 100]^2, with an empty
+     * polygon among them.
+     */
+    PolygonSet<double> randomPolygons(int count, unsigned seed)
+    {
+        std::mt19937 generator{ seed };
+        std::uniform_real_distribution<double> center{ 0.0, 100.0 };
+        std::uniform_real_distribution<double> radius{ 0.5, 6.0 };
+        PolygonSet<double> set;
+        for(int i{}; i < count; ++i)
+        {
+            if (i == count / 2)
+            {
+                set.push_back(Poligono<double>{});
+                continue;
+            }
+            double cx{ center(generator) };
+            double cy{ center(generator) };
+            int sides{ 3 + i % 2 };
+            for(int s{}; s < sides; ++s)
+            {
+                double angle{ 2 * M_PI * s / sides };
+                double r{ radius(generator) };
+                set.pushVertex(Punto<double>{ cx + r * std::cos(angle), cy + r * std::sin(angle) });
+            }
+            set.endPolygon();
+        }
+        return set;
+    }
+
+    std::vector<Punto<double>> randomPoints(int count, unsigned seed)
+    {
+        std::mt19937 generator{ seed };
+        std::uniform_real_distribution<double> coord{ -10.0, 110.0 };
+        std::vector<Punto<double>> points;
+        for(int i{}; i < count; ++i)
+        {
+            points.push_back(Punto<double>{ coord(generator), coord(generator) });
+        }
+        return points;
+    }
+
+    /*
+     * Squared distance from p to the polygon by brute force, 0 inside.
+     */
+    double distance2(const Poligono<double> &pol, const Punto<double> &p)
+    {
+        if (pol.pointInside(p))
+        {
+            return 0;
+        }
+        double best{ 1e300 };
+        for(int i{}; i < pol.getLength(); ++i)
+        {
+            const Punto<double> &a{ pol[i] };
+            const Punto<double> &b{ pol[(i + 1) % pol.getLength()] };
+            double dx{ b.getX() - a.getX() };
+            double dy{ b.getY() - a.getY() };
+            double t{ ((p.getX() - a.getX()) * dx + (p.getY() - a.getY()) * dy) / (dx * dx + dy * dy) };
+            t = std::max(0.0, std::min(1.0, t));
+            double ex{ a.getX() + t * dx - p.getX() };
+            double ey{ a.getY() + t * dy - p.getY() };
+            best = std::min(best, ex * ex + ey * ey);
+        }
+        return best;
+    }
+}
+
+void testLocate()
+{
+    PolygonSet<int> squares{ setup::squares() };
+    const PolygonRTree<int> tree{ squares };
+    ASSERT_EQUALS(2000, tree.getLength());
+    ASSERT_EQUALS(3, tree.getHeight());
+
+    // every square holds its lower left corner
+    bool allFound{ true };
+    for(int y{}; y < 40; ++y)
+    {
+        for(int x{}; x < 50; ++x)
+        {
+            std::vector<int> containing;
+            tree.containing(Punto<int>{ x, y }, containing);
+            allFound = allFound && std::count(containing.begin(), containing.end(), y * 50 + x) == 1;
+        }
+    }
+    ASSERT_EQUALS(true, allFound);
+    ASSERT_EQUALS(-1, tree.locate(Punto<int>{ -1, 5 }));
+    ASSERT_EQUALS(-1, tree.locate(Punto<int>{ 20, 41 }));
+
+    PolygonSet<double> polygons{ setup::randomPolygons(3000, 1u) };
+    const PolygonRTree<double> randomTree{ polygons };
+    std::vector<Punto<double>> points{ setup::randomPoints(2000, 2u) };
+    bool allMatch{ true };
+    int inside{ };
+    for(const Punto<double> &p: points)
+    {
+        std::vector<int> expected;
+        for(int i{}; i < polygons.getLength(); ++i)
+        {
+            if (polygons[i].pointInside(p))
+            {
+                expected.push_back(i);
+            }
+        }
+        std::vector<int> containing;
+        randomTree.containing(p, containing);
+        std::sort(containing.begin(), containing.end());
+        allMatch = allMatch && containing == expected;
+        int located{ randomTree.locate(p) };
+        allMatch = allMatch && (expected.empty() ? located == -1
+                                                 : std::count(expected.begin(), expected.end(), located) == 1);
+        inside += !expected.empty();
+    }
+    ASSERT_EQUALS(true, allMatch);
+    ASSERT_EQUALS(true, inside > 100);
+
+    for(int threads: { 1, 4 })
+    {
+        std::vector<int> located(points.size());
+        randomTree.locateAll(points.data(), static_cast<int>(points.size()), located.data(), threads);
+        bool sameAsSingle{ true };
+        for(std::size_t i{}; i < points.size(); ++i)
+        {
+            sameAsSingle = sameAsSingle && located[i] == randomTree.locate(points[i]);
+        }
+        ASSERT_EQUALS(true, sameAsSingle);
+    }
+
+    // trees with one polygon or none
+    PolygonSet<double> one;
+    one.push_back(Poligono<double>{{0,0}, {1,0}, {0,1}});
+    ASSERT_EQUALS(0, PolygonRTree<double>{ one }.locate(Punto<double>{ 0.2, 0.2 }));
+    ASSERT_EQUALS(-1, PolygonRTree<double>{ PolygonSet<double>{} }.locate(Punto<double>{ 0.2, 0.2 }));
+}
+
+void testIntersecting()
+{
+    PolygonSet<double> polygons{ setup::randomPolygons(3000, 3u) };
+    const PolygonRTree<double> tree{ polygons };
+    std::mt19937 generator{ 4u };
+    std::uniform_real_distribution<double> coord{ -10.0, 110.0 };
+    std::uniform_real_distribution<double> size{ 0.0, 20.0 };
+    bool allMatch{ true };
+    for(int q{}; q < 200; ++q)
+    {
+        double x{ coord(generator) };
+        double y{ coord(generator) };
+        const BoundingBox<double> box{ x, y, x + size(generator), y + size(generator) };
+        std::vector<int> expected;
+        for(int i{}; i < polygons.getLength(); ++i)
+        {
+            const Poligono<double> pol{ polygons[i] };
+            if (BoundingBox<double>::of(&pol[0], pol.getLength()).intersects(box))
+            {
+                expected.push_back(i);
+            }
+        }
+        std::vector<int> found;
+        tree.intersecting(box, found);
+        std::sort(found.begin(), found.end());
+        allMatch = allMatch && found == expected;
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+void testNearest()
+{
+    PolygonSet<double> polygons{ setup::randomPolygons(2000, 5u) };
+    const PolygonRTree<double> tree{ polygons };
+    std::vector<Punto<double>> points{ setup::randomPoints(200, 6u) };
+    bool allMatch{ true };
+    for(const Punto<double> &p: points)
+    {
+        std::vector<double> expected;
+        for(int i{}; i < polygons.getLength(); ++i)
+        {
+            if (polygons.polygonLength(i) > 0)
+            {
+                expected.push_back(setup::distance2(polygons[i], p));
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        std::vector<int> nearest;
+        tree.nearest(p, 5, nearest);
+        allMatch = allMatch && nearest.size() == 5;
+        for(std::size_t i{}; allMatch && i < nearest.size(); ++i)
+        {
+            allMatch = withinEps(expected[i], setup::distance2(polygons[nearest[i]], p), 1e-12, 1e-9);
+        }
+    }
+    ASSERT_EQUALS(true, allMatch);
+
+    // asking for more than there are gives all of them but the empty one
+    std::vector<int> all;
+    tree.nearest(Punto<double>{ 50, 50 }, 5000, all);
+    ASSERT_EQUALS(1999, static_cast<int>(all.size()));
+}
+
+void testSerialization()
+{
+    PolygonSet<double> polygons{ setup::randomPolygons(3000, 7u) };
+    const PolygonRTree<double> tree{ polygons };
+    {
+        std::ofstream out{ setup::treePath, std::ios::binary };
+        ASSERT_EQUALS(true, tree.write(out));
+        std::ofstream polygonsOut{ setup::polygonsPath, std::ios::binary };
+        ASSERT_EQUALS(true, writePolygonSet(polygonsOut, polygons));
+    }
+
+    // the tree mapped next to the mapped polygons
+    MappedGeometry<double> mapped{ setup::polygonsPath };
+    const PolygonRTree<double> loaded{ setup::treePath, mapped };
+    ASSERT_EQUALS(true, loaded.isValid());
+    ASSERT_EQUALS(tree.getLength(), loaded.getLength());
+    ASSERT_EQUALS(tree.getHeight(), loaded.getHeight());
+    std::vector<Punto<double>> points{ setup::randomPoints(1000, 8u) };
+    bool allMatch{ true };
+    for(const Punto<double> &p: points)
+    {
+        std::vector<int> expected;
+        std::vector<int> found;
+        tree.nearest(p, 3, expected);
+        loaded.nearest(p, 3, found);
+        allMatch = allMatch && tree.locate(p) == loaded.locate(p) && expected == found;
+    }
+    ASSERT_EQUALS(true, allMatch);
+
+    // the tree only opens over the polygons it was built for
+    PolygonSet<double> fewer{ setup::randomPolygons(10, 7u) };
+    ASSERT_EQUALS(true, PolygonRTree<double>(setup::treePath, fewer).getStatus() == BinaryStatus::BAD_OFFSETS);
+    ASSERT_EQUALS(true, PolygonRTree<float>(setup::treePath, PolygonSet<float>{}).getStatus() == BinaryStatus::WRONG_SCALAR);
+    ASSERT_EQUALS(true, PolygonRTree<double>(setup::polygonsPath, polygons).getStatus() == BinaryStatus::BAD_MAGIC);
+    ASSERT_EQUALS(true, MappedGeometry<double>{ setup::treePath }.getStatus() == BinaryStatus::BAD_MAGIC);
+    const PolygonRTree<double> missing{ "testpolygonrtree_missing.bin", polygons };
+    ASSERT_EQUALS(true, missing.getStatus() == BinaryStatus::CANT_OPEN);
+    ASSERT_EQUALS(-1, missing.locate(points[0]));
+
+    // boxes starting far past the end of the file
+    std::string bytes;
+    {
+        std::ifstream in{ setup::treePath, std::ios::binary };
+        bytes.assign(std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{});
+    }
+    bytes.replace(24, 8, "\xf0\xff\xff\xff\xff\xff\xff\xff", 8);
+    {
+        std::ofstream out{ setup::treePath, std::ios::binary };
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    ASSERT_EQUALS(true, PolygonRTree<double>(setup::treePath, polygons).getStatus() == BinaryStatus::TOO_SHORT);
+
+    std::remove(setup::treePath.c_str());
+    std::remove(setup::polygonsPath.c_str());
+}
+
+int main() {
+    RUN(testLocate);
+    RUN(testIntersecting);
+    RUN(testNearest);
+    RUN(testSerialization);
+
+    return TEST_REPORT();
+}
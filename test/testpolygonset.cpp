@@ -0,0 +1,136 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <vector>
+
+namespace setup
+{
+    const Poligono<int> polB {{5,0}, {6,4}, {4,5}, {1,5}, {1,0}};
+
+    /*
+     * Set with polB, a clockwise triangle and a square built vertex by vertex.
+     */
+    PolygonSet<int> layer()
+    {
+        PolygonSet<int> set{};
+        set.reserve(3, 12);
+        set.push_back(polB);
+
+        const Punto<int> triangle[3]{{ 0, 0 }, { 0, 4 }, { 3, 0 }};
+        set.push_back(triangle, 3);
+
+        set.pushVertex(Punto<int>{ 10, 10 });
+        set.pushVertex(Punto<int>{ 12, 10 });
+        set.pushVertex(Punto<int>{ 12, 12 });
+        set.pushVertex(Punto<int>{ 10, 12 });
+        set.endPolygon();
+        return set;
+    }
+}
+
+void testPolygonSetInit()
+{
+    const PolygonSet<double> empty{};
+    ASSERT_EQUALS(0, empty.getLength());
+    ASSERT_EQUALS(0, empty.getVertexCount());
+
+    const PolygonSet<int> set{ setup::layer() };
+    ASSERT_EQUALS(3, set.getLength());
+    ASSERT_EQUALS(12, set.getVertexCount());
+    ASSERT_EQUALS(5, set.polygonLength(0));
+    ASSERT_EQUALS(3, set.polygonLength(1));
+    ASSERT_EQUALS(4, set.polygonLength(2));
+
+    const int* offsets{ set.getOffsets() };
+    ASSERT_EQUALS(0, offsets[0]);
+    ASSERT_EQUALS(5, offsets[1]);
+    ASSERT_EQUALS(8, offsets[2]);
+    ASSERT_EQUALS(12, offsets[3]);
+    ASSERT_EQUALS(Punto<int>(0, 4), set.getVertices()[6]);
+}
+
+void testPolygonSetViews()
+{
+    const PolygonSet<int> set{ setup::layer() };
+    // the views share the vertex array of the set
+    ASSERT_EQUALS(set.getVertices() + 5, &set[1][0]);
+    ASSERT_EQUALS(true, set[0].isView());
+
+    ASSERT_EQUALS(setup::polB.doubleSignedArea(), set[0].doubleSignedArea());
+    ASSERT_EQUALS(-12, set[1].doubleSignedArea());
+    ASSERT_EQUALS(8, set[2].doubleSignedArea());
+
+    ASSERT_EQUALS(true, set[0].isCCW());
+    ASSERT_EQUALS(false, set[1].isCCW());
+    ASSERT_EQUALS(true, set[2].isCCW());
+
+    for(int i{}; i < 5; ++i)
+    {
+        ASSERT_EQUALS(setup::polB.signedAngle(i), set[0].signedAngle(i));
+    }
+
+    ASSERT_EQUALS(true, set[0].pointInside(Punto<int>{ 2, 1 }));
+    ASSERT_EQUALS(false, set[0].pointInside(Punto<int>{ 11, 11 }));
+    ASSERT_EQUALS(true, set[1].pointInside(Punto<int>{ 1, 1 }));
+    ASSERT_EQUALS(true, set[2].pointInside(Punto<int>{ 11, 11 }));
+
+    // the views of a const set copy their vertices before editing them
+    auto copy{ set[0] };
+    copy[0] = Punto<int>{ 42, 42 };
+    ASSERT_EQUALS(false, copy.isView());
+    ASSERT_EQUALS(Punto<int>(42, 42), copy[0]);
+    ASSERT_EQUALS(Punto<int>(5, 0), set.getVertices()[0]);
+}
+
+void testPolygonSetEdit()
+{
+    PolygonSet<int> set{ setup::layer() };
+    Poligono<int> square{ set[2] };
+    square[1] = Punto<int>{ 14, 10 };
+    ASSERT_EQUALS(Punto<int>(14, 10), set.getVertices()[9]);
+    ASSERT_EQUALS(12, set[2].doubleSignedArea());
+
+    // dropping polygons also drops a polygon left half built
+    set.pushVertex(Punto<int>{ 1, 1 });
+    set.truncate(1);
+    ASSERT_EQUALS(1, set.getLength());
+    ASSERT_EQUALS(5, set.getVertexCount());
+    ASSERT_EQUALS(44, set[0].doubleSignedArea());
+
+    set.clear();
+    ASSERT_EQUALS(0, set.getLength());
+    ASSERT_EQUALS(0, set.getVertexCount());
+
+    set.push_back(setup::polB);
+    ASSERT_EQUALS(1, set.getLength());
+    ASSERT_EQUALS(44, set[0].doubleSignedArea());
+
+    // copying polygons of a set into itself, while it grows
+    PolygonSet<int> grown{};
+    grown.push_back(setup::polB);
+    for(int i{}; i < 6; ++i)
+    {
+        grown.push_back(grown[i]);
+    }
+    grown.push_back(grown.getVertices() + 1, 3);
+    ASSERT_EQUALS(8, grown.getLength());
+    bool allCopied{ true };
+    for(int i{}; i < 7; ++i)
+    {
+        allCopied = allCopied && grown[i].doubleSignedArea() == 44;
+    }
+    ASSERT_EQUALS(true, allCopied);
+    ASSERT_EQUALS(Punto<int>(6, 4), grown[7][0]);
+    ASSERT_EQUALS(Punto<int>(1, 5), grown[7][2]);
+}
+
+int main() {
+    RUN(testPolygonSetInit);
+    RUN(testPolygonSetViews);
+    RUN(testPolygonSetEdit);
+
+    return TEST_REPORT();
+}
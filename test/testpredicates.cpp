@@ -0,0 +1,230 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <cmath>
+#include <random>
+
+namespace setup
+{
+    // distance between consecutive doubles in [0.5, 1)
+    const double ulpHalf{ std::ldexp(1.0, -53) };
+}
+
+int sign(double value)
+{
+    return (value > 0) - (value < 0);
+}
+
+void testOrient2dSimple()
+{
+    ASSERT_EQUALS(1.0, orient2d(0.0, 0.0, 1.0, 0.0, 0.0, 1.0));
+    ASSERT_EQUALS(-1.0, orient2d(0.0, 0.0, 0.0, 1.0, 1.0, 0.0));
+    ASSERT_EQUALS(0.0, orient2d(0.0, 0.0, 1.0, 1.0, 3.0, 3.0));
+    ASSERT_EQUALS(0.0, orient2d(Punto<int>{ 1, 2 }, Punto<int>{ 3, 4 }, Punto<int>{ -1, 0 }));
+    ASSERT_EQUALS(1, sign(orient2d(Punto<float>{ 0.0f, 0.0f }, Punto<float>{ 2.0f, 0.0f }, Punto<float>{ 1.0f, 0.5f })));
+}
+
+void testOrient2dNearlyCollinear()
+{
+    // b and c lie on the line y = x, so the sign of the orientation of a, b
+    // and c is the sign of a.y - a.x, which plain evaluation gets wrong for
+    // many of these points
+    const Punto<double> b{ 12, 12 };
+    const Punto<double> c{ 24, 24 };
+    int wrong{};
+    for(int i{}; i < 64; ++i)
+    {
+        for(int j{}; j < 64; ++j)
+        {
+            const Punto<double> a{ 0.5 + i * setup::ulpHalf, 0.5 + j * setup::ulpHalf };
+            int expected{ (j > i) - (j < i) };
+            if (sign(orient2d(a, b, c)) != expected || sign(orient2d(b, c, a)) != expected
+                || sign(orient2d(c, b, a)) != -expected)
+            {
+                ++wrong;
+            }
+        }
+    }
+    ASSERT_EQUALS(0, wrong);
+}
+
+void testIncircle()
+{
+    const Punto<double> a{ 1, 0 };
+    const Punto<double> b{ 0, 1 };
+    const Punto<double> c{ -1, 0 };
+    ASSERT_EQUALS(0.0, incircle(a, b, c, Punto<double>{ 0, -1 }));
+    ASSERT_EQUALS(1, sign(incircle(a, b, c, Punto<double>{ 0, 0 })));
+    ASSERT_EQUALS(-1, sign(incircle(a, b, c, Punto<double>{ 2, 2 })));
+    ASSERT_EQUALS(-1, sign(incircle(a, b, c, Punto<double>{ 0, -1 - 2 * setup::ulpHalf })));
+    ASSERT_EQUALS(1, sign(incircle(a, b, c, Punto<double>{ 0, -1 + setup::ulpHalf })));
+    // clockwise order swaps the sign
+    ASSERT_EQUALS(-1, sign(incircle(c, b, a, Punto<double>{ 0, 0 })));
+
+    // the same circle far from the origin needs the exact evaluation
+    const double offset{ 1e6 };
+    const double ulpOffset{ std::ldexp(1.0, -33) };
+    const Punto<double> fa{ offset + 1, offset };
+    const Punto<double> fb{ offset, offset + 1 };
+    const Punto<double> fc{ offset - 1, offset };
+    ASSERT_EQUALS(0.0, incircle(fa, fb, fc, Punto<double>{ offset, offset - 1 }));
+    ASSERT_EQUALS(-1, sign(incircle(fa, fb, fc, Punto<double>{ offset, offset - 1 - ulpOffset })));
+    ASSERT_EQUALS(1, sign(incircle(fa, fb, fc, Punto<double>{ offset, offset - 1 + ulpOffset })));
+    ASSERT_EQUALS(0.0, incircle(Punto<int>{ 3, 4 }, Punto<int>{ -4, 3 }, Punto<int>{ -5, 0 }, Punto<int>{ 0, -5 }));
+}
+
+void testSegmentoPolicy()
+{
+    const Segmento<double> s{ Punto<double>{ 12, 12 }, Punto<double>{ 24, 24 } };
+    const Punto<double> above{ 0.5, 0.5 + setup::ulpHalf };
+    const Punto<double> below{ 0.5 + setup::ulpHalf, 0.5 };
+    const Punto<double> on{ 0.5, 0.5 };
+    ASSERT_EQUALS(true, s.isPointToTheLeft<RobustPredicates>(above));
+    ASSERT_EQUALS(false, s.isPointToTheRight<RobustPredicates>(above));
+    ASSERT_EQUALS(true, s.isPointToTheRight<RobustPredicates>(below));
+    ASSERT_EQUALS(false, s.isPointToTheLeft<RobustPredicates>(on));
+    ASSERT_EQUALS(false, s.isPointToTheRight<RobustPredicates>(on));
+
+    // the default policy keeps the old behaviour
+    const Segmento<int> si{ 1, 0, 5, 0 };
+    ASSERT_EQUALS(true, si.isPointToTheLeft(Punto<int>{ 3, 1 }));
+    ASSERT_EQUALS(true, si.isPointToTheRight(Punto<int>{ 3, -1 }));
+    ASSERT_EQUALS(si.lineDeterminant(Punto<int>{ 2, 7 }), FastPredicates::orientation(Punto<int>{ 1, 0 }, Punto<int>{ 5, 0 }, Punto<int>{ 2, 7 }));
+}
+
+void testPointInsidePolicy()
+{
+    // counter clockwise triangle whose hypotenuse goes from (30,70) to the
+    // origin. Points are in a grid of step 2^-30 around (15,35), which lies on
+    // the hypotenuse, so the exact answer can be computed with integers
+    const Poligono<double> pol{ Punto<double>{ 0, 0 }, Punto<double>{ 30, 0 }, Punto<double>{ 30, 70 } };
+    const double step{ std::ldexp(1.0, -30) };
+    int wrong{};
+    for(int i{ -40 }; i <= 40; ++i)
+    {
+        for(int j{ -40 }; j <= 40; ++j)
+        {
+            const Punto<double> p{ 15 + i * step, 35 + j * step };
+            // 70x - 30y scaled by 2^30, the points on the edge count as inside
+            long long orientation{ 70LL * (15LL * (1LL << 30) + i) - 30LL * (35LL * (1LL << 30) + j) };
+            if (pol.pointInside<RobustPredicates>(p) != (orientation >= 0))
+            {
+                ++wrong;
+            }
+        }
+    }
+    ASSERT_EQUALS(0, wrong);
+
+    // away from the edges both policies agree
+    ASSERT_EQUALS(true, pol.pointInside<RobustPredicates>(Punto<double>{ 20, 10 }));
+    ASSERT_EQUALS(pol.pointInside(Punto<double>{ 20, 10 }), pol.pointInside<RobustPredicates>(Punto<double>{ 20, 10 }));
+    ASSERT_EQUALS(false, pol.pointInside<RobustPredicates>(Punto<double>{ 5, 60 }));
+    ASSERT_EQUALS(pol.pointInside(Punto<double>{ 5, 60 }), pol.pointInside<RobustPredicates>(Punto<double>{ 5, 60 }));
+}
+
+void testIntegerWidening()
+{
+    // products of coordinates past 46341 don't fit in an int
+    ASSERT_EQUALS(2147488281LL, crossProdValue(Vector<int>{ 46341, 0 }, Vector<int>{ 0, 46341 }));
+    ASSERT_EQUALS(2147488281LL, dotProduct(Vector<int>{ 46341, 1 }, Vector<int>{ 46341, 0 }));
+
+    // orientations over the whole int range are exact
+    const Punto<int> low{ -2147483647 - 1, -2147483647 - 1 };
+    const Punto<int> high{ 2147483647, 2147483647 };
+    ASSERT_EQUALS(true, FastPredicates::orientation(low, high, Punto<int>{ 2147483647, -2147483647 - 1 }) < 0);
+    ASSERT_EQUALS(true, FastPredicates::orientation(low, high, Punto<int>{ -2147483647 - 1, 2147483647 }) > 0);
+    const Punto<int> origin{ 0, 0 };
+    const Punto<int> far{ 2000000000, 1000000000 };
+    ASSERT_EQUALS(true, FastPredicates::orientation(origin, far, Punto<int>{ -2000000000, -1000000000 }) == 0);
+    ASSERT_EQUALS(true, FastPredicates::orientation(origin, far, Punto<int>{ -2000000000, -999999999 }) > 0);
+
+    const Segmento<int> diagonal{ low, high };
+    ASSERT_EQUALS(true, diagonal.isPointInLine(Punto<int>{ 123456789, 123456789 }));
+    ASSERT_EQUALS(true, diagonal.isPointToTheLeft(Punto<int>{ 123456789, 123456790 }));
+    ASSERT_EQUALS(true, diagonal.isPointToTheRight(Punto<int>{ 2147483647, 2147483646 }));
+
+    // a triangle below the diagonal of the whole int range
+    const Poligono<int> pol{ low, Punto<int>{ 2147483647, -2147483647 - 1 }, high };
+    const int xs[]{ 1000000000, 1000000000, -5, -2000000000, 2147483647 };
+    const int ys[]{ 999999999, 1000000001, -6, 2000000000, 2147483646 };
+    const bool expected[]{ true, false, true, false, false };
+    bool inside[5]{};
+    pol.pointsInside(xs, ys, 5, inside);
+    const PreparedPoligono<int> prepared{ pol };
+    bool allMatch{ true };
+    for(int i{}; i < 5; ++i)
+    {
+        const Punto<int> p{ xs[i], ys[i] };
+        allMatch = allMatch && pol.pointInside(p) == expected[i] && inside[i] == expected[i]
+                   && prepared.pointInside(p) == expected[i];
+    }
+    ASSERT_EQUALS(true, allMatch);
+    ASSERT_EQUALS(true, pol.isConvex());
+}
+
+void testOrient3d()
+{
+    const Punto3D<double> a{ 0, 0, 0 };
+    const Punto3D<double> b{ 1, 0, 0 };
+    const Punto3D<double> c{ 0, 1, 0 };
+    ASSERT_EQUALS(1.0, orient3d(a, b, c, Punto3D<double>{ 0, 0, 1 }));
+    ASSERT_EQUALS(-2.0, orient3d(a, b, c, Punto3D<double>{ 5, 5, -2 }));
+    ASSERT_EQUALS(0.0, orient3d(a, b, c, Punto3D<double>{ 7, -3, 0 }));
+    // swapping two points swaps the sign
+    ASSERT_EQUALS(-1.0, orient3d(b, a, c, Punto3D<double>{ 0, 0, 1 }));
+
+    // b, c and d lie on the plane z = x, and the orientation of a has the
+    // sign of a.z - a.x, which plain evaluation gets wrong for many of these
+    const Punto3D<double> pb{ 12, 0, 12 };
+    const Punto3D<double> pc{ 24, 5, 24 };
+    const Punto3D<double> pd{ 7, 19, 7 };
+    int wrong{};
+    for(int i{}; i < 32; ++i)
+    {
+        for(int j{}; j < 32; ++j)
+        {
+            const Punto3D<double> pa{ 0.5 + i * setup::ulpHalf, 0.3, 0.5 + j * setup::ulpHalf };
+            int expected{ (j > i) - (j < i) };
+            if (sign(orient3d(pb, pc, pd, pa)) != expected || sign(orient3d(pa, pb, pc, pd)) != -expected
+                || sign(orient3d(pc, pb, pd, pa)) != -expected)
+            {
+                ++wrong;
+            }
+        }
+    }
+    ASSERT_EQUALS(0, wrong);
+
+    // integer points against their exact triple product, many of them coplanar
+    std::mt19937 generator{ 1u };
+    std::uniform_int_distribution<int> coord{ -3, 3 };
+    bool allMatch{ true };
+    for(int t{}; t < 2000; ++t)
+    {
+        Punto3D<int> p[4];
+        for(Punto3D<int> &q: p)
+        {
+            q = Punto3D<int>{ coord(generator), coord(generator), coord(generator) };
+        }
+        const Vector3D<int> u{ p[1] - p[0] };
+        const Vector3D<int> v{ p[2] - p[0] };
+        const Vector3D<int> w{ p[3] - p[0] };
+        auto triple{ dotProduct(crossProduct(u, v), Vector3D<long long>{ w.getX(), w.getY(), w.getZ() }) };
+        allMatch = allMatch && sign(orient3d(p[0], p[1], p[2], p[3])) == signOf(triple);
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+int main() {
+    RUN(testOrient2dSimple);
+    RUN(testOrient2dNearlyCollinear);
+    RUN(testIncircle);
+    RUN(testSegmentoPolicy);
+    RUN(testPointInsidePolicy);
+    RUN(testIntegerWidening);
+    RUN(testOrient3d);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,202 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace setup
+{
+    const Poligono<double> polA {{   1,1.8}, {-0.3,2.3}, {  -2,2.2 }, {-2.6,1.2}, {-1.6,  1},
+                                 {-0.9,1.6}, {-0.2,1.3}, {-0.7,-0.3}, {-1.6,-0.2},{-1.6,0.4},
+                                 {-2.5,0.3}, {-1.5,-1.9},{0.02727272727,-1.3}, {1.3,-0.8}};
+
+    const Poligono<int> polB {{5,0}, {6,4}, {4,5}, {1,5}, {1,0}};
+
+    const Poligono<float> polC{{-3.4, 0.4}, {2, -0.5}, {-1.6, -0.5}};
+}
+
+void testPreparedInit()
+{
+    const PreparedPoligono<int> prepB{ setup::polB };
+    ASSERT_EQUALS(Punto<int>(1, 0), prepB.getMin());
+    ASSERT_EQUALS(Punto<int>(6, 5), prepB.getMax());
+    // the edges from (4,5) to (1,5) and from (1,0) to (5,0) are horizontal
+    ASSERT_EQUALS(3, prepB.getEdgeCount());
+
+    const PreparedPoligono<double> prepA{ setup::polA };
+    ASSERT_EQUALS(Punto<double>(-2.6, -1.9), prepA.getMin());
+    ASSERT_EQUALS(Punto<double>(1.3, 2.3), prepA.getMax());
+    ASSERT_EQUALS(14, prepA.getEdgeCount());
+}
+
+void testPreparedBoundingBox()
+{
+    const PreparedPoligono<int> prepB{ setup::polB };
+    ASSERT_EQUALS(true, prepB.inBoundingBox(Punto<int>{ 1, 0 }));
+    ASSERT_EQUALS(true, prepB.inBoundingBox(Punto<int>{ 6, 5 }));
+    ASSERT_EQUALS(false, prepB.inBoundingBox(Punto<int>{ 0, 3 }));
+    ASSERT_EQUALS(false, prepB.inBoundingBox(Punto<int>{ 3, 6 }));
+}
+
+void testPreparedPointInside()
+{
+    const PreparedPoligono<int> prepB{ setup::polB };
+    ASSERT_EQUALS(true, prepB.pointInside(Punto<int>{ 2, 1 }));
+    ASSERT_EQUALS(true, prepB.pointInside(Punto<int>{ 2, 0 }));
+    ASSERT_EQUALS(true, prepB.pointInside(Punto<int>{ 1, 0 }));
+    ASSERT_EQUALS(false, prepB.pointInside(Punto<int>{ 0, 1 }));
+    ASSERT_EQUALS(false, prepB.pointInside(Punto<int>{ 6, 1 }));
+
+    const PreparedPoligono<float> prepC{ setup::polC };
+    ASSERT_EQUALS(true, prepC.pointInside(Punto<float>{ -2.0f, 0.0f }));
+    ASSERT_EQUALS(true, prepC.pointInside(Punto<float>{ 0.0f, -0.5f }));
+    ASSERT_EQUALS(true, prepC.pointInside(Punto<float>{ -1.6f, -0.5f }));
+    ASSERT_EQUALS(false, prepC.pointInside(Punto<float>{ -1.6000001f, -0.5f }));
+    ASSERT_EQUALS(false, prepC.pointInside(Punto<float>{  1.99999999f, -0.5f }));
+}
+
+void testPreparedMatchesPoligono()
+{
+    std::mt19937 gen{ 7 };
+    std::uniform_real_distribution<double> coord{ -3.0, 3.0 };
+    const PreparedPoligono<double> prepA{ setup::polA };
+
+    std::vector<Punto<double>> puntos;
+    for(int i{}; i < 3000; ++i)
+    {
+        puntos.push_back(Punto<double>{ coord(gen), coord(gen) });
+    }
+    for(int i{}; i < setup::polA.getLength(); ++i)
+    {
+        puntos.push_back(setup::polA[i]);
+    }
+
+    std::unique_ptr<bool[]> inside{ new bool[puntos.size()] };
+    prepA.pointsInside(puntos.data(), static_cast<int>(puntos.size()), inside.get());
+
+    bool allMatch{ true };
+    for(std::size_t i{}; i < puntos.size(); ++i)
+    {
+        bool expected{ setup::polA.pointInside(puntos[i]) };
+        allMatch = allMatch && (prepA.pointInside(puntos[i]) == expected) && (inside[i] == expected);
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+void testPreparedConvex()
+{
+    // a regular polygon with enough edges to take the convex path in batches
+    Poligono<double> circle{};
+    const int sides{ 200 };
+    for(int i{}; i < sides; ++i)
+    {
+        double angle{ 2 * M_PI * i / sides };
+        circle.push_back(Punto<double>{ 3 * std::cos(angle), 3 * std::sin(angle) });
+    }
+    const PreparedPoligono<double> prepared{ circle };
+    ASSERT_EQUALS(true, prepared.isConvex());
+    ASSERT_EQUALS(false, PreparedPoligono<double>{ setup::polA }.isConvex());
+
+    std::mt19937 gen{ 8 };
+    std::uniform_real_distribution<double> coord{ -3.5, 3.5 };
+    std::vector<Punto<double>> puntos;
+    for(int i{}; i < 3000; ++i)
+    {
+        puntos.push_back(Punto<double>{ coord(gen), coord(gen) });
+    }
+    for(int i{}; i < sides; ++i)
+    {
+        puntos.push_back(circle[i]);
+    }
+
+    std::unique_ptr<bool[]> inside{ new bool[puntos.size()] };
+    prepared.pointsInside(puntos.data(), static_cast<int>(puntos.size()), inside.get());
+    bool allMatch{ true };
+    for(std::size_t i{}; i < puntos.size(); ++i)
+    {
+        bool expected{ circle.pointInside(puntos[i]) };
+        allMatch = allMatch && (prepared.pointInside(puntos[i]) == expected) && (inside[i] == expected);
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+void testPreparedConvexEdges()
+{
+    // points taken along the edges are the ones closest to being misjudged
+    std::mt19937 gen{ 9 };
+    std::uniform_real_distribution<double> unit{ 0.0, 1.0 };
+    bool allConvex{ true };
+    bool allMatch{ true };
+    for(int round{}; round < 40; ++round)
+    {
+        int sides{ 3 + round * 5 };
+        std::vector<double> angles;
+        for(int i{}; i < sides; ++i)
+        {
+            angles.push_back(2 * M_PI * unit(gen));
+        }
+        std::sort(angles.begin(), angles.end());
+        double centerX{ 10 * unit(gen) - 5 };
+        double centerY{ 10 * unit(gen) - 5 };
+        double radiusX{ 0.5 + 3 * unit(gen) };
+        double radiusY{ 0.5 + 3 * unit(gen) };
+        Poligono<double> pol{};
+        for(double angle: angles)
+        {
+            pol.push_back(Punto<double>{ centerX + radiusX * std::cos(angle),
+                                         centerY + radiusY * std::sin(angle) });
+        }
+        const PreparedPoligono<double> prepared{ pol };
+        allConvex = allConvex && prepared.isConvex();
+
+        std::vector<Punto<double>> puntos;
+        for(int i{}; i < sides; ++i)
+        {
+            const Punto<double> &a{ pol[i] };
+            const Punto<double> &b{ pol[(i + 1) % sides] };
+            puntos.push_back(a);
+            for(int j{}; j < 50; ++j)
+            {
+                double t{ unit(gen) };
+                puntos.push_back(Punto<double>{ a.getX() + t * (b.getX() - a.getX()),
+                                                a.getY() + t * (b.getY() - a.getY()) });
+            }
+        }
+
+        std::unique_ptr<bool[]> inside{ new bool[puntos.size()] };
+        prepared.pointsInside(puntos.data(), static_cast<int>(puntos.size()), inside.get());
+        for(std::size_t i{}; i < puntos.size(); ++i)
+        {
+            bool expected{ pol.pointInside(puntos[i]) };
+            allMatch = allMatch && (prepared.pointInside(puntos[i]) == expected) && (inside[i] == expected);
+        }
+    }
+    ASSERT_EQUALS(true, allConvex);
+    ASSERT_EQUALS(true, allMatch);
+}
+
+void testPreparedEmpty()
+{
+    const Poligono<double> empty{};
+    const PreparedPoligono<double> prepared{ empty };
+    ASSERT_EQUALS(0, prepared.getEdgeCount());
+    ASSERT_EQUALS(false, prepared.pointInside(Punto<double>{}));
+}
+
+int main() {
+    RUN(testPreparedInit);
+    RUN(testPreparedBoundingBox);
+    RUN(testPreparedPointInside);
+    RUN(testPreparedMatchesPoligono);
+    RUN(testPreparedConvex);
+    RUN(testPreparedConvexEdges);
+    RUN(testPreparedEmpty);
+
+    return TEST_REPORT();
+}
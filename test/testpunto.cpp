@@ -1,5 +1,6 @@
 #include <elem_geometricos.h>
 #include <tinytest.h>
+#include <type_traits>
 
 
 /*
@@ -92,11 +93,91 @@ void testPuntoScalarProduct()
     ASSERT_EQUALS(p2, res3);
 }
 
+void testPuntoEquality()
+{
+    // the y coordinate takes part in the comparison
+    ASSERT_EQUALS(false, (Punto<int>{ 1, 2 } == Punto<int>{ 1, 3 }));
+    ASSERT_EQUALS(false, (Punto<long>{ 0, 0 } == Punto<long>{ 0, -1 }));
+    ASSERT_EQUALS(true, (Punto<int>{ 4, -2 } == Punto<int>{ 4, -2 }));
+    ASSERT_EQUALS(false, (Punto<double>{ 1.0, 2.0 } == Punto<double>{ 1.0, 2.5 }));
+    ASSERT_EQUALS(false, (Punto<float>{ 1.0f, 2.0f } == Punto<float>{ 2.0f, 2.0f }));
+}
+
+/*
+ * The value layer can be evaluated at compile time and never throws.
+ */
+void testPuntoConstexpr()
+{
+    constexpr Punto<int> p1{ 3, -4 };
+    constexpr Punto<double> p2{ 0.5, 0.25 };
+    constexpr auto sum{ p1 + p2 };
+    static_assert(sum.getX() == 3.5 && sum.getY() == -3.75, "mixed type addition");
+    static_assert(std::is_same<decltype(evaluate(sum)), Punto<double>>::value, "addition promotes");
+    static_assert((p1 - p1) == Punto<int>{ }, "subtraction");
+    static_assert(-p1 == Punto<int>{ -3, 4 }, "unary minus");
+    static_assert(2*p1*3 == Punto<int>{ 18, -24 }, "scalar product");
+    static_assert(!(p1 == Punto<int>{ 3, 4 }), "equality compares y");
+    static_assert(p2*2 == Punto<double>{ 1, 0.5 }, "double equality");
+    static_assert(!(Punto<float>{ 1, 2 } == Punto<float>{ 1, 2.5f }), "float equality");
+
+    static_assert(std::is_trivially_copyable<Punto<double>>::value, "Punto copies are plain copies");
+    static_assert(noexcept(p1 + p2) && noexcept(p1 == p1) && noexcept(p1*2), "operators don't throw");
+    ASSERT_EQUALS(true, sum == Punto<double>(3.5, -3.75));
+}
+
+/*
+ * Chains of operators are evaluated by expression templates.
+ */
+void testPuntoExpressions()
+{
+    const Punto<int> a{ 7, 2 };
+    const Punto<int> b{ 3, -2 };
+    const Punto<double> c{ 0.5, 0.25 };
+
+    Punto<double> fused{ (a - b)*0.5 + c };
+    ASSERT_EQUALS(Punto<double>(2.5, 2.25), fused);
+    Punto<int> scaled{ 2*(a + b) - -b };
+    ASSERT_EQUALS(Punto<int>(23, -2), scaled);
+
+    // operands are held by value, so an expression outlives the temporaries
+    auto later{ Punto<int>{ 1, 1 } + Punto<int>{ 2, 3 } };
+    ASSERT_EQUALS(Punto<int>(3, 4), later);
+    static_assert(std::is_same<decltype(evaluate((a - b)*2)), Punto<int>>::value, "int stays int");
+    static_assert(std::is_same<decltype(evaluate(a*1.5f)), Punto<float>>::value, "int times float");
+    static_assert(std::is_trivially_copyable<decltype((a - b)*0.5 + c)>::value, "nodes are plain values");
+}
+
+/*
+ * Punto3D shares the value layer of Punto, with a third coordinate.
+ */
+void testPunto3D()
+{
+    constexpr Punto3D<int> p1{ 3, -4, 5 };
+    constexpr Punto3D<double> p2{ 0.5, 0.25, -1 };
+    constexpr auto sum{ p1 + p2 };
+    static_assert(sum.getX() == 3.5 && sum.getY() == -3.75 && sum.getZ() == 4, "mixed type addition");
+    static_assert(std::is_same<decltype(evaluate(sum)), Punto3D<double>>::value, "addition promotes");
+    static_assert(-p1 == Punto3D<int>{ -3, 4, -5 }, "unary minus");
+    static_assert(2*p1 - p1 == p1, "scalar product");
+    static_assert(!(p1 == Punto3D<int>{ 3, -4, 6 }), "equality compares z");
+    static_assert(std::is_trivially_copyable<Punto3D<double>>::value, "Punto3D copies are plain copies");
+
+    Punto3D<double> fused{ (p1 - p2)*2 + p2 };
+    ASSERT_EQUALS(Punto3D<double>(5.5, -8.25, 11), fused);
+    ASSERT_EQUALS(true, (Punto3D<double>{ 1, 2, 3 } == Punto3D<double>{ 1, 2, 3 + 1e-12 }));
+    ASSERT_EQUALS(false, (Punto3D<float>{ 1, 2, 3 } == Punto3D<float>{ 1, 2, 3.5f }));
+    ASSERT_EQUALS(Punto3D<int>(), Punto3D<int>(0, 0, 0));
+}
+
 int main() {
     RUN(testPuntoInit);
     RUN(testPuntoAdd);
     RUN(testPuntoSubstract);
     RUN(testPuntoScalarProduct);
+    RUN(testPuntoEquality);
+    RUN(testPuntoConstexpr);
+    RUN(testPuntoExpressions);
+    RUN(testPunto3D);
 
     return TEST_REPORT();
 }
\ No newline at end of file
@@ -0,0 +1,169 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+/*
+ * Returns the pairs of the result, sorted.
+ */
+std::vector<std::pair<int, int>> pairsOf(const std::vector<SegmentIntersection> &result)
+{
+    std::vector<std::pair<int, int>> pairs;
+    for(const SegmentIntersection &inter: result)
+    {
+        pairs.push_back(std::pair<int, int>{ inter.first, inter.second });
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+/*
+ * Returns the intersecting pairs testing every pair of segments.
+ */
+template <class T>
+std::vector<std::pair<int, int>> bruteForcePairs(const std::vector<Punto<T>> &endpoints)
+{
+    std::vector<Punto<double>> puntos;
+    for(const Punto<T> &p: endpoints)
+    {
+        puntos.push_back(Punto<double>{ static_cast<double>(p.getX()), static_cast<double>(p.getY()) });
+    }
+    std::vector<std::pair<int, int>> pairs;
+    int count{ static_cast<int>(endpoints.size()) / 2 };
+    for(int i{}; i < count; ++i)
+    {
+        for(int j{ i + 1 }; j < count; ++j)
+        {
+            if (segmentsIntersect(puntos[2*i], puntos[2*i+1], puntos[2*j], puntos[2*j+1]))
+            {
+                pairs.push_back(std::pair<int, int>{ i, j });
+            }
+        }
+    }
+    return pairs;
+}
+
+void testSimpleCrossing()
+{
+    const std::vector<Segmento<int>> segments{{ 0, 0, 4, 4 }, { 0, 4, 4, 0 }, { 5, 5, 6, 6 }};
+    std::vector<SegmentIntersection> result{ segmentIntersections(segments.data(), 3) };
+    ASSERT_EQUALS(1, static_cast<int>(result.size()));
+    ASSERT_EQUALS(0, result[0].first);
+    ASSERT_EQUALS(1, result[0].second);
+    ASSERT_EQUALS(Punto<double>(2, 2), result[0].point);
+}
+
+void testDegenerate()
+{
+    const std::vector<Punto<int>> endpoints{
+            // star of segments sharing the endpoint (2, 2)
+            { 2, 2 }, { 0, 0 },
+            { 2, 2 }, { 4, 1 },
+            { 5, 2 }, { 2, 2 },
+            { 2, 2 }, { 2, 6 },
+            // collinear overlaps along y = 8
+            { 0, 8 }, { 6, 8 },
+            { 4, 8 }, { 9, 8 },
+            { 6, 8 }, { 7, 8 },
+            // T junction on the middle of the first overlap
+            { 3, 8 }, { 3, 10 },
+            // vertical segments overlapping
+            { 12, 0 }, { 12, 5 },
+            { 12, 5 }, { 12, 3 },
+            // a single point on a segment
+            { 1, 1 }, { 1, 1 },
+            // far away
+            { 20, 20 }, { 21, 25 }};
+    std::vector<SegmentIntersection> result{ segmentIntersections(endpoints.data(), 12) };
+    ASSERT_EQUALS(true, pairsOf(result) == bruteForcePairs(endpoints));
+    ASSERT_EQUALS(12, static_cast<int>(result.size()));
+    for(const SegmentIntersection &inter: result)
+    {
+        if (inter.first == 4 && inter.second == 5)
+        {
+            ASSERT_EQUALS(Punto<double>(4, 8), inter.point);
+        }
+        if (inter.first == 0 && inter.second == 10)
+        {
+            ASSERT_EQUALS(Punto<double>(1, 1), inter.point);
+        }
+    }
+}
+
+void testRandomGrid()
+{
+    // a small grid makes shared endpoints, overlaps and vertical segments
+    // very common
+    std::mt19937 gen{ 10 };
+    std::uniform_int_distribution<int> coord{ 0, 12 };
+    std::vector<Punto<int>> endpoints;
+    for(int i{}; i < 600; ++i)
+    {
+        endpoints.push_back(Punto<int>{ coord(gen), coord(gen) });
+    }
+    std::vector<SegmentIntersection> result{ segmentIntersections(endpoints.data(), 300) };
+    ASSERT_EQUALS(true, pairsOf(result) == bruteForcePairs(endpoints));
+}
+
+void testRandomShort()
+{
+    // short segments, like a road network, with crossings in their interior
+    std::mt19937 gen{ 3 };
+    std::uniform_real_distribution<double> coord{ 0.0, 1000.0 };
+    std::uniform_real_distribution<double> delta{ -20.0, 20.0 };
+    std::vector<Punto<double>> endpoints;
+    for(int i{}; i < 5000; ++i)
+    {
+        Punto<double> start{ coord(gen), coord(gen) };
+        endpoints.push_back(start);
+        endpoints.push_back(Punto<double>{ start.getX() + delta(gen), start.getY() + delta(gen) });
+    }
+    std::vector<SegmentIntersection> result{ segmentIntersections(endpoints.data(), 5000) };
+    std::vector<std::pair<int, int>> expected{ bruteForcePairs(endpoints) };
+    ASSERT_EQUALS(true, expected.size() > 100);
+    ASSERT_EQUALS(true, pairsOf(result) == expected);
+}
+
+void testInexactGrid()
+{
+    // multiples of 0.1 aren't exact, so crossings get rounded onto the
+    // sweep line or behind it
+    const std::vector<Punto<double>> rounded{
+            { 0.1 * 3, 0.1 * 2 }, { 0.1, 0.1 * 4 },
+            { 0, 0.1 }, { 0.1 * 3, 0 },
+            { 0.1 * 3, 0 }, { 0.1 * 2, 0.1 * 3 }};
+    std::vector<SegmentIntersection> result{ segmentIntersections(rounded.data(), 3) };
+    ASSERT_EQUALS(true, pairsOf(result) == bruteForcePairs(rounded));
+
+    std::mt19937 gen{ 7 };
+    std::uniform_int_distribution<int> coord{ 0, 5 };
+    std::uniform_int_distribution<int> segments{ 2, 8 };
+    bool allMatch{ true };
+    for(int i{}; i < 3000; ++i)
+    {
+        std::vector<Punto<double>> endpoints;
+        int count{ segments(gen) };
+        for(int j{}; j < 2 * count; ++j)
+        {
+            endpoints.push_back(Punto<double>{ 0.1 * coord(gen), 0.1 * coord(gen) });
+        }
+        allMatch = allMatch && pairsOf(segmentIntersections(endpoints.data(), count)) == bruteForcePairs(endpoints);
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+int main() {
+    RUN(testSimpleCrossing);
+    RUN(testDegenerate);
+    RUN(testRandomGrid);
+    RUN(testRandomShort);
+    RUN(testInexactGrid);
+
+    return TEST_REPORT();
+}
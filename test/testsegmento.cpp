@@ -4,6 +4,9 @@
 
 #include <elem_geometricos.h>
 #include <tinytest.h>
+#include <random>
+#include <type_traits>
+#include <vector>
 
 namespace setup
 {
@@ -133,6 +136,114 @@ void testPrecision()
 
 }
 
+void testLineDeterminants()
+{
+    // several whole vectors plus a tail
+    const PointBuffer<int> puntos{{ 2, 0 }, { 3, 1 }, { 3, -1 }, { 0, 5 }, { 9, 0 }, { 4, 4 }, { -3, -8 }};
+    std::vector<OrientationType<int>> dets(7);
+    setup::s2.lineDeterminants(puntos, dets.data());
+    for(int i{}; i < puntos.getLength(); ++i)
+    {
+        ASSERT_EQUALS(setup::s2.lineDeterminant(puntos[i]), dets[i]);
+    }
+
+    // far enough from the origin for the determinants to overflow int
+    const Segmento<int> far{ -2000000000, -1000000000, 2000000000, 1500000000 };
+    const PointBuffer<int> farPuntos{{ 50000, 50000 }, { -2147483647, 2147483647 }, { 2000000000, 1500000000 }};
+    std::vector<OrientationType<int>> farDets(3);
+    far.lineDeterminants(farPuntos, farDets.data());
+    for(int i{}; i < farPuntos.getLength(); ++i)
+    {
+        ASSERT_EQUALS(true, far.lineDeterminant(farPuntos[i]) == farDets[i]);
+    }
+    ASSERT_EQUALS(true, farDets[2] == 0);
+
+    std::mt19937 gen{ 11 };
+    std::uniform_real_distribution<double> coord{ -10.0, 10.0 };
+    PointBuffer<double> randoms;
+    for(int i{}; i < 101; ++i)
+    {
+        randoms.push_back(Punto<double>{ coord(gen), coord(gen) });
+    }
+    std::vector<double> doubleDets(101);
+    setup::s1.lineDeterminants(randoms, doubleDets.data());
+    for(int i{}; i < randoms.getLength(); ++i)
+    {
+        ASSERT_EQUALS(true, withinEps(setup::s1.lineDeterminant(randoms[i]), doubleDets[i], 1e-10, 1e-10));
+    }
+}
+
+void testClassifyPoints()
+{
+    const PointBuffer<int> puntos{{ 2, 0 }, { 3, 1 }, { 3, -1 }, { 0, 5 }, { 9, 0 }, { 4, -4 }, { -3, 0 }};
+    std::vector<LineSide> sides(7);
+    setup::s2.classifyPoints(puntos, sides.data());
+    const LineSide expected[7]{ LineSide::ON, LineSide::LEFT, LineSide::RIGHT, LineSide::LEFT,
+                                LineSide::ON, LineSide::RIGHT, LineSide::ON };
+    for(int i{}; i < 7; ++i)
+    {
+        ASSERT_EQUALS(true, expected[i] == sides[i]);
+    }
+
+    // points scattered around the line of s1, some of them within the
+    // tolerance of isPointInLine
+    std::mt19937 gen{ 5 };
+    std::uniform_real_distribution<double> along{ -3.0, 3.0 };
+    std::uniform_real_distribution<double> off{ -1e-9, 1e-9 };
+    PointBuffer<double> randoms;
+    for(int i{}; i < 203; ++i)
+    {
+        double t{ along(gen) };
+        double x{ -0.3 + t * -1.7 };
+        double y{ 2.3 + t * -0.1 + ((i % 3 == 0) ? 0.0 : off(gen)) };
+        randoms.push_back(Punto<double>{ x, y });
+    }
+    std::vector<LineSide> doubleSides(203);
+    setup::s1.classifyPoints(randoms, doubleSides.data());
+    std::vector<double> dets(203);
+    setup::s1.lineDeterminants(randoms, dets.data());
+    int onLine{};
+    for(int i{}; i < randoms.getLength(); ++i)
+    {
+        LineSide side{ doubleSides[i] };
+        bool inLine{ withinEps(dets[i], 0.0, 1e-10, 1e-10) };
+        ASSERT_EQUALS(inLine, side == LineSide::ON);
+        ASSERT_EQUALS(!inLine && dets[i] > 0, side == LineSide::LEFT);
+        ASSERT_EQUALS(!inLine && dets[i] < 0, side == LineSide::RIGHT);
+        onLine += inLine;
+    }
+    ASSERT_EQUALS(true, onLine > 0 && onLine < 203);
+
+    const Punto<float> p1{ -1.6f, -0.5f };
+    const PointBuffer<float> floats{ p1, setup::v2.getEnd(), Punto<float>{ 0.0f, 3.0f } };
+    std::vector<LineSide> floatSides(3);
+    setup::s4.classifyPoints(floats, floatSides.data());
+    ASSERT_EQUALS(true, floatSides[0] == LineSide::RIGHT);
+    ASSERT_EQUALS(true, floatSides[1] == LineSide::ON);
+    ASSERT_EQUALS(true, floatSides[2] == LineSide::LEFT);
+}
+
+/*
+ * The value layer can be evaluated at compile time and never throws.
+ */
+void testSegmentoConstexpr()
+{
+    constexpr Segmento<int> s{ 1, 0, 5, 0 };
+    constexpr Segmento<double> d{ Punto<double>{ 0, 0 }, Punto<double>{ 2, 2 } };
+    static_assert(s.doubleAreaSegment() == 0, "area with the origin");
+    static_assert(s.lineDeterminant(Punto<int>{ 3, 2 }) == 8, "line determinant");
+    static_assert(s.isPointInLine(Punto<int>{ 9, 0 }), "point in line");
+    static_assert(d.isPointInLine(Punto<double>{ 1, 1 }), "point in line with tolerance");
+    static_assert(!d.isPointInLine(Punto<double>{ 1, 1.5 }), "point off the line");
+    static_assert(s.swapSegmento().getStart() == Vector<int>{ 5, 0 }, "swap");
+    static_assert(s.diffX() == -4 && s.diffY() == 0, "diffs");
+    static_assert(Segmento<int>{ 0, -1, 0, 1 }.straddleHorizontally(), "straddle");
+
+    static_assert(std::is_trivially_copyable<Segmento<float>>::value, "Segmento copies are plain copies");
+    static_assert(noexcept(s.lineDeterminant(Punto<int>{ })), "lineDeterminant doesn't throw");
+    ASSERT_EQUALS(8, s.lineDeterminant(Punto<int>{ 3, 2 }));
+}
+
 int main() {
     RUN(testSegmentoInit);
     RUN(testLength);
@@ -141,6 +252,9 @@ int main() {
     RUN(testDiffs);
     RUN(testIntersect);
     RUN(testPrecision);
+    RUN(testLineDeterminants);
+    RUN(testClassifyPoints);
+    RUN(testSegmentoConstexpr);
 
     return TEST_REPORT();
 }
\ No newline at end of file
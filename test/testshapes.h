@@ -0,0 +1,36 @@
+//
+// Random shapes shared by the tests.
+//
+
+#ifndef ELEM_GEOMETRICOS_TESTSHAPES_H
+#define ELEM_GEOMETRICOS_TESTSHAPES_H
+
+#include <elem_geometricos.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace setup
+{
+    /*
+     * Star shaped polygon of n vertices with random radii between scale and
+     * 10*scale, clockwise when cw. Coordinates are rounded towards zero for
+     * integer types.
+     */
+    template <class T = double>
+    std::vector<Punto<T>> randomStar(int n, unsigned seed, bool cw = false, double scale = 1.0)
+    {
+        std::mt19937 generator{ seed };
+        std::uniform_real_distribution<double> radius{ scale, 10 * scale };
+        std::vector<Punto<T>> vertices;
+        for(int i{}; i < n; ++i)
+        {
+            double angle{ (cw ? -2 : 2) * M_PI * i / n };
+            double r{ radius(generator) };
+            vertices.push_back(Punto<T>{ static_cast<T>(r * std::cos(angle)), static_cast<T>(r * std::sin(angle)) });
+        }
+        return vertices;
+    }
+}
+
+#endif //ELEM_GEOMETRICOS_TESTSHAPES_H
@@ -0,0 +1,236 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include "testshapes.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace setup
+{
+    // a square with extra vertices along its sides, one of them off by 1
+    const Poligono<int> square{{0,0}, {5,0}, {10,0}, {10,5}, {11,10}, {5,10}, {0,10}};
+
+    /*
+     * Visvalingam by brute force: removes the vertex with the smallest
+     * triangle, the first one on ties, while it's not above tolerance and
+     * more than three are left. Returns the indices of the vertices left.
+     */
+    template <class T>
+    std::vector<int> bruteVisvalingam(const std::vector<Punto<T>> &vertices, double tolerance)
+    {
+        std::vector<int> left(vertices.size());
+        for(std::size_t i{}; i < left.size(); ++i)
+        {
+            left[i] = static_cast<int>(i);
+        }
+        while (left.size() > 3)
+        {
+            int n{ static_cast<int>(left.size()) };
+            int smallest{ -1 };
+            double smallestArea{ };
+            for(int i{}; i < n; ++i)
+            {
+                double area{ std::fabs(static_cast<double>(Poligono<T>::signedAngle(
+                        vertices[left[(i + n - 1) % n]], vertices[left[i]], vertices[left[(i + 1) % n]]))) / 2 };
+                if (smallest < 0 || area < smallestArea || (area == smallestArea && left[i] < left[smallest]))
+                {
+                    smallest = i;
+                    smallestArea = area;
+                }
+            }
+            if (smallestArea > tolerance)
+            {
+                break;
+            }
+            left.erase(left.begin() + smallest);
+        }
+        return left;
+    }
+
+    /*
+     * Whether kept goes around the polygon in order once, and every vertex
+     * dropped between two kept ones is within tolerance of the line through
+     * them.
+     */
+    template <class T>
+    bool withinTolerance(const std::vector<Punto<T>> &vertices, const std::vector<int> &kept, double tolerance)
+    {
+        int n{ static_cast<int>(vertices.size()) };
+        int k{ static_cast<int>(kept.size()) };
+        int turns{ };
+        for(int i{}; i < k; ++i)
+        {
+            turns += kept[(i + 1) % k] <= kept[i];
+        }
+        if (turns != 1)
+        {
+            return false;
+        }
+        for(int i{}; i < k; ++i)
+        {
+            const Segmento<double> chord{ static_cast<double>(vertices[kept[i]].getX()),
+                                          static_cast<double>(vertices[kept[i]].getY()),
+                                          static_cast<double>(vertices[kept[(i + 1) % k]].getX()),
+                                          static_cast<double>(vertices[kept[(i + 1) % k]].getY()) };
+            for(int j{ (kept[i] + 1) % n }; j != kept[(i + 1) % k]; j = (j + 1) % n)
+            {
+                const Punto<double> p{ static_cast<double>(vertices[j].getX()), static_cast<double>(vertices[j].getY()) };
+                if (std::fabs(chord.lineDeterminant(p)) / chord.length() > tolerance * (1 + 1e-12))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+void testDouglasPeucker()
+{
+    // the vertices along the sides go first, then the one off by 1, which is
+    // 5/sqrt(101) away from the side
+    const Poligono<int> noMidpoints{ simplify(setup::square, SimplificationMethod::DOUGLAS_PEUCKER, 0.4) };
+    ASSERT_EQUALS(5, noMidpoints.getLength());
+    const Poligono<int> corners{ simplify(setup::square, SimplificationMethod::DOUGLAS_PEUCKER, 2.0) };
+    ASSERT_EQUALS(4, corners.getLength());
+    ASSERT_EQUALS(true, corners.pointInside(Punto<int>{ 5, 5 }));
+    const Poligono<int> all{ simplify(setup::square, SimplificationMethod::DOUGLAS_PEUCKER, -1.0) };
+    ASSERT_EQUALS(7, all.getLength());
+
+    // at least three vertices are left, whatever the tolerance
+    ASSERT_EQUALS(3, simplify(setup::square, SimplificationMethod::DOUGLAS_PEUCKER, 1e9).getLength());
+
+    bool allWithin{ true };
+    for(unsigned seed{}; seed < 10; ++seed)
+    {
+        std::vector<Punto<double>> star{ setup::randomStar<double>(500, seed, seed % 2 == 1, 100) };
+        PolygonSet<double> set;
+        set.push_back(star.data(), 500);
+        VertexRanking ranking{ rankVertices(set, SimplificationMethod::DOUGLAS_PEUCKER) };
+        for(double tolerance: { 0.0, 10.0, 100.0, 400.0 })
+        {
+            allWithin = allWithin && setup::withinTolerance(star, ranking.kept(0, tolerance), tolerance);
+        }
+    }
+    ASSERT_EQUALS(true, allWithin);
+}
+
+void testVisvalingam()
+{
+    const Poligono<int> corners{ simplify(setup::square, SimplificationMethod::VISVALINGAM, 10.0) };
+    ASSERT_EQUALS(4, corners.getLength());
+    ASSERT_EQUALS(7, simplify(setup::square, SimplificationMethod::VISVALINGAM, -1.0).getLength());
+    ASSERT_EQUALS(3, simplify(setup::square, SimplificationMethod::VISVALINGAM, 1e9).getLength());
+
+    // the heap gives the same vertices as removing them one by one
+    bool allMatch{ true };
+    for(unsigned seed{}; seed < 10; ++seed)
+    {
+        std::vector<Punto<int>> star{ setup::randomStar<int>(200, seed, seed % 2 == 1, 100) };
+        PolygonSet<int> set;
+        set.push_back(star.data(), 200);
+        VertexRanking ranking{ rankVertices(set, SimplificationMethod::VISVALINGAM) };
+        for(double tolerance: { 0.0, 500.0, 5000.0, 50000.0 })
+        {
+            // the polygon may start at another vertex
+            std::vector<int> kept{ ranking.kept(0, tolerance) };
+            std::sort(kept.begin(), kept.end());
+            allMatch = allMatch && kept == setup::bruteVisvalingam(star, tolerance);
+        }
+    }
+    ASSERT_EQUALS(true, allMatch);
+}
+
+void testRanking()
+{
+    std::vector<Punto<float>> star{ setup::randomStar<float>(1000, 3u, false, 100) };
+    PolygonSet<float> set;
+    set.push_back(star.data(), 1000);
+    for(SimplificationMethod method: { SimplificationMethod::DOUGLAS_PEUCKER, SimplificationMethod::VISVALINGAM })
+    {
+        VertexRanking ranking{ rankVertices(set, method) };
+        ASSERT_EQUALS(1, ranking.getLength());
+
+        // a tolerance keeps the vertices above it, and the vertices kept at
+        // one tolerance are kept at every smaller one
+        bool nested{ true };
+        std::vector<int> previous{ ranking.kept(0, -1.0) };
+        std::sort(previous.begin(), previous.end());
+        ASSERT_EQUALS(1000, static_cast<int>(previous.size()));
+        for(double tolerance: { 1.0, 10.0, 100.0, 1000.0, 10000.0 })
+        {
+            std::vector<int> kept{ ranking.kept(0, tolerance) };
+            std::sort(kept.begin(), kept.end());
+            int above{ };
+            for(int i{}; i < 1000; ++i)
+            {
+                above += ranking.getImportance()[i] > tolerance;
+            }
+            nested = nested && above == static_cast<int>(kept.size())
+                     && std::includes(previous.begin(), previous.end(), kept.begin(), kept.end());
+            previous = kept;
+        }
+        ASSERT_EQUALS(true, nested);
+    }
+
+    // polygons of up to three vertices are kept whole
+    PolygonSet<int> small;
+    small.push_back(Poligono<int>{});
+    small.push_back(Poligono<int>{{0,0}, {1,0}, {0,1}});
+    VertexRanking smallRanking{ rankVertices(small, SimplificationMethod::VISVALINGAM) };
+    ASSERT_EQUALS(0, static_cast<int>(smallRanking.kept(0, 1e9).size()));
+    ASSERT_EQUALS(3, static_cast<int>(smallRanking.kept(1, 1e9).size()));
+}
+
+void testBatchRanking()
+{
+    PolygonSet<double> set;
+    set.push_back(Poligono<double>{});
+    for(unsigned seed{}; seed < 200; ++seed)
+    {
+        std::vector<Punto<double>> star{ setup::randomStar<double>(3 + 37 * seed % 400, seed, seed % 3 == 0, 100) };
+        set.push_back(star.data(), static_cast<int>(star.size()));
+    }
+
+    for(SimplificationMethod method: { SimplificationMethod::DOUGLAS_PEUCKER, SimplificationMethod::VISVALINGAM })
+    {
+        double tolerance{ (method == SimplificationMethod::DOUGLAS_PEUCKER) ? 50.0 : 5000.0 };
+        VertexRanking single{ rankVertices(set, method, 1) };
+        VertexRanking threaded{ rankVertices(set, method, 4) };
+        ASSERT_EQUALS(set.getLength(), threaded.getLength());
+        bool sameImportance{ true };
+        for(int i{}; i < set.getVertexCount(); ++i)
+        {
+            sameImportance = sameImportance && single.getImportance()[i] == threaded.getImportance()[i];
+        }
+        ASSERT_EQUALS(true, sameImportance);
+
+        PolygonSet<double> simplified;
+        threaded.extract(set, tolerance, simplified);
+        ASSERT_EQUALS(set.getLength(), simplified.getLength());
+        bool allMatch{ simplified.getVertexCount() < set.getVertexCount() };
+        for(int i{}; allMatch && i < set.getLength(); ++i)
+        {
+            const Poligono<double> expected{ simplify(set[i], method, tolerance) };
+            allMatch = expected.getLength() == simplified.polygonLength(i);
+            for(int v{}; allMatch && v < expected.getLength(); ++v)
+            {
+                allMatch = expected[v] == simplified[i][v];
+            }
+        }
+        ASSERT_EQUALS(true, allMatch);
+    }
+}
+
+int main() {
+    RUN(testDouglasPeucker);
+    RUN(testVisvalingam);
+    RUN(testRanking);
+    RUN(testBatchRanking);
+
+    return TEST_REPORT();
+}
@@ -0,0 +1,252 @@
+//
+// Created by malva on 17-10-26.
+//
+
+#include <elem_geometricos.h>
+#include <tinytest.h>
+#include "testshapes.h"
+#include <vector>
+
+namespace setup
+{
+    const Poligono<double> polA {{   1,1.8}, {-0.3,2.3}, {  -2,2.2 }, {-2.6,1.2}, {-1.6,  1},
+                                 {-0.9,1.6}, {-0.2,1.3}, {-0.7,-0.3}, {-1.6,-0.2},{-1.6,0.4},
+                                 {-2.5,0.3}, {-1.5,-1.9},{0.02727272727,-1.3}, {1.3,-0.8}};
+
+    const Poligono<int> polB {{5,0}, {6,4}, {4,5}, {1,5}, {1,0}};
+
+    const Poligono<float> polC{{-3.4, 0.4}, {2, -0.5}, {-1.6, -0.5}};
+
+    /*
+     * Counter clockwise polygon with teeth notched up from its bottom and
+     * down from its top, giving split and merge vertices.
+     */
+    std::vector<Punto<double>> comb(int teeth)
+    {
+        std::vector<Punto<double>> vertices;
+        for(int i{}; i < teeth; ++i)
+        {
+            vertices.push_back(Punto<double>{ 2.0 * i, 0.0 });
+            vertices.push_back(Punto<double>{ 2.0 * i + 1, 2.0 });
+        }
+        vertices.push_back(Punto<double>{ 2.0 * teeth, 0.0 });
+        for(int i{ teeth }; i > 0; --i)
+        {
+            vertices.push_back(Punto<double>{ 2.0 * i, 10.0 });
+            vertices.push_back(Punto<double>{ 2.0 * i - 1, 8.0 });
+        }
+        vertices.push_back(Punto<double>{ 0.0, 10.0 });
+        return vertices;
+    }
+
+    /*
+     * Checks that the triangles cover the polygon of the given vertices: there
+     * are length-2 of them, all counter clockwise, inside the polygon and
+     * adding up to its area.
+     */
+    template <class T>
+    bool coversPolygon(const Punto<T>* vertices, int length, const std::vector<Triangle> &triangles)
+    {
+        if (static_cast<int>(triangles.size()) != length - 2)
+        {
+            return false;
+        }
+        std::vector<Punto<double>> exact;
+        for(int i{}; i < length; ++i)
+        {
+            exact.push_back(Punto<double>{ static_cast<double>(vertices[i].getX()),
+                                           static_cast<double>(vertices[i].getY()) });
+        }
+        Poligono<double> polDouble{ exact.begin(), exact.end() };
+        double area{ };
+        for(const Triangle &t: triangles)
+        {
+            if (t.a < 0 || t.b < 0 || t.c < 0 || t.a >= length || t.b >= length || t.c >= length)
+            {
+                return false;
+            }
+            double doubleArea{ Poligono<double>::signedAngle(exact[t.a], exact[t.b], exact[t.c]) };
+            if (doubleArea < 0)
+            {
+                return false;
+            }
+            area += doubleArea / 2;
+            Punto<double> centroid{ (exact[t.a].getX() + exact[t.b].getX() + exact[t.c].getX()) / 3,
+                                    (exact[t.a].getY() + exact[t.b].getY() + exact[t.c].getY()) / 3 };
+            if (doubleArea > 1e-9 && !polDouble.pointInside(centroid))
+            {
+                return false;
+            }
+        }
+        return withinEps(polDouble.area(), area, 1e-9, 1e-9);
+    }
+
+    template <class T>
+    bool coversPolygon(const Poligono<T> &pol, const std::vector<Triangle> &triangles)
+    {
+        return coversPolygon(&pol[0], pol.getLength(), triangles);
+    }
+}
+
+void testSignedAngleOfPoints()
+{
+    for(int i{}; i < setup::polA.getLength(); ++i)
+    {
+        const Punto<double> &prev{ setup::polA[(i + 13) % 14] };
+        const Punto<double> &next{ setup::polA[(i + 1) % 14] };
+        ASSERT_EQUALS(setup::polA.signedAngle(i), Poligono<double>::signedAngle(prev, setup::polA[i], next));
+    }
+    // positive for a left turn
+    ASSERT_EQUALS(1, Poligono<int>::signedAngle(Punto<int>{ 0, 0 }, Punto<int>{ 1, 0 }, Punto<int>{ 1, 1 }));
+}
+
+void testEarClipping()
+{
+    Triangulator<double> triangulatorDouble;
+    std::vector<Triangle> trianglesA(12);
+    triangulatorDouble.earClipping(&setup::polA[0], 14, trianglesA.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(setup::polA, trianglesA));
+
+    Triangulator<int> triangulatorInt;
+    std::vector<Triangle> trianglesB(3);
+    triangulatorInt.earClipping(&setup::polB[0], 5, trianglesB.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(setup::polB, trianglesB));
+
+    // clockwise polygons give counter clockwise triangles too
+    Triangulator<float> triangulatorFloat;
+    std::vector<Triangle> trianglesC(1);
+    triangulatorFloat.earClipping(&setup::polC[0], 3, trianglesC.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(setup::polC, trianglesC));
+
+    // collinear vertices are still used by the triangles
+    const Poligono<int> square{{0,0}, {1,0}, {2,0}, {2,2}, {0,2}};
+    std::vector<Triangle> trianglesSquare(3);
+    triangulatorInt.earClipping(&square[0], 5, trianglesSquare.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(square, trianglesSquare));
+
+    std::vector<Punto<double>> comb{ setup::comb(20) };
+    std::vector<Triangle> trianglesComb(comb.size() - 2);
+    triangulatorDouble.earClipping(comb.data(), static_cast<int>(comb.size()), trianglesComb.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(comb.data(), static_cast<int>(comb.size()), trianglesComb));
+
+    std::vector<Punto<double>> star{ setup::randomStar(500, 7u, true) };
+    std::vector<Triangle> trianglesStar(498);
+    triangulatorDouble.earClipping(star.data(), 500, trianglesStar.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(star.data(), 500, trianglesStar));
+}
+
+void testMonotone()
+{
+    Triangulator<double> triangulatorDouble;
+    std::vector<Triangle> trianglesA(12);
+    triangulatorDouble.monotone(&setup::polA[0], 14, trianglesA.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(setup::polA, trianglesA));
+
+    Triangulator<int> triangulatorInt;
+    std::vector<Triangle> trianglesB(3);
+    triangulatorInt.monotone(&setup::polB[0], 5, trianglesB.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(setup::polB, trianglesB));
+
+    Triangulator<float> triangulatorFloat;
+    std::vector<Triangle> trianglesC(1);
+    triangulatorFloat.monotone(&setup::polC[0], 3, trianglesC.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(setup::polC, trianglesC));
+
+    // horizontal edges and collinear vertices
+    const Poligono<int> square{{0,0}, {1,0}, {2,0}, {2,2}, {0,2}};
+    std::vector<Triangle> trianglesSquare(3);
+    triangulatorInt.monotone(&square[0], 5, trianglesSquare.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(square, trianglesSquare));
+
+    std::vector<Punto<double>> comb{ setup::comb(50) };
+    std::vector<Triangle> trianglesComb(comb.size() - 2);
+    triangulatorDouble.monotone(comb.data(), static_cast<int>(comb.size()), trianglesComb.data());
+    ASSERT_EQUALS(true, setup::coversPolygon(comb.data(), static_cast<int>(comb.size()), trianglesComb));
+
+    bool allCovered{ true };
+    for(unsigned seed{}; seed < 10; ++seed)
+    {
+        std::vector<Punto<double>> star{ setup::randomStar(1000, seed, seed % 2 == 1) };
+        std::vector<Triangle> triangles(998);
+        triangulatorDouble.monotone(star.data(), 1000, triangles.data());
+        allCovered = allCovered && setup::coversPolygon(star.data(), 1000, triangles);
+    }
+    ASSERT_EQUALS(true, allCovered);
+
+    // a self intersecting polygon gives the sweep more pieces than there is
+    // room for; nothing is written past the four triangles
+    const Poligono<int> crossed{{-392,65}, {-277,121}, {-504,426}, {615,787}, {199,158}, {442,262}};
+    std::vector<Triangle> trianglesCrossed(5, Triangle{ -1, -1, -1 });
+    triangulatorInt.monotone(&crossed[0], 6, trianglesCrossed.data());
+    ASSERT_EQUALS(-1, trianglesCrossed[4].a);
+    bool inRange{ true };
+    for(int t{}; t < 4; ++t)
+    {
+        for(int vertex: { trianglesCrossed[t].a, trianglesCrossed[t].b, trianglesCrossed[t].c })
+        {
+            inRange = inRange && vertex >= 0 && vertex < 6;
+        }
+    }
+    ASSERT_EQUALS(true, inRange);
+}
+
+void testTriangulate()
+{
+    ASSERT_EQUALS(true, setup::coversPolygon(setup::polA, triangulate(setup::polA)));
+    ASSERT_EQUALS(true, setup::coversPolygon(setup::polB, triangulate(setup::polB)));
+
+    std::vector<Punto<double>> star{ setup::randomStar(1000, 3u) };
+    Poligono<double> pol{ star.begin(), star.end() };
+    ASSERT_EQUALS(true, setup::coversPolygon(pol, triangulate(pol)));
+
+    // degenerate polygons have no triangles
+    ASSERT_EQUALS(0, static_cast<int>(triangulate(Poligono<int>{}).size()));
+    ASSERT_EQUALS(0, static_cast<int>(triangulate(Poligono<int>{{0,0}, {1,1}}).size()));
+}
+
+void testBatchTriangulate()
+{
+    PolygonSet<double> set;
+    set.push_back(setup::polA);
+    set.push_back(Poligono<double>{});
+    for(unsigned seed{}; seed < 200; ++seed)
+    {
+        std::vector<Punto<double>> star{ setup::randomStar(10 + 37 * seed % 400, seed, seed % 3 == 0) };
+        set.push_back(star.data(), static_cast<int>(star.size()));
+    }
+
+    std::vector<int> offsets{ triangleOffsets(set) };
+    ASSERT_EQUALS(set.getLength() + 1, static_cast<int>(offsets.size()));
+    ASSERT_EQUALS(0, offsets[1] - offsets[0] - 12);
+    ASSERT_EQUALS(offsets[1], offsets[2]);
+
+    for(int threads: { 1, 4 })
+    {
+        std::vector<Triangle> triangles(static_cast<std::size_t>(offsets.back()));
+        batchTriangulate(set, triangles.data(), threads);
+        bool allMatch{ true };
+        for(int i{}; i < set.getLength(); ++i)
+        {
+            const Poligono<double> pol{ set[i] };
+            std::vector<Triangle> expected{ triangulate(pol) };
+            std::vector<Triangle> got(triangles.begin() + offsets[i], triangles.begin() + offsets[i + 1]);
+            allMatch = allMatch && (expected.size() == got.size());
+            for(std::size_t t{}; allMatch && t < got.size(); ++t)
+            {
+                allMatch = expected[t].a == got[t].a && expected[t].b == got[t].b && expected[t].c == got[t].c;
+            }
+            allMatch = allMatch && (pol.getLength() < 3 || setup::coversPolygon(pol, got));
+        }
+        ASSERT_EQUALS(true, allMatch);
+    }
+}
+
+int main() {
+    RUN(testSignedAngleOfPoints);
+    RUN(testEarClipping);
+    RUN(testMonotone);
+    RUN(testTriangulate);
+    RUN(testBatchTriangulate);
+
+    return TEST_REPORT();
+}
@@ -3,6 +3,7 @@
 //
 #include <elem_geometricos.h>
 #include <tinytest.h>
+#include <type_traits>
 
 void testVectorInit()
 {
@@ -123,6 +124,58 @@ void testVectorCrossProdValue()
     ASSERT_EQUALS(true, withinEps(expected3, crossProdValue(v3a, v3b), 1e-10, 1e-10));
 }
 
+/*
+ * The value layer can be evaluated at compile time and never throws.
+ */
+void testVectorConstexpr()
+{
+    constexpr Vector<int> v1{ -6, 8 };
+    constexpr Vector<int> v2{ 5, 12 };
+    constexpr Vector<double> v3{ 0.5, 0.25 };
+    static_assert(dotProduct(v1, v2) == 66, "dot product");
+    static_assert(crossProdValue(v1, v2) == -112, "cross product");
+    static_assert(v1 + v2 == Vector<int>{ -1, 20 }, "addition");
+    static_assert(v1 - v2 == Vector<int>{ -11, -4 }, "subtraction");
+    static_assert((v2 - v3).getX() == 4.5 && (v2 - v3).getY() == 11.75, "mixed type subtraction");
+    static_assert(std::is_same<decltype(evaluate(v2 - v3)), Vector<double>>::value, "subtraction promotes");
+    static_assert(0.5*v1 == Vector<double>{ -3, 4 }, "scalar product");
+    static_assert(!(v1 == Vector<int>{ -6, -8 }), "equality");
+
+    static_assert(std::is_trivially_copyable<Vector<double>>::value, "Vector copies are plain copies");
+    static_assert(noexcept(v1 - v3) && noexcept(dotProduct(v1, v3)) && noexcept(crossProdValue(v1, v3)),
+                  "operators don't throw");
+    ASSERT_EQUALS(-112, crossProdValue(v1, v2));
+}
+
+void testVector3D()
+{
+    constexpr Vector3D<int> v1{ 1, 2, 3 };
+    constexpr Vector3D<int> v2{ 4, -5, 6 };
+    static_assert(dotProduct(v1, v2) == 12, "dot product");
+    static_assert(crossProduct(v1, v2) == Vector3D<long long>{ 27, 6, -13 }, "cross product");
+    static_assert(dotProduct(crossProduct(v1, v2), v1) == 0, "the cross product is perpendicular");
+    static_assert(v1 - v2 == Vector3D<int>{ -3, 7, -3 }, "subtraction");
+    static_assert(std::is_same<decltype(evaluate(v1*0.5)), Vector3D<double>>::value, "scalar product promotes");
+    static_assert(noexcept(dotProduct(v1, v2)) && noexcept(crossProduct(v1, v2)), "operators don't throw");
+
+    // products of int coordinates don't overflow
+    const Vector3D<int> big{ 2000000000, -2000000000, 2000000000 };
+    ASSERT_EQUALS(12000000000000000000.0, static_cast<double>(dotProduct(big, big)));
+    ASSERT_EQUALS(true, crossProduct(big, big) == Vector3D<long long>{});
+
+    const Vector3D<double> unitX{ 1, 0, 0 };
+    const Vector3D<double> unitY{ 0, 1, 0 };
+    ASSERT_EQUALS(Vector3D<double>(0, 0, 1), crossProduct(unitX, unitY));
+    ASSERT_EQUALS(Vector3D<double>(0, 0, -1), crossProduct(unitY, unitX));
+    ASSERT_EQUALS(Vector3D<double>(0, 0, 1), crossProduct(unitX + unitY, unitY));
+
+    const Vector3D<int> v3{ 2, 3, 6 };
+    ASSERT_EQUALS(true, withinEps(7.0, v3.euclideanNorm(), 1e-10, 1e-10));
+    ASSERT_EQUALS(Vector3D<double>(2.0 / 7, 3.0 / 7, 6.0 / 7), v3.vecNorm());
+    ASSERT_EQUALS(true, withinEps(1.0, Vector3D<float>{ 1.5f, -2.5f, 0.5f }.vecNorm().euclideanNorm(), 1e-10, 1e-10));
+    ASSERT_EQUALS(Punto3D<double>(1, 0, 0), unitX.getEnd());
+}
+
 int main() {
     RUN(testVectorInit);
     RUN(testVectorDotProduct);
@@ -130,6 +183,8 @@ int main() {
     RUN(testVectorScale);
     RUN(testVectorNormalize);
     RUN(testVectorCrossProdValue);
+    RUN(testVectorConstexpr);
+    RUN(testVector3D);
 
     return TEST_REPORT();
 }